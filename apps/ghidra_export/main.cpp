@@ -1,10 +1,97 @@
+#include <cstdio>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "ghirda/core/program.h"
+#include "ghirda/loader/container.h"
+#include "ghirda/loader/loader_registry.h"
+#include "ghirda/plugin/registry.h"
+
+namespace {
+
+const char* symbol_kind_name(ghirda::core::SymbolKind kind) {
+  switch (kind) {
+    case ghirda::core::SymbolKind::Function:
+      return "function";
+    case ghirda::core::SymbolKind::Label:
+      return "label";
+    case ghirda::core::SymbolKind::Data:
+      return "data";
+    case ghirda::core::SymbolKind::External:
+      return "external";
+    case ghirda::core::SymbolKind::Unknown:
+      break;
+  }
+  return "unknown";
+}
+
+void print_symbols(const ghirda::core::Program& program) {
+  for (const auto& symbol : program.symbols()) {
+    char address[24];
+    std::snprintf(address, sizeof(address), "0x%016llx", static_cast<unsigned long long>(symbol.address));
+    std::cout << address << ' ' << symbol_kind_name(symbol.kind) << ' ' << symbol.name << '\n';
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: ghidra_export <image|archive> [--loader <name>]" << std::endl;
+    return 2;
+  }
+  std::string loader_name;
+  for (int i = 2; i + 1 < argc; ++i) {
+    if (std::string(argv[i]) == "--loader") {
+      loader_name = argv[i + 1];
+    }
+  }
+
+  auto loaders = ghirda::loader::LoaderRegistry::with_builtin_loaders();
+  ghirda::plugin::Registry plugins;
+  plugins.install_loaders(&loaders);
+
+  std::string error;
+  auto source = ghirda::loader::open_byte_source(argv[1], &error);
+  if (!source) {
+    std::cerr << "load failed: " << error << std::endl;
+    return 1;
+  }
+
+  // Archives go member by member; anything only the raw loader would take is
+  // tried as a container first.
+  std::vector<ghirda::loader::LoaderMatch> matches;
+  if (loader_name.empty() && loaders.probe(*source, &matches, nullptr) &&
+      (matches.empty() || matches.front().confidence <= 1)) {
+    ghirda::loader::Container container;
+    if (ghirda::loader::Container::open(*source, &container, nullptr)) {
+      std::vector<ghirda::core::Program> programs;
+      std::vector<ghirda::loader::ContainerMemberResult> results;
+      const bool ok = ghirda::loader::load_container(*source, loaders, "export", &programs, &results, &error);
+      size_t next = 0;
+      for (const auto& result : results) {
+        if (!result.error.empty()) {
+          std::cerr << result.member << ": " << result.error << std::endl;
+        }
+        if (result.loaded) {
+          std::cout << "# member " << result.member << " loader " << result.loader << std::endl;
+          print_symbols(programs[next++]);
+        }
+      }
+      return ok ? 0 : 1;
+    }
+  }
 
-int main() {
   ghirda::core::Program program("export");
-  std::cout << "ghidra_export: not implemented" << std::endl;
-  (void)program;
+  const bool loaded = loader_name.empty() ? loaders.load(*source, &program, &error, &loader_name)
+                                          : loaders.load_with(loader_name, *source, &program, &error);
+  if (!loaded) {
+    std::cerr << "load failed: " << error << std::endl;
+    return 1;
+  }
+
+  std::cout << "# loader " << loader_name << std::endl;
+  print_symbols(program);
   return 0;
 }
@@ -1,31 +1,332 @@
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "ghirda/analysis/function_discovery.h"
+#include "ghirda/analysis/function_id.h"
+#include "ghirda/analysis/string_discovery.h"
+#include "ghirda/core/byte_pattern.h"
 #include "ghirda/decompiler/decompiler.h"
+#include "ghirda/decompiler/type_propagation.h"
+#include "ghirda/loader/container.h"
 #include "ghirda/loader/elf_loader.h"
+#include "ghirda/loader/loader_registry.h"
+#include "ghirda/loader/raw_loader.h"
+#include "ghirda/plugin/registry.h"
 #include "ghirda/sleigh/decoder.h"
 
+namespace {
+
+ghirda::decompiler::SSAGraph build_bench_graph(const ghirda::core::Program& program, size_t op_count) {
+  using ghirda::decompiler::SSAOp;
+  using ghirda::decompiler::SSAValue;
+  using ghirda::sleigh::OpCode;
+
+  std::vector<uint64_t> functions;
+  for (const auto& func : program.debug_info().functions) {
+    functions.push_back(func.low_pc);
+  }
+  std::vector<uint64_t> data;
+  for (const auto& sym : program.symbols()) {
+    if (sym.kind == ghirda::core::SymbolKind::Function) {
+      functions.push_back(sym.address);
+    } else {
+      data.push_back(sym.address);
+    }
+  }
+  if (functions.empty()) {
+    functions.push_back(0x1000);
+  }
+  if (data.empty()) {
+    data.push_back(0x2000);
+  }
+
+  ghirda::decompiler::SSAGraph graph;
+  uint64_t next_id = 0;
+  auto value = [&](bool is_constant, uint64_t constant) {
+    SSAValue v{};
+    v.id = next_id++;
+    v.size = 8;
+    v.is_constant = is_constant;
+    v.constant = constant;
+    graph.add_value(v);
+    return v.id;
+  };
+  auto op = [&](OpCode opcode, uint64_t output, std::vector<uint64_t> inputs) {
+    SSAOp o{};
+    o.opcode = opcode;
+    o.output = output;
+    o.inputs = std::move(inputs);
+    graph.add_op(o);
+  };
+
+  uint64_t cursor = value(false, 0);
+  uint64_t carried = value(false, 0);
+  for (size_t i = 0; graph.ops().size() < op_count; ++i) {
+    uint64_t slot = value(true, data[i % data.size()]);
+    uint64_t loaded = value(false, 0);
+    op(OpCode::Load, loaded, {slot});
+
+    uint64_t stride = value(true, 8);
+    uint64_t element = value(false, 0);
+    op(OpCode::PtrAdd, element, {cursor, stride});
+    uint64_t field = value(false, 0);
+    op(OpCode::Load, field, {element});
+    op(OpCode::Store, ghirda::decompiler::kNoSSAValue, {element, loaded});
+
+    uint64_t target = value(true, functions[i % functions.size()]);
+    uint64_t ret = value(false, 0);
+    op(OpCode::Call, ret, {target});
+    uint64_t sum = value(false, 0);
+    op(OpCode::IntAdd, sum, {ret, field});
+    uint64_t merged = value(false, 0);
+    op(OpCode::MultiEqual, merged, {sum, carried});
+
+    carried = merged;
+    cursor = element;
+  }
+  return graph;
+}
+
+void bench_types(const ghirda::core::Program& program, size_t op_count) {
+  ghirda::decompiler::SSAGraph graph = build_bench_graph(program, op_count);
+  for (bool use_debug : {true, false}) {
+    ghirda::decompiler::TypePropagator propagator(program);
+    propagator.set_use_debug_info(use_debug);
+    ghirda::decompiler::TypePropagationResult result;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = propagator.run(graph, &result, &error);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "type propagation (" << (use_debug ? "debug" : "no debug") << "): "
+              << (ok ? "ok" : error) << " ops=" << graph.ops().size() << " classes=" << result.stats.classes
+              << " seeded=" << result.stats.seeded << " conflicts=" << result.stats.conflicts
+              << " time_ms=" << elapsed.count() << std::endl;
+  }
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
   if (argc < 2) {
-    std::cerr << "usage: ghidra_headless <elf>" << std::endl;
+    std::cerr << "usage: ghidra_headless <image> [--loader <name>] [--base <addr>] [--bench-types <ops>] "
+                 "[--debug-dir <dir>] [--debug-index <file>] [--analyze <threads>] [--search <hex pattern>]... "
+                 "[--fid <signature db>] [--fid-build <signature db>] [--strings <min length>] "
+                 "[--debug-function <name>]"
+              << std::endl;
     return 2;
   }
 
+  size_t bench_type_ops = 0;
+  bool analyze = false;
+  size_t analysis_threads = 0;
+  std::vector<std::string> search_patterns;
+  std::string fid_path;
+  std::string fid_build_path;
+  uint32_t string_min_length = 0;
+  std::string debug_function;
+  std::string loader_name;
+  ghirda::loader::RawLoaderOptions raw_options;
+  auto debug_files = std::make_shared<ghirda::loader::DebugFileResolver>();
+  for (int i = 2; i + 1 < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--loader") {
+      loader_name = argv[i + 1];
+    } else if (arg == "--base") {
+      raw_options.base_address = std::strtoull(argv[i + 1], nullptr, 0);
+    } else if (arg == "--bench-types") {
+      bench_type_ops = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+    } else if (arg == "--debug-dir") {
+      debug_files->add_root(argv[i + 1]);
+    } else if (arg == "--debug-index") {
+      debug_files->set_index_path(argv[i + 1]);
+    } else if (arg == "--analyze") {
+      analyze = true;
+      analysis_threads = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+    } else if (arg == "--search") {
+      search_patterns.push_back(argv[i + 1]);
+    } else if (arg == "--fid") {
+      fid_path = argv[i + 1];
+      analyze = true;
+    } else if (arg == "--fid-build") {
+      fid_build_path = argv[i + 1];
+      analyze = true;
+    } else if (arg == "--strings") {
+      string_min_length = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+    } else if (arg == "--debug-function") {
+      debug_function = argv[i + 1];
+    }
+  }
+
+  auto loaders = ghirda::loader::LoaderRegistry::with_builtin_loaders();
+  loaders.add("elf", [debug_files] {
+    auto loader = std::make_unique<ghirda::loader::ElfLoader>();
+    loader->set_debug_file_resolver(debug_files);
+    return loader;
+  });
+  loaders.add("raw", [raw_options] { return std::make_unique<ghirda::loader::RawLoader>(raw_options); });
+  ghirda::plugin::Registry plugins;
+  plugins.install_loaders(&loaders);
+
   ghirda::core::Program program("sample");
-  ghirda::loader::ElfLoader loader;
   std::string error;
-  if (!loader.load(argv[1], &program, &error)) {
+  auto source = ghirda::loader::open_byte_source(argv[1], &error);
+  // Answers from the name index without loading the image.
+  if (source && !debug_function.empty()) {
+    ghirda::loader::ElfLoader elf;
+    elf.set_debug_file_resolver(debug_files);
+    ghirda::core::DebugFunction function;
+    bool indexed = false;
+    auto start = std::chrono::steady_clock::now();
+    const bool found = elf.find_debug_function(*source, debug_function, &function, &indexed, &error);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    if (!found) {
+      std::cerr << "debug function not found: " << debug_function << (error.empty() ? "" : " (" + error + ")")
+                << std::endl;
+      return 1;
+    }
+    std::cout << "debug function: " << function.name << " low_pc=0x" << std::hex << function.low_pc
+              << " high_pc=0x" << function.high_pc << std::dec << " via=" << (indexed ? "debug_names" : "die_walk")
+              << " time_ms=" << elapsed.count() << std::endl;
+    return 0;
+  }
+  // Archives hold several programs; rather than raw-load one as a flat blob,
+  // point at ghidra_export, which loads them member by member.
+  std::vector<ghirda::loader::LoaderMatch> matches;
+  if (source && loader_name.empty() && loaders.probe(*source, &matches, nullptr) &&
+      (matches.empty() || matches.front().confidence <= 1)) {
+    ghirda::loader::Container container;
+    if (ghirda::loader::Container::open(*source, &container, nullptr)) {
+      std::cerr << "load failed: " << argv[1] << ": " << ghirda::loader::container_format_name(container.format())
+                << " archive with " << container.members().size()
+                << " member(s); use ghidra_export, or --loader to force one loader" << std::endl;
+      return 1;
+    }
+  }
+  bool loaded = false;
+  if (source) {
+    loaded = loader_name.empty() ? loaders.load(*source, &program, &error, &loader_name)
+                                 : loaders.load_with(loader_name, *source, &program, &error);
+  }
+  if (!loaded) {
     std::cerr << "load failed: " << error << std::endl;
     return 1;
   }
 
+  std::cout << "loader: " << loader_name << " (" << ghirda::core::processor_name(program.processor()) << ")"
+            << std::endl;
+
   std::cout << "loaded program with " << program.memory_map().regions().size() << " region(s)" << std::endl;
   std::cout << "image segments: " << program.memory_image().segments().size() << std::endl;
   std::cout << "relocations: " << program.relocations().size() << std::endl;
+  std::cout << "references: " << program.references().size() << std::endl;
+  std::cout << "call frames: " << program.call_frames().size() << std::endl;
   std::cout << "debug functions: " << program.debug_info().functions.size() << std::endl;
+  std::cout << "types: " << program.types().types().size() << " (" << program.types().duplicates_dropped()
+            << " duplicate(s) merged, " << program.types().name_collisions() << " name collision(s))" << std::endl;
   std::cout << "debug lines: " << program.debug_info().lines.size() << std::endl;
+  if (!program.debug_info().debug_file.empty()) {
+    std::cout << "debug file: " << program.debug_info().debug_file << std::endl;
+  }
+  if (!program.debug_info().unresolved_split_units.empty()) {
+    std::cout << "unresolved split units: " << program.debug_info().unresolved_split_units.size() << std::endl;
+  }
   std::cout << "sections: " << program.sections().size() << std::endl;
   std::cout << "segments: " << program.segments().size() << std::endl;
 
+  if (analyze) {
+    ghirda::analysis::FunctionDiscoveryOptions options;
+    options.thread_count = analysis_threads;
+    ghirda::analysis::FunctionDiscovery discovery(&program, options);
+    auto start = std::chrono::steady_clock::now();
+    discovery.run(&error);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    const auto& stats = discovery.stats();
+    const auto& graph = discovery.call_graph();
+    size_t recursive = 0;
+    for (uint32_t node = 0; node < graph.node_count(); ++node) {
+      recursive += graph.recursive(node) ? 1 : 0;
+    }
+    std::cout << "functions: " << discovery.functions().size() << " (seeds=" << stats.seeds
+              << " call_targets=" << stats.call_targets << " prologues=" << stats.prologues << ")" << std::endl;
+    std::cout << "call graph: " << graph.node_count() << " node(s) " << graph.edge_count() << " edge(s) "
+              << graph.component_count() << " component(s) " << recursive << " recursive" << std::endl;
+    std::cout << "analysis: rounds=" << stats.rounds << " decoded=" << stats.decoded
+              << " instructions=" << stats.instructions << " references=" << program.references().size()
+              << " time_ms=" << elapsed.count() << std::endl;
+
+    ghirda::analysis::FunctionIdOptions fid_options;
+    fid_options.thread_count = analysis_threads;
+    if (!fid_build_path.empty()) {
+      ghirda::analysis::SignatureDatabaseBuilder builder;
+      const std::string image = argv[1];
+      const std::string library = image.substr(image.find_last_of('/') + 1);
+      const size_t added =
+          ghirda::analysis::add_program_signatures(program, discovery.functions(), library, fid_options, &builder);
+      if (!builder.write(fid_build_path, &error)) {
+        std::cerr << "fid build failed: " << error << std::endl;
+        return 1;
+      }
+      std::cout << "fid signatures written: " << added << std::endl;
+    }
+    if (!fid_path.empty()) {
+      ghirda::analysis::SignatureDatabase database;
+      std::vector<ghirda::analysis::FunctionIdMatch> matches;
+      ghirda::analysis::FunctionIdStats fid_stats;
+      start = std::chrono::steady_clock::now();
+      if (!database.open(fid_path, &error) ||
+          !ghirda::analysis::identify_functions(&program, discovery.functions(), database, fid_options, &matches,
+                                                &fid_stats, &error)) {
+        std::cerr << "fid failed: " << error << std::endl;
+        return 1;
+      }
+      elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+      std::cout << "fid: signatures=" << database.size() << " hashed=" << fid_stats.hashed
+                << " matched=" << fid_stats.matched << " ambiguous=" << fid_stats.ambiguous
+                << " applied=" << fid_stats.applied << " time_ms=" << elapsed.count() << std::endl;
+    }
+  }
+
+  if (string_min_length != 0) {
+    ghirda::analysis::StringDiscoveryOptions options;
+    options.min_length = string_min_length;
+    options.thread_count = analysis_threads;
+    ghirda::analysis::StringDiscoveryStats stats;
+    auto start = std::chrono::steady_clock::now();
+    if (!ghirda::analysis::discover_strings(&program, options, &stats, &error)) {
+      std::cerr << "string discovery failed: " << error << std::endl;
+      return 1;
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "strings: ascii=" << stats.ascii << " utf8=" << stats.utf8 << " utf16=" << stats.utf16
+              << " referenced=" << stats.referenced << " bytes=" << stats.bytes_scanned
+              << " time_ms=" << elapsed.count() << std::endl;
+  }
+
+  if (!search_patterns.empty()) {
+    ghirda::core::PatternSet patterns;
+    for (const auto& text : search_patterns) {
+      if (!patterns.add(text, nullptr, &error)) {
+        std::cerr << "bad pattern '" << text << "': " << error << std::endl;
+        return 2;
+      }
+    }
+    patterns.compile();
+    std::vector<ghirda::core::PatternMatch> matches;
+    auto start = std::chrono::steady_clock::now();
+    program.memory_image().search(patterns, &matches);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "pattern matches: " << matches.size() << " time_ms=" << elapsed.count() << std::endl;
+    constexpr size_t kShownMatches = 16;
+    for (size_t i = 0; i < matches.size() && i < kShownMatches; ++i) {
+      std::cout << "  0x" << std::hex << matches[i].address << std::dec << " " << search_patterns[matches[i].pattern]
+                << std::endl;
+    }
+  }
+
   ghirda::sleigh::Decoder decoder;
   std::vector<uint8_t> bytes{0x90};
   auto decode = decoder.decode(bytes, 0x1000);
@@ -34,5 +335,9 @@ int main(int argc, char** argv) {
   ghirda::decompiler::Decompiler decompiler;
   auto result = decompiler.decompile_function(program, 0x1000);
   std::cout << "decompile success: " << result.success << std::endl;
+
+  if (bench_type_ops != 0) {
+    bench_types(program, bench_type_ops);
+  }
   return 0;
 }
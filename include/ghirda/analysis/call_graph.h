@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ghirda::analysis {
+
+struct CallEdge {
+  uint64_t caller = 0;
+  uint64_t callee = 0;
+};
+
+// Function-level call graph in compressed sparse row form: nodes are
+// function entries in address order, and each node's callees (and, in a
+// second CSR, its callers) are one contiguous, sorted slice of a shared
+// array. build() also splits the graph into strongly connected components.
+class CallGraph {
+public:
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+
+  // Edges whose ends are not both in entries are dropped, as are duplicates.
+  void build(std::vector<uint64_t> entries, std::span<const CallEdge> edges);
+
+  size_t node_count() const;
+  size_t edge_count() const;
+  // kNoNode when entry is not a node.
+  uint32_t node_at(uint64_t entry) const;
+  uint64_t entry(uint32_t node) const;
+  std::span<const uint32_t> callees(uint32_t node) const;
+  std::span<const uint32_t> callers(uint32_t node) const;
+
+  // Components are numbered callees first: every component a node calls
+  // into has a smaller number than its own, unless it is the same one.
+  size_t component_count() const;
+  uint32_t component(uint32_t node) const;
+  std::span<const uint32_t> component_members(uint32_t component) const;
+  // In a component of several functions, or calls itself.
+  bool recursive(uint32_t node) const;
+
+private:
+  void compute_components();
+
+  std::vector<uint64_t> entries_{};
+  std::vector<uint32_t> callee_offsets_{};
+  std::vector<uint32_t> callee_nodes_{};
+  std::vector<uint32_t> caller_offsets_{};
+  std::vector<uint32_t> caller_nodes_{};
+  std::vector<uint32_t> component_of_{};
+  std::vector<uint32_t> component_offsets_{};
+  std::vector<uint32_t> component_nodes_{};
+};
+
+} // namespace ghirda::analysis
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "ghirda/core/processor.h"
+
+namespace ghirda::analysis {
+
+enum class FlowKind : uint8_t {
+  Fallthrough,
+  Jump,
+  ConditionalJump,
+  Call,
+  Return,
+  IndirectJump,
+  IndirectCall,
+  // Execution does not continue: hlt, int3, ud2, brk, udf.
+  Halt,
+  Invalid,
+};
+
+struct FlowInstruction {
+  uint8_t length = 0;
+  FlowKind kind = FlowKind::Invalid;
+  // Branch or call destination, when encoded in the instruction.
+  bool has_target = false;
+  uint64_t target = 0;
+  // Absolute or PC-relative data operand (x86 disp32/moffs, RIP-relative
+  // memory, AArch64 ADR and literal loads).
+  bool has_data = false;
+  bool data_write = false;
+  uint64_t data = 0;
+  // x86 ModRM displacement and immediate fields as offset and size in
+  // bytes (size 0 when absent), for callers that mask layout-dependent
+  // operands. Relative branch targets and moffs addresses are immediates.
+  uint8_t displacement_offset = 0;
+  uint8_t displacement_size = 0;
+  uint8_t immediate_offset = 0;
+  uint8_t immediate_size = 0;
+};
+
+// True for the instruction sets decode_flow() understands: x86, x86-64 and
+// AArch64.
+bool flow_supported(ghirda::core::Processor processor);
+
+// Decodes just enough of the instruction at the start of bytes to follow
+// control flow: its length, how it transfers control and where to, and any
+// data address it names. Returns false, with kind Invalid, on an unknown or
+// truncated encoding.
+bool decode_flow(ghirda::core::Processor processor, std::span<const uint8_t> bytes, uint64_t address,
+                 FlowInstruction* out);
+
+} // namespace ghirda::analysis
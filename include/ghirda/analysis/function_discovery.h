@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ghirda/analysis/call_graph.h"
+#include "ghirda/core/program.h"
+
+namespace ghirda::analysis {
+
+// Half-open [start, end).
+struct AddressRange {
+  uint64_t start = 0;
+  uint64_t end = 0;
+};
+
+enum class FunctionSource : uint8_t {
+  // Loader metadata (Program::FunctionStartSource).
+  EntryPoint,
+  Export,
+  ExceptionTable,
+  TlsCallback,
+  // Function symbols and DWARF subprograms.
+  Symbol,
+  // Targets of relocated pointers (Pointer references) in executable memory.
+  Pointer,
+  CallTarget,
+  Prologue,
+  // Passed to add_entries().
+  Requested,
+};
+
+const char* function_source_name(FunctionSource source);
+
+struct Function {
+  uint64_t entry = 0;
+  // Sorted, disjoint ranges of the instructions reachable from entry without
+  // flowing into another function's entry.
+  std::vector<AddressRange> body;
+  FunctionSource source = FunctionSource::Requested;
+};
+
+struct FunctionDiscoveryOptions {
+  // Seed from Function symbols and DWARF subprograms besides loader metadata.
+  bool use_symbols = true;
+  // Look for prologue patterns in executable bytes no body covers.
+  bool scan_prologues = true;
+  // Name new functions FUN_<address> in the program's symbol table.
+  bool add_symbols = true;
+  // Add Call/Jump/Read/Write references to the program's database.
+  bool record_references = true;
+  // Decode workers (0 = hardware concurrency).
+  size_t thread_count = 0;
+  // Per-function cap on decoded instructions.
+  size_t max_instructions = size_t{1} << 20;
+};
+
+struct FunctionDiscoveryStats {
+  size_t seeds = 0;
+  size_t call_targets = 0;
+  size_t prologues = 0;
+  // Decode rounds, and functions (re)decoded across them.
+  size_t rounds = 0;
+  size_t decoded = 0;
+  size_t instructions = 0;
+};
+
+// Finds functions by recursive descent from seeds over the program's
+// executable memory. Each round decodes the pending entries on worker
+// threads; call targets found there become the next round's entries, and a
+// function whose body a new entry splits is decoded again. Jumps to another
+// function's entry are tail calls. Only processors with a flow decoder
+// (flow_supported()) get bodies; others keep their seeds as empty
+// functions.
+class FunctionDiscovery {
+public:
+  explicit FunctionDiscovery(ghirda::core::Program* program, FunctionDiscoveryOptions options = {});
+
+  // Seeds from the program and runs to a fixed point.
+  bool run(std::string* error);
+  // Adds entries found elsewhere (a script, a user) and follows what they
+  // call, re-decoding only the functions they affect.
+  bool add_entries(std::span<const uint64_t> entries, std::string* error);
+
+  // Ordered by entry.
+  const std::vector<Function>& functions() const;
+  const Function* function_at(uint64_t entry) const;
+  const Function* function_containing(uint64_t address) const;
+  const CallGraph& call_graph() const;
+  const FunctionDiscoveryStats& stats() const;
+
+private:
+  struct CodeChunk {
+    uint64_t start = 0;
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+  };
+  struct Seed {
+    uint64_t entry = 0;
+    FunctionSource source = FunctionSource::Requested;
+  };
+  struct Decoded {
+    std::vector<AddressRange> body;
+    std::vector<CallEdge> calls;
+    std::vector<uint64_t> new_targets;
+    std::vector<ghirda::core::Reference> references;
+    size_t instructions = 0;
+  };
+
+  void collect_code();
+  const CodeChunk* chunk_at(uint64_t address) const;
+  bool is_entry(uint64_t address) const;
+  void decode(uint32_t index, Decoded* out) const;
+  // Decodes seeds and everything they reach; returns the number of new
+  // functions.
+  size_t explore(std::vector<Seed> seeds);
+  std::vector<Seed> scan_prologues() const;
+  void rebuild_index();
+  void finish(size_t first_new);
+
+  ghirda::core::Program* program_;
+  FunctionDiscoveryOptions options_;
+  ghirda::core::Processor processor_ = ghirda::core::Processor::Unknown;
+  std::vector<CodeChunk> chunks_{};
+  std::vector<Function> functions_{};
+  // Call edges out of each function, parallel to functions_.
+  std::vector<std::vector<CallEdge>> calls_{};
+  std::unordered_map<uint64_t, uint32_t> index_{};
+  // Entries as of the current round, sorted.
+  std::vector<uint64_t> entries_{};
+  // Every body range with its function, sorted by start; reach_[i] is the
+  // largest end among ranges_[0..i].
+  std::vector<AddressRange> ranges_{};
+  std::vector<uint32_t> range_owner_{};
+  std::vector<uint64_t> reach_{};
+  CallGraph call_graph_{};
+  FunctionDiscoveryStats stats_{};
+};
+
+} // namespace ghirda::analysis
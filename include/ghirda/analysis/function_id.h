@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ghirda/analysis/function_discovery.h"
+#include "ghirda/core/program.h"
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::analysis {
+
+struct FunctionHash {
+  uint64_t hash = 0;
+  // Body bytes hashed.
+  uint32_t size = 0;
+};
+
+// Hashes function bodies with the bytes that depend on where code and data
+// were linked zeroed: words the program's relocations patch, x86 relative
+// branch targets, RIP-relative and absolute memory operands, displacements
+// and immediates that hold an address inside the image, and on AArch64 the
+// PC-relative immediates and the page offsets used with ADRP. Two copies of a
+// function linked into different images hash alike.
+class FunctionHasher {
+public:
+  explicit FunctionHasher(const ghirda::core::Program& program);
+
+  // False when the body is empty or not backed by image bytes.
+  bool hash(const Function& function, FunctionHash* out) const;
+
+private:
+  struct Span {
+    uint64_t start = 0;
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+  };
+
+  const Span* span_at(uint64_t address) const;
+  bool looks_like_address(uint64_t value) const;
+  void mask_instructions(uint64_t address, uint8_t* bytes, size_t size, uint32_t* adrp_registers) const;
+  void mask_relocations(uint64_t address, uint8_t* bytes, size_t size) const;
+
+  ghirda::core::Processor processor_ = ghirda::core::Processor::Unknown;
+  std::vector<Span> spans_{};
+  // Patched ranges, sorted by start.
+  std::vector<std::pair<uint64_t, uint8_t>> relocated_{};
+};
+
+// Collects signatures and writes them as a database file.
+class SignatureDatabaseBuilder {
+public:
+  void add(const FunctionHash& hash, std::string_view name, std::string_view library);
+  size_t size() const;
+  std::vector<uint8_t> serialize() const;
+  bool write(const std::string& path, std::string* error) const;
+
+private:
+  struct Signature {
+    FunctionHash hash;
+    std::string name;
+    std::string library;
+  };
+
+  std::vector<Signature> signatures_{};
+};
+
+struct SignatureMatch {
+  std::string_view name;
+  std::string_view library;
+  // Another signature with the same hash and size has a different name.
+  bool ambiguous = false;
+};
+
+// Read-only view of a signature database. The file is a header, a
+// directory of the first entry for each top-bits hash prefix, fixed-size
+// entries sorted by (hash, size) and a string table, all little-endian, so
+// it is used straight from a mapping: a lookup reads two directory slots and
+// scans the few entries between them.
+class SignatureDatabase {
+public:
+  bool open(const std::string& path, std::string* error);
+  // Uses bytes in place; they must outlive the database.
+  bool attach(std::span<const uint8_t> bytes, std::string* error);
+
+  size_t size() const;
+  // Appends the signatures for hash and returns how many were appended.
+  size_t lookup(const FunctionHash& hash, std::vector<SignatureMatch>* out) const;
+
+private:
+  std::string_view string_at(uint32_t offset) const;
+
+  std::unique_ptr<ghirda::loader::ByteSource> file_{};
+  ghirda::loader::ByteView view_{};
+  std::span<const uint8_t> bytes_{};
+  uint32_t directory_bits_ = 0;
+  uint64_t count_ = 0;
+  size_t directory_offset_ = 0;
+  size_t entries_offset_ = 0;
+  size_t strings_offset_ = 0;
+  size_t strings_size_ = 0;
+};
+
+struct FunctionIdOptions {
+  // Bodies smaller than this are too generic to identify.
+  uint32_t min_size = 16;
+  // Name functions whose signatures are ambiguous after the first name.
+  bool apply_ambiguous = false;
+  // Replace names other than the FUN_ defaults.
+  bool rename_named = false;
+  // Hashing workers (0 = hardware concurrency).
+  size_t thread_count = 0;
+};
+
+struct FunctionIdMatch {
+  uint64_t entry = 0;
+  std::string name;
+  std::string library;
+  bool ambiguous = false;
+};
+
+struct FunctionIdStats {
+  size_t hashed = 0;
+  size_t matched = 0;
+  size_t ambiguous = 0;
+  // Symbols added or renamed.
+  size_t applied = 0;
+};
+
+// Hashes functions on worker threads, looks each up in database and names
+// the matches in the program's symbol table: FUN_ defaults are renamed,
+// functions without a symbol gain one.
+bool identify_functions(ghirda::core::Program* program, std::span<const Function> functions,
+                        const SignatureDatabase& database, const FunctionIdOptions& options,
+                        std::vector<FunctionIdMatch>* matches, FunctionIdStats* stats, std::string* error);
+
+// Adds a signature for every function with a Function symbol at its entry
+// other than a FUN_ default, and returns how many were added.
+size_t add_program_signatures(const ghirda::core::Program& program, std::span<const Function> functions,
+                              std::string_view library, const FunctionIdOptions& options,
+                              SignatureDatabaseBuilder* builder);
+
+} // namespace ghirda::analysis
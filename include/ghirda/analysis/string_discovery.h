@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ghirda/core/data_item.h"
+#include "ghirda/core/program.h"
+
+namespace ghirda::analysis {
+
+struct StringDiscoveryOptions {
+  // Characters, not bytes.
+  uint32_t min_length = 4;
+  bool ascii = true;
+  bool utf8 = true;
+  // UTF-16LE strings of ASCII-range characters at even addresses.
+  bool utf16 = true;
+  // Strings end at a NUL (two for UTF-16).
+  bool require_terminator = true;
+  // Also scan code sections, or executable memory when the format marks no
+  // code sections.
+  bool scan_code = false;
+  // Scanning workers (0 = hardware concurrency).
+  size_t thread_count = 0;
+};
+
+struct StringDiscoveryStats {
+  uint64_t bytes_scanned = 0;
+  size_t ascii = 0;
+  size_t utf8 = 0;
+  size_t utf16 = 0;
+  // Strings with at least one reference to their start.
+  size_t referenced = 0;
+};
+
+// Appends the strings in data, mapped at base, ordered by address, and
+// returns how many were appended. Bytes are classified 64 at a time into
+// printable, high-bit and zero masks (with AVX2 or SSE2 on x86-64), and
+// strings are read off the runs in those masks; only runs holding high-bit
+// bytes are decoded byte by byte, to validate UTF-8.
+size_t scan_strings(std::span<const uint8_t> data, uint64_t base, const StringDiscoveryOptions& options,
+                    std::vector<ghirda::core::DataItem>* out);
+
+// Scans readable memory outside code on worker threads, adds the strings to
+// the program's data items, finalizes them and counts their references from
+// the program's finalized reference database.
+bool discover_strings(ghirda::core::Program* program, const StringDiscoveryOptions& options,
+                      StringDiscoveryStats* stats, std::string* error);
+
+} // namespace ghirda::analysis
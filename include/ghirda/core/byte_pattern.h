@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ghirda::core {
+
+// A byte string where mask selects the bits that must match; mask 0x00 is a
+// wildcard byte and 0xf0/0x0f a wildcard nibble.
+struct BytePattern {
+  std::vector<uint8_t> bytes;
+  std::vector<uint8_t> mask;
+};
+
+// Parses hex bytes with optional whitespace, "??" for any byte and "?" for
+// any nibble: "48 8b 05 ?? ?? ?? ?? e8 ?5".
+bool parse_byte_pattern(std::string_view text, BytePattern* out, std::string* error);
+BytePattern literal_byte_pattern(std::span<const uint8_t> bytes);
+
+struct PatternMatch {
+  uint64_t address = 0;
+  uint32_t pattern = 0;
+};
+
+// Many patterns compiled for one pass over the data. Each pattern is keyed
+// by an anchor: its least common run of four fully specified bytes (or two,
+// or one, when it has no such run). The scan hashes the four-byte window at
+// every position into a bit filter of about 128 bits per anchor; on x86-64
+// CPUs with AVX2 eight windows are hashed and probed per step with a
+// gather. Windows that pass look up the anchor's bucket and verify the
+// candidate patterns under their masks, eight bytes at a time. Patterns
+// without a four-byte anchor go through direct-indexed tables in separate
+// passes.
+class PatternSet {
+public:
+  // Sets id to the pattern's index. Patterns need at least one fully
+  // specified byte.
+  bool add(const BytePattern& pattern, uint32_t* id, std::string* error);
+  bool add(std::string_view text, uint32_t* id, std::string* error);
+  // Builds the filter and buckets; call after the last add() and before
+  // scanning.
+  void compile();
+
+  size_t size() const;
+  bool compiled() const;
+  const BytePattern& pattern(uint32_t id) const;
+
+  // Appends matches in data, mapped at base, grouped by anchor width rather
+  // than sorted, and returns how many were appended. Only matches whose
+  // anchor starts in [first, last) are reported, but patterns may read data
+  // outside that window, so adjacent windows find every match exactly once.
+  size_t scan(std::span<const uint8_t> data, uint64_t base, std::vector<PatternMatch>* out, size_t first = 0,
+              size_t last = SIZE_MAX) const;
+
+private:
+  struct Compiled {
+    std::vector<uint64_t> bytes;
+    std::vector<uint64_t> mask;
+    uint32_t length = 0;
+    uint32_t anchor = 0;
+    uint8_t anchor_length = 0;
+  };
+  struct Entry {
+    uint32_t key = 0;
+    uint32_t pattern = 0;
+    // Pattern bytes from the anchor on, for a one-load reject.
+    uint64_t head = 0;
+    uint64_t head_mask = 0;
+  };
+
+  bool matches(const Compiled& pattern, const uint8_t* data, size_t size, size_t start) const;
+  void verify_window(const uint8_t* data, size_t size, size_t position, uint64_t base,
+                     std::vector<PatternMatch>* out) const;
+  void verify(uint32_t begin, uint32_t end, const std::vector<Entry>& entries, uint32_t key, const uint8_t* data,
+              size_t size, size_t position, uint64_t base, std::vector<PatternMatch>* out) const;
+
+  std::vector<BytePattern> patterns_{};
+  std::vector<Compiled> compiled_{};
+  bool ready_ = false;
+  // Four-byte anchors: one filter bit per filter_bits_-bit window hash, and
+  // CSR buckets keyed by the hash's top bits.
+  unsigned filter_bits_ = 0;
+  unsigned bucket_shift_ = 0;
+  std::vector<uint32_t> filter_{};
+  std::vector<uint32_t> word_offsets_{};
+  std::vector<Entry> word_entries_{};
+  // Two-byte anchors by value, and one-byte anchors by byte.
+  std::vector<uint64_t> pair_filter_{};
+  std::vector<uint32_t> pair_offsets_{};
+  std::vector<Entry> pair_entries_{};
+  std::vector<uint32_t> byte_offsets_{};
+  std::vector<Entry> byte_entries_{};
+};
+
+} // namespace ghirda::core
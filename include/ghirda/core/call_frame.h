@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ghirda::core {
+
+// Registers use the processor's DWARF numbering (x86-64: rbp 6, rsp 7,
+// return address 16; AArch64: x29 29, x30 30, sp 31).
+enum class CfaRuleKind : uint8_t {
+  Undefined,
+  // CFA = register + offset.
+  RegisterOffset,
+  Expression,
+};
+
+enum class RegisterRuleKind : uint8_t {
+  Undefined,
+  SameValue,
+  // Saved at CFA + offset.
+  Offset,
+  // Value is CFA + offset.
+  ValueOffset,
+  // Held in another register.
+  Register,
+  // Saved at the address an expression computes, or the expression's value.
+  Expression,
+  ValueExpression,
+};
+
+struct RegisterRule {
+  uint32_t reg = 0;
+  RegisterRuleKind kind = RegisterRuleKind::SameValue;
+  int64_t offset = 0;
+  uint32_t other = 0;
+  // Expression bytes, pointing into the table that produced the rule.
+  std::span<const uint8_t> expression{};
+};
+
+// Unwind rules for a range of instructions of one function.
+struct CallFrameRow {
+  uint64_t start = 0;
+  uint64_t end = 0;
+  CfaRuleKind cfa = CfaRuleKind::Undefined;
+  uint32_t cfa_register = 0;
+  int64_t cfa_offset = 0;
+  std::span<const uint8_t> cfa_expression{};
+  uint32_t return_address_register = 0;
+  bool signal_frame = false;
+  // Registers whose rule the CFI sets, ordered by register number.
+  std::vector<RegisterRule> registers;
+};
+
+struct FrameDescription {
+  uint64_t start = 0;
+  uint64_t end = 0;
+  // Offset of the FDE in .eh_frame.
+  uint64_t offset = 0;
+};
+
+// Call frame information from .eh_frame. Lookups binary-search the
+// .eh_frame_hdr table when the image has one, or an index of FDE ranges
+// built on attach otherwise; CIEs and CFA programs are only decoded for the
+// FDE a query lands in.
+class CallFrameTable {
+public:
+  // Takes .eh_frame and optionally .eh_frame_hdr (empty hdr = none) as
+  // mapped at the given addresses. Fixed-size fields are read in the
+  // image's byte order; absptr values are address_size bytes.
+  bool attach(uint64_t eh_frame_address, std::vector<uint8_t> eh_frame, uint64_t hdr_address,
+              std::vector<uint8_t> hdr, bool big_endian, uint8_t address_size, std::string* error);
+  // Decodes eh_frame_ptr from an .eh_frame_hdr, for images that only have
+  // the PT_GNU_EH_FRAME segment to go on.
+  static bool eh_frame_address(std::span<const uint8_t> hdr, uint64_t hdr_address, bool big_endian,
+                               uint8_t address_size, uint64_t* out);
+
+  bool empty() const;
+  // FDEs in the search table.
+  size_t size() const;
+  // True when lookups use .eh_frame_hdr rather than the built index.
+  bool has_search_table() const;
+
+  bool find(uint64_t address, FrameDescription* out) const;
+  // Runs the CIE's initial instructions and the FDE's program up to address.
+  bool row_at(uint64_t address, CallFrameRow* out, std::string* error) const;
+  // Appends every FDE with a non-empty range, in .eh_frame order, and
+  // returns how many were appended.
+  size_t enumerate(std::vector<FrameDescription>* out) const;
+
+private:
+  struct Cie {
+    uint64_t code_align = 1;
+    int64_t data_align = 1;
+    uint32_t return_address_register = 0;
+    uint8_t fde_encoding = 0;
+    bool augmented = false;
+    bool signal_frame = false;
+    size_t instructions = 0;
+    size_t end = 0;
+  };
+
+  bool parse_cie(size_t offset, Cie* out) const;
+  // Reads the FDE at offset against its CIE; instructions and end bound its
+  // CFA program.
+  bool parse_fde(size_t offset, const Cie& cie, FrameDescription* out, size_t* instructions, size_t* end) const;
+  // Offset of the CIE the FDE at offset refers to, or false for a CIE or
+  // terminator.
+  bool fde_cie(size_t offset, size_t* cie_offset) const;
+  bool fde_at(size_t offset, FrameDescription* out) const;
+
+  uint64_t eh_frame_address_ = 0;
+  std::vector<uint8_t> eh_frame_{};
+  uint64_t hdr_address_ = 0;
+  std::vector<uint8_t> hdr_{};
+  bool big_endian_ = false;
+  uint8_t address_size_ = 8;
+  // .eh_frame_hdr search table: position in hdr_, entries, and encoding.
+  size_t table_offset_ = 0;
+  size_t table_count_ = 0;
+  uint8_t table_encoding_ = 0xff;
+  // Used instead when there is no usable search table, ordered by start.
+  std::vector<FrameDescription> index_{};
+};
+
+} // namespace ghirda::core
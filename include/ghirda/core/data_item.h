@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ghirda::core {
+
+class ReferenceDatabase;
+
+enum class DataItemType : uint8_t {
+  AsciiString,
+  Utf8String,
+  // Little-endian.
+  Utf16String,
+};
+
+const char* data_item_type_name(DataItemType type);
+
+// Sixteen bytes per item.
+struct DataItem {
+  uint64_t address = 0;
+  // Bytes, terminator included when there is one.
+  uint32_t size = 0;
+  // References to address, saturating; see DataItemTable::count_references().
+  uint16_t references = 0;
+  DataItemType type = DataItemType::AsciiString;
+  bool terminated = false;
+};
+
+// Defined data, added in bulk and queryable after finalize(), which sorts the
+// items by address. Items never overlap: an item starting inside an earlier
+// one is dropped. The references behind an item's count come from
+// ReferenceDatabase::references_to(item.address).
+class DataItemTable {
+public:
+  void add(const DataItem& item);
+  void add(std::span<const DataItem> items);
+  void reserve(size_t count);
+  void finalize();
+
+  size_t size() const;
+  bool empty() const;
+  size_t memory_usage() const;
+  std::span<const DataItem> items() const;
+  // Item starting at address, or nullptr.
+  const DataItem* at(uint64_t address) const;
+  // Item whose bytes include address, or nullptr.
+  const DataItem* containing(uint64_t address) const;
+
+  // Sets every item's reference count from a finalized database; call after
+  // finalize().
+  void count_references(const ReferenceDatabase& references);
+
+private:
+  std::vector<DataItem> items_{};
+  bool sorted_ = true;
+};
+
+} // namespace ghirda::core
@@ -57,6 +57,12 @@ struct DebugInfo {
   std::vector<DebugLineEntry> lines;
   std::vector<DebugType> types;
   std::string pdb_path;
+  // GNU build-id of the image (hex) and the separate debug file the DWARF was
+  // read from, if any.
+  std::string build_id;
+  std::string debug_file;
+  // dwo names (or ids) of split DWARF units whose .dwo/.dwp was not found.
+  std::vector<std::string> unresolved_split_units;
 };
 
 } // namespace ghirda::core
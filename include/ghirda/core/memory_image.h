@@ -1,24 +1,79 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace ghirda::core {
 
+class PatternSet;
+struct PatternMatch;
+
+// A segment's bytes: owned, or a read-only view into a file mapping that
+// keeper holds alive. The first write through mutable_data() copies a view
+// into owned storage.
+class SegmentBytes {
+public:
+  SegmentBytes() = default;
+  SegmentBytes(std::vector<uint8_t> bytes);
+  SegmentBytes(const uint8_t* data, size_t size, std::shared_ptr<const void> keeper);
+
+  const uint8_t* data() const;
+  size_t size() const;
+  bool empty() const;
+  const uint8_t* begin() const;
+  const uint8_t* end() const;
+  bool borrowed() const;
+  uint8_t* mutable_data();
+
+private:
+  std::vector<uint8_t> owned_{};
+  const uint8_t* view_ = nullptr;
+  size_t view_size_ = 0;
+  std::shared_ptr<const void> keeper_{};
+};
+
 struct ImageSegment {
   uint64_t start = 0;
-  std::vector<uint8_t> data;
+  SegmentBytes data;
+};
+
+struct ImageWrite {
+  uint64_t address = 0;
+  uint64_t value = 0;
+  uint8_t size = 8;
+  // Adds value to the stored word instead of replacing it (implicit addends,
+  // base relocation deltas).
+  bool add = false;
+  bool applied = false;
 };
 
 class MemoryImage {
 public:
   void map_segment(uint64_t start, const std::vector<uint8_t>& bytes);
+  void map_segment(uint64_t start, std::vector<uint8_t>&& bytes);
+  // Maps bytes in place; keeper must keep them valid (e.g. the file mapping).
+  void map_view(uint64_t start, const uint8_t* data, size_t size, std::shared_ptr<const void> keeper);
   void zero_fill(uint64_t start, uint64_t size);
 
+  bool contains(uint64_t address) const;
   bool read_u32(uint64_t address, uint32_t* value) const;
   bool read_u64(uint64_t address, uint64_t* value) const;
   bool write_u32(uint64_t address, uint32_t value);
   bool write_u64(uint64_t address, uint64_t value);
+  // Applies a batch of 4- or 8-byte writes in one pass over the segments:
+  // writes are stably sorted by address and each segment is located once for
+  // the run of writes that falls inside it. Values are stored in the image's
+  // byte order. Sets applied on every write that landed and returns their
+  // count.
+  size_t apply_writes(std::vector<ImageWrite>* writes, bool big_endian = false);
+
+  // Scans every segment for a compiled pattern set, splitting segments into
+  // windows shared out to thread_count workers (0 = hardware concurrency).
+  // Matches do not span segments. Appends them ordered by address, then
+  // pattern, and returns how many were appended.
+  size_t search(const PatternSet& patterns, std::vector<PatternMatch>* out, size_t thread_count = 0) const;
 
   const std::vector<ImageSegment>& segments() const;
 
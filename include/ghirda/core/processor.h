@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ghirda::core {
+
+// Instruction set of a loaded image, as reported by its header.
+enum class Processor : uint8_t {
+  Unknown,
+  X86,
+  X86_64,
+  Arm,
+  Aarch64,
+  RiscV,
+  Mips,
+  PowerPc,
+  PowerPc64,
+};
+
+const char* processor_name(Processor processor);
+
+} // namespace ghirda::core
@@ -4,10 +4,14 @@
 #include <vector>
 
 #include "ghirda/core/address_space.h"
+#include "ghirda/core/call_frame.h"
+#include "ghirda/core/data_item.h"
 #include "ghirda/core/debug_info.h"
 #include "ghirda/core/memory_map.h"
 #include "ghirda/core/relocation.h"
 #include "ghirda/core/memory_image.h"
+#include "ghirda/core/processor.h"
+#include "ghirda/core/reference.h"
 #include "ghirda/core/symbol.h"
 #include "ghirda/core/type_system.h"
 
@@ -16,6 +20,11 @@ namespace ghirda::core {
 class Program {
 public:
   explicit Program(std::string name);
+  Program(const Program&) = default;
+  // noexcept so std::vector<Program> moves instead of copying when it grows.
+  Program(Program&&) noexcept = default;
+  Program& operator=(const Program&) = default;
+  Program& operator=(Program&&) noexcept = default;
 
   const std::string& name() const;
   MemoryMap& memory_map();
@@ -28,25 +37,42 @@ public:
 
   void add_symbol(const Symbol& symbol);
   const std::vector<Symbol>& symbols() const;
+  // Renames symbols()[index].
+  void rename_symbol(size_t index, std::string name);
 
   TypeSystem& types();
   const TypeSystem& types() const;
 
   void add_relocation(const Relocation& relocation);
-  const std::vector<Relocation>& relocations() const;
+  RelocationTable& relocations();
+  const RelocationTable& relocations() const;
+
+  ReferenceDatabase& references();
+  const ReferenceDatabase& references() const;
+
+  DataItemTable& data_items();
+  const DataItemTable& data_items() const;
 
   void set_load_bias(uint64_t bias);
   uint64_t load_bias() const;
 
+  void set_processor(Processor processor);
+  Processor processor() const;
+
   DebugInfo& debug_info();
   const DebugInfo& debug_info() const;
 
+  CallFrameTable& call_frames();
+  const CallFrameTable& call_frames() const;
+
   struct Section {
     std::string name;
     uint64_t address = 0;
     uint64_t size = 0;
     uint64_t file_offset = 0;
     uint64_t flags = 0;
+    // Holds instructions per the format's section flags.
+    bool executable = false;
   };
 
   struct Segment {
@@ -56,10 +82,27 @@ public:
     uint64_t flags = 0;
   };
 
+  enum class FunctionStartSource {
+    EntryPoint,
+    Export,
+    ExceptionTable,
+    TlsCallback,
+  };
+
+  // Function entries known from loader metadata, for seeding disassembly.
+  // size is 0 when the metadata does not bound the function.
+  struct FunctionStart {
+    uint64_t address = 0;
+    uint64_t size = 0;
+    FunctionStartSource source = FunctionStartSource::EntryPoint;
+  };
+
   void add_section(const Section& section);
   const std::vector<Section>& sections() const;
   void add_segment(const Segment& segment);
   const std::vector<Segment>& segments() const;
+  void add_function_start(const FunctionStart& start);
+  const std::vector<FunctionStart>& function_starts() const;
 
 private:
   std::string name_;
@@ -68,11 +111,16 @@ private:
   std::vector<AddressSpace> address_spaces_{};
   std::vector<Symbol> symbols_{};
   TypeSystem types_{};
-  std::vector<Relocation> relocations_{};
+  RelocationTable relocations_{};
+  ReferenceDatabase references_{};
+  DataItemTable data_items_{};
   uint64_t load_bias_ = 0;
+  Processor processor_ = Processor::Unknown;
   DebugInfo debug_info_{};
+  CallFrameTable call_frames_{};
   std::vector<Section> sections_{};
   std::vector<Segment> segments_{};
+  std::vector<FunctionStart> function_starts_{};
 };
 
 } // namespace ghirda::core
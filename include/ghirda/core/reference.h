@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ghirda::core {
+
+enum class ReferenceType : uint8_t {
+  // Code to code.
+  Call,
+  Jump,
+  // Code to data.
+  Read,
+  Write,
+  // Data to code or data: a stored address, e.g. a relocated word.
+  Pointer,
+};
+
+struct Reference {
+  uint64_t from = 0;
+  uint64_t to = 0;
+  ReferenceType type = ReferenceType::Pointer;
+};
+
+// References are added in bulk and become queryable after finalize(), which
+// merges them into two read-only indices, one keyed by source and one by
+// target. Each index keeps its distinct keys as low 32-bit halves behind a
+// sparse fence of full keys, plus per key a run of (address delta, type)
+// entries packed at the run's widest byte width. A lookup searches the
+// cache-resident fence, then one short block of keys, then decodes the run
+// without branching on entry sizes.
+class ReferenceDatabase {
+public:
+  void add(uint64_t from, uint64_t to, ReferenceType type);
+  void add(const Reference& reference);
+  void reserve(size_t count);
+  size_t pending() const;
+
+  // Folds pending references into the indices, dropping duplicates. The two
+  // indices are built on separate threads unless thread_count is 1.
+  void finalize(size_t thread_count = 0);
+
+  // Finalized references.
+  size_t size() const;
+  bool empty() const;
+  // Encoded size of both indices, in bytes.
+  size_t memory_usage() const;
+
+  // Appends matches to out, ordered by the opposite address, and returns how
+  // many were appended. Reusing out across calls avoids allocation.
+  size_t references_from(uint64_t from, std::vector<Reference>* out) const;
+  size_t references_to(uint64_t to, std::vector<Reference>* out) const;
+  // Sources of Call references to target.
+  size_t callers(uint64_t target, std::vector<uint64_t>* out) const;
+  size_t count_to(uint64_t to) const;
+  // count_to() for ascending targets in one pass over the reverse index.
+  void count_to(std::span<const uint64_t> targets, std::span<uint32_t> counts) const;
+  bool has_references_to(uint64_t to) const;
+  // Every finalized reference, ordered by source.
+  std::vector<Reference> all() const;
+
+private:
+  struct Index {
+    static constexpr unsigned kBlockShift = 10;
+    static constexpr size_t kFenceStride = 64;
+
+    // Every kFenceStride-th key and the first key of each 4 GiB page, in
+    // full; fence_slots gives their positions in keys. A fence block never
+    // spans pages, so its keys compare by their low halves.
+    std::vector<uint64_t> fence;
+    std::vector<uint32_t> fence_slots;
+    std::vector<uint32_t> keys;
+    // Start of each key's run in bytes, keys.size() + 1 entries:
+    // bases[slot >> kBlockShift] + offsets[slot].
+    std::vector<uint64_t> bases;
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> bytes;
+
+    bool find(uint64_t key, size_t* slot) const;
+    uint64_t offset(size_t slot) const;
+    // Entries in the run at slot.
+    size_t count(size_t slot) const;
+    size_t memory_usage() const;
+  };
+
+  static void build(const std::vector<Reference>& sorted, bool by_target, Index* index);
+  template <typename Fn>
+  static void decode(const Index& index, size_t slot, uint64_t key, Fn&& fn);
+
+  std::vector<Reference> pending_{};
+  Index forward_{};
+  Index reverse_{};
+  size_t size_ = 0;
+};
+
+} // namespace ghirda::core
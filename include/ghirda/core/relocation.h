@@ -1,17 +1,64 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace ghirda::core {
 
+enum class RelocationStatus : uint8_t {
+  Applied,
+  // Kept for reference only; the stored value already holds the result, as
+  // for base relocations of an image loaded at its preferred address.
+  Recorded,
+  Unsupported,
+  // The target does not fall inside a mapped segment.
+  Unmapped,
+};
+
+// One fixed-size record per relocation. Symbol names are interned in the
+// owning RelocationTable and referenced by id.
 struct Relocation {
+  static constexpr uint32_t kNoSymbol = 0xffffffffu;
+
   uint64_t address = 0;
-  uint32_t type = 0;
-  std::string symbol;
   int64_t addend = 0;
-  bool applied = false;
-  std::string note;
+  uint32_t type = 0;
+  uint32_t symbol = kNoSymbol;
+  RelocationStatus status = RelocationStatus::Recorded;
+  // Bytes the relocation patches; 0 when unknown, as for unsupported types.
+  uint8_t size = 0;
+};
+
+class RelocationTable {
+public:
+  // Returns the id for name, adding it on first use. An empty name is
+  // kNoSymbol.
+  uint32_t intern(std::string_view name);
+  // Empty for kNoSymbol and unknown ids. Valid until the next intern().
+  const std::string& symbol_name(uint32_t id) const;
+  size_t symbol_count() const;
+
+  void add(const Relocation& relocation);
+  void reserve(size_t count);
+
+  size_t size() const;
+  bool empty() const;
+  const Relocation& operator[](size_t index) const;
+  std::vector<Relocation>::const_iterator begin() const;
+  std::vector<Relocation>::const_iterator end() const;
+  const std::vector<Relocation>& records() const;
+  size_t count(RelocationStatus status) const;
+
+private:
+  std::vector<Relocation> records_{};
+  std::vector<std::string> names_{};
+  // Name hash to id, checked against names_; holds no pointers into names_,
+  // so copies and moves of the table stay valid.
+  std::unordered_multimap<size_t, uint32_t> ids_{};
 };
 
 } // namespace ghirda::core
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ghirda::core {
 
+using TypeId = uint32_t;
+constexpr TypeId kInvalidTypeId = UINT32_MAX;
+
 enum class TypeKind {
   Void,
   Integer,
@@ -19,6 +24,7 @@ enum class TypeKind {
 struct TypeMember {
   std::string name;
   std::string type_name;
+  TypeId type_id = kInvalidTypeId;
   uint32_t offset = 0;
   uint32_t size = 0;
   uint32_t bit_size = 0;
@@ -27,19 +33,44 @@ struct TypeMember {
 };
 
 struct Type {
+  TypeId id = kInvalidTypeId;
   TypeKind kind = TypeKind::Void;
   std::string name;
   uint32_t size = 0;
   std::vector<TypeMember> members;
 };
 
+// Type database with O(1) lookup by id and name. Types are deduplicated by
+// structure on insertion, so identical definitions coming from different
+// compilation units share one id. Members compare by name, layout and member
+// type id; since member types are interned first, equal ids mean structurally
+// equal member types all the way down. Ids are indices into types() and never
+// change. A name maps to the first type added under it; later, structurally
+// different types with the same name keep their own ids and are counted in
+// name_collisions().
 class TypeSystem {
 public:
-  void add_type(const Type& type);
+  TypeId add_type(const Type& type);
   const std::vector<Type>& types() const;
 
+  const Type* find(TypeId id) const;
+  const Type* find(const std::string& name) const;
+  TypeId find_id(const std::string& name) const;
+
+  // Sets unset member type ids by member type name.
+  void link_members();
+  size_t duplicates_dropped() const;
+  size_t name_collisions() const;
+
 private:
+  static uint64_t structural_hash(const Type& type);
+  static bool structurally_equal(const Type& a, const Type& b);
+
   std::vector<Type> types_;
+  std::unordered_map<std::string, TypeId> by_name_;
+  std::unordered_multimap<uint64_t, TypeId> by_hash_;
+  size_t duplicates_dropped_ = 0;
+  size_t name_collisions_ = 0;
 };
 
 } // namespace ghirda::core
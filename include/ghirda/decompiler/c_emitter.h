@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ghirda::decompiler {
+
+enum class TokenKind {
+  Keyword,
+  Type,
+  Identifier,
+  Function,
+  Literal,
+  Comment,
+  Operator,
+  Punctuation,
+  Whitespace,
+  Newline
+};
+
+struct Token {
+  TokenKind kind = TokenKind::Identifier;
+  uint64_t offset = 0;
+  uint32_t length = 0;
+  uint64_t address = 0;
+};
+
+class OutputSink {
+public:
+  virtual ~OutputSink() = default;
+  virtual bool write(const char* data, size_t size) = 0;
+  virtual bool flush() { return true; }
+};
+
+class ChunkedBuffer : public OutputSink {
+public:
+  explicit ChunkedBuffer(size_t chunk_size = 64 * 1024);
+
+  bool write(const char* data, size_t size) override;
+
+  size_t size() const;
+  void clear();
+  bool drain_to(OutputSink* sink) const;
+  void append_to(std::string* out) const;
+
+private:
+  struct Chunk {
+    std::unique_ptr<char[]> data;
+    size_t used = 0;
+  };
+
+  std::vector<Chunk> chunks_{};
+  size_t active_ = 0;
+  size_t chunk_size_ = 0;
+  size_t size_ = 0;
+};
+
+class BufferPool {
+public:
+  explicit BufferPool(size_t chunk_size = 64 * 1024);
+
+  std::unique_ptr<ChunkedBuffer> acquire();
+  void release(std::unique_ptr<ChunkedBuffer> buffer);
+
+private:
+  std::mutex mutex_{};
+  std::vector<std::unique_ptr<ChunkedBuffer>> free_{};
+  size_t chunk_size_ = 0;
+};
+
+class FdSink : public OutputSink {
+public:
+  explicit FdSink(int fd);
+
+  bool write(const char* data, size_t size) override;
+
+private:
+  int fd_ = -1;
+};
+
+class StringSink : public OutputSink {
+public:
+  explicit StringSink(std::string* out);
+
+  bool write(const char* data, size_t size) override;
+
+private:
+  std::string* out_ = nullptr;
+};
+
+// Writes C text to a sink in one pass, batching small writes through a local
+// staging buffer. When a token vector is supplied, every emitted token is
+// recorded with its byte offset in the overall stream.
+class CEmitter {
+public:
+  explicit CEmitter(OutputSink* sink, std::vector<Token>* tokens = nullptr);
+  ~CEmitter();
+
+  CEmitter(const CEmitter&) = delete;
+  CEmitter& operator=(const CEmitter&) = delete;
+
+  void keyword(std::string_view text);
+  void type_name(std::string_view text);
+  void identifier(std::string_view text);
+  void function_name(std::string_view text);
+  void literal(std::string_view text);
+  void hex_literal(uint64_t value);
+  void comment(std::string_view text);
+  void op(std::string_view text);
+  void punct(std::string_view text);
+  void space();
+  void newline();
+
+  void open_block();
+  void close_block();
+
+  void set_address(uint64_t address);
+  bool flush();
+
+  bool ok() const;
+  uint64_t bytes_written() const;
+
+private:
+  void emit(TokenKind kind, std::string_view text);
+  void write_indent();
+  void stage(const char* data, size_t size);
+
+  OutputSink* sink_ = nullptr;
+  std::vector<Token>* tokens_ = nullptr;
+  std::vector<char> staging_{};
+  uint64_t written_ = 0;
+  uint64_t address_ = 0;
+  uint32_t indent_ = 0;
+  bool at_line_start_ = true;
+  bool ok_ = true;
+};
+
+} // namespace ghirda::decompiler
@@ -3,6 +3,7 @@
 #include <string>
 
 #include "ghirda/core/program.h"
+#include "ghirda/decompiler/c_emitter.h"
 
 namespace ghirda::decompiler {
 
@@ -14,6 +15,7 @@ struct DecompileResult {
 class Decompiler {
 public:
   DecompileResult decompile_function(const ghirda::core::Program& program, uint64_t entry);
+  bool decompile_function(const ghirda::core::Program& program, uint64_t entry, CEmitter* emitter);
 };
 
 } // namespace ghirda::decompiler
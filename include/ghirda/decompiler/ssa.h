@@ -3,11 +3,24 @@
 #include <cstdint>
 #include <vector>
 
+#include "ghirda/sleigh/pcode_ir.h"
+
 namespace ghirda::decompiler {
 
+constexpr uint64_t kNoSSAValue = UINT64_MAX;
+
 struct SSAValue {
   uint64_t id = 0;
   uint32_t size = 0;
+  bool is_constant = false;
+  uint64_t constant = 0;
+};
+
+struct SSAOp {
+  ghirda::sleigh::OpCode opcode = ghirda::sleigh::OpCode::Unknown;
+  uint64_t address = 0;
+  uint64_t output = kNoSSAValue;
+  std::vector<uint64_t> inputs{};
 };
 
 class SSAGraph {
@@ -15,8 +28,12 @@ public:
   void add_value(const SSAValue& value);
   const std::vector<SSAValue>& values() const;
 
+  void add_op(const SSAOp& op);
+  const std::vector<SSAOp>& ops() const;
+
 private:
   std::vector<SSAValue> values_{};
+  std::vector<SSAOp> ops_{};
 };
 
 } // namespace ghirda::decompiler
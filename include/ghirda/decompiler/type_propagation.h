@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ghirda/core/program.h"
+#include "ghirda/decompiler/ssa.h"
+
+namespace ghirda::decompiler {
+
+struct InferredType {
+  ghirda::core::TypeKind kind = ghirda::core::TypeKind::Void;
+  std::string name;
+  uint32_t size = 0;
+};
+
+struct TypePropagationStats {
+  size_t classes = 0;
+  size_t seeded = 0;
+  size_t conflicts = 0;
+};
+
+struct TypePropagationResult {
+  std::vector<InferredType> types;
+  TypePropagationStats stats;
+};
+
+// Unification-based type inference over an SSA graph. Values that must share a
+// type (copies, phis, pointer arithmetic) are merged in a union-find, loads and
+// stores link a pointer class to its pointee class, and seeds come from debug
+// info (return types and data symbol types) and import slots. Each op is
+// visited a bounded number of times and the union-find uses union by rank with
+// path halving, so the pass stays near-linear in the size of the graph.
+class TypePropagator {
+public:
+  explicit TypePropagator(const ghirda::core::Program& program);
+
+  // When disabled, no seed derived from debug info is used; only import slots
+  // and the graph's own operations type values.
+  void set_use_debug_info(bool enabled);
+  bool run(const SSAGraph& graph, TypePropagationResult* out, std::string* error) const;
+
+private:
+  struct SeedType {
+    ghirda::core::TypeKind kind = ghirda::core::TypeKind::Void;
+    std::string name;
+    uint32_t size = 0;
+  };
+
+  SeedType seed_from_debug(uint64_t type_ref) const;
+
+  const ghirda::core::Program& program_;
+  std::unordered_map<uint64_t, const ghirda::core::DebugType*> debug_types_{};
+  std::unordered_map<uint64_t, SeedType> return_types_{};
+  std::unordered_map<uint64_t, SeedType> data_types_{};
+  std::unordered_set<uint64_t> import_slots_{};
+  bool use_debug_info_ = true;
+};
+
+} // namespace ghirda::decompiler
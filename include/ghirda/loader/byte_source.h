@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ghirda::loader {
+
+enum class Endian {
+  Little,
+  Big
+};
+
+// Bounds-checked, zero-copy window onto source bytes. A view may share
+// ownership of its backing block, so it stays valid after the source moves on.
+class ByteView {
+public:
+  ByteView() = default;
+  ByteView(const uint8_t* data, size_t size, std::shared_ptr<const void> owner = {});
+
+  const uint8_t* data() const;
+  size_t size() const;
+  bool empty() const;
+  std::span<const uint8_t> span() const;
+  // Backing block the view shares, or null when it borrows without owning.
+  const std::shared_ptr<const void>& owner() const;
+  uint8_t operator[](size_t index) const;
+  bool subview(uint64_t offset, uint64_t size, ByteView* out) const;
+
+private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  std::shared_ptr<const void> owner_{};
+};
+
+class ByteSource {
+public:
+  virtual ~ByteSource() = default;
+
+  virtual uint64_t size() const = 0;
+  virtual bool read(uint64_t offset, void* out, size_t size) const = 0;
+  virtual bool view(uint64_t offset, uint64_t size, ByteView* out) const = 0;
+
+  bool contains(uint64_t offset, uint64_t size) const;
+  bool read_blob(uint64_t offset, uint64_t size, std::vector<uint8_t>* out) const;
+  bool read_cstring(uint64_t offset, std::string* out, size_t max_length = 4096) const;
+
+  // File the bytes came from; empty for in-memory sources. Lets loaders find
+  // companion files such as split DWARF packages next to the image.
+  const std::string& path() const;
+
+protected:
+  std::string path_{};
+};
+
+class MemoryByteSource : public ByteSource {
+public:
+  explicit MemoryByteSource(std::vector<uint8_t> bytes);
+  explicit MemoryByteSource(std::shared_ptr<const std::vector<uint8_t>> bytes);
+
+  uint64_t size() const override;
+  bool read(uint64_t offset, void* out, size_t size) const override;
+  bool view(uint64_t offset, uint64_t size, ByteView* out) const override;
+
+private:
+  std::shared_ptr<const std::vector<uint8_t>> bytes_{};
+};
+
+class MmapByteSource : public ByteSource {
+public:
+  static std::unique_ptr<MmapByteSource> open(const std::string& path, std::string* error);
+
+  uint64_t size() const override;
+  bool read(uint64_t offset, void* out, size_t size) const override;
+  bool view(uint64_t offset, uint64_t size, ByteView* out) const override;
+
+private:
+  struct Mapping;
+  explicit MmapByteSource(std::shared_ptr<const Mapping> mapping);
+
+  std::shared_ptr<const Mapping> mapping_{};
+};
+
+// pread(2)-backed source that serves small reads from a readahead window.
+// Safe to share between threads; views own their block.
+class PreadByteSource : public ByteSource {
+public:
+  static constexpr size_t kDefaultReadahead = 256 * 1024;
+
+  static std::unique_ptr<PreadByteSource> open(const std::string& path, std::string* error,
+                                               size_t readahead = kDefaultReadahead);
+  ~PreadByteSource() override;
+
+  uint64_t size() const override;
+  bool read(uint64_t offset, void* out, size_t size) const override;
+  bool view(uint64_t offset, uint64_t size, ByteView* out) const override;
+
+private:
+  struct Block {
+    uint64_t offset = 0;
+    std::vector<uint8_t> bytes;
+  };
+
+  PreadByteSource(int fd, uint64_t size, size_t readahead);
+  bool pread_exact(uint64_t offset, void* out, size_t size) const;
+  std::shared_ptr<const Block> block_for(uint64_t offset, uint64_t size) const;
+
+  int fd_ = -1;
+  uint64_t size_ = 0;
+  size_t readahead_ = kDefaultReadahead;
+  mutable std::mutex mutex_{};
+  mutable std::shared_ptr<const Block> block_{};
+};
+
+// Window [base, base + size) of another source, e.g. one slice of a universal
+// binary. Reads and views go straight to the parent, so slices of a mapped
+// file share one mapping. The parent must outlive the window.
+class SubByteSource : public ByteSource {
+public:
+  SubByteSource(const ByteSource& parent, uint64_t base, uint64_t size);
+
+  uint64_t base() const;
+  uint64_t size() const override;
+  bool read(uint64_t offset, void* out, size_t size) const override;
+  bool view(uint64_t offset, uint64_t size, ByteView* out) const override;
+
+private:
+  const ByteSource& parent_;
+  uint64_t base_ = 0;
+  uint64_t size_ = 0;
+};
+
+std::shared_ptr<ByteSource> open_byte_source(const std::string& path, std::string* error);
+
+// Cursor over a contiguous view with endian-aware typed reads. Every read is
+// bounds-checked and leaves the cursor untouched on failure.
+class ByteReader {
+public:
+  explicit ByteReader(ByteView view, Endian endian = Endian::Little);
+
+  uint64_t offset() const;
+  uint64_t remaining() const;
+  bool seek(uint64_t offset);
+  bool skip(uint64_t count);
+  void set_endian(Endian endian);
+  Endian endian() const;
+
+  bool read_u8(uint8_t* value);
+  bool read_u16(uint16_t* value);
+  bool read_u32(uint32_t* value);
+  bool read_u64(uint64_t* value);
+  bool read_bytes(void* out, size_t size);
+  bool read_view(uint64_t size, ByteView* out);
+  bool read_cstring(std::string* out);
+
+private:
+  template <typename T>
+  bool read_integer(T* value);
+
+  ByteView view_{};
+  uint64_t offset_ = 0;
+  Endian endian_ = Endian::Little;
+};
+
+std::string read_string(const ByteView& table, uint64_t offset);
+
+} // namespace ghirda::loader
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ghirda/core/program.h"
+#include "ghirda/loader/byte_source.h"
+#include "ghirda/loader/loader_registry.h"
+
+namespace ghirda::loader {
+
+enum class ContainerFormat {
+  Unknown,
+  // Unix ar (.a), GNU and BSD member naming.
+  Ar,
+  // Zip and its derivatives (APK, JAR, AAR), including ZIP64.
+  Zip,
+  // cpio "newc"/"crc" and portable ASCII (odc) archives, as in initramfs,
+  // including archives concatenated after the first (gzip ones inflated).
+  Cpio,
+  // ISO 9660 primary volume; Joliet and Rock Ridge names are not read.
+  Iso9660,
+};
+
+const char* container_format_name(ContainerFormat format);
+ContainerFormat detect_container(const ByteSource& source);
+
+enum class MemberCompression {
+  Stored,
+  Deflate,
+  // Any other zip method; open_member() reports it.
+  Unsupported,
+};
+
+struct ContainerMember {
+  // Full path inside the container.
+  std::string name;
+  // Start and length of the member's bytes as stored in the container.
+  uint64_t offset = 0;
+  uint64_t stored_size = 0;
+  uint64_t size = 0;
+  MemberCompression compression = MemberCompression::Stored;
+  // 0 for the container's own bytes; n for the n-th archive inflated from a
+  // compressed segment appended to them.
+  uint32_t part = 0;
+};
+
+// Regular-file members of an archive, read in place. A gzip-wrapped archive
+// (e.g. initramfs.cpio.gz) is inflated into memory once on open; otherwise
+// stored members are windows onto the caller's source, which must outlive
+// the container, and deflated ones are inflated per open_member() call.
+class Container {
+public:
+  static bool open(const ByteSource& source, Container* out, std::string* error);
+
+  ContainerFormat format() const;
+  // True when the archive itself was gzip-wrapped.
+  bool gzipped() const;
+  const std::vector<ContainerMember>& members() const;
+
+  // Safe to call from several threads at once.
+  bool open_member(size_t index, std::shared_ptr<const ByteSource>* out, std::string* error) const;
+
+private:
+  const ByteSource* source_ = nullptr;
+  std::shared_ptr<const ByteSource> inflated_{};
+  std::vector<std::shared_ptr<const ByteSource>> parts_{};
+  ContainerFormat format_ = ContainerFormat::Unknown;
+  std::vector<ContainerMember> members_{};
+};
+
+struct ContainerLoadOptions {
+  // Members whose best probe is below this are skipped instead of loaded;
+  // the default leaves out what only the raw loader would take.
+  uint32_t min_confidence = 2;
+  // Members declaring more bytes than this are skipped.
+  uint64_t max_member_size = uint64_t{1} << 32;
+  size_t thread_count = 0;
+};
+
+struct ContainerMemberResult {
+  std::string member;
+  // Empty when the member was skipped.
+  std::string loader;
+  std::string error;
+  bool loaded = false;
+};
+
+// Loads every recognized member into its own Program ("<name>:<member>") on
+// up to thread_count workers (0 = hardware concurrency). Each worker opens,
+// inflates, probes and loads its member; nothing is written to disk.
+// programs holds loaded members only, in member order; results covers every
+// member. Returns false if the container could not be read or a recognized
+// member failed to load.
+bool load_container(const ByteSource& source, const LoaderRegistry& registry, const std::string& name,
+                    std::vector<ghirda::core::Program>* programs, std::vector<ContainerMemberResult>* results,
+                    std::string* error, const ContainerLoadOptions& options = {});
+
+} // namespace ghirda::loader
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+#include "ghirda/loader/elf_sections.h"
+
+namespace ghirda::loader {
+
+// CRC-32 as used by .gnu_debuglink (the zlib polynomial).
+uint32_t gnu_debuglink_crc32(const ByteView& bytes, uint32_t crc = 0);
+
+// Locates the separate debug file of a stripped ELF image, the way GDB does:
+//   <root>/.build-id/ab/cdef....debug for the build-id, then the debuglink
+//   name in the image's directory, its .debug/ subdirectory and under
+//   <root>/<image dir>/ (CRC-checked).
+// Debug trees that do not follow the .build-id layout are found through a
+// local index file mapping build-ids to paths. The index is read once per
+// resolver and rebuilt by scanning the roots only when it is missing or a
+// root changed after it was written, so repeated loads do not re-walk them.
+class DebugFileResolver {
+public:
+  static constexpr const char* kDefaultRoot = "/usr/lib/debug";
+
+  DebugFileResolver();
+  explicit DebugFileResolver(std::vector<std::string> roots);
+
+  void add_root(std::string root);
+  // Where the build-id index is kept; no index is used when empty.
+  void set_index_path(std::string path);
+
+  bool find(const ElfDebugLink& link, const std::string& image_path, std::string* out_path);
+
+private:
+  bool matches_build_id(const std::string& path, const std::string& build_id) const;
+  bool matches_crc(const std::string& path, uint32_t crc) const;
+  bool find_in_index(const std::string& build_id, std::string* out_path);
+  void load_index();
+  bool index_stale() const;
+  void rebuild_index();
+  void save_index() const;
+
+  std::vector<std::string> roots_{};
+  std::string index_path_{};
+
+  std::mutex mutex_{};
+  bool index_loaded_ = false;
+  bool index_rebuilt_ = false;
+  std::unordered_map<std::string, std::string> index_{};
+};
+
+} // namespace ghirda::loader
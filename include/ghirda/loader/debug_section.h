@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+
+enum class SectionCompression {
+  None,
+  Zlib,
+  Zstd
+};
+
+// A debug section as stored in the image. Stored sections are served straight
+// from the source view; SHF_COMPRESSED and .zdebug_* payloads are inflated on
+// first access. view() may be called from several threads and inflates once.
+class DebugSection {
+public:
+  DebugSection(std::string name, ByteView raw, SectionCompression compression = SectionCompression::None,
+               uint64_t uncompressed_size = 0);
+
+  // Builds a section from an ELF section header. Handles Elf32/Elf64_Chdr for
+  // SHF_COMPRESSED and the GNU "ZLIB" + big-endian size prefix for .zdebug_*.
+  static std::shared_ptr<DebugSection> from_elf(const ByteSource& source, const std::string& name, uint64_t offset,
+                                                uint64_t size, uint64_t flags, bool elf64, Endian endian,
+                                                std::string* error);
+
+  // ".zdebug_info" and ".debug_info" both report ".debug_info".
+  const std::string& name() const;
+  SectionCompression compression() const;
+  uint64_t stored_size() const;
+  uint64_t size() const;
+
+  // nullptr if the payload could not be decoded; error() says why.
+  const ByteView* view() const;
+  bool materialized() const;
+  const std::string& error() const;
+
+private:
+  void materialize() const;
+
+  std::string name_;
+  ByteView raw_{};
+  SectionCompression compression_ = SectionCompression::None;
+  uint64_t size_ = 0;
+
+  mutable std::once_flag once_{};
+  mutable std::atomic<bool> done_{false};
+  mutable bool ok_ = false;
+  mutable std::vector<uint8_t> bytes_{};
+  mutable ByteView inflated_{};
+  mutable std::string error_{};
+};
+
+bool compression_supported(SectionCompression compression);
+bool decompress_section(SectionCompression compression, const uint8_t* data, size_t size, uint64_t expected_size,
+                        std::vector<uint8_t>* out, std::string* error);
+
+// Inflates the compressed sections of at least min_size bytes on worker
+// threads, so big sections decode concurrently while small or unused ones stay
+// lazy.
+void prefetch_debug_sections(const std::vector<std::shared_ptr<DebugSection>>& sections, uint64_t min_size,
+                             size_t thread_count = 0);
+
+} // namespace ghirda::loader
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+
+struct DwarfNameEntry {
+  uint32_t tag = 0;
+  uint64_t unit_offset = 0;
+  // Section offset of the DIE in .debug_info.
+  uint64_t die_offset = 0;
+};
+
+// DWARF 5 .debug_names accelerator table. Lookups hash the name into the
+// table's buckets and decode only the matching entries, so no DIE is walked.
+// The section and string buffers must outlive the index.
+class DwarfNameIndex {
+public:
+  bool parse(const ByteView* names, const ByteView* debug_str, std::string* error);
+
+  bool empty() const;
+  size_t name_count() const;
+  bool lookup(const std::string& name, std::vector<DwarfNameEntry>* out) const;
+
+  // DJB hash over the case-folded name, as specified for .debug_names.
+  static uint32_t hash(const std::string& name);
+
+private:
+  struct IndexAttr {
+    uint32_t index = 0;
+    uint32_t form = 0;
+  };
+
+  struct Abbrev {
+    uint32_t tag = 0;
+    std::vector<IndexAttr> attributes;
+  };
+
+  struct Unit {
+    uint8_t offset_size = 4;
+    uint32_t comp_unit_count = 0;
+    uint32_t local_type_unit_count = 0;
+    uint32_t bucket_count = 0;
+    uint32_t name_count = 0;
+    uint64_t cu_list = 0;
+    uint64_t buckets = 0;
+    uint64_t hashes = 0;
+    uint64_t string_offsets = 0;
+    uint64_t entry_offsets = 0;
+    uint64_t entry_pool = 0;
+    uint64_t end = 0;
+    std::vector<std::pair<uint64_t, Abbrev>> abbrevs;
+  };
+
+  uint64_t read_offset(const Unit& unit, uint64_t at) const;
+  bool name_matches(const Unit& unit, uint32_t index, const std::string& name) const;
+  bool read_entries(const Unit& unit, uint32_t index, std::vector<DwarfNameEntry>* out) const;
+
+  const ByteView* names_ = nullptr;
+  const ByteView* debug_str_ = nullptr;
+  std::vector<Unit> units_{};
+};
+
+} // namespace ghirda::loader
@@ -1,16 +1,24 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "ghirda/core/debug_info.h"
+#include "ghirda/loader/debug_section.h"
+#include "ghirda/loader/dwarf_names.h"
 
 namespace ghirda::loader {
 
 struct DwarfSection {
-  const std::vector<uint8_t>* data = nullptr;
+  std::shared_ptr<const DebugSection> section{};
+
+  bool present() const;
+  // Materialises the section on first use; nullptr if absent or undecodable.
+  const ByteView* view() const;
 };
 
 struct DwarfSections {
@@ -18,17 +26,40 @@ struct DwarfSections {
   DwarfSection debug_abbrev;
   DwarfSection debug_line;
   DwarfSection debug_str;
+  DwarfSection debug_str_offsets;
+  DwarfSection debug_addr;
+  DwarfSection debug_line_str;
+  DwarfSection debug_rnglists;
+  DwarfSection debug_names;
 };
 
+// Maps ".debug_*" (and Mach-O "__debug_*") section names to their slot, or
+// nullptr for sections the reader does not consume.
+DwarfSection* dwarf_section_slot(DwarfSections* sections, const std::string& name);
+
+class SplitDwarfResolver;
+
 class DwarfReader {
 public:
   explicit DwarfReader(DwarfSections sections);
   bool parse(ghirda::core::DebugInfo* out, std::string* error);
 
+  // Skeleton units (-gsplit-dwarf) are followed into their .dwo/.dwp unit
+  // through the resolver as they are reached; without one only the skeleton
+  // is read. Split units that cannot be found are listed in
+  // DebugInfo::unresolved_split_units rather than failing the parse.
+  void set_split_resolver(SplitDwarfResolver* resolver);
+
+  // Finds a subprogram by name. With .debug_names only the indexed DIEs are
+  // decoded; without it every unit is walked.
+  bool has_name_index();
+  bool find_function(const std::string& name, ghirda::core::DebugFunction* out, std::string* error);
+
 private:
   struct AbbrevAttr {
     uint32_t name = 0;
     uint32_t form = 0;
+    int64_t implicit_const = 0;
   };
 
   struct AbbrevEntry {
@@ -38,6 +69,56 @@ private:
     std::vector<AbbrevAttr> attributes;
   };
 
+  using AbbrevTable = std::unordered_map<uint32_t, AbbrevEntry>;
+
+  // Per-unit decoding state: header fields plus the v5 base attributes that
+  // strx/addrx/rnglistx forms are relative to.
+  struct UnitContext {
+    uint64_t offset = 0;
+    uint64_t die_start = 0;
+    uint64_t end = 0;
+    uint16_t version = 0;
+    uint8_t unit_type = 0;
+    uint8_t offset_size = 4;
+    uint8_t address_size = 8;
+    uint64_t abbrev_offset = 0;
+    uint64_t str_offsets_base = 0;
+    uint64_t addr_base = 0;
+    uint64_t rnglists_base = 0;
+    uint64_t base_address = 0;
+    bool has_dwo_id = false;
+    uint64_t dwo_id = 0;
+    std::string dwo_name;
+    std::string comp_dir;
+  };
+
+  struct Die {
+    uint64_t offset = 0;
+    const AbbrevEntry* abbrev = nullptr;
+    std::string name;
+    uint64_t low_pc = 0;
+    uint64_t high_pc = 0;
+    bool high_pc_is_offset = false;
+    uint64_t ranges = 0;
+    uint32_t ranges_form = 0;
+    bool has_stmt_list = false;
+    uint64_t stmt_list = 0;
+    uint64_t byte_size = 0;
+    uint64_t type_ref = 0;
+    uint64_t member_location = 0;
+    uint64_t upper_bound = 0;
+    uint64_t lower_bound = 0;
+    uint64_t count = 0;
+    uint64_t bit_size = 0;
+    int64_t bit_offset = -1;
+    int64_t data_bit_offset = -1;
+    uint64_t alignment = 0;
+    std::string dwo_name;
+    std::string comp_dir;
+    bool has_dwo_id = false;
+    uint64_t dwo_id = 0;
+  };
+
   struct LineFile {
     std::string name;
     uint32_t dir_index = 0;
@@ -52,12 +133,14 @@ private:
     uint8_t line_range = 0;
     uint8_t opcode_base = 0;
     std::vector<uint8_t> standard_opcode_lengths;
+    // Indexed directly by DW_LNS_set_file / directory index; v2-4 tables get
+    // an empty slot 0 so both layouts index the same way.
     std::vector<std::string> include_dirs;
     std::vector<LineFile> files;
   };
 
   struct Cursor {
-    const std::vector<uint8_t>* data = nullptr;
+    const ByteView* data = nullptr;
     size_t offset = 0;
 
     bool can_read(size_t count) const;
@@ -69,23 +152,50 @@ private:
     bool read_uleb(uint64_t* value);
     bool read_sleb(int64_t* value);
     bool read_cstring(std::string* out);
+    bool read_sized(uint8_t size, uint64_t* value);
+    bool read_initial_length(uint64_t* length, uint8_t* offset_size);
     bool skip(size_t count);
   };
 
+  bool read_unit_header(Cursor& cursor, UnitContext* unit, std::string* error);
   bool parse_unit(Cursor& cursor, ghirda::core::DebugInfo* out, std::string* error);
-  bool parse_abbrev_table(uint64_t offset, std::unordered_map<uint32_t, AbbrevEntry>* table,
-                          std::string* error);
-  bool parse_die_tree(Cursor& cursor, const std::unordered_map<uint32_t, AbbrevEntry>& abbrev,
-                      uint8_t address_size, uint64_t unit_offset, ghirda::core::DebugInfo* out,
+  void parse_split_unit(const UnitContext& skeleton, ghirda::core::DebugInfo* out);
+  const AbbrevTable* abbrev_table(uint64_t offset, std::string* error);
+  bool parse_abbrev_table(uint64_t offset, AbbrevTable* table, std::string* error);
+  bool scan_unit_bases(const UnitContext& unit, const AbbrevTable& abbrev, UnitContext* out);
+  bool read_die(Cursor& cursor, const AbbrevTable& abbrev, const UnitContext& unit, Die* die, std::string* error);
+  bool parse_die_tree(Cursor& cursor, const AbbrevTable& abbrev, UnitContext& unit, ghirda::core::DebugInfo* out,
                       std::string* error);
-  bool parse_line_program(uint64_t offset, ghirda::core::DebugInfo* out, std::string* error);
+  bool parse_line_program(uint64_t offset, const UnitContext& unit, ghirda::core::DebugInfo* out,
+                          std::string* error);
+  bool read_line_entry_formats(Cursor& cursor, std::vector<std::pair<uint64_t, uint64_t>>* formats);
 
-  bool read_form(Cursor& cursor, uint32_t form, uint8_t address_size, uint64_t unit_offset,
-                 uint64_t* uvalue, int64_t* svalue, std::string* str_value);
+  bool read_form(Cursor& cursor, uint32_t form, int64_t implicit_const, const UnitContext& unit, uint64_t* uvalue,
+                 int64_t* svalue, std::string* str_value);
+  bool read_ranges(const UnitContext& unit, uint64_t value, uint32_t form,
+                   std::vector<std::pair<uint64_t, uint64_t>>* ranges);
+  void resolve_pc_range(const UnitContext& unit, Die* die);
 
   std::string read_str(uint64_t offset) const;
+  std::string read_line_str(uint64_t offset) const;
+  std::string read_str_index(const UnitContext& unit, uint64_t index) const;
+  uint64_t read_addr_index(const UnitContext& unit, uint64_t index) const;
 
   DwarfSections sections_{};
+  std::unordered_map<uint64_t, AbbrevTable> abbrev_cache_{};
+  bool names_loaded_ = false;
+  DwarfNameIndex names_{};
+
+  SplitDwarfResolver* split_resolver_ = nullptr;
+  // Set on the nested reader for a split unit: the skeleton supplies addr_base
+  // and the base address, and line tables stay with the skeleton.
+  bool split_unit_ = false;
+  UnitContext skeleton_{};
+  // DIE offsets of split units are relative to their own .debug_info.dwo; they
+  // are shifted past the main section (and earlier split units) so offsets
+  // stay unique within one DebugInfo.
+  uint64_t offset_bias_ = 0;
+  uint64_t next_split_bias_ = 0;
 };
 
 } // namespace ghirda::loader
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ghirda/core/debug_info.h"
+#include "ghirda/core/program.h"
+#include "ghirda/core/type_system.h"
+#include "ghirda/loader/dwarf_reader.h"
+
+namespace ghirda::loader {
+
+struct ResolvedType {
+  // Empty for anonymous structs and unions.
+  std::string name;
+  uint32_t size = 0;
+  // Typedef, const and volatile carry their target's kind.
+  ghirda::core::TypeKind kind = ghirda::core::TypeKind::Void;
+};
+
+// Resolves DWARF type DIEs into display names and sizes. Every DIE references
+// at most one other type, so the reference graph is a forest with occasional
+// cycles; each DIE is resolved exactly once by walking its chain with an
+// explicit stack, and independent graphs are spread across worker threads.
+class DwarfTypeResolver {
+public:
+  explicit DwarfTypeResolver(const ghirda::core::DebugInfo& debug_info);
+
+  void resolve(size_t thread_count = 0);
+  const ResolvedType* find(uint64_t die_offset) const;
+  void emit(ghirda::core::TypeSystem* types) const;
+
+private:
+  void resolve_component(const std::vector<uint32_t>& nodes, std::vector<uint8_t>* state);
+  ResolvedType compute(uint32_t node) const;
+  const ResolvedType* target_of(uint32_t node) const;
+
+  const ghirda::core::DebugInfo& debug_info_;
+  std::unordered_map<uint64_t, uint32_t> index_{};
+  std::vector<uint32_t> target_{};
+  std::vector<ResolvedType> results_{};
+};
+
+bool ingest_dwarf(const DwarfSections& sections, ghirda::core::Program* program, std::string* error,
+                  SplitDwarfResolver* split_resolver = nullptr);
+
+} // namespace ghirda::loader
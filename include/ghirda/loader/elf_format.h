@@ -0,0 +1,261 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+
+// On-disk ELF records for both classes. Fields are in file byte order until
+// read through read_elf_table, which converts whole tables at once.
+struct Elf32Header {
+  uint8_t ident[16];
+  uint16_t type;
+  uint16_t machine;
+  uint32_t version;
+  uint32_t entry;
+  uint32_t phoff;
+  uint32_t shoff;
+  uint32_t flags;
+  uint16_t ehsize;
+  uint16_t phentsize;
+  uint16_t phnum;
+  uint16_t shentsize;
+  uint16_t shnum;
+  uint16_t shstrndx;
+};
+
+struct Elf64Header {
+  uint8_t ident[16];
+  uint16_t type;
+  uint16_t machine;
+  uint32_t version;
+  uint64_t entry;
+  uint64_t phoff;
+  uint64_t shoff;
+  uint32_t flags;
+  uint16_t ehsize;
+  uint16_t phentsize;
+  uint16_t phnum;
+  uint16_t shentsize;
+  uint16_t shnum;
+  uint16_t shstrndx;
+};
+
+struct Elf32Phdr {
+  uint32_t type;
+  uint32_t offset;
+  uint32_t vaddr;
+  uint32_t paddr;
+  uint32_t filesz;
+  uint32_t memsz;
+  uint32_t flags;
+  uint32_t align;
+};
+
+struct Elf64Phdr {
+  uint32_t type;
+  uint32_t flags;
+  uint64_t offset;
+  uint64_t vaddr;
+  uint64_t paddr;
+  uint64_t filesz;
+  uint64_t memsz;
+  uint64_t align;
+};
+
+struct Elf32Shdr {
+  uint32_t name;
+  uint32_t type;
+  uint32_t flags;
+  uint32_t addr;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t link;
+  uint32_t info;
+  uint32_t addralign;
+  uint32_t entsize;
+};
+
+struct Elf64Shdr {
+  uint32_t name;
+  uint32_t type;
+  uint64_t flags;
+  uint64_t addr;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t link;
+  uint32_t info;
+  uint64_t addralign;
+  uint64_t entsize;
+};
+
+struct Elf32Sym {
+  uint32_t name;
+  uint32_t value;
+  uint32_t size;
+  uint8_t info;
+  uint8_t other;
+  uint16_t shndx;
+};
+
+struct Elf64Sym {
+  uint32_t name;
+  uint8_t info;
+  uint8_t other;
+  uint16_t shndx;
+  uint64_t value;
+  uint64_t size;
+};
+
+struct Elf32Rel {
+  uint32_t offset;
+  uint32_t info;
+};
+
+struct Elf32Rela {
+  uint32_t offset;
+  uint32_t info;
+  int32_t addend;
+};
+
+struct Elf64Rel {
+  uint64_t offset;
+  uint64_t info;
+};
+
+struct Elf64Rela {
+  uint64_t offset;
+  uint64_t info;
+  int64_t addend;
+};
+
+template <typename T>
+T swap_bytes(T value) {
+  using U = std::make_unsigned_t<T>;
+  U bits = static_cast<U>(value);
+  if constexpr (sizeof(T) == 2) {
+    bits = __builtin_bswap16(bits);
+  } else if constexpr (sizeof(T) == 4) {
+    bits = __builtin_bswap32(bits);
+  } else if constexpr (sizeof(T) == 8) {
+    bits = __builtin_bswap64(bits);
+  }
+  return static_cast<T>(bits);
+}
+
+template <typename... T>
+void swap_fields(T&... fields) {
+  ((fields = swap_bytes(fields)), ...);
+}
+
+inline void swap_record(Elf32Header* h) {
+  swap_fields(h->type, h->machine, h->version, h->entry, h->phoff, h->shoff, h->flags, h->ehsize, h->phentsize,
+              h->phnum, h->shentsize, h->shnum, h->shstrndx);
+}
+inline void swap_record(Elf64Header* h) {
+  swap_fields(h->type, h->machine, h->version, h->entry, h->phoff, h->shoff, h->flags, h->ehsize, h->phentsize,
+              h->phnum, h->shentsize, h->shnum, h->shstrndx);
+}
+inline void swap_record(Elf32Phdr* p) {
+  swap_fields(p->type, p->offset, p->vaddr, p->paddr, p->filesz, p->memsz, p->flags, p->align);
+}
+inline void swap_record(Elf64Phdr* p) {
+  swap_fields(p->type, p->flags, p->offset, p->vaddr, p->paddr, p->filesz, p->memsz, p->align);
+}
+inline void swap_record(Elf32Shdr* s) {
+  swap_fields(s->name, s->type, s->flags, s->addr, s->offset, s->size, s->link, s->info, s->addralign, s->entsize);
+}
+inline void swap_record(Elf64Shdr* s) {
+  swap_fields(s->name, s->type, s->flags, s->addr, s->offset, s->size, s->link, s->info, s->addralign, s->entsize);
+}
+inline void swap_record(Elf32Sym* s) { swap_fields(s->name, s->value, s->size, s->shndx); }
+inline void swap_record(Elf64Sym* s) { swap_fields(s->name, s->shndx, s->value, s->size); }
+inline void swap_record(Elf32Rel* r) { swap_fields(r->offset, r->info); }
+inline void swap_record(Elf32Rela* r) { swap_fields(r->offset, r->info, r->addend); }
+inline void swap_record(Elf64Rel* r) { swap_fields(r->offset, r->info); }
+inline void swap_record(Elf64Rela* r) { swap_fields(r->offset, r->info, r->addend); }
+inline void swap_record(uint32_t* word) { *word = swap_bytes(*word); }
+inline void swap_record(uint64_t* word) { *word = swap_bytes(*word); }
+
+// Record types and byte order for one ELF class/data combination. Code
+// templated on it compiles to plain loads when kSwap is false, so the
+// ELF64 little-endian path carries no per-field checks.
+template <typename Word, bool BigEndian>
+struct ElfFormat {
+  static constexpr bool kElf64 = sizeof(Word) == 8;
+  static constexpr bool kBigEndian = BigEndian;
+  static constexpr bool kSwap = BigEndian != (std::endian::native == std::endian::big);
+
+  using Addr = Word;
+  using Header = std::conditional_t<kElf64, Elf64Header, Elf32Header>;
+  using Phdr = std::conditional_t<kElf64, Elf64Phdr, Elf32Phdr>;
+  using Shdr = std::conditional_t<kElf64, Elf64Shdr, Elf32Shdr>;
+  using Sym = std::conditional_t<kElf64, Elf64Sym, Elf32Sym>;
+  using Rel = std::conditional_t<kElf64, Elf64Rel, Elf32Rel>;
+  using Rela = std::conditional_t<kElf64, Elf64Rela, Elf32Rela>;
+
+  static uint32_t reloc_type(Word info) {
+    return kElf64 ? static_cast<uint32_t>(info & 0xffffffffu) : static_cast<uint32_t>(info & 0xffu);
+  }
+  static uint32_t reloc_sym(Word info) {
+    return kElf64 ? static_cast<uint32_t>(static_cast<uint64_t>(info) >> 32) : static_cast<uint32_t>(info >> 8);
+  }
+};
+
+using Elf32Le = ElfFormat<uint32_t, false>;
+using Elf32Be = ElfFormat<uint32_t, true>;
+using Elf64Le = ElfFormat<uint64_t, false>;
+using Elf64Be = ElfFormat<uint64_t, true>;
+
+// Class and byte order from e_ident.
+struct ElfIdent {
+  bool elf64 = true;
+  Endian endian = Endian::Little;
+};
+
+// Calls fn with a value of the ElfFormat matching ident.
+template <typename Fn>
+decltype(auto) with_elf_format(const ElfIdent& ident, Fn&& fn) {
+  if (ident.elf64) {
+    return ident.endian == Endian::Big ? fn(Elf64Be{}) : fn(Elf64Le{});
+  }
+  return ident.endian == Endian::Big ? fn(Elf32Be{}) : fn(Elf32Le{});
+}
+
+// Reads count records at offset and converts them to host order in one pass
+// over the table.
+template <typename Format, typename T>
+bool read_elf_table(const ByteSource& source, uint64_t offset, size_t count, std::vector<T>* out) {
+  out->resize(count);
+  if (count == 0) {
+    return true;
+  }
+  if (count > source.size() / sizeof(T) || !source.read(offset, out->data(), count * sizeof(T))) {
+    out->clear();
+    return false;
+  }
+  if constexpr (Format::kSwap) {
+    for (T& record : *out) {
+      swap_record(&record);
+    }
+  }
+  return true;
+}
+
+template <typename Format, typename T>
+bool read_elf_record(const ByteSource& source, uint64_t offset, T* out) {
+  if (!source.read(offset, out, sizeof(T))) {
+    return false;
+  }
+  if constexpr (Format::kSwap) {
+    swap_record(out);
+  }
+  return true;
+}
+
+} // namespace ghirda::loader
@@ -1,12 +1,32 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
+#include "ghirda/core/debug_info.h"
+#include "ghirda/loader/debug_file.h"
 #include "ghirda/loader/loader.h"
 
 namespace ghirda::loader {
 
 class ElfLoader : public Loader {
 public:
-  bool load(const std::string& path, ghirda::core::Program* program, std::string* error) override;
+  using Loader::load;
+  uint32_t probe(std::span<const uint8_t> header) const override;
+  bool load(const ByteSource& source, ghirda::core::Program* program, std::string* error) override;
+
+  // Consulted when the image carries no .debug_info of its own; defaults to
+  // the system /usr/lib/debug tree without an index. nullptr disables it.
+  void set_debug_file_resolver(std::shared_ptr<DebugFileResolver> resolver);
+
+  // Looks up one DWARF subprogram without loading the image: through
+  // .debug_names when the image (or its debug file) has one, otherwise by
+  // walking every DIE. indexed reports which path was taken.
+  bool find_debug_function(const ByteSource& source, const std::string& name, ghirda::core::DebugFunction* out,
+                           bool* indexed, std::string* error);
+
+private:
+  std::shared_ptr<DebugFileResolver> debug_files_ = std::make_shared<DebugFileResolver>();
 };
 
 } // namespace ghirda::loader
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+#include "ghirda/loader/debug_section.h"
+#include "ghirda/loader/dwarf_reader.h"
+#include "ghirda/loader/elf_format.h"
+
+namespace ghirda::loader {
+
+struct ElfSectionHeader {
+  std::string name;
+  uint32_t type = 0;
+  uint64_t flags = 0;
+  uint64_t addr = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  uint32_t link = 0;
+  uint32_t info = 0;
+  uint64_t addralign = 0;
+  uint64_t entsize = 0;
+};
+
+// Identity of a separate debug file as recorded in a stripped image.
+struct ElfDebugLink {
+  // NT_GNU_BUILD_ID descriptor as lowercase hex; empty if absent.
+  std::string build_id;
+  // .gnu_debuglink file name and the CRC-32 of the file it names.
+  std::string debuglink;
+  uint32_t debuglink_crc = 0;
+
+  bool empty() const;
+};
+
+// Reads the class and byte order from e_ident.
+bool read_elf_ident(const ByteSource& source, ElfIdent* out, std::string* error);
+
+// Reads the named section table of any ELF file, including relocatable
+// objects such as .dwo files and .dwp packages.
+bool read_elf_section_headers(const ByteSource& source, std::vector<ElfSectionHeader>* out, std::string* error);
+
+// Same, for a header already read and converted to host order. An image
+// without a section table yields an empty list.
+template <typename Format>
+bool read_elf_section_table(const ByteSource& source, const typename Format::Header& header,
+                            std::vector<ElfSectionHeader>* out, std::string* error) {
+  using Shdr = typename Format::Shdr;
+  out->clear();
+  if (header.shoff == 0 || header.shnum == 0) {
+    return true;
+  }
+  if (header.shentsize != sizeof(Shdr) || header.shstrndx >= header.shnum) {
+    if (error) {
+      *error = "malformed section header table";
+    }
+    return false;
+  }
+  std::vector<Shdr> sections;
+  if (!read_elf_table<Format>(source, header.shoff, header.shnum, &sections)) {
+    if (error) {
+      *error = "failed to read section headers";
+    }
+    return false;
+  }
+  ByteView shstrtab;
+  if (!source.view(sections[header.shstrndx].offset, sections[header.shstrndx].size, &shstrtab)) {
+    if (error) {
+      *error = "failed to read section string table";
+    }
+    return false;
+  }
+
+  out->reserve(sections.size());
+  for (const Shdr& shdr : sections) {
+    out->push_back(ElfSectionHeader{read_string(shstrtab, shdr.name), shdr.type, shdr.flags, shdr.addr, shdr.offset,
+                                    shdr.size, shdr.link, shdr.info, shdr.addralign, shdr.entsize});
+  }
+  return true;
+}
+
+// Attaches the DWARF sections of an ELF file to their reader slots. With
+// split set only the ".dwo"-suffixed sections of a split unit or package are
+// taken, under their unsuffixed slot. Every created section is also appended
+// to all_sections when given, for prefetching.
+bool collect_dwarf_sections(const ByteSource& source, const std::vector<ElfSectionHeader>& headers, bool split,
+                            DwarfSections* out, std::vector<std::shared_ptr<DebugSection>>* all_sections,
+                            std::string* error);
+
+// Collects the GNU build-id note and .gnu_debuglink from the section table.
+void read_elf_debug_link(const ByteSource& source, const std::vector<ElfSectionHeader>& headers,
+                         ElfDebugLink* out);
+
+} // namespace ghirda::loader
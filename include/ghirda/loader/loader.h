@@ -1,15 +1,24 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
 
 #include "ghirda/core/program.h"
+#include "ghirda/loader/byte_source.h"
 
 namespace ghirda::loader {
 
 class Loader {
 public:
   virtual ~Loader() = default;
-  virtual bool load(const std::string& path, ghirda::core::Program* program, std::string* error) = 0;
+  // Confidence from 0 (not this format) to 100 that the loader handles a file
+  // starting with header. header holds at most LoaderRegistry::kProbeSize
+  // bytes and may be shorter than any fixed structure; probes must not read
+  // the source.
+  virtual uint32_t probe(std::span<const uint8_t> header) const;
+  virtual bool load(const std::string& path, ghirda::core::Program* program, std::string* error);
+  virtual bool load(const ByteSource& source, ghirda::core::Program* program, std::string* error) = 0;
 };
 
 } // namespace ghirda::loader
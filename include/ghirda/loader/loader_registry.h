@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ghirda/loader/loader.h"
+
+namespace ghirda::loader {
+
+using LoaderFactory = std::function<std::unique_ptr<Loader>()>;
+
+struct LoaderMatch {
+  std::string name;
+  uint32_t confidence = 0;
+};
+
+// Picks a loader by format probing instead of trying each one in turn. The
+// first kProbeSize bytes of a source are viewed once and passed to every
+// registered loader's probe(); the highest confidence wins, ties going to the
+// earlier registration.
+class LoaderRegistry {
+public:
+  static constexpr size_t kProbeSize = 4096;
+
+  // elf, pe, macho, and raw as the fallback, all with default settings.
+  static LoaderRegistry with_builtin_loaders();
+
+  // Registers factory under name. An existing entry of that name is replaced
+  // in place, keeping its tie-break position, so callers can swap in a
+  // configured loader for a built-in one.
+  void add(std::string name, LoaderFactory factory);
+  bool contains(const std::string& name) const;
+  std::vector<std::string> names() const;
+
+  // Loaders with non-zero confidence, best first.
+  std::vector<LoaderMatch> probe(std::span<const uint8_t> header) const;
+  bool probe(const ByteSource& source, std::vector<LoaderMatch>* matches, std::string* error) const;
+  // Best match for each source, probed on up to thread_count workers (0 =
+  // hardware concurrency). Confidence 0 means no loader claimed the source.
+  std::vector<LoaderMatch> probe_all(std::span<const ByteSource* const> sources, size_t thread_count = 0) const;
+
+  // New instance of the named loader; nullptr if none is registered.
+  std::unique_ptr<Loader> create(const std::string& name) const;
+
+  // Loads with the best-matching loader; loader_name receives its name.
+  bool load(const ByteSource& source, ghirda::core::Program* program, std::string* error,
+            std::string* loader_name = nullptr) const;
+  bool load(const std::string& path, ghirda::core::Program* program, std::string* error,
+            std::string* loader_name = nullptr) const;
+  // Skips probing.
+  bool load_with(const std::string& name, const ByteSource& source, ghirda::core::Program* program,
+                 std::string* error) const;
+
+private:
+  struct Entry {
+    std::string name;
+    LoaderFactory factory;
+    // Kept for probing, which is const and reads no loader settings.
+    std::unique_ptr<Loader> prober;
+  };
+
+  std::vector<Entry> entries_{};
+};
+
+} // namespace ghirda::loader
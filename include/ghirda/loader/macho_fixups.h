@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ghirda/core/program.h"
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+
+struct MachoSegment {
+  std::string name;
+  uint64_t vmaddr = 0;
+  uint64_t vmsize = 0;
+  uint64_t fileoff = 0;
+  uint64_t filesize = 0;
+};
+
+// What dyld fixups are resolved against: segments in load-command order (the
+// opcode streams and chained starts index them), dylibs in LC_LOAD_DYLIB
+// order (ordinal 1 is dylibs[0]) and the image's own defined symbols, used
+// for self, flat and weak binds.
+struct MachoImageLayout {
+  std::vector<MachoSegment> segments;
+  std::vector<std::string> dylibs;
+  std::unordered_map<std::string, uint64_t> defined;
+};
+
+// File ranges of the LC_DYLD_INFO(_ONLY) opcode streams.
+struct MachoDyldInfo {
+  uint32_t rebase_off = 0;
+  uint32_t rebase_size = 0;
+  uint32_t bind_off = 0;
+  uint32_t bind_size = 0;
+  uint32_t weak_bind_off = 0;
+  uint32_t weak_bind_size = 0;
+  uint32_t lazy_bind_off = 0;
+  uint32_t lazy_bind_size = 0;
+};
+
+// Both functions decode every fixup first and then apply them to the
+// program's MemoryImage as one address-sorted batch, recording a Relocation
+// per fixup. The image is kept at its preferred address, so classic rebases
+// are recorded but leave memory untouched; chained rebases are rewritten
+// from their packed encoding to the target pointer. Binds to other images
+// resolve to their addend.
+bool apply_dyld_info(const ByteSource& source, const MachoImageLayout& layout, const MachoDyldInfo& info,
+                     ghirda::core::Program* program, std::string* error);
+bool apply_chained_fixups(const ByteSource& source, const MachoImageLayout& layout, uint32_t data_offset,
+                          uint32_t data_size, ghirda::core::Program* program, std::string* error);
+
+} // namespace ghirda::loader
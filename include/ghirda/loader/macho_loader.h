@@ -1,12 +1,45 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "ghirda/loader/loader.h"
 
 namespace ghirda::loader {
 
+struct MachoSlice {
+  uint32_t cputype = 0;
+  uint32_t cpusubtype = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  uint32_t align = 0;
+  std::string arch;
+};
+
+// Loads thin 64-bit Mach-O images and universal (fat) binaries. For a fat
+// file, load() picks the host architecture if present and otherwise the first
+// 64-bit slice; load_slice() and load_all() give explicit control. Slices are
+// windows onto the caller's source, so nothing is reopened or copied.
 class MachoLoader : public Loader {
 public:
-  bool load(const std::string& path, ghirda::core::Program* program, std::string* error) override;
+  using Loader::load;
+  uint32_t probe(std::span<const uint8_t> header) const override;
+  bool load(const ByteSource& source, ghirda::core::Program* program, std::string* error) override;
+
+  static bool is_fat(const ByteSource& source);
+  // A thin image is reported as a single slice covering the whole source.
+  static bool list_slices(const ByteSource& source, std::vector<MachoSlice>* slices, std::string* error);
+
+  bool load_slice(const ByteSource& source, size_t index, ghirda::core::Program* program, std::string* error);
+  bool load_slice(const ByteSource& source, const std::string& arch, ghirda::core::Program* program,
+                  std::string* error);
+  // Loads every slice into its own Program ("<name>:<arch>") on up to
+  // thread_count workers (0 = hardware concurrency). errors[i] is empty when
+  // slice i loaded; returns true only if all slices loaded.
+  bool load_all(const ByteSource& source, const std::string& name, std::vector<ghirda::core::Program>* programs,
+                std::vector<std::string>* errors, size_t thread_count = 0);
 };
 
 } // namespace ghirda::loader
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+
+// Multi-stream file container underneath PDBs. Opening reads only the
+// superblock and stream directory; a stream's blocks are touched the first
+// time it is requested. Streams stored in consecutive blocks are served as a
+// view of the source; scattered ones are gathered into one buffer once.
+class MsfFile {
+public:
+  static constexpr uint32_t kInvalidStream = 0xffff;
+
+  static bool is_msf(const ByteSource& source);
+  static std::unique_ptr<MsfFile> open(std::shared_ptr<const ByteSource> source, std::string* error);
+  ~MsfFile();
+
+  uint32_t block_size() const;
+  size_t stream_count() const;
+  uint64_t stream_size(uint32_t index) const;
+
+  // nullptr if the stream does not exist or its blocks are out of range.
+  // Safe to call from several threads; each stream is assembled once.
+  const ByteView* stream(uint32_t index) const;
+
+private:
+  struct Stream;
+
+  MsfFile(std::shared_ptr<const ByteSource> source, uint32_t block_size);
+  bool read_directory(uint32_t directory_bytes, std::string* error);
+  void assemble(uint32_t index) const;
+
+  std::shared_ptr<const ByteSource> source_{};
+  uint32_t block_size_ = 0;
+  std::vector<uint64_t> sizes_{};
+  std::vector<std::vector<uint32_t>> blocks_{};
+  std::vector<std::unique_ptr<Stream>> streams_{};
+};
+
+} // namespace ghirda::loader
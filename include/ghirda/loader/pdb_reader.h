@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ghirda/core/debug_info.h"
+#include "ghirda/core/program.h"
+#include "ghirda/loader/byte_source.h"
+#include "ghirda/loader/msf_file.h"
+
+namespace ghirda::loader {
+
+struct PdbModule {
+  std::string name;
+  std::string object_name;
+  uint32_t stream = MsfFile::kInvalidStream;
+  uint32_t symbols_size = 0;
+  uint32_t c11_size = 0;
+  uint32_t c13_size = 0;
+};
+
+struct PdbSymbol {
+  std::string name;
+  uint64_t address = 0;
+  bool function = false;
+};
+
+// One CodeView type stream (TPI or IPI). Records are located through the
+// stream's own index-offset buffer (one entry every few KiB of records) when
+// the hash stream provides it, so a lookup walks at most one short run; without
+// it the record offsets are scanned once on first lookup.
+class PdbTypeStream {
+public:
+  bool parse(const MsfFile& msf, uint32_t stream, std::string* error);
+
+  bool present() const;
+  uint32_t begin() const;
+  uint32_t end() const;
+  // Record body (after the length and kind) of a type index.
+  bool record(uint32_t index, uint16_t* kind, ByteView* body) const;
+
+  // Visits every record in index order.
+  template <typename Visitor>
+  bool for_each(Visitor&& visit) const;
+
+private:
+  struct IndexOffset {
+    uint32_t index = 0;
+    uint32_t offset = 0;
+  };
+
+  bool next_record(ByteReader& reader, uint16_t* kind, ByteView* body) const;
+  void build_full_index() const;
+
+  const ByteView* data_ = nullptr;
+  uint32_t header_size_ = 0;
+  uint32_t begin_ = 0;
+  uint32_t end_ = 0;
+  mutable std::mutex mutex_{};
+  mutable std::vector<IndexOffset> index_{};
+  mutable bool full_index_ = false;
+};
+
+// PDB 7 (MSF) reader. Only the stream directory and the DBI header are read
+// on open; type, symbol, module and line streams are mapped and decoded when
+// asked for.
+class PdbFile {
+public:
+  static std::unique_ptr<PdbFile> open(const std::string& path, std::string* error);
+  static std::unique_ptr<PdbFile> open(std::shared_ptr<const ByteSource> source, std::string* error);
+
+  // Matches the GUID and age from the image's RSDS CodeView record.
+  bool matches(const uint8_t guid[16], uint32_t age) const;
+  uint32_t age() const;
+
+  // Section:offset addresses are reported relative to this image base.
+  void set_image_base(uint64_t image_base);
+  uint64_t address_of(uint16_t segment, uint32_t offset) const;
+
+  const std::vector<PdbModule>& modules() const;
+  const PdbTypeStream& tpi() const;
+  const PdbTypeStream& ipi() const;
+
+  bool read_publics(std::vector<PdbSymbol>* out) const;
+  bool find_public(const std::string& name, PdbSymbol* out) const;
+  bool read_module_functions(size_t module, std::vector<ghirda::core::DebugFunction>* out) const;
+  bool read_module_lines(size_t module, std::vector<ghirda::core::DebugLineEntry>* out) const;
+  // Decodes the TPI stream into DebugInfo types keyed by type index (in
+  // die_offset). Forward references are redirected to their definitions;
+  // forward_refs receives the redirections for references held elsewhere.
+  bool read_types(std::vector<ghirda::core::DebugType>* out,
+                  std::unordered_map<uint32_t, uint32_t>* forward_refs = nullptr) const;
+
+private:
+  PdbFile() = default;
+  bool parse_info(std::string* error);
+  bool parse_dbi(std::string* error);
+  uint32_t return_type_of(uint32_t type_index, bool item_id) const;
+  std::string name_at(uint32_t offset) const;
+  void build_public_index() const;
+
+  std::unique_ptr<MsfFile> msf_{};
+  uint8_t guid_[16] = {};
+  uint32_t age_ = 0;
+  uint32_t names_stream_ = MsfFile::kInvalidStream;
+  uint32_t symbol_records_stream_ = MsfFile::kInvalidStream;
+  uint32_t section_header_stream_ = MsfFile::kInvalidStream;
+  uint64_t image_base_ = 0;
+  std::vector<uint32_t> section_addresses_{};
+  std::vector<PdbModule> modules_{};
+  PdbTypeStream tpi_{};
+  PdbTypeStream ipi_{};
+
+  mutable std::mutex publics_mutex_{};
+  mutable bool publics_indexed_ = false;
+  mutable std::unordered_map<std::string, uint32_t> public_offsets_{};
+};
+
+struct PdbIngestOptions {
+  bool publics = true;
+  bool functions = true;
+  bool types = true;
+  // Line tables are the bulk of a large PDB; off unless asked for.
+  bool lines = false;
+};
+
+bool ingest_pdb(const PdbFile& pdb, ghirda::core::Program* program, const PdbIngestOptions& options,
+                std::string* error);
+
+template <typename Visitor>
+bool PdbTypeStream::for_each(Visitor&& visit) const {
+  if (!data_) {
+    return false;
+  }
+  ByteReader reader(*data_);
+  if (!reader.seek(header_size_)) {
+    return false;
+  }
+  for (uint32_t index = begin_; index < end_; ++index) {
+    uint16_t kind = 0;
+    ByteView body;
+    if (!next_record(reader, &kind, &body)) {
+      return false;
+    }
+    visit(index, kind, body);
+  }
+  return true;
+}
+
+} // namespace ghirda::loader
@@ -1,12 +1,33 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "ghirda/loader/loader.h"
+#include "ghirda/loader/pdb_reader.h"
 
 namespace ghirda::loader {
 
 class PeLoader : public Loader {
 public:
-  bool load(const std::string& path, ghirda::core::Program* program, std::string* error) override;
+  using Loader::load;
+  uint32_t probe(std::span<const uint8_t> header) const override;
+  bool load(const ByteSource& source, ghirda::core::Program* program, std::string* error) override;
+
+  // The PDB named in the image's RSDS record is looked for at its recorded
+  // path, beside the image, then in these directories; it is used only if its
+  // GUID and age match.
+  void add_pdb_search_dir(std::string dir);
+  void set_pdb_options(const PdbIngestOptions& options);
+  void set_pdb_enabled(bool enabled);
+
+private:
+  bool load_pdb(const ByteSource& source, const uint8_t guid[16], uint32_t age, uint64_t image_base,
+                ghirda::core::Program* program) const;
+
+  std::vector<std::string> pdb_search_dirs_{};
+  PdbIngestOptions pdb_options_{};
+  bool pdb_enabled_ = true;
 };
 
 } // namespace ghirda::loader
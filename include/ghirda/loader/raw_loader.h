@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ghirda/loader/loader.h"
+
+namespace ghirda::loader {
+
+enum class RawArch {
+  Unknown,
+  X86_64,
+  X86,
+  Arm,
+  Thumb,
+  Aarch64,
+  RiscV,
+  Mips,
+  PowerPc,
+};
+
+const char* raw_arch_name(RawArch arch);
+// Accepts the names raw_arch_name returns.
+bool parse_raw_arch(std::string_view name, RawArch* arch);
+
+struct RawLoaderOptions {
+  uint64_t base_address = 0;
+  // Window of the source to map; size 0 takes everything after offset.
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  // Unknown scores every prologue set and keeps the best match.
+  RawArch arch = RawArch::Unknown;
+  bool big_endian = false;
+  // Classification granularity, and scan workers (0 = hardware concurrency).
+  uint32_t block_size = 4096;
+  size_t thread_count = 0;
+};
+
+enum class BlobRegionKind {
+  Padding,
+  Data,
+  Code,
+  // Compressed or encrypted content.
+  HighEntropy,
+};
+
+struct BlobRegion {
+  uint64_t start = 0;
+  uint64_t size = 0;
+  BlobRegionKind kind = BlobRegionKind::Data;
+  // Mean Shannon entropy of the region's blocks, in bits per byte.
+  double entropy = 0.0;
+  uint32_t prologues = 0;
+};
+
+struct BlobScan {
+  RawArch arch = RawArch::Unknown;
+  bool big_endian = false;
+  std::vector<BlobRegion> regions;
+};
+
+// Headerless images such as flash dumps. The bytes are mapped at the
+// configured base and the regions found by scan() are proposed into the
+// program's MemoryMap, code as executable.
+class RawLoader : public Loader {
+public:
+  explicit RawLoader(RawLoaderOptions options = {});
+
+  using Loader::load;
+  uint32_t probe(std::span<const uint8_t> header) const override;
+  bool load(const ByteSource& source, ghirda::core::Program* program, std::string* error) override;
+
+  void set_options(const RawLoaderOptions& options);
+  const RawLoaderOptions& options() const;
+  // Result of the most recent load().
+  const BlobScan& last_scan() const;
+
+  // Classifies the options' window of source block by block on worker
+  // threads (byte histogram entropy plus per-architecture prologue counts)
+  // and merges neighbouring blocks of the same kind. Addresses are relative
+  // to options.base_address.
+  static bool scan(const ByteSource& source, const RawLoaderOptions& options, BlobScan* out, std::string* error);
+
+private:
+  RawLoaderOptions options_{};
+  BlobScan last_scan_{};
+};
+
+} // namespace ghirda::loader
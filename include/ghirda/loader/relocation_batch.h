@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ghirda/core/program.h"
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+
+// Shared relocation engine for the loaders. Relocations are collected with
+// their computed values, then commit() sorts them by target address (and so
+// by page), applies every write through one MemoryImage::apply_writes pass
+// and appends the records to the program's relocation table in that order.
+// Applied pointer-valued writes that land on mapped memory also become
+// Pointer references in the program's reference database.
+class RelocationBatch {
+public:
+  // Words are read and written in the given byte order.
+  explicit RelocationBatch(ghirda::core::Program* program, Endian endian = Endian::Little);
+
+  // Symbol ids are shared with the program's relocation table.
+  uint32_t intern(std::string_view name);
+  const std::string& symbol_name(uint32_t id) const;
+
+  void reserve(size_t count);
+  // Replaces the size-byte word at record.address with value. pointer is
+  // false for results that are not addresses, such as PC-relative offsets.
+  void store(const ghirda::core::Relocation& record, uint64_t value, uint8_t size = 8, bool pointer = true);
+  // Adds delta to the size-byte word already at record.address.
+  void add(const ghirda::core::Relocation& record, uint64_t delta, uint8_t size = 8, bool pointer = true);
+  // Keeps record, with its status, without touching memory. A pointer
+  // record of known size whose word already holds a mapped address still
+  // adds a Pointer reference; one at an unmapped address becomes Unmapped.
+  void record(const ghirda::core::Relocation& record, bool pointer = false);
+
+  size_t pending() const;
+  // Returns the number of writes that landed. The batch is empty afterwards.
+  size_t commit();
+
+private:
+  enum class Mode : uint8_t { None, Store, Add };
+  struct Entry {
+    ghirda::core::Relocation record;
+    uint64_t value = 0;
+    uint8_t size = 0;
+    Mode mode = Mode::None;
+    bool pointer = false;
+  };
+
+  bool read_word(const ghirda::core::MemoryImage& image, const Entry& entry, uint64_t* out) const;
+
+  ghirda::core::Program* program_ = nullptr;
+  Endian endian_ = Endian::Little;
+  std::vector<Entry> entries_{};
+};
+
+} // namespace ghirda::loader
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ghirda/loader/byte_source.h"
+#include "ghirda/loader/dwarf_reader.h"
+
+namespace ghirda::loader {
+
+struct SplitDwarfStats {
+  size_t requested = 0;
+  size_t from_package = 0;
+  size_t from_dwo = 0;
+  size_t missing = 0;
+};
+
+// Finds the split half of -gsplit-dwarf skeleton units. A .dwp package next
+// to the image is mapped on the first request and only its CU index is read;
+// each lookup then hashes the unit's dwo_id into the index and hands back
+// views of that unit's contributions, so the rest of the package is never
+// touched. Units missing from the package fall back to their .dwo file, named
+// by DW_AT_dwo_name relative to DW_AT_comp_dir or a search directory.
+// resolve() may be called from several threads.
+class SplitDwarfResolver {
+public:
+  explicit SplitDwarfResolver(std::string image_path);
+  ~SplitDwarfResolver();
+
+  void set_package_path(std::string path);
+  void add_search_dir(std::string dir);
+
+  // On success out holds the unit's .debug_info/abbrev/str/str_offsets/line/
+  // rnglists; .debug_addr stays with the skeleton's image and is left empty.
+  bool resolve(uint64_t dwo_id, const std::string& dwo_name, const std::string& comp_dir, DwarfSections* out,
+               std::string* error);
+
+  SplitDwarfStats stats() const;
+
+private:
+  struct Package;
+
+  bool open_package();
+  bool resolve_in_package(uint64_t dwo_id, DwarfSections* out);
+  bool resolve_dwo(const std::string& dwo_name, const std::string& comp_dir, DwarfSections* out,
+                   std::string* error);
+
+  std::string image_path_;
+  std::string package_path_;
+  std::vector<std::string> search_dirs_{};
+
+  mutable std::mutex mutex_{};
+  bool package_opened_ = false;
+  std::unique_ptr<Package> package_{};
+  std::unordered_map<std::string, DwarfSections> dwo_files_{};
+  SplitDwarfStats stats_{};
+};
+
+} // namespace ghirda::loader
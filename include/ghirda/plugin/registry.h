@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 
+#include "ghirda/loader/loader_registry.h"
+
 namespace ghirda::plugin {
 
 struct PluginInfo {
@@ -10,13 +12,27 @@ struct PluginInfo {
   std::string name;
 };
 
+// A loader a plugin adds to the format registry under name.
+struct LoaderContribution {
+  std::string plugin_id;
+  std::string name;
+  ghirda::loader::LoaderFactory factory;
+};
+
 class Registry {
 public:
   void register_plugin(const PluginInfo& info);
   const std::vector<PluginInfo>& plugins() const;
 
+  void register_loader(LoaderContribution contribution);
+  const std::vector<LoaderContribution>& loaders() const;
+  // Adds every contributed loader to registry; a contribution named like an
+  // existing loader replaces it.
+  void install_loaders(ghirda::loader::LoaderRegistry* registry) const;
+
 private:
   std::vector<PluginInfo> plugins_{};
+  std::vector<LoaderContribution> loaders_{};
 };
 
 } // namespace ghirda::plugin
@@ -13,6 +13,12 @@ enum class OpCode {
   Branch,
   Call,
   Return,
+  IntAdd,
+  IntSub,
+  PtrAdd,
+  PtrSub,
+  Cast,
+  MultiEqual,
   Unknown
 };
 
@@ -0,0 +1,164 @@
+#include "ghirda/analysis/call_graph.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ghirda::analysis {
+namespace {
+
+// Counting sort of (from, to) pairs into CSR rows; rows come out sorted
+// because pairs are visited in (from, to) order.
+void fill_csr(size_t nodes, const std::vector<std::pair<uint32_t, uint32_t>>& pairs, std::vector<uint32_t>* offsets,
+              std::vector<uint32_t>* targets) {
+  offsets->assign(nodes + 1, 0);
+  for (const auto& pair : pairs) {
+    ++(*offsets)[pair.first + 1];
+  }
+  for (size_t i = 0; i < nodes; ++i) {
+    (*offsets)[i + 1] += (*offsets)[i];
+  }
+  targets->resize(pairs.size());
+  std::vector<uint32_t> cursor(offsets->begin(), offsets->end() - 1);
+  for (const auto& pair : pairs) {
+    (*targets)[cursor[pair.first]++] = pair.second;
+  }
+}
+
+} // namespace
+
+void CallGraph::build(std::vector<uint64_t> entries, std::span<const CallEdge> edges) {
+  std::sort(entries.begin(), entries.end());
+  entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+  entries_ = std::move(entries);
+
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  pairs.reserve(edges.size());
+  for (const CallEdge& edge : edges) {
+    const uint32_t caller = node_at(edge.caller);
+    const uint32_t callee = node_at(edge.callee);
+    if (caller != kNoNode && callee != kNoNode) {
+      pairs.emplace_back(caller, callee);
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+  fill_csr(entries_.size(), pairs, &callee_offsets_, &callee_nodes_);
+
+  for (auto& pair : pairs) {
+    std::swap(pair.first, pair.second);
+  }
+  std::sort(pairs.begin(), pairs.end());
+  fill_csr(entries_.size(), pairs, &caller_offsets_, &caller_nodes_);
+
+  compute_components();
+}
+
+// Tarjan's algorithm with an explicit stack, so deep call chains cannot
+// overflow the native one. Components complete in reverse topological order,
+// which is the callees-first numbering.
+void CallGraph::compute_components() {
+  constexpr uint32_t kUnvisited = UINT32_MAX;
+  const size_t count = entries_.size();
+  std::vector<uint32_t> index(count, kUnvisited);
+  std::vector<uint32_t> low(count, 0);
+  std::vector<bool> on_stack(count, false);
+  std::vector<uint32_t> stack;
+  struct Frame {
+    uint32_t node;
+    uint32_t next_edge;
+  };
+  std::vector<Frame> frames;
+
+  component_of_.assign(count, 0);
+  component_offsets_.assign(1, 0);
+  component_nodes_.clear();
+  component_nodes_.reserve(count);
+  uint32_t counter = 0;
+
+  auto visit = [&](uint32_t node) {
+    index[node] = low[node] = counter++;
+    stack.push_back(node);
+    on_stack[node] = true;
+    frames.push_back(Frame{node, callee_offsets_[node]});
+  };
+
+  for (uint32_t root = 0; root < count; ++root) {
+    if (index[root] != kUnvisited) {
+      continue;
+    }
+    visit(root);
+    while (!frames.empty()) {
+      const uint32_t node = frames.back().node;
+      if (frames.back().next_edge < callee_offsets_[node + 1]) {
+        const uint32_t callee = callee_nodes_[frames.back().next_edge++];
+        if (index[callee] == kUnvisited) {
+          visit(callee);
+        } else if (on_stack[callee]) {
+          low[node] = std::min(low[node], index[callee]);
+        }
+        continue;
+      }
+
+      if (low[node] == index[node]) {
+        const uint32_t id = static_cast<uint32_t>(component_offsets_.size() - 1);
+        uint32_t member = 0;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          on_stack[member] = false;
+          component_of_[member] = id;
+          component_nodes_.push_back(member);
+        } while (member != node);
+        component_offsets_.push_back(static_cast<uint32_t>(component_nodes_.size()));
+      }
+      frames.pop_back();
+      if (!frames.empty()) {
+        const uint32_t parent = frames.back().node;
+        low[parent] = std::min(low[parent], low[node]);
+      }
+    }
+  }
+}
+
+size_t CallGraph::node_count() const { return entries_.size(); }
+
+size_t CallGraph::edge_count() const { return callee_nodes_.size(); }
+
+uint32_t CallGraph::node_at(uint64_t entry) const {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), entry);
+  if (it == entries_.end() || *it != entry) {
+    return kNoNode;
+  }
+  return static_cast<uint32_t>(it - entries_.begin());
+}
+
+uint64_t CallGraph::entry(uint32_t node) const { return entries_[node]; }
+
+std::span<const uint32_t> CallGraph::callees(uint32_t node) const {
+  return std::span<const uint32_t>(callee_nodes_).subspan(callee_offsets_[node],
+                                                          callee_offsets_[node + 1] - callee_offsets_[node]);
+}
+
+std::span<const uint32_t> CallGraph::callers(uint32_t node) const {
+  return std::span<const uint32_t>(caller_nodes_).subspan(caller_offsets_[node],
+                                                          caller_offsets_[node + 1] - caller_offsets_[node]);
+}
+
+size_t CallGraph::component_count() const { return component_offsets_.empty() ? 0 : component_offsets_.size() - 1; }
+
+uint32_t CallGraph::component(uint32_t node) const { return component_of_[node]; }
+
+std::span<const uint32_t> CallGraph::component_members(uint32_t component) const {
+  return std::span<const uint32_t>(component_nodes_)
+      .subspan(component_offsets_[component], component_offsets_[component + 1] - component_offsets_[component]);
+}
+
+bool CallGraph::recursive(uint32_t node) const {
+  if (component_members(component_of_[node]).size() > 1) {
+    return true;
+  }
+  const auto own = callees(node);
+  return std::binary_search(own.begin(), own.end(), node);
+}
+
+} // namespace ghirda::analysis
@@ -0,0 +1,460 @@
+#include "ghirda/analysis/flow_decoder.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace ghirda::analysis {
+namespace {
+
+using ghirda::core::Processor;
+
+constexpr size_t kMaxX86Length = 15;
+
+int64_t sign_extend(uint64_t value, unsigned bits) {
+  const uint64_t sign = uint64_t{1} << (bits - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+uint64_t read_le(std::span<const uint8_t> bytes, size_t pos, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value |= static_cast<uint64_t>(bytes[pos + i]) << (8 * i);
+  }
+  return value;
+}
+
+bool x86_legacy_prefix(uint8_t b) {
+  switch (b) {
+    case 0xf0:
+    case 0xf2:
+    case 0xf3:
+    case 0x26:
+    case 0x2e:
+    case 0x36:
+    case 0x3e:
+    case 0x64:
+    case 0x65:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// One-byte opcodes that do not exist in 64-bit mode.
+bool x86_invalid_in_64(uint8_t op) {
+  switch (op) {
+    case 0x06:
+    case 0x07:
+    case 0x0e:
+    case 0x16:
+    case 0x17:
+    case 0x1e:
+    case 0x1f:
+    case 0x27:
+    case 0x2f:
+    case 0x37:
+    case 0x3f:
+    case 0x60:
+    case 0x61:
+    case 0x82:
+    case 0x9a:
+    case 0xce:
+    case 0xd4:
+    case 0xd5:
+    case 0xd6:
+    case 0xea:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool x86_modrm_one_byte(uint8_t op) {
+  if (op < 0x40) {
+    return (op & 7) < 4;
+  }
+  if (op >= 0x80 && op <= 0x8f) {
+    return true;
+  }
+  if (op >= 0xd0 && op <= 0xd3) {
+    return true;
+  }
+  if (op >= 0xd8 && op <= 0xdf) {
+    return true;
+  }
+  switch (op) {
+    case 0x62:
+    case 0x63:
+    case 0x69:
+    case 0x6b:
+    case 0xc0:
+    case 0xc1:
+    case 0xc4:
+    case 0xc5:
+    case 0xc6:
+    case 0xc7:
+    case 0xf6:
+    case 0xf7:
+    case 0xfe:
+    case 0xff:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Immediate bytes of a one-byte-map opcode; z is the operand-size word.
+size_t x86_imm_one_byte(uint8_t op, uint8_t reg, size_t z, bool rex_w, bool x64, bool address16, bool address32) {
+  if (op < 0x40) {
+    return (op & 7) == 4 ? 1 : ((op & 7) == 5 ? z : 0);
+  }
+  if ((op >= 0x70 && op <= 0x7f) || (op >= 0xb0 && op <= 0xb7) || (op >= 0xe0 && op <= 0xe7)) {
+    return 1;
+  }
+  if (op >= 0xb8 && op <= 0xbf) {
+    return rex_w ? 8 : z;
+  }
+  if (op >= 0xa0 && op <= 0xa3) {
+    return x64 ? (address32 ? 4 : 8) : (address16 ? 2 : 4);
+  }
+  switch (op) {
+    case 0x68:
+    case 0x69:
+    case 0x81:
+    case 0xa9:
+    case 0xc7:
+      return z;
+    case 0x6a:
+    case 0x6b:
+    case 0x80:
+    case 0x82:
+    case 0x83:
+    case 0xa8:
+    case 0xc0:
+    case 0xc1:
+    case 0xc6:
+    case 0xcd:
+    case 0xd4:
+    case 0xd5:
+    case 0xeb:
+      return 1;
+    case 0xe8:
+    case 0xe9:
+      return x64 ? 4 : z;
+    case 0xc2:
+    case 0xca:
+      return 2;
+    case 0xc8:
+      return 3;
+    case 0x9a:
+    case 0xea:
+      return z + 2;
+    case 0xf6:
+      return reg < 2 ? 1 : 0;
+    case 0xf7:
+      return reg < 2 ? z : 0;
+    default:
+      return 0;
+  }
+}
+
+bool x86_modrm_0f(uint8_t op) {
+  if ((op >= 0x30 && op <= 0x37) || (op >= 0x80 && op <= 0x8f) || (op >= 0xc8 && op <= 0xcf)) {
+    return false;
+  }
+  switch (op) {
+    case 0x05:
+    case 0x06:
+    case 0x07:
+    case 0x08:
+    case 0x09:
+    case 0x0b:
+    case 0x0e:
+    case 0x77:
+    case 0xa0:
+    case 0xa1:
+    case 0xa2:
+    case 0xa8:
+    case 0xa9:
+    case 0xaa:
+      return false;
+    default:
+      return true;
+  }
+}
+
+bool x86_imm8_0f(uint8_t op) {
+  switch (op) {
+    case 0x0f:
+    case 0x70:
+    case 0x71:
+    case 0x72:
+    case 0x73:
+    case 0xa4:
+    case 0xac:
+    case 0xba:
+    case 0xc2:
+    case 0xc4:
+    case 0xc5:
+    case 0xc6:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool decode_x86(std::span<const uint8_t> bytes, uint64_t address, bool x64, FlowInstruction* out) {
+  const size_t limit = std::min(bytes.size(), kMaxX86Length);
+  size_t pos = 0;
+  bool operand16 = false;
+  bool address_override = false;
+  bool rex_w = false;
+  while (pos < limit && (bytes[pos] == 0x66 || bytes[pos] == 0x67 || x86_legacy_prefix(bytes[pos]))) {
+    operand16 = operand16 || bytes[pos] == 0x66;
+    address_override = address_override || bytes[pos] == 0x67;
+    ++pos;
+  }
+  if (x64 && pos < limit && (bytes[pos] & 0xf0) == 0x40) {
+    rex_w = (bytes[pos] & 0x08) != 0;
+    ++pos;
+  }
+  if (pos >= limit) {
+    return false;
+  }
+
+  // map 0 is the one-byte table; 1, 2 and 3 are 0F, 0F38 and 0F3A, and 5 and
+  // 6 the EVEX-only maps.
+  uint8_t op = bytes[pos++];
+  unsigned map = 0;
+  bool vex = false;
+  if (op == 0x0f) {
+    if (pos >= limit) {
+      return false;
+    }
+    op = bytes[pos++];
+    map = 1;
+    if (op == 0x38 || op == 0x3a) {
+      map = op == 0x38 ? 2 : 3;
+      if (pos >= limit) {
+        return false;
+      }
+      op = bytes[pos++];
+    }
+  } else if ((op == 0xc4 || op == 0xc5 || op == 0x62) && pos < limit && (x64 || (bytes[pos] & 0xc0) == 0xc0)) {
+    const size_t payload = op == 0xc5 ? 1 : (op == 0xc4 ? 2 : 3);
+    if (pos + payload >= limit) {
+      return false;
+    }
+    map = op == 0xc5 ? 1 : (op == 0xc4 ? bytes[pos] & 0x1f : bytes[pos] & 0x07);
+    if (map == 0 || map == 4 || map == 7 || (op != 0x62 && map > 3)) {
+      return false;
+    }
+    pos += payload;
+    op = bytes[pos++];
+    vex = true;
+  } else if (x64 && x86_invalid_in_64(op)) {
+    return false;
+  }
+
+  bool has_modrm = false;
+  if (map == 0) {
+    has_modrm = x86_modrm_one_byte(op);
+  } else if (map == 1) {
+    has_modrm = vex ? op != 0x77 : x86_modrm_0f(op);
+  } else {
+    has_modrm = true;
+  }
+
+  uint8_t mod = 3;
+  uint8_t reg = 0;
+  bool rip_relative = false;
+  bool absolute = false;
+  size_t disp_pos = 0;
+  size_t disp_size = 0;
+  const bool address16 = !x64 && address_override;
+  if (has_modrm) {
+    if (pos >= limit) {
+      return false;
+    }
+    const uint8_t modrm = bytes[pos++];
+    mod = modrm >> 6;
+    reg = (modrm >> 3) & 7;
+    const uint8_t rm = modrm & 7;
+    size_t disp = 0;
+    if (mod != 3 && address16) {
+      disp = mod == 1 ? 1 : (mod == 2 || rm == 6 ? 2 : 0);
+    } else if (mod != 3) {
+      uint8_t base = rm;
+      if (rm == 4) {
+        if (pos >= limit) {
+          return false;
+        }
+        base = bytes[pos++] & 7;
+      }
+      disp = mod == 1 ? 1 : (mod == 2 || base == 5 ? 4 : 0);
+      rip_relative = x64 && mod == 0 && rm == 5;
+      absolute = !x64 && mod == 0 && rm == 5;
+    }
+    disp_pos = pos;
+    disp_size = disp;
+    pos += disp;
+  }
+
+  const size_t z = operand16 ? 2 : 4;
+  size_t imm = 0;
+  if (map == 0) {
+    imm = x86_imm_one_byte(op, reg, z, rex_w, x64, address16, address_override);
+  } else if (map == 1) {
+    imm = op >= 0x80 && op <= 0x8f && !vex ? (x64 ? 4 : z) : (x86_imm8_0f(op) ? 1 : 0);
+  } else if (map == 3) {
+    imm = 1;
+  }
+  const size_t imm_pos = pos;
+  pos += imm;
+  if (pos > limit) {
+    return false;
+  }
+
+  out->length = static_cast<uint8_t>(pos);
+  out->kind = FlowKind::Fallthrough;
+  out->displacement_offset = static_cast<uint8_t>(disp_pos);
+  out->displacement_size = static_cast<uint8_t>(disp_size);
+  out->immediate_offset = static_cast<uint8_t>(imm_pos);
+  out->immediate_size = static_cast<uint8_t>(imm);
+  const uint64_t next = address + pos;
+  const uint64_t address_mask = x64 ? ~uint64_t{0} : 0xffffffffu;
+  auto relative = [&](FlowKind kind) {
+    out->kind = kind;
+    out->has_target = true;
+    out->target = (next + static_cast<uint64_t>(sign_extend(read_le(bytes, imm_pos, imm), 8 * imm))) & address_mask;
+  };
+
+  if (map == 0) {
+    if ((op >= 0x70 && op <= 0x7f) || (op >= 0xe0 && op <= 0xe3)) {
+      relative(FlowKind::ConditionalJump);
+    } else if (op == 0xeb || op == 0xe9) {
+      relative(FlowKind::Jump);
+    } else if (op == 0xe8) {
+      relative(FlowKind::Call);
+    } else if (op == 0xc2 || op == 0xc3 || op == 0xca || op == 0xcb || op == 0xcf) {
+      out->kind = FlowKind::Return;
+    } else if (op == 0xf4 || op == 0xcc) {
+      out->kind = FlowKind::Halt;
+    } else if (op == 0x9a) {
+      out->kind = FlowKind::IndirectCall;
+    } else if (op == 0xea) {
+      out->kind = FlowKind::IndirectJump;
+    } else if (op == 0xff && (reg == 2 || reg == 3)) {
+      out->kind = FlowKind::IndirectCall;
+    } else if (op == 0xff && (reg == 4 || reg == 5)) {
+      out->kind = FlowKind::IndirectJump;
+    } else if (op >= 0xa0 && op <= 0xa3 && imm >= 4) {
+      out->has_data = true;
+      out->data_write = op >= 0xa2;
+      out->data = read_le(bytes, imm_pos, imm);
+    }
+  } else if (map == 1 && !vex) {
+    if (op >= 0x80 && op <= 0x8f) {
+      relative(FlowKind::ConditionalJump);
+    } else if (op == 0x0b) {
+      out->kind = FlowKind::Halt;
+    }
+  }
+
+  if (rip_relative || absolute) {
+    const uint64_t disp = read_le(bytes, disp_pos, 4);
+    out->has_data = true;
+    out->data = rip_relative ? next + static_cast<uint64_t>(sign_extend(disp, 32)) : disp;
+    out->data_write = map == 0 && (op == 0x88 || op == 0x89 || op == 0xc6 || op == 0xc7);
+  }
+  return true;
+}
+
+bool decode_aarch64(std::span<const uint8_t> bytes, uint64_t address, FlowInstruction* out) {
+  if (bytes.size() < 4 || (address & 3) != 0) {
+    return false;
+  }
+  const uint32_t insn = static_cast<uint32_t>(read_le(bytes, 0, 4));
+  out->length = 4;
+  out->kind = FlowKind::Fallthrough;
+  auto branch = [&](FlowKind kind, uint64_t field, unsigned bits) {
+    out->kind = kind;
+    out->has_target = true;
+    out->target = address + static_cast<uint64_t>(sign_extend(field, bits) * 4);
+  };
+
+  if ((insn & 0x7c000000u) == 0x14000000u) {
+    // B, BL.
+    branch((insn & 0x80000000u) != 0 ? FlowKind::Call : FlowKind::Jump, insn & 0x03ffffffu, 26);
+  } else if ((insn & 0xff000010u) == 0x54000000u) {
+    // B.cond; AL and NV always branch.
+    const bool always = (insn & 0xe) == 0xe;
+    branch(always ? FlowKind::Jump : FlowKind::ConditionalJump, (insn >> 5) & 0x7ffff, 19);
+  } else if ((insn & 0x7e000000u) == 0x34000000u) {
+    // CBZ, CBNZ.
+    branch(FlowKind::ConditionalJump, (insn >> 5) & 0x7ffff, 19);
+  } else if ((insn & 0x7e000000u) == 0x36000000u) {
+    // TBZ, TBNZ.
+    branch(FlowKind::ConditionalJump, (insn >> 5) & 0x3fff, 14);
+  } else if ((insn & 0xfe000000u) == 0xd6000000u && ((insn >> 16) & 0x1f) == 0x1f) {
+    // Branch to register, including the pointer-authenticated forms.
+    switch ((insn >> 21) & 0x7) {
+      case 0:
+        out->kind = FlowKind::IndirectJump;
+        break;
+      case 1:
+        out->kind = FlowKind::IndirectCall;
+        break;
+      case 2:
+      case 4:
+        out->kind = FlowKind::Return;
+        break;
+      default:
+        return false;
+    }
+  } else if ((insn & 0x9f000000u) == 0x10000000u) {
+    // ADR.
+    const uint64_t imm = ((insn >> 5) & 0x7ffff) << 2 | ((insn >> 29) & 0x3);
+    out->has_data = true;
+    out->data = address + static_cast<uint64_t>(sign_extend(imm, 21));
+  } else if ((insn & 0x3b000000u) == 0x18000000u) {
+    // LDR (literal), general and SIMD registers.
+    out->has_data = true;
+    out->data = address + static_cast<uint64_t>(sign_extend((insn >> 5) & 0x7ffff, 19) * 4);
+  } else if ((insn & 0xffe0001fu) == 0xd4200000u || (insn & 0xffe0001fu) == 0xd4400000u ||
+             (insn & 0xffff0000u) == 0) {
+    // BRK, HLT, UDF.
+    out->kind = FlowKind::Halt;
+  }
+  return true;
+}
+
+} // namespace
+
+bool flow_supported(Processor processor) {
+  return processor == Processor::X86 || processor == Processor::X86_64 || processor == Processor::Aarch64;
+}
+
+bool decode_flow(Processor processor, std::span<const uint8_t> bytes, uint64_t address, FlowInstruction* out) {
+  *out = FlowInstruction{};
+  bool ok = false;
+  switch (processor) {
+    case Processor::X86:
+      ok = decode_x86(bytes, address, false, out);
+      break;
+    case Processor::X86_64:
+      ok = decode_x86(bytes, address, true, out);
+      break;
+    case Processor::Aarch64:
+      ok = decode_aarch64(bytes, address, out);
+      break;
+    default:
+      break;
+  }
+  if (!ok) {
+    *out = FlowInstruction{};
+  }
+  return ok;
+}
+
+} // namespace ghirda::analysis
@@ -0,0 +1,533 @@
+#include "ghirda/analysis/function_discovery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <numeric>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+#include "ghirda/analysis/flow_decoder.h"
+
+namespace ghirda::analysis {
+namespace {
+
+using ghirda::core::Processor;
+using ghirda::core::Reference;
+using ghirda::core::ReferenceType;
+
+FunctionSource from_start_source(ghirda::core::Program::FunctionStartSource source) {
+  switch (source) {
+    case ghirda::core::Program::FunctionStartSource::EntryPoint:
+      return FunctionSource::EntryPoint;
+    case ghirda::core::Program::FunctionStartSource::Export:
+      return FunctionSource::Export;
+    case ghirda::core::Program::FunctionStartSource::ExceptionTable:
+      return FunctionSource::ExceptionTable;
+    case ghirda::core::Program::FunctionStartSource::TlsCallback:
+      return FunctionSource::TlsCallback;
+  }
+  return FunctionSource::EntryPoint;
+}
+
+uint32_t load_u32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+         static_cast<uint32_t>(p[3]) << 24;
+}
+
+// Immediates below this are taken as constants, not addresses.
+constexpr uint64_t kMinAddressOperand = 0x10000;
+
+// Bytes a prologue match needs, and the alignment candidates are tried at.
+constexpr size_t kPrologueWindow = 4;
+
+uint64_t prologue_alignment(Processor processor) { return processor == Processor::Aarch64 ? 4 : 16; }
+
+// endbr and frame-pointer setup on x86; PAC, BTI and the frame record store
+// (stp x29, x30, [sp, #-n]!) on AArch64.
+bool prologue_at(Processor processor, const uint8_t* p) {
+  const uint32_t word = load_u32(p);
+  switch (processor) {
+    case Processor::X86_64:
+      return word == 0xfa1e0ff3u || word == 0xe5894855u || word == 0xec8b4855u;
+    case Processor::X86:
+      return word == 0xfb1e0ff3u || (word & 0xffffff) == 0xe58955u || (word & 0xffffff) == 0xec8b55u;
+    case Processor::Aarch64:
+      return word == 0xd503233fu || word == 0xd503237fu || word == 0xd503245fu || (word & 0xffc07fffu) == 0xa9807bfdu;
+    default:
+      return false;
+  }
+}
+
+template <typename Worker>
+void run_workers(size_t thread_count, size_t items, Worker&& worker) {
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, items);
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace
+
+const char* function_source_name(FunctionSource source) {
+  switch (source) {
+    case FunctionSource::EntryPoint:
+      return "entry";
+    case FunctionSource::Export:
+      return "export";
+    case FunctionSource::ExceptionTable:
+      return "exception-table";
+    case FunctionSource::TlsCallback:
+      return "tls-callback";
+    case FunctionSource::Symbol:
+      return "symbol";
+    case FunctionSource::Pointer:
+      return "pointer";
+    case FunctionSource::CallTarget:
+      return "call-target";
+    case FunctionSource::Prologue:
+      return "prologue";
+    case FunctionSource::Requested:
+      return "requested";
+  }
+  return "unknown";
+}
+
+FunctionDiscovery::FunctionDiscovery(ghirda::core::Program* program, FunctionDiscoveryOptions options)
+    : program_(program), options_(options) {}
+
+void FunctionDiscovery::collect_code() {
+  chunks_.clear();
+  processor_ = program_->processor();
+  const auto& segments = program_->memory_image().segments();
+  // Linkers often map read-only data in the same executable segment as the
+  // code; when the format marks code sections, decode only those.
+  std::vector<std::pair<uint64_t, uint64_t>> code_ranges;
+  for (const auto& section : program_->sections()) {
+    if (section.executable && section.size != 0) {
+      code_ranges.emplace_back(section.address, section.address + section.size);
+    }
+  }
+  for (const auto& region : program_->memory_map().regions()) {
+    if (!region.executable) {
+      continue;
+    }
+    const uint64_t region_end = region.start + region.size;
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    if (code_ranges.empty()) {
+      ranges.emplace_back(region.start, region_end);
+    } else {
+      for (const auto& [code_start, code_end] : code_ranges) {
+        if (std::max(region.start, code_start) < std::min(region_end, code_end)) {
+          ranges.emplace_back(std::max(region.start, code_start), std::min(region_end, code_end));
+        }
+      }
+    }
+    for (const auto& [range_start, range_end] : ranges) {
+      for (const auto& segment : segments) {
+        const uint64_t start = std::max(range_start, segment.start);
+        const uint64_t end = std::min(range_end, segment.start + segment.data.size());
+        if (start < end) {
+          chunks_.push_back(CodeChunk{start, segment.data.data() + (start - segment.start), end - start});
+        }
+      }
+    }
+  }
+  std::sort(chunks_.begin(), chunks_.end(), [](const CodeChunk& a, const CodeChunk& b) { return a.start < b.start; });
+}
+
+const FunctionDiscovery::CodeChunk* FunctionDiscovery::chunk_at(uint64_t address) const {
+  auto it = std::upper_bound(chunks_.begin(), chunks_.end(), address,
+                             [](uint64_t value, const CodeChunk& chunk) { return value < chunk.start; });
+  if (it == chunks_.begin()) {
+    return nullptr;
+  }
+  --it;
+  return address - it->start < it->size ? &*it : nullptr;
+}
+
+bool FunctionDiscovery::is_entry(uint64_t address) const {
+  return std::binary_search(entries_.begin(), entries_.end(), address);
+}
+
+void FunctionDiscovery::decode(uint32_t index, Decoded* out) const {
+  const uint64_t entry = functions_[index].entry;
+  std::vector<uint64_t> work{entry};
+  std::unordered_set<uint64_t> seen;
+  std::vector<AddressRange> instructions;
+
+  // A branch to another function's entry is a tail call; anything else
+  // executable is more of this function.
+  auto branch_to = [&](uint64_t from, uint64_t target, ReferenceType type) {
+    if (options_.record_references) {
+      out->references.push_back(Reference{from, target, type});
+    }
+    if (target != entry && is_entry(target)) {
+      out->calls.push_back(CallEdge{entry, target});
+    } else if (chunk_at(target)) {
+      work.push_back(target);
+    }
+  };
+
+  while (!work.empty() && instructions.size() < options_.max_instructions) {
+    uint64_t pc = work.back();
+    work.pop_back();
+    while (instructions.size() < options_.max_instructions && !seen.count(pc) && (pc == entry || !is_entry(pc))) {
+      const CodeChunk* chunk = chunk_at(pc);
+      FlowInstruction insn;
+      if (!chunk ||
+          !decode_flow(processor_, std::span<const uint8_t>(chunk->data + (pc - chunk->start), chunk->start + chunk->size - pc),
+                       pc, &insn)) {
+        break;
+      }
+      seen.insert(pc);
+      instructions.push_back(AddressRange{pc, pc + insn.length});
+      if (insn.has_data && options_.record_references) {
+        out->references.push_back(Reference{pc, insn.data, insn.data_write ? ReferenceType::Write : ReferenceType::Read});
+      }
+      // Non-PIC code takes addresses as immediates (mov $imm, push $imm);
+      // moffs addresses are already the data operand.
+      if (options_.record_references && insn.kind == FlowKind::Fallthrough && insn.immediate_size >= 4 &&
+          !(insn.has_data && insn.displacement_size == 0)) {
+        const uint8_t* immediate = chunk->data + (pc - chunk->start) + insn.immediate_offset;
+        uint64_t value = load_u32(immediate);
+        if (insn.immediate_size >= 8) {
+          value |= static_cast<uint64_t>(load_u32(immediate + 4)) << 32;
+        }
+        if (value >= kMinAddressOperand && program_->memory_image().contains(value)) {
+          out->references.push_back(Reference{pc, value, ReferenceType::Read});
+        }
+      }
+
+      bool falls_through = true;
+      switch (insn.kind) {
+        case FlowKind::Call:
+          if (insn.has_target) {
+            if (options_.record_references) {
+              out->references.push_back(Reference{pc, insn.target, ReferenceType::Call});
+            }
+            out->calls.push_back(CallEdge{entry, insn.target});
+            if (!is_entry(insn.target) && chunk_at(insn.target)) {
+              out->new_targets.push_back(insn.target);
+            }
+          }
+          break;
+        case FlowKind::ConditionalJump:
+          branch_to(pc, insn.target, ReferenceType::Jump);
+          break;
+        case FlowKind::Jump:
+          branch_to(pc, insn.target, ReferenceType::Jump);
+          falls_through = false;
+          break;
+        case FlowKind::Return:
+        case FlowKind::IndirectJump:
+        case FlowKind::Halt:
+        case FlowKind::Invalid:
+          falls_through = false;
+          break;
+        case FlowKind::Fallthrough:
+        case FlowKind::IndirectCall:
+          break;
+      }
+      if (!falls_through) {
+        break;
+      }
+      pc += insn.length;
+    }
+  }
+
+  out->instructions = instructions.size();
+  std::sort(instructions.begin(), instructions.end(),
+            [](const AddressRange& a, const AddressRange& b) { return a.start < b.start; });
+  for (const AddressRange& range : instructions) {
+    if (!out->body.empty() && range.start <= out->body.back().end) {
+      out->body.back().end = std::max(out->body.back().end, range.end);
+    } else {
+      out->body.push_back(range);
+    }
+  }
+}
+
+size_t FunctionDiscovery::explore(std::vector<Seed> seeds) {
+  size_t added = 0;
+  std::vector<uint32_t> dirty;
+  std::vector<uint64_t> fresh;
+  while (!seeds.empty()) {
+    fresh.clear();
+    dirty.clear();
+    for (const Seed& seed : seeds) {
+      if (index_.count(seed.entry) != 0 || !chunk_at(seed.entry)) {
+        continue;
+      }
+      const auto id = static_cast<uint32_t>(functions_.size());
+      index_.emplace(seed.entry, id);
+      functions_.push_back(Function{seed.entry, {}, seed.source});
+      calls_.emplace_back();
+      fresh.push_back(seed.entry);
+      dirty.push_back(id);
+      stats_.call_targets += seed.source == FunctionSource::CallTarget ? 1 : 0;
+    }
+    if (fresh.empty()) {
+      break;
+    }
+    added += fresh.size();
+
+    // Bodies that now run into a new entry are cut short there.
+    for (uint64_t entry : fresh) {
+      auto it = std::upper_bound(ranges_.begin(), ranges_.end(), entry,
+                                 [](uint64_t value, const AddressRange& range) { return value < range.start; });
+      for (size_t i = static_cast<size_t>(it - ranges_.begin()); i > 0 && reach_[i - 1] > entry; --i) {
+        if (entry < ranges_[i - 1].end) {
+          dirty.push_back(range_owner_[i - 1]);
+        }
+      }
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    entries_.clear();
+    entries_.reserve(functions_.size());
+    for (const Function& function : functions_) {
+      entries_.push_back(function.entry);
+    }
+    std::sort(entries_.begin(), entries_.end());
+
+    std::vector<Decoded> results(dirty.size());
+    std::atomic<size_t> next{0};
+    run_workers(options_.thread_count, dirty.size(), [&] {
+      for (size_t i = next.fetch_add(1); i < dirty.size(); i = next.fetch_add(1)) {
+        decode(dirty[i], &results[i]);
+      }
+    });
+
+    ++stats_.rounds;
+    stats_.decoded += dirty.size();
+    seeds.clear();
+    for (size_t i = 0; i < dirty.size(); ++i) {
+      Decoded& result = results[i];
+      functions_[dirty[i]].body = std::move(result.body);
+      calls_[dirty[i]] = std::move(result.calls);
+      stats_.instructions += result.instructions;
+      for (const Reference& reference : result.references) {
+        program_->references().add(reference);
+      }
+      for (uint64_t target : result.new_targets) {
+        seeds.push_back(Seed{target, FunctionSource::CallTarget});
+      }
+    }
+    rebuild_index();
+  }
+  return added;
+}
+
+std::vector<FunctionDiscovery::Seed> FunctionDiscovery::scan_prologues() const {
+  std::vector<Seed> found;
+  const uint64_t alignment = prologue_alignment(processor_);
+  // A match suppresses others in the same window, so one prologue's
+  // consecutive instructions do not each become an entry.
+  const uint64_t window = processor_ == Processor::Aarch64 ? 16 : alignment;
+  size_t next_range = 0;
+  for (const CodeChunk& chunk : chunks_) {
+    const uint64_t chunk_end = chunk.start + chunk.size;
+    uint64_t cursor = (chunk.start + alignment - 1) & ~(alignment - 1);
+    while (cursor + kPrologueWindow <= chunk_end) {
+      while (next_range < ranges_.size() && reach_[next_range] <= cursor) {
+        ++next_range;
+      }
+      // ranges_ is sorted by start, so the first range reaching past cursor
+      // either covers it or bounds the gap.
+      uint64_t gap_end = chunk_end;
+      if (next_range < ranges_.size()) {
+        const uint64_t start = ranges_[next_range].start;
+        if (start <= cursor) {
+          cursor = (reach_[next_range] + alignment - 1) & ~(alignment - 1);
+          continue;
+        }
+        gap_end = std::min(gap_end, start);
+      }
+      for (; cursor + kPrologueWindow <= gap_end; cursor += alignment) {
+        if (prologue_at(processor_, chunk.data + (cursor - chunk.start))) {
+          found.push_back(Seed{cursor, FunctionSource::Prologue});
+          cursor += window - alignment;
+        }
+      }
+      cursor = std::max(cursor, (gap_end + alignment - 1) & ~(alignment - 1));
+    }
+  }
+  return found;
+}
+
+void FunctionDiscovery::rebuild_index() {
+  std::vector<std::pair<AddressRange, uint32_t>> owned;
+  for (uint32_t i = 0; i < functions_.size(); ++i) {
+    for (const AddressRange& range : functions_[i].body) {
+      owned.emplace_back(range, i);
+    }
+  }
+  std::sort(owned.begin(), owned.end(), [](const auto& a, const auto& b) { return a.first.start < b.first.start; });
+  ranges_.resize(owned.size());
+  range_owner_.resize(owned.size());
+  reach_.resize(owned.size());
+  uint64_t reach = 0;
+  for (size_t i = 0; i < owned.size(); ++i) {
+    ranges_[i] = owned[i].first;
+    range_owner_[i] = owned[i].second;
+    reach = std::max(reach, owned[i].first.end);
+    reach_[i] = reach;
+  }
+}
+
+void FunctionDiscovery::finish(size_t first_new) {
+  if (options_.add_symbols && first_new < functions_.size()) {
+    std::vector<uint64_t> named;
+    for (const auto& symbol : program_->symbols()) {
+      if (symbol.kind != ghirda::core::SymbolKind::External) {
+        named.push_back(symbol.address);
+      }
+    }
+    std::sort(named.begin(), named.end());
+    for (size_t i = first_new; i < functions_.size(); ++i) {
+      const uint64_t entry = functions_[i].entry;
+      if (!std::binary_search(named.begin(), named.end(), entry)) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "FUN_%08llx", static_cast<unsigned long long>(entry));
+        program_->add_symbol(ghirda::core::Symbol{name, entry, ghirda::core::SymbolKind::Function});
+      }
+    }
+  }
+  if (options_.record_references) {
+    program_->references().finalize(options_.thread_count);
+  }
+
+  std::vector<uint32_t> order(functions_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [this](uint32_t a, uint32_t b) { return functions_[a].entry < functions_[b].entry; });
+  std::vector<Function> functions(functions_.size());
+  std::vector<std::vector<CallEdge>> calls(calls_.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    functions[i] = std::move(functions_[order[i]]);
+    calls[i] = std::move(calls_[order[i]]);
+  }
+  functions_ = std::move(functions);
+  calls_ = std::move(calls);
+  entries_.clear();
+  for (uint32_t i = 0; i < functions_.size(); ++i) {
+    index_[functions_[i].entry] = i;
+    entries_.push_back(functions_[i].entry);
+  }
+  rebuild_index();
+
+  std::vector<CallEdge> edges;
+  for (const auto& out : calls_) {
+    edges.insert(edges.end(), out.begin(), out.end());
+  }
+  call_graph_.build(entries_, edges);
+}
+
+bool FunctionDiscovery::run(std::string* error) {
+  if (!program_) {
+    if (error) {
+      *error = "program is null";
+    }
+    return false;
+  }
+  functions_.clear();
+  calls_.clear();
+  index_.clear();
+  entries_.clear();
+  ranges_.clear();
+  range_owner_.clear();
+  reach_.clear();
+  stats_ = FunctionDiscoveryStats{};
+  collect_code();
+
+  std::vector<Seed> seeds;
+  for (const auto& start : program_->function_starts()) {
+    seeds.push_back(Seed{start.address, from_start_source(start.source)});
+  }
+  if (options_.use_symbols) {
+    for (const auto& symbol : program_->symbols()) {
+      if (symbol.kind == ghirda::core::SymbolKind::Function) {
+        seeds.push_back(Seed{symbol.address, FunctionSource::Symbol});
+      }
+    }
+    for (const auto& function : program_->debug_info().functions) {
+      seeds.push_back(Seed{function.low_pc, FunctionSource::Symbol});
+    }
+  }
+  // Relocated pointers into code: vtables, callback tables, init arrays.
+  for (const Reference& reference : program_->references().all()) {
+    if (reference.type == ReferenceType::Pointer && chunk_at(reference.to)) {
+      seeds.push_back(Seed{reference.to, FunctionSource::Pointer});
+    }
+  }
+  stats_.seeds = seeds.size();
+  explore(std::move(seeds));
+
+  if (options_.scan_prologues && flow_supported(processor_)) {
+    for (;;) {
+      std::vector<Seed> found = scan_prologues();
+      const size_t added = explore(std::move(found));
+      stats_.prologues += added;
+      if (added == 0) {
+        break;
+      }
+    }
+  }
+  finish(0);
+  return true;
+}
+
+bool FunctionDiscovery::add_entries(std::span<const uint64_t> entries, std::string* error) {
+  if (!program_) {
+    if (error) {
+      *error = "program is null";
+    }
+    return false;
+  }
+  if (chunks_.empty()) {
+    collect_code();
+  }
+  const size_t first_new = functions_.size();
+  std::vector<Seed> seeds;
+  for (uint64_t entry : entries) {
+    seeds.push_back(Seed{entry, FunctionSource::Requested});
+  }
+  explore(std::move(seeds));
+  finish(first_new);
+  return true;
+}
+
+const std::vector<Function>& FunctionDiscovery::functions() const { return functions_; }
+
+const Function* FunctionDiscovery::function_at(uint64_t entry) const {
+  auto it = index_.find(entry);
+  return it == index_.end() ? nullptr : &functions_[it->second];
+}
+
+const Function* FunctionDiscovery::function_containing(uint64_t address) const {
+  auto it = std::upper_bound(ranges_.begin(), ranges_.end(), address,
+                             [](uint64_t value, const AddressRange& range) { return value < range.start; });
+  for (size_t i = static_cast<size_t>(it - ranges_.begin()); i > 0 && reach_[i - 1] > address; --i) {
+    if (address < ranges_[i - 1].end) {
+      return &functions_[range_owner_[i - 1]];
+    }
+  }
+  return function_at(address);
+}
+
+const CallGraph& FunctionDiscovery::call_graph() const { return call_graph_; }
+
+const FunctionDiscoveryStats& FunctionDiscovery::stats() const { return stats_; }
+
+} // namespace ghirda::analysis
@@ -0,0 +1,539 @@
+#include "ghirda/analysis/function_id.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+#include "ghirda/analysis/flow_decoder.h"
+
+namespace ghirda::analysis {
+namespace {
+
+using ghirda::core::Processor;
+
+constexpr char kMagic[8] = {'G', 'H', 'F', 'I', 'D', 'D', 'B', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kEntrySize = 24;
+// Relocations of unknown width mask the common operand size.
+constexpr uint8_t kDefaultRelocationSize = 4;
+// Values below this are treated as constants even when the image maps them.
+constexpr uint64_t kMinAddressOperand = 0x10000;
+
+uint64_t mix(uint64_t hash, uint64_t value) {
+  hash ^= value * 0x9e3779b97f4a7c15ull;
+  return std::rotl(hash, 29) * 0xbf58476d1ce4e5b9ull;
+}
+
+uint64_t finish(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  return hash ^ (hash >> 33);
+}
+
+uint64_t load_le(const uint8_t* p, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value |= static_cast<uint64_t>(p[i]) << (8 * i);
+  }
+  return value;
+}
+
+template <typename T>
+T load(std::span<const uint8_t> bytes, size_t offset) {
+  T value{};
+  std::memcpy(&value, bytes.data() + offset, sizeof(value));
+  return value;
+}
+
+template <typename T>
+void store(std::vector<uint8_t>* out, size_t offset, T value) {
+  std::memcpy(out->data() + offset, &value, sizeof(value));
+}
+
+bool is_default_name(std::string_view name) { return name.rfind("FUN_", 0) == 0; }
+
+template <typename Worker>
+void run_workers(size_t thread_count, size_t items, Worker&& worker) {
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, items);
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+// Hashes functions[i] into hashes[i] on worker threads; ok[i] is 0 for
+// bodies that could not be hashed or fall under min_size.
+void hash_all(const ghirda::core::Program& program, std::span<const Function> functions, const FunctionIdOptions& options,
+              std::vector<FunctionHash>* hashes, std::vector<uint8_t>* ok) {
+  const FunctionHasher hasher(program);
+  hashes->assign(functions.size(), FunctionHash{});
+  ok->assign(functions.size(), 0);
+  constexpr size_t kBatch = 64;
+  std::atomic<size_t> next{0};
+  run_workers(options.thread_count, (functions.size() + kBatch - 1) / kBatch, [&]() {
+    for (size_t first = next.fetch_add(kBatch); first < functions.size(); first = next.fetch_add(kBatch)) {
+      const size_t last = std::min(functions.size(), first + kBatch);
+      for (size_t i = first; i < last; ++i) {
+        (*ok)[i] = hasher.hash(functions[i], &(*hashes)[i]) && (*hashes)[i].size >= options.min_size ? 1 : 0;
+      }
+    }
+  });
+}
+
+} // namespace
+
+FunctionHasher::FunctionHasher(const ghirda::core::Program& program) : processor_(program.processor()) {
+  for (const auto& segment : program.memory_image().segments()) {
+    if (!segment.data.empty()) {
+      spans_.push_back(Span{segment.start, segment.data.data(), segment.data.size()});
+    }
+  }
+  std::sort(spans_.begin(), spans_.end(), [](const Span& a, const Span& b) { return a.start < b.start; });
+  relocated_.reserve(program.relocations().size());
+  for (const auto& relocation : program.relocations()) {
+    if (relocation.status != ghirda::core::RelocationStatus::Unmapped) {
+      relocated_.emplace_back(relocation.address, relocation.size != 0 ? relocation.size : kDefaultRelocationSize);
+    }
+  }
+  std::sort(relocated_.begin(), relocated_.end());
+}
+
+const FunctionHasher::Span* FunctionHasher::span_at(uint64_t address) const {
+  auto it = std::upper_bound(spans_.begin(), spans_.end(), address,
+                             [](uint64_t value, const Span& span) { return value < span.start; });
+  if (it == spans_.begin()) {
+    return nullptr;
+  }
+  --it;
+  return address - it->start < it->size ? &*it : nullptr;
+}
+
+bool FunctionHasher::looks_like_address(uint64_t value) const {
+  return value >= kMinAddressOperand && span_at(value) != nullptr;
+}
+
+void FunctionHasher::mask_instructions(uint64_t address, uint8_t* bytes, size_t size, uint32_t* adrp_registers) const {
+  if (processor_ == Processor::Aarch64) {
+    for (size_t pos = 0; pos + 4 <= size; pos += 4) {
+      uint32_t insn = static_cast<uint32_t>(load_le(bytes + pos, 4));
+      if ((insn & 0x7c000000u) == 0x14000000u) {
+        // B, BL.
+        insn &= ~0x03ffffffu;
+      } else if ((insn & 0xff000010u) == 0x54000000u || (insn & 0x7e000000u) == 0x34000000u ||
+                 (insn & 0x3b000000u) == 0x18000000u) {
+        // B.cond, CBZ/CBNZ, LDR (literal).
+        insn &= ~(0x7ffffu << 5);
+      } else if ((insn & 0x7e000000u) == 0x36000000u) {
+        // TBZ, TBNZ.
+        insn &= ~(0x3fffu << 5);
+      } else if ((insn & 0x1f000000u) == 0x10000000u) {
+        // ADR, ADRP.
+        if ((insn & 0x80000000u) != 0) {
+          *adrp_registers |= uint32_t{1} << (insn & 31);
+        }
+        insn &= ~((0x7ffffu << 5) | (0x3u << 29));
+      } else if (((insn & 0xff800000u) == 0x91000000u || (insn & 0x3b000000u) == 0x39000000u) &&
+                 (*adrp_registers >> ((insn >> 5) & 31) & 1) != 0) {
+        // ADD or LDR/STR with an unsigned offset from an ADRP page.
+        insn &= ~(0xfffu << 10);
+      }
+      for (size_t k = 0; k < 4; ++k) {
+        bytes[pos + k] = static_cast<uint8_t>(insn >> (8 * k));
+      }
+    }
+    return;
+  }
+  if (processor_ != Processor::X86 && processor_ != Processor::X86_64) {
+    return;
+  }
+
+  size_t pos = 0;
+  FlowInstruction insn;
+  while (pos < size && decode_flow(processor_, std::span<const uint8_t>(bytes + pos, size - pos), address + pos, &insn)) {
+    uint8_t* at = bytes + pos;
+    const bool address_displacement =
+        insn.displacement_size == 4 &&
+        ((insn.has_data && !insn.has_target) || looks_like_address(load_le(at + insn.displacement_offset, 4)));
+    const bool address_immediate =
+        insn.immediate_size >= 4 && !insn.has_target &&
+        ((insn.has_data && insn.displacement_size == 0) ||
+         looks_like_address(load_le(at + insn.immediate_offset, std::min<size_t>(insn.immediate_size, 8))));
+    if (address_displacement) {
+      std::memset(at + insn.displacement_offset, 0, insn.displacement_size);
+    }
+    // Branches within the range keep their displacement; the rest depend on
+    // where the target was linked.
+    const bool outside = insn.has_target && (insn.target < address || insn.target >= address + size);
+    if (address_immediate || (outside && insn.immediate_size != 0)) {
+      std::memset(at + insn.immediate_offset, 0, insn.immediate_size);
+    }
+    pos += insn.length;
+  }
+}
+
+void FunctionHasher::mask_relocations(uint64_t address, uint8_t* bytes, size_t size) const {
+  // Patched words are at most eight bytes, so one may start up to seven
+  // bytes before the range.
+  const uint64_t from = address >= 8 ? address - 8 : 0;
+  auto it = std::lower_bound(relocated_.begin(), relocated_.end(), std::make_pair(from, uint8_t{0}));
+  for (; it != relocated_.end() && it->first < address + size; ++it) {
+    const uint64_t start = std::max(it->first, address);
+    const uint64_t end = std::min(it->first + it->second, address + size);
+    if (start < end) {
+      std::memset(bytes + (start - address), 0, static_cast<size_t>(end - start));
+    }
+  }
+}
+
+bool FunctionHasher::hash(const Function& function, FunctionHash* out) const {
+  if (function.body.empty()) {
+    return false;
+  }
+  std::vector<uint8_t> buffer;
+  uint64_t hash = 0;
+  uint64_t total = 0;
+  uint32_t adrp_registers = 0;
+  for (const AddressRange& range : function.body) {
+    const Span* span = span_at(range.start);
+    if (!span || range.end <= range.start || range.end - span->start > span->size) {
+      return false;
+    }
+    const size_t size = static_cast<size_t>(range.end - range.start);
+    const uint8_t* source = span->data + (range.start - span->start);
+    buffer.assign(source, source + size);
+    mask_instructions(range.start, buffer.data(), size, &adrp_registers);
+    mask_relocations(range.start, buffer.data(), size);
+
+    hash = mix(hash, size);
+    size_t pos = 0;
+    for (; pos + 8 <= size; pos += 8) {
+      uint64_t word = 0;
+      std::memcpy(&word, buffer.data() + pos, sizeof(word));
+      hash = mix(hash, word);
+    }
+    if (pos < size) {
+      hash = mix(hash, load_le(buffer.data() + pos, size - pos));
+    }
+    total += size;
+  }
+  if (total > UINT32_MAX) {
+    return false;
+  }
+  out->hash = finish(hash ^ total);
+  out->size = static_cast<uint32_t>(total);
+  return true;
+}
+
+void SignatureDatabaseBuilder::add(const FunctionHash& hash, std::string_view name, std::string_view library) {
+  signatures_.push_back(Signature{hash, std::string(name), std::string(library)});
+}
+
+size_t SignatureDatabaseBuilder::size() const { return signatures_.size(); }
+
+std::vector<uint8_t> SignatureDatabaseBuilder::serialize() const {
+  std::vector<const Signature*> order;
+  order.reserve(signatures_.size());
+  for (const Signature& signature : signatures_) {
+    order.push_back(&signature);
+  }
+  const auto key = [](const Signature* s) { return std::tie(s->hash.hash, s->hash.size, s->name, s->library); };
+  std::sort(order.begin(), order.end(), [&](const Signature* a, const Signature* b) { return key(a) < key(b); });
+  order.erase(std::unique(order.begin(), order.end(), [&](const Signature* a, const Signature* b) { return key(a) == key(b); }),
+              order.end());
+  const size_t count = std::min<size_t>(order.size(), UINT32_MAX);
+
+  std::string strings(1, '\0');
+  std::unordered_map<std::string_view, uint32_t> interned;
+  auto intern = [&](const std::string& text) {
+    auto it = interned.find(text);
+    if (it != interned.end()) {
+      return it->second;
+    }
+    const uint32_t offset = static_cast<uint32_t>(strings.size());
+    strings.append(text).push_back('\0');
+    interned.emplace(text, offset);
+    return offset;
+  };
+
+  const uint32_t bits = std::clamp<uint32_t>(static_cast<uint32_t>(std::bit_width(count)), 6, 26) - 2;
+  const size_t directory_size = ((size_t{1} << bits) + 1) * sizeof(uint32_t);
+  const size_t entries_offset = (kHeaderSize + directory_size + 7) & ~size_t{7};
+  const size_t strings_offset = entries_offset + count * kEntrySize;
+
+  std::vector<uint8_t> out(strings_offset, 0);
+  std::memcpy(out.data(), kMagic, sizeof(kMagic));
+  store<uint32_t>(&out, 8, kVersion);
+  store<uint32_t>(&out, 12, bits);
+  store<uint64_t>(&out, 16, count);
+  store<uint64_t>(&out, 24, kHeaderSize);
+  store<uint64_t>(&out, 32, entries_offset);
+  store<uint64_t>(&out, 40, strings_offset);
+
+  size_t group = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const Signature& signature = *order[i];
+    if (order[group]->hash.hash != signature.hash.hash || order[group]->hash.size != signature.hash.size) {
+      group = i;
+    }
+    size_t group_end = i + 1;
+    while (group_end < count && order[group_end]->hash.hash == signature.hash.hash &&
+           order[group_end]->hash.size == signature.hash.size) {
+      ++group_end;
+    }
+    bool ambiguous = false;
+    for (size_t k = group; k < group_end && !ambiguous; ++k) {
+      ambiguous = order[k]->name != signature.name;
+    }
+    const size_t at = entries_offset + i * kEntrySize;
+    store<uint64_t>(&out, at, signature.hash.hash);
+    store<uint32_t>(&out, at + 8, signature.hash.size);
+    store<uint32_t>(&out, at + 12, intern(signature.name));
+    store<uint32_t>(&out, at + 16, intern(signature.library));
+    store<uint32_t>(&out, at + 20, ambiguous ? 1 : 0);
+  }
+
+  size_t slot = 0;
+  for (size_t prefix = 0; prefix <= (size_t{1} << bits); ++prefix) {
+    while (slot < count && (order[slot]->hash.hash >> (64 - bits)) < prefix) {
+      ++slot;
+    }
+    store<uint32_t>(&out, kHeaderSize + prefix * sizeof(uint32_t), static_cast<uint32_t>(slot));
+  }
+  store<uint64_t>(&out, 48, strings.size());
+  out.insert(out.end(), strings.begin(), strings.end());
+  return out;
+}
+
+bool SignatureDatabaseBuilder::write(const std::string& path, std::string* error) const {
+  const std::vector<uint8_t> bytes = serialize();
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file || !file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+    if (error) {
+      *error = "cannot write " + path;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool SignatureDatabase::open(const std::string& path, std::string* error) {
+  auto file = ghirda::loader::MmapByteSource::open(path, error);
+  if (!file) {
+    return false;
+  }
+  ghirda::loader::ByteView view;
+  if (!file->view(0, file->size(), &view)) {
+    if (error) {
+      *error = "cannot map " + path;
+    }
+    return false;
+  }
+  if (!attach(view.span(), error)) {
+    return false;
+  }
+  file_ = std::move(file);
+  view_ = view;
+  return true;
+}
+
+bool SignatureDatabase::attach(std::span<const uint8_t> bytes, std::string* error) {
+  auto fail = [&](const char* message) {
+    if (error) {
+      *error = message;
+    }
+    return false;
+  };
+  if constexpr (std::endian::native != std::endian::little) {
+    return fail("signature databases are read on little-endian hosts only");
+  }
+  if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0) {
+    return fail("not a signature database");
+  }
+  if (load<uint32_t>(bytes, 8) != kVersion) {
+    return fail("unsupported signature database version");
+  }
+  const uint32_t bits = load<uint32_t>(bytes, 12);
+  const uint64_t count = load<uint64_t>(bytes, 16);
+  const uint64_t directory = load<uint64_t>(bytes, 24);
+  const uint64_t entries = load<uint64_t>(bytes, 32);
+  const uint64_t strings = load<uint64_t>(bytes, 40);
+  const uint64_t strings_size = load<uint64_t>(bytes, 48);
+  const uint64_t size = bytes.size();
+  if (bits == 0 || bits > 32 || count > UINT32_MAX || directory > size ||
+      ((uint64_t{1} << bits) + 1) * sizeof(uint32_t) > size - directory || entries > size ||
+      count * kEntrySize > size - entries || strings > size || strings_size > size - strings) {
+    return fail("truncated signature database");
+  }
+  bytes_ = bytes;
+  directory_bits_ = bits;
+  count_ = count;
+  directory_offset_ = static_cast<size_t>(directory);
+  entries_offset_ = static_cast<size_t>(entries);
+  strings_offset_ = static_cast<size_t>(strings);
+  strings_size_ = static_cast<size_t>(strings_size);
+  file_.reset();
+  view_ = {};
+  return true;
+}
+
+size_t SignatureDatabase::size() const { return static_cast<size_t>(count_); }
+
+std::string_view SignatureDatabase::string_at(uint32_t offset) const {
+  if (offset >= strings_size_) {
+    return {};
+  }
+  const char* start = reinterpret_cast<const char*>(bytes_.data() + strings_offset_ + offset);
+  const void* end = std::memchr(start, '\0', strings_size_ - offset);
+  return end ? std::string_view(start, static_cast<const char*>(end) - start) : std::string_view{};
+}
+
+size_t SignatureDatabase::lookup(const FunctionHash& hash, std::vector<SignatureMatch>* out) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const size_t prefix = static_cast<size_t>(hash.hash >> (64 - directory_bits_));
+  const size_t slot = directory_offset_ + prefix * sizeof(uint32_t);
+  const size_t end = std::min<size_t>(load<uint32_t>(bytes_, slot + sizeof(uint32_t)), count_);
+  size_t i = std::min<size_t>(load<uint32_t>(bytes_, slot), end);
+  const size_t before = out->size();
+  for (; i < end; ++i) {
+    const size_t at = entries_offset_ + i * kEntrySize;
+    const uint64_t entry_hash = load<uint64_t>(bytes_, at);
+    if (entry_hash > hash.hash) {
+      break;
+    }
+    if (entry_hash == hash.hash && load<uint32_t>(bytes_, at + 8) == hash.size) {
+      out->push_back(SignatureMatch{string_at(load<uint32_t>(bytes_, at + 12)),
+                                    string_at(load<uint32_t>(bytes_, at + 16)),
+                                    (load<uint32_t>(bytes_, at + 20) & 1) != 0});
+    }
+  }
+  return out->size() - before;
+}
+
+bool identify_functions(ghirda::core::Program* program, std::span<const Function> functions,
+                        const SignatureDatabase& database, const FunctionIdOptions& options,
+                        std::vector<FunctionIdMatch>* matches, FunctionIdStats* stats, std::string* error) {
+  if (database.size() == 0) {
+    if (error) {
+      *error = "empty signature database";
+    }
+    return false;
+  }
+  std::vector<FunctionHash> hashes;
+  std::vector<uint8_t> ok;
+  hash_all(*program, functions, options, &hashes, &ok);
+
+  FunctionIdStats local;
+  const size_t first_match = matches->size();
+  std::vector<SignatureMatch> found;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (!ok[i]) {
+      continue;
+    }
+    ++local.hashed;
+    found.clear();
+    if (database.lookup(hashes[i], &found) == 0) {
+      continue;
+    }
+    ++local.matched;
+    const bool ambiguous = std::any_of(found.begin(), found.end(), [](const SignatureMatch& m) { return m.ambiguous; });
+    local.ambiguous += ambiguous ? 1 : 0;
+    matches->push_back(
+        FunctionIdMatch{functions[i].entry, std::string(found[0].name), std::string(found[0].library), ambiguous});
+  }
+
+  // Symbols at each entry, by address.
+  std::vector<std::pair<uint64_t, size_t>> at_entry;
+  const auto& symbols = program->symbols();
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    if (symbols[i].kind != ghirda::core::SymbolKind::External) {
+      at_entry.emplace_back(symbols[i].address, i);
+    }
+  }
+  std::sort(at_entry.begin(), at_entry.end());
+  for (size_t m = first_match; m < matches->size(); ++m) {
+    const FunctionIdMatch& match = (*matches)[m];
+    if (match.ambiguous && !options.apply_ambiguous) {
+      continue;
+    }
+    auto it = std::lower_bound(at_entry.begin(), at_entry.end(), std::make_pair(match.entry, size_t{0}));
+    size_t rename = SIZE_MAX;
+    bool named = false;
+    bool already = false;
+    for (; it != at_entry.end() && it->first == match.entry; ++it) {
+      const std::string& name = symbols[it->second].name;
+      already = already || name == match.name;
+      if (is_default_name(name)) {
+        rename = std::min(rename, it->second);
+      } else {
+        named = true;
+        if (options.rename_named && symbols[it->second].kind == ghirda::core::SymbolKind::Function) {
+          rename = std::min(rename, it->second);
+        }
+      }
+    }
+    if (already) {
+      continue;
+    }
+    if (rename != SIZE_MAX) {
+      program->rename_symbol(rename, match.name);
+    } else if (!named) {
+      program->add_symbol(ghirda::core::Symbol{match.name, match.entry, ghirda::core::SymbolKind::Function});
+    } else {
+      continue;
+    }
+    ++local.applied;
+  }
+  if (stats) {
+    *stats = local;
+  }
+  return true;
+}
+
+size_t add_program_signatures(const ghirda::core::Program& program, std::span<const Function> functions,
+                              std::string_view library, const FunctionIdOptions& options,
+                              SignatureDatabaseBuilder* builder) {
+  std::vector<std::pair<uint64_t, const std::string*>> names;
+  for (const auto& symbol : program.symbols()) {
+    if (symbol.kind == ghirda::core::SymbolKind::Function && !symbol.name.empty() && !is_default_name(symbol.name)) {
+      names.emplace_back(symbol.address, &symbol.name);
+    }
+  }
+  // The first name given to an address wins.
+  std::stable_sort(names.begin(), names.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::vector<FunctionHash> hashes;
+  std::vector<uint8_t> ok;
+  hash_all(program, functions, options, &hashes, &ok);
+  size_t added = 0;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (!ok[i]) {
+      continue;
+    }
+    auto it = std::lower_bound(names.begin(), names.end(), functions[i].entry,
+                               [](const auto& entry, uint64_t address) { return entry.first < address; });
+    if (it != names.end() && it->first == functions[i].entry) {
+      builder->add(hashes[i], *it->second, library);
+      ++added;
+    }
+  }
+  return added;
+}
+
+} // namespace ghirda::analysis
@@ -0,0 +1,604 @@
+#include "ghirda/analysis/string_discovery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define GHIRDA_STRINGS_X86 1
+#endif
+
+namespace ghirda::analysis {
+namespace {
+
+using ghirda::core::DataItem;
+using ghirda::core::DataItemType;
+
+constexpr size_t kBlock = 64;
+// Blocks classified per call, so mask arrays stay on the stack.
+constexpr size_t kBatchBlocks = 64;
+// Scanning windows; each is extended to just past a pair of NULs, which no
+// string crosses, so windows scan independently.
+constexpr size_t kWindow = size_t{1} << 20;
+constexpr uint64_t kEvenBits = 0x5555555555555555ull;
+// Characters checked in the masks before a candidate end is decoded.
+constexpr unsigned kCheckedLength = 8;
+// Padding for a partial last block: neither text, high nor zero.
+constexpr uint8_t kPadByte = 0x01;
+
+// Bit i describes byte i of a 64-byte block. text marks printable ASCII,
+// tab, line feed and carriage return; high marks bytes >= 0x80.
+struct BlockMasks {
+  uint64_t text = 0;
+  uint64_t high = 0;
+  uint64_t zero = 0;
+};
+
+// Printable ASCII, tab, line feed or carriage return.
+bool is_text(uint8_t byte) { return (byte >= 0x20 && byte < 0x7f) || byte == '\t' || byte == '\n' || byte == '\r'; }
+
+using Classifier = void (*)(const uint8_t* data, size_t blocks, BlockMasks* out);
+
+#ifdef GHIRDA_STRINGS_X86
+void classify_sse2(const uint8_t* data, size_t blocks, BlockMasks* out) {
+  const __m128i below = _mm_set1_epi8(0x1f);
+  const __m128i above = _mm_set1_epi8(0x7f);
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage = _mm_set1_epi8('\r');
+  const __m128i zero = _mm_setzero_si128();
+  for (size_t b = 0; b < blocks; ++b) {
+    BlockMasks masks;
+    for (unsigned part = 0; part < kBlock / 16; ++part) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + b * kBlock + part * 16));
+      // Signed compares: bytes >= 0x80 are negative and fail the first.
+      const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above));
+      const __m128i space = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, newline)),
+                                         _mm_cmpeq_epi8(v, carriage));
+      const unsigned shift = part * 16;
+      masks.text |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_or_si128(printable, space))))
+                    << shift;
+      masks.high |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(v))) << shift;
+      masks.zero |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))))
+                    << shift;
+    }
+    out[b] = masks;
+  }
+}
+
+__attribute__((target("avx2"))) void classify_avx2(const uint8_t* data, size_t blocks, BlockMasks* out) {
+  const __m256i below = _mm256_set1_epi8(0x1f);
+  const __m256i above = _mm256_set1_epi8(0x7f);
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i newline = _mm256_set1_epi8('\n');
+  const __m256i carriage = _mm256_set1_epi8('\r');
+  const __m256i zero = _mm256_setzero_si256();
+  for (size_t b = 0; b < blocks; ++b) {
+    BlockMasks masks;
+    for (unsigned part = 0; part < kBlock / 32; ++part) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + b * kBlock + part * 32));
+      const __m256i printable = _mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v));
+      const __m256i space = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(v, tab), _mm256_cmpeq_epi8(v, newline)), _mm256_cmpeq_epi8(v, carriage));
+      const unsigned shift = part * 32;
+      masks.text |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(printable, space))))
+                    << shift;
+      masks.high |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v))) << shift;
+      masks.zero |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero))))
+                    << shift;
+    }
+    out[b] = masks;
+  }
+}
+
+// Compares write 64-bit masks directly.
+__attribute__((target("avx512bw"))) void classify_avx512(const uint8_t* data, size_t blocks, BlockMasks* out) {
+  const __m512i space = _mm512_set1_epi8(0x20);
+  const __m512i printable_count = _mm512_set1_epi8(0x7f - 0x20);
+  const __m512i tab = _mm512_set1_epi8('\t');
+  const __m512i carriage = _mm512_set1_epi8('\r');
+  const __m512i two = _mm512_set1_epi8(2);
+  for (size_t b = 0; b < blocks; ++b) {
+    const __m512i v = _mm512_loadu_si512(data + b * kBlock);
+    // Tab and line feed are the two bytes from 0x09.
+    const __mmask64 text = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, space), printable_count) |
+                           _mm512_cmplt_epu8_mask(_mm512_sub_epi8(v, tab), two) | _mm512_cmpeq_epi8_mask(v, carriage);
+    out[b] = BlockMasks{text, _mm512_movepi8_mask(v), _mm512_testn_epi8_mask(v, v)};
+  }
+}
+
+Classifier classifier() {
+  static const Classifier chosen = __builtin_cpu_supports("avx512bw") ? classify_avx512
+                                   : __builtin_cpu_supports("avx2")   ? classify_avx2
+                                                                      : classify_sse2;
+  return chosen;
+}
+#else
+void classify_scalar(const uint8_t* data, size_t blocks, BlockMasks* out) {
+  for (size_t b = 0; b < blocks; ++b) {
+    BlockMasks masks;
+    for (unsigned i = 0; i < kBlock; ++i) {
+      const uint8_t byte = data[b * kBlock + i];
+      masks.text |= static_cast<uint64_t>(is_text(byte)) << i;
+      masks.high |= static_cast<uint64_t>(byte >= 0x80) << i;
+      masks.zero |= static_cast<uint64_t>(byte == 0) << i;
+    }
+    out[b] = masks;
+  }
+}
+
+Classifier classifier() { return classify_scalar; }
+#endif
+
+// Length of the UTF-8 sequence at p, or 0 when it is malformed, overlong, a
+// surrogate, beyond U+10FFFF or a C1 control.
+size_t utf8_length(const uint8_t* p, size_t available) {
+  const uint8_t lead = p[0];
+  const auto continuation = [&](size_t i) { return i < available && (p[i] & 0xc0) == 0x80; };
+  if (lead < 0x80) {
+    return 1;
+  }
+  if (lead >= 0xc2 && lead <= 0xdf) {
+    return continuation(1) && (lead != 0xc2 || p[1] >= 0xa0) ? 2 : 0;
+  }
+  if (lead >= 0xe0 && lead <= 0xef) {
+    if (!continuation(1) || !continuation(2)) {
+      return 0;
+    }
+    if ((lead == 0xe0 && p[1] < 0xa0) || (lead == 0xed && p[1] >= 0xa0)) {
+      return 0;
+    }
+    return 3;
+  }
+  if (lead >= 0xf0 && lead <= 0xf4) {
+    if (!continuation(1) || !continuation(2) || !continuation(3)) {
+      return 0;
+    }
+    if ((lead == 0xf0 && p[1] < 0x90) || (lead == 0xf4 && p[1] >= 0x90)) {
+      return 0;
+    }
+    return 4;
+  }
+  return 0;
+}
+
+// Start of the longest valid UTF-8 suffix of [start, end), adding its
+// characters to chars. UTF-8 synchronizes on lead bytes, so this is the last
+// piece a forward scan splitting at invalid sequences would find.
+size_t utf8_suffix(const uint8_t* data, size_t start, size_t end, size_t* chars, bool* multibyte) {
+  size_t j = end;
+  while (j > start) {
+    size_t k = j - 1;
+    while (k > start && j - k < 4 && (data[k] & 0xc0) == 0x80) {
+      --k;
+    }
+    if ((data[k] & 0xc0) == 0x80 || utf8_length(data + k, j - k) != j - k) {
+      break;
+    }
+    ++*chars;
+    *multibyte |= j - k > 1;
+    j = k;
+  }
+  return j;
+}
+
+// The run of mask bits reaching a block's first byte: where it started, or
+// the block start when none does, and whether it held high-bit bytes.
+struct Carry {
+  size_t start = 0;
+  bool high = false;
+};
+
+// Calls emit(start, p, high) for every run of mask bits whose last byte is a
+// set bit p of ends.
+template <typename Emit>
+void emit_runs(const Carry& carry, uint64_t mask, uint64_t high, uint64_t ends, size_t offset, Emit&& emit) {
+  for (; ends != 0; ends &= ends - 1) {
+    const unsigned p = static_cast<unsigned>(std::countr_zero(ends));
+    const uint64_t through = (uint64_t{2} << p) - 1;
+    const uint64_t gaps = ~mask & ((uint64_t{1} << p) - 1);
+    if (gaps != 0) {
+      const unsigned start = 64 - static_cast<unsigned>(std::countl_zero(gaps));
+      emit(offset + start, p, ((high & through) >> start) != 0);
+    } else {
+      emit(carry.start, p, carry.high || (high & through) != 0);
+    }
+  }
+}
+
+// Moves carry past a block: to the run reaching its last byte.
+void advance(Carry* carry, uint64_t mask, uint64_t high, size_t offset) {
+  if (mask == ~uint64_t{0}) [[unlikely]] {
+    carry->high |= high != 0;
+    return;
+  }
+  // Just past the last gap: the block end when the last byte is one.
+  const unsigned start = 64 - static_cast<unsigned>(std::countl_zero(~mask));
+  carry->start = offset + start;
+  carry->high = (high >> 1 >> (start - 1)) != 0;
+}
+
+class Scanner {
+public:
+  Scanner(std::span<const uint8_t> data, uint64_t base, const StringDiscoveryOptions& options,
+          std::vector<DataItem>* out)
+      : data_(data.data()), size_(data.size()), base_(base), options_(options), out_(out) {}
+
+  // Scans [first, last); no string may cross either end. Runs are found by
+  // their last byte: with terminators required only bytes followed by NULs
+  // are candidates, so the masks alone reject nearly every block.
+  void scan(size_t first, size_t last) {
+    const Classifier classify = classifier();
+    const bool text_strings = options_.ascii || options_.utf8;
+    const uint64_t high_text = options_.utf8 ? ~uint64_t{0} : 0;
+    BlockMasks masks[kBatchBlocks];
+    uint8_t tail[kBlock];
+    Carry text{first};
+    Carry even{first};
+    Carry odd{first};
+    uint64_t odd_carry = 0;
+    uint64_t previous_mask = 0;
+    uint64_t previous_chars = 0;
+    // Runs must have min_length characters; checking a few rejects most ends.
+    const unsigned checked_length = std::min<unsigned>(options_.min_length, kCheckedLength);
+    size_t offset = 0;
+    const auto on_text = [&](size_t start, unsigned p, bool high) { emit_text(start, offset + p + 1, high); };
+    const auto on_utf16 = [&](size_t start, unsigned p, bool) { emit_utf16(start, offset + p + 2); };
+    for (size_t batch = first; batch < last; batch += kBatchBlocks * kBlock) {
+      const size_t bytes = std::min(last - batch, kBatchBlocks * kBlock);
+      size_t blocks = bytes / kBlock;
+      classify(data_ + batch, blocks, masks);
+      if (bytes % kBlock != 0) {
+        // Bytes past last are real where there are any, so terminators
+        // read right, but cannot be text.
+        const size_t offset_tail = batch + blocks * kBlock;
+        std::memset(tail, kPadByte, sizeof(tail));
+        std::memcpy(tail, data_ + offset_tail, std::min(kBlock, size_ - offset_tail));
+        classify(tail, 1, masks + blocks);
+        const uint64_t valid = (uint64_t{1} << (bytes % kBlock)) - 1;
+        masks[blocks].text &= valid;
+        masks[blocks].high &= valid;
+        ++blocks;
+      }
+      for (size_t b = 0; b < blocks; ++b) {
+        offset = batch + b * kBlock;
+        const BlockMasks& m = masks[b];
+        // Runs end and terminators sit up to three bytes into the next block.
+        const BlockMasks next = b + 1 < blocks ? masks[b + 1] : lookahead(offset + kBlock, last);
+        const uint64_t next_zero = next.zero & 7;
+        const uint64_t zero1 = (m.zero >> 1) | (next_zero << 63);
+        if (text_strings) {
+          const uint64_t mask = m.text | (m.high & high_text);
+          uint64_t ends;
+          if (options_.require_terminator) {
+            ends = mask & zero1;
+          } else {
+            const uint64_t next_text = (next.text | (next.high & high_text)) & 1;
+            ends = mask & ~((mask >> 1) | (next_text << 63));
+          }
+          for (unsigned k = 1; k < checked_length; ++k) {
+            ends &= (mask << k) | (previous_mask >> (64 - k));
+          }
+          previous_mask = mask;
+          if (ends != 0) {
+            emit_runs(text, mask, m.high, ends, offset, on_text);
+          }
+          advance(&text, mask, m.high, offset);
+        }
+        if (options_.utf16) {
+          // A character is a text byte followed by a zero byte; runs at
+          // either parity are widened over their zero bytes.
+          const uint64_t chars = m.text & zero1;
+          const uint64_t even_chars = chars & kEvenBits;
+          const uint64_t odd_chars = chars & ~kEvenBits;
+          uint64_t ends;
+          if (options_.require_terminator) {
+            ends = chars & ((m.zero >> 2) | (next_zero << 62)) & ((m.zero >> 3) | (next_zero << 61));
+          } else {
+            const uint64_t next_chars = next.text & (next.zero >> 1) & 3;
+            ends = chars & ~((chars >> 2) | (next_chars << 62));
+          }
+          for (unsigned k = 1; k < checked_length; ++k) {
+            ends &= (chars << (2 * k)) | (previous_chars >> (64 - 2 * k));
+          }
+          previous_chars = chars;
+          const uint64_t even_mask = even_chars | (even_chars << 1);
+          const uint64_t odd_mask = odd_chars | (odd_chars << 1) | odd_carry;
+          if (ends != 0) [[unlikely]] {
+            emit_runs(even, even_mask, 0, ends & kEvenBits, offset, on_utf16);
+            emit_runs(odd, odd_mask, 0, ends & ~kEvenBits, offset, on_utf16);
+          }
+          advance(&even, even_mask, 0, offset);
+          advance(&odd, odd_mask, 0, offset);
+          odd_carry = odd_chars >> 63;
+        }
+      }
+    }
+  }
+
+private:
+  // Masks for the three bytes at at: text and high only before last, zero
+  // anywhere in the data.
+  BlockMasks lookahead(size_t at, size_t last) const {
+    BlockMasks ahead;
+    for (size_t k = 0; k < 3 && at + k < size_; ++k) {
+      const uint8_t byte = data_[at + k];
+      ahead.zero |= static_cast<uint64_t>(byte == 0) << k;
+      if (at + k < last) {
+        ahead.text |= static_cast<uint64_t>(is_text(byte)) << k;
+        ahead.high |= static_cast<uint64_t>(byte >= 0x80) << k;
+      }
+    }
+    return ahead;
+  }
+
+  void emit_text(size_t start, size_t end, bool high) {
+    // Characters never outnumber bytes.
+    if (end - start < options_.min_length) {
+      return;
+    }
+    const bool terminated = end < size_ && data_[end] == 0;
+    if (options_.require_terminator && !terminated) {
+      return;
+    }
+    if (!high) {
+      finish_text(start, end, end - start, false, terminated);
+      return;
+    }
+    size_t chars = 0;
+    bool multibyte = false;
+    if (options_.require_terminator) {
+      // Only the piece before the terminator can end in one.
+      const size_t piece = utf8_suffix(data_, start, end, &chars, &multibyte);
+      finish_text(piece, end, chars, multibyte, true);
+      return;
+    }
+    size_t piece = start;
+    for (size_t i = start; i < end;) {
+      const size_t length = utf8_length(data_ + i, end - i);
+      if (length == 0) {
+        finish_text(piece, i, chars, multibyte, false);
+        piece = ++i;
+        chars = 0;
+        multibyte = false;
+        continue;
+      }
+      ++chars;
+      multibyte |= length > 1;
+      i += length;
+    }
+    finish_text(piece, end, chars, multibyte, terminated);
+  }
+
+  void finish_text(size_t start, size_t end, size_t chars, bool multibyte, bool terminated) {
+    if (chars < options_.min_length || (options_.require_terminator && !terminated)) {
+      return;
+    }
+    if (multibyte ? !options_.utf8 : !options_.ascii) {
+      return;
+    }
+    push(start, end - start + (terminated ? 1 : 0), multibyte ? DataItemType::Utf8String : DataItemType::AsciiString,
+         terminated);
+  }
+
+  void emit_utf16(size_t start, size_t end) {
+    if ((end - start) / 2 < options_.min_length || ((base_ + start) & 1) != 0) {
+      return;
+    }
+    const bool terminated = end + 1 < size_ && data_[end] == 0 && data_[end + 1] == 0;
+    if (options_.require_terminator && !terminated) {
+      return;
+    }
+    push(start, end - start + (terminated ? 2 : 0), DataItemType::Utf16String, terminated);
+  }
+
+  void push(size_t start, size_t bytes, DataItemType type, bool terminated) {
+    DataItem item;
+    item.address = base_ + start;
+    item.size = static_cast<uint32_t>(std::min<size_t>(bytes, std::numeric_limits<uint32_t>::max()));
+    item.type = type;
+    item.terminated = terminated;
+    out_->push_back(item);
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+  uint64_t base_;
+  const StringDiscoveryOptions& options_;
+  std::vector<DataItem>* out_;
+};
+
+// Text runs come out in order; UTF-16 runs interleave with them.
+void sort_items(std::vector<DataItem>* items, size_t first) {
+  const auto begin = items->begin() + static_cast<std::ptrdiff_t>(first);
+  const auto by_address = [](const DataItem& a, const DataItem& b) { return a.address < b.address; };
+  if (!std::is_sorted(begin, items->end(), by_address)) {
+    std::sort(begin, items->end(), by_address);
+  }
+}
+
+// End of the window starting at first: just past the first pair of NULs at
+// or after first + kWindow, or the end of data.
+size_t window_end(std::span<const uint8_t> data, size_t first) {
+  if (data.size() - first <= kWindow) {
+    return data.size();
+  }
+  const uint8_t* p = data.data() + first + kWindow;
+  const uint8_t* end = data.data() + data.size();
+  while (p + 1 < end) {
+    p = static_cast<const uint8_t*>(std::memchr(p, 0, static_cast<size_t>(end - p - 1)));
+    if (p == nullptr) {
+      break;
+    }
+    if (p[1] == 0) {
+      return static_cast<size_t>(p + 2 - data.data());
+    }
+    p += 2;
+  }
+  return data.size();
+}
+
+template <typename Worker>
+void run_workers(size_t thread_count, size_t items, Worker&& worker) {
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, items);
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+struct Chunk {
+  uint64_t start = 0;
+  std::span<const uint8_t> data;
+};
+
+// Readable memory backed by image bytes, minus code unless options ask for
+// it, ordered by address.
+std::vector<Chunk> collect_chunks(const ghirda::core::Program& program, const StringDiscoveryOptions& options) {
+  std::vector<std::pair<uint64_t, uint64_t>> code_ranges;
+  for (const auto& section : program.sections()) {
+    if (section.executable && section.size != 0) {
+      code_ranges.emplace_back(section.address, section.address + section.size);
+    }
+  }
+  std::sort(code_ranges.begin(), code_ranges.end());
+
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  for (const auto& region : program.memory_map().regions()) {
+    if (!region.readable) {
+      continue;
+    }
+    const uint64_t region_end = region.start + region.size;
+    if (!region.executable || options.scan_code) {
+      ranges.emplace_back(region.start, region_end);
+      continue;
+    }
+    // Linkers often map read-only data in the executable segment; keep
+    // what the code sections leave over.
+    uint64_t cursor = region.start;
+    for (const auto& [code_start, code_end] : code_ranges) {
+      if (code_end <= cursor) {
+        continue;
+      }
+      if (code_start >= region_end) {
+        break;
+      }
+      if (code_start > cursor) {
+        ranges.emplace_back(cursor, code_start);
+      }
+      cursor = code_end;
+    }
+    if (!code_ranges.empty() && cursor < region_end) {
+      ranges.emplace_back(cursor, region_end);
+    }
+  }
+
+  std::vector<Chunk> chunks;
+  for (const auto& [range_start, range_end] : ranges) {
+    for (const auto& segment : program.memory_image().segments()) {
+      const uint64_t start = std::max(range_start, segment.start);
+      const uint64_t end = std::min(range_end, segment.start + segment.data.size());
+      if (start < end) {
+        chunks.push_back(Chunk{start, std::span<const uint8_t>(segment.data).subspan(start - segment.start, end - start)});
+      }
+    }
+  }
+  std::sort(chunks.begin(), chunks.end(), [](const Chunk& a, const Chunk& b) { return a.start < b.start; });
+  return chunks;
+}
+
+} // namespace
+
+size_t scan_strings(std::span<const uint8_t> data, uint64_t base, const StringDiscoveryOptions& options,
+                    std::vector<DataItem>* out) {
+  const size_t before = out->size();
+  Scanner scanner(data, base, options, out);
+  for (size_t first = 0; first < data.size();) {
+    const size_t last = window_end(data, first);
+    scanner.scan(first, last);
+    first = last;
+  }
+  sort_items(out, before);
+  return out->size() - before;
+}
+
+bool discover_strings(ghirda::core::Program* program, const StringDiscoveryOptions& options,
+                      StringDiscoveryStats* stats, std::string* error) {
+  if (options.min_length == 0) {
+    if (error) {
+      *error = "minimum string length must be at least 1";
+    }
+    return false;
+  }
+  struct Window {
+    const Chunk* chunk = nullptr;
+    size_t first = 0;
+    size_t last = 0;
+  };
+  const std::vector<Chunk> chunks = collect_chunks(*program, options);
+  std::vector<Window> windows;
+  StringDiscoveryStats local;
+  for (const Chunk& chunk : chunks) {
+    for (size_t first = 0; first < chunk.data.size();) {
+      const size_t last = window_end(chunk.data, first);
+      windows.push_back(Window{&chunk, first, last});
+      first = last;
+    }
+    local.bytes_scanned += chunk.data.size();
+  }
+
+  std::vector<std::vector<DataItem>> found(windows.size());
+  std::atomic<size_t> next{0};
+  run_workers(options.thread_count, windows.size(), [&]() {
+    for (size_t i = next.fetch_add(1); i < windows.size(); i = next.fetch_add(1)) {
+      const Window& window = windows[i];
+      Scanner scanner(window.chunk->data, window.chunk->start, options, &found[i]);
+      scanner.scan(window.first, window.last);
+      sort_items(&found[i], 0);
+    }
+  });
+
+  ghirda::core::DataItemTable& items = program->data_items();
+  size_t total = 0;
+  for (const auto& window_items : found) {
+    total += window_items.size();
+  }
+  items.reserve(items.size() + total);
+  for (const auto& window_items : found) {
+    items.add(window_items);
+  }
+  items.finalize();
+  items.count_references(program->references());
+  for (const DataItem& item : items.items()) {
+    switch (item.type) {
+      case DataItemType::AsciiString:
+        ++local.ascii;
+        break;
+      case DataItemType::Utf8String:
+        ++local.utf8;
+        break;
+      case DataItemType::Utf16String:
+        ++local.utf16;
+        break;
+    }
+    local.referenced += item.references != 0 ? 1 : 0;
+  }
+  if (stats) {
+    *stats = local;
+  }
+  return true;
+}
+
+} // namespace ghirda::analysis
@@ -0,0 +1,445 @@
+#include "ghirda/core/byte_pattern.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define GHIRDA_PATTERN_AVX2 1
+#endif
+
+namespace ghirda::core {
+namespace {
+
+constexpr uint32_t kHashMultiplier = 0x9e3779b1u;
+// Filter size in hash bits: about 128 bits per anchor, 512 bytes to 512 KiB.
+constexpr unsigned kMinFilterBits = 12;
+constexpr unsigned kMaxFilterBits = 22;
+constexpr unsigned kMaxBucketBits = 16;
+
+int hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Rough frequency of a byte in code and data; anchors avoid common bytes so
+// the filter passes fewer windows.
+unsigned byte_weight(uint8_t byte) {
+  switch (byte) {
+    case 0x00:
+      return 16;
+    case 0xff:
+      return 8;
+    case 0x48:
+    case 0x8b:
+    case 0x89:
+    case 0x0f:
+    case 0x24:
+    case 0x01:
+    case 0x20:
+    case 0xcc:
+    case 0x90:
+    case 0xe8:
+    case 0x83:
+    case 0x4c:
+    case 0xc3:
+      return 4;
+    default:
+      return byte < 0x20 ? 2 : 1;
+  }
+}
+
+// Start of the fully specified window of the given length with the lowest
+// weight, or false when there is none.
+bool best_window(const BytePattern& pattern, size_t length, size_t* out) {
+  bool found = false;
+  unsigned best = 0;
+  size_t run = 0;
+  for (size_t i = 0; i < pattern.mask.size(); ++i) {
+    run = pattern.mask[i] == 0xff ? run + 1 : 0;
+    if (run < length) {
+      continue;
+    }
+    const size_t start = i + 1 - length;
+    unsigned weight = 0;
+    for (size_t k = 0; k < length; ++k) {
+      weight += byte_weight(pattern.bytes[start + k]);
+    }
+    if (!found || weight < best) {
+      found = true;
+      best = weight;
+      *out = start;
+    }
+  }
+  return found;
+}
+
+uint32_t window_hash(uint32_t window, unsigned bits) { return (window * kHashMultiplier) >> (32 - bits); }
+
+#ifdef GHIRDA_PATTERN_AVX2
+// Collects positions from *position on whose window passes the filter,
+// eight windows per step, until end, the last full 16-byte load or capacity
+// is reached; leaves *position at the first window not examined.
+__attribute__((target("avx2"))) size_t filter_windows_avx2(const uint8_t* data, size_t size, size_t* position,
+                                                           size_t end, const uint32_t* filter, unsigned bits,
+                                                           size_t* candidates, size_t capacity) {
+  const __m256i windows = _mm256_setr_epi8(0, 1, 2, 3, 1, 2, 3, 4, 2, 3, 4, 5, 3, 4, 5, 6, 4, 5, 6, 7, 5, 6, 7, 8, 6,
+                                           7, 8, 9, 7, 8, 9, 10);
+  const __m256i multiplier = _mm256_set1_epi32(static_cast<int>(kHashMultiplier));
+  const __m256i low_bits = _mm256_set1_epi32(31);
+  const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+  size_t count = 0;
+  size_t i = *position;
+  for (; i + 8 <= end && i + 16 <= size && count + 8 <= capacity; i += 8) {
+    const __m256i bytes = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    const __m256i hash = _mm256_srl_epi32(_mm256_mullo_epi32(_mm256_shuffle_epi8(bytes, windows), multiplier), shift);
+    const __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(filter), _mm256_srli_epi32(hash, 5), 4);
+    const __m256i hit = _mm256_slli_epi32(_mm256_srlv_epi32(words, _mm256_and_si256(hash, low_bits)), 31);
+    unsigned lanes = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(hit)));
+    while (lanes != 0) [[unlikely]] {
+      candidates[count++] = i + static_cast<size_t>(std::countr_zero(lanes));
+      lanes &= lanes - 1;
+    }
+  }
+  *position = i;
+  return count;
+}
+
+bool has_avx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+#endif
+
+template <typename Entry>
+void fill_buckets(size_t buckets, std::vector<std::pair<uint32_t, Entry>>* keyed, std::vector<uint32_t>* offsets,
+                  std::vector<Entry>* entries) {
+  std::stable_sort(keyed->begin(), keyed->end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  offsets->assign(buckets + 1, 0);
+  entries->clear();
+  entries->reserve(keyed->size());
+  for (const auto& [bucket, entry] : *keyed) {
+    ++(*offsets)[bucket + 1];
+    entries->push_back(entry);
+  }
+  for (size_t i = 0; i < buckets; ++i) {
+    (*offsets)[i + 1] += (*offsets)[i];
+  }
+}
+
+} // namespace
+
+bool parse_byte_pattern(std::string_view text, BytePattern* out, std::string* error) {
+  out->bytes.clear();
+  out->mask.clear();
+  int nibbles = 0;
+  uint8_t value = 0;
+  uint8_t mask = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      if (nibbles == 1) {
+        if (error) {
+          *error = "pattern byte split at offset " + std::to_string(i);
+        }
+        return false;
+      }
+      continue;
+    }
+    uint8_t nibble = 0;
+    uint8_t nibble_mask = 0;
+    if (c != '?') {
+      const int v = hex_value(c);
+      if (v < 0) {
+        if (error) {
+          *error = std::string("invalid pattern character '") + c + "' at offset " + std::to_string(i);
+        }
+        return false;
+      }
+      nibble = static_cast<uint8_t>(v);
+      nibble_mask = 0xf;
+    }
+    value = static_cast<uint8_t>((value << 4) | nibble);
+    mask = static_cast<uint8_t>((mask << 4) | nibble_mask);
+    if (++nibbles == 2) {
+      out->bytes.push_back(value);
+      out->mask.push_back(mask);
+      nibbles = 0;
+      value = 0;
+      mask = 0;
+    }
+  }
+  if (nibbles != 0) {
+    if (error) {
+      *error = "pattern ends in half a byte";
+    }
+    return false;
+  }
+  if (out->bytes.empty()) {
+    if (error) {
+      *error = "empty pattern";
+    }
+    return false;
+  }
+  return true;
+}
+
+BytePattern literal_byte_pattern(std::span<const uint8_t> bytes) {
+  BytePattern pattern;
+  pattern.bytes.assign(bytes.begin(), bytes.end());
+  pattern.mask.assign(bytes.size(), 0xff);
+  return pattern;
+}
+
+bool PatternSet::add(const BytePattern& pattern, uint32_t* id, std::string* error) {
+  if (pattern.bytes.empty() || pattern.bytes.size() != pattern.mask.size()) {
+    if (error) {
+      *error = pattern.bytes.empty() ? "empty pattern" : "pattern mask length differs from its bytes";
+    }
+    return false;
+  }
+  if (std::find(pattern.mask.begin(), pattern.mask.end(), 0xff) == pattern.mask.end()) {
+    if (error) {
+      *error = "pattern has no fully specified byte";
+    }
+    return false;
+  }
+  if (pattern.bytes.size() > UINT32_MAX || patterns_.size() >= UINT32_MAX) {
+    if (error) {
+      *error = "pattern set too large";
+    }
+    return false;
+  }
+  BytePattern normalized = pattern;
+  for (size_t i = 0; i < normalized.bytes.size(); ++i) {
+    normalized.bytes[i] &= normalized.mask[i];
+  }
+  if (id) {
+    *id = static_cast<uint32_t>(patterns_.size());
+  }
+  patterns_.push_back(std::move(normalized));
+  ready_ = false;
+  return true;
+}
+
+bool PatternSet::add(std::string_view text, uint32_t* id, std::string* error) {
+  BytePattern pattern;
+  return parse_byte_pattern(text, &pattern, error) && add(pattern, id, error);
+}
+
+void PatternSet::compile() {
+  compiled_.clear();
+  compiled_.reserve(patterns_.size());
+  std::vector<std::pair<uint32_t, Entry>> words;
+  std::vector<std::pair<uint32_t, Entry>> pairs;
+  std::vector<std::pair<uint32_t, Entry>> bytes;
+
+  for (uint32_t id = 0; id < patterns_.size(); ++id) {
+    const BytePattern& source = patterns_[id];
+    Compiled pattern;
+    pattern.length = static_cast<uint32_t>(source.bytes.size());
+    const size_t blocks = (source.bytes.size() + 7) / 8;
+    pattern.bytes.assign(blocks, 0);
+    pattern.mask.assign(blocks, 0);
+    std::memcpy(pattern.bytes.data(), source.bytes.data(), source.bytes.size());
+    std::memcpy(pattern.mask.data(), source.mask.data(), source.mask.size());
+
+    size_t anchor = 0;
+    for (uint8_t length : {uint8_t{4}, uint8_t{2}, uint8_t{1}}) {
+      if (best_window(source, length, &anchor)) {
+        pattern.anchor = static_cast<uint32_t>(anchor);
+        pattern.anchor_length = length;
+        break;
+      }
+    }
+    const uint8_t* key_bytes = source.bytes.data() + anchor;
+    Entry entry{0, id, 0, 0};
+    const size_t head = std::min<size_t>(8, source.bytes.size() - anchor);
+    std::memcpy(&entry.head, key_bytes, head);
+    std::memcpy(&entry.head_mask, source.mask.data() + anchor, head);
+    if (pattern.anchor_length == 4) {
+      uint32_t window = 0;
+      std::memcpy(&window, key_bytes, sizeof(window));
+      entry.key = window;
+      words.push_back({window, entry});
+    } else if (pattern.anchor_length == 2) {
+      uint16_t pair = 0;
+      std::memcpy(&pair, key_bytes, sizeof(pair));
+      entry.key = pair;
+      pairs.push_back({pair, entry});
+    } else {
+      entry.key = key_bytes[0];
+      bytes.push_back({key_bytes[0], entry});
+    }
+    compiled_.push_back(std::move(pattern));
+  }
+
+  filter_.clear();
+  word_offsets_.clear();
+  word_entries_.clear();
+  filter_bits_ = 0;
+  bucket_shift_ = 0;
+  if (!words.empty()) {
+    filter_bits_ = std::clamp(static_cast<unsigned>(std::bit_width(words.size())) + 7, kMinFilterBits, kMaxFilterBits);
+    bucket_shift_ = filter_bits_ - std::min(filter_bits_, kMaxBucketBits);
+    filter_.assign(size_t{1} << (filter_bits_ - 5), 0);
+    for (auto& [bucket, entry] : words) {
+      const uint32_t hash = window_hash(entry.key, filter_bits_);
+      filter_[hash >> 5] |= uint32_t{1} << (hash & 31);
+      bucket = hash >> bucket_shift_;
+    }
+    fill_buckets(size_t{1} << (filter_bits_ - bucket_shift_), &words, &word_offsets_, &word_entries_);
+  }
+
+  pair_filter_.clear();
+  pair_offsets_.clear();
+  pair_entries_.clear();
+  if (!pairs.empty()) {
+    pair_filter_.assign(size_t{1} << 10, 0);
+    for (const auto& [pair, entry] : pairs) {
+      pair_filter_[pair >> 6] |= uint64_t{1} << (pair & 63);
+    }
+    fill_buckets(size_t{1} << 16, &pairs, &pair_offsets_, &pair_entries_);
+  }
+
+  byte_offsets_.clear();
+  byte_entries_.clear();
+  if (!bytes.empty()) {
+    fill_buckets(256, &bytes, &byte_offsets_, &byte_entries_);
+  }
+  ready_ = true;
+}
+
+size_t PatternSet::size() const { return patterns_.size(); }
+
+bool PatternSet::compiled() const { return ready_; }
+
+const BytePattern& PatternSet::pattern(uint32_t id) const { return patterns_[id]; }
+
+bool PatternSet::matches(const Compiled& pattern, const uint8_t* data, size_t size, size_t start) const {
+  const uint8_t* at = data + start;
+  const size_t blocks = pattern.bytes.size();
+  for (size_t i = 0; i < blocks; ++i) {
+    uint64_t word = 0;
+    const size_t offset = i * 8;
+    if (start + offset + 8 <= size) {
+      std::memcpy(&word, at + offset, sizeof(word));
+    } else {
+      std::memcpy(&word, at + offset, size - start - offset);
+    }
+    if (((word ^ pattern.bytes[i]) & pattern.mask[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PatternSet::verify_window(const uint8_t* data, size_t size, size_t position, uint64_t base,
+                               std::vector<PatternMatch>* out) const {
+  uint32_t window = 0;
+  std::memcpy(&window, data + position, sizeof(window));
+  const uint32_t bucket = window_hash(window, filter_bits_) >> bucket_shift_;
+  verify(word_offsets_[bucket], word_offsets_[bucket + 1], word_entries_, window, data, size, position, base, out);
+}
+
+void PatternSet::verify(uint32_t begin, uint32_t end, const std::vector<Entry>& entries, uint32_t key,
+                        const uint8_t* data, size_t size, size_t position, uint64_t base,
+                        std::vector<PatternMatch>* out) const {
+  uint64_t head = 0;
+  const bool full_head = size - position >= sizeof(head);
+  if (full_head) {
+    std::memcpy(&head, data + position, sizeof(head));
+  }
+  for (uint32_t i = begin; i < end; ++i) {
+    const Entry& entry = entries[i];
+    if (entry.key != key || (full_head && ((head ^ entry.head) & entry.head_mask) != 0)) {
+      continue;
+    }
+    const Compiled& pattern = compiled_[entry.pattern];
+    if (position < pattern.anchor) {
+      continue;
+    }
+    const size_t start = position - pattern.anchor;
+    if (size - start < pattern.length) {
+      continue;
+    }
+    if (matches(pattern, data, size, start)) {
+      out->push_back(PatternMatch{base + start, entry.pattern});
+    }
+  }
+}
+
+size_t PatternSet::scan(std::span<const uint8_t> data, uint64_t base, std::vector<PatternMatch>* out, size_t first,
+                        size_t last) const {
+  if (!ready_) {
+    return 0;
+  }
+  const size_t before = out->size();
+  const uint8_t* bytes = data.data();
+  const size_t size = data.size();
+  last = std::min(last, size);
+
+  if (!filter_.empty() && size >= 4) {
+    const size_t end = std::min(last, size - 3);
+    const uint32_t* filter = filter_.data();
+    const unsigned bits = filter_bits_;
+    size_t i = first;
+#ifdef GHIRDA_PATTERN_AVX2
+    if (has_avx2()) {
+      size_t candidates[256];
+      while (true) {
+        const size_t from = i;
+        const size_t count = filter_windows_avx2(bytes, size, &i, end, filter, bits, candidates, std::size(candidates));
+        for (size_t k = 0; k < count; ++k) {
+          verify_window(bytes, size, candidates[k], base, out);
+        }
+        if (i == from) {
+          break;
+        }
+      }
+    }
+#endif
+    for (; i < end; ++i) {
+      uint32_t window = 0;
+      std::memcpy(&window, bytes + i, sizeof(window));
+      const uint32_t hash = window_hash(window, bits);
+      if ((filter[hash >> 5] >> (hash & 31)) & 1) [[unlikely]] {
+        verify_window(bytes, size, i, base, out);
+      }
+    }
+  }
+
+  if (!pair_filter_.empty() && size >= 2) {
+    const size_t end = std::min(last, size - 1);
+    for (size_t i = first; i < end; ++i) {
+      uint16_t pair = 0;
+      std::memcpy(&pair, bytes + i, sizeof(pair));
+      if ((pair_filter_[pair >> 6] >> (pair & 63)) & 1) {
+        verify(pair_offsets_[pair], pair_offsets_[pair + 1], pair_entries_, pair, bytes, size, i, base, out);
+      }
+    }
+  }
+
+  if (!byte_entries_.empty()) {
+    for (size_t i = first; i < last; ++i) {
+      const uint8_t byte = bytes[i];
+      if (byte_offsets_[byte] != byte_offsets_[byte + 1]) {
+        verify(byte_offsets_[byte], byte_offsets_[byte + 1], byte_entries_, byte, bytes, size, i, base, out);
+      }
+    }
+  }
+  return out->size() - before;
+}
+
+} // namespace ghirda::core
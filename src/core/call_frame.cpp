@@ -0,0 +1,756 @@
+#include "ghirda/core/call_frame.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace ghirda::core {
+namespace {
+
+constexpr uint8_t kEncOmit = 0xff;
+constexpr uint8_t kEncFormatMask = 0x0f;
+constexpr uint8_t kEncApplicationMask = 0x70;
+constexpr uint8_t kEncAbsptr = 0x00;
+constexpr uint8_t kEncUleb128 = 0x01;
+constexpr uint8_t kEncUdata2 = 0x02;
+constexpr uint8_t kEncUdata4 = 0x03;
+constexpr uint8_t kEncUdata8 = 0x04;
+constexpr uint8_t kEncSleb128 = 0x09;
+constexpr uint8_t kEncSdata2 = 0x0a;
+constexpr uint8_t kEncSdata4 = 0x0b;
+constexpr uint8_t kEncSdata8 = 0x0c;
+constexpr uint8_t kEncPcrel = 0x10;
+constexpr uint8_t kEncDatarel = 0x30;
+
+constexpr uint8_t kCfaAdvanceLoc = 0x40;
+constexpr uint8_t kCfaOffset = 0x80;
+constexpr uint8_t kCfaRestore = 0xc0;
+constexpr uint8_t kCfaNop = 0x00;
+constexpr uint8_t kCfaSetLoc = 0x01;
+constexpr uint8_t kCfaAdvanceLoc1 = 0x02;
+constexpr uint8_t kCfaAdvanceLoc2 = 0x03;
+constexpr uint8_t kCfaAdvanceLoc4 = 0x04;
+constexpr uint8_t kCfaOffsetExtended = 0x05;
+constexpr uint8_t kCfaRestoreExtended = 0x06;
+constexpr uint8_t kCfaUndefined = 0x07;
+constexpr uint8_t kCfaSameValue = 0x08;
+constexpr uint8_t kCfaRegister = 0x09;
+constexpr uint8_t kCfaRememberState = 0x0a;
+constexpr uint8_t kCfaRestoreState = 0x0b;
+constexpr uint8_t kCfaDefCfa = 0x0c;
+constexpr uint8_t kCfaDefCfaRegister = 0x0d;
+constexpr uint8_t kCfaDefCfaOffset = 0x0e;
+constexpr uint8_t kCfaDefCfaExpression = 0x0f;
+constexpr uint8_t kCfaExpression = 0x10;
+constexpr uint8_t kCfaOffsetExtendedSf = 0x11;
+constexpr uint8_t kCfaDefCfaSf = 0x12;
+constexpr uint8_t kCfaDefCfaOffsetSf = 0x13;
+constexpr uint8_t kCfaValOffset = 0x14;
+constexpr uint8_t kCfaValOffsetSf = 0x15;
+constexpr uint8_t kCfaValExpression = 0x16;
+// AArch64 negate_ra_state, SPARC window_save; no operands either way.
+constexpr uint8_t kCfaGnuWindowSave = 0x2d;
+constexpr uint8_t kCfaGnuArgsSize = 0x2e;
+constexpr uint8_t kCfaGnuNegativeOffsetExtended = 0x2f;
+
+// Bounds-checked cursor over CFI bytes; any overrun clears ok and reads 0.
+class Reader {
+public:
+  Reader(std::span<const uint8_t> bytes, uint64_t address, bool big_endian, uint8_t address_size)
+      : bytes_(bytes), address_(address), big_endian_(big_endian), address_size_(address_size) {}
+
+  size_t pos = 0;
+  bool ok = true;
+
+  bool has(size_t count) {
+    if (count > bytes_.size() || pos > bytes_.size() - count) {
+      ok = false;
+    }
+    return ok;
+  }
+
+  uint64_t fixed(size_t size) {
+    if (!has(size)) {
+      return 0;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+      const uint64_t byte = bytes_[pos + (big_endian_ ? i : size - 1 - i)];
+      value = value << 8 | byte;
+    }
+    pos += size;
+    return value;
+  }
+
+  uint8_t u8() { return static_cast<uint8_t>(fixed(1)); }
+
+  uint64_t uleb() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; has(1); shift += 7) {
+      const uint8_t byte = bytes_[pos++];
+      if (shift < 64) {
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      }
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    return value;
+  }
+
+  int64_t sleb() {
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte = 0;
+    while (has(1)) {
+      byte = bytes_[pos++];
+      if (shift < 64) {
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      }
+      shift += 7;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    if (shift < 64 && (byte & 0x40) != 0) {
+      value |= ~uint64_t{0} << shift;
+    }
+    return static_cast<int64_t>(value);
+  }
+
+  std::span<const uint8_t> block(size_t size) {
+    if (!has(size)) {
+      return {};
+    }
+    auto out = bytes_.subspan(pos, size);
+    pos += size;
+    return out;
+  }
+
+  void skip(size_t size) {
+    if (has(size)) {
+      pos += size;
+    }
+  }
+
+  // A DW_EH_PE-encoded value. Only the format is applied when application
+  // is false (pc_range, which is a length). Indirect values are returned as
+  // the address of the pointer.
+  bool encoded(uint8_t encoding, uint64_t data_base, uint64_t* out, bool application = true) {
+    if (encoding == kEncOmit) {
+      return false;
+    }
+    const uint64_t field = address_ + pos;
+    uint64_t value = 0;
+    switch (encoding & kEncFormatMask) {
+      case kEncAbsptr:
+        value = fixed(address_size_);
+        break;
+      case kEncUleb128:
+        value = uleb();
+        break;
+      case kEncUdata2:
+        value = fixed(2);
+        break;
+      case kEncUdata4:
+        value = fixed(4);
+        break;
+      case kEncUdata8:
+        value = fixed(8);
+        break;
+      case kEncSleb128:
+        value = static_cast<uint64_t>(sleb());
+        break;
+      case kEncSdata2:
+        value = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(fixed(2))));
+        break;
+      case kEncSdata4:
+        value = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(fixed(4))));
+        break;
+      case kEncSdata8:
+        value = fixed(8);
+        break;
+      default:
+        ok = false;
+        return false;
+    }
+    if (application) {
+      switch (encoding & kEncApplicationMask) {
+        case 0:
+          break;
+        case kEncPcrel:
+          value += field;
+          break;
+        case kEncDatarel:
+          value += data_base;
+          break;
+        default:
+          ok = false;
+          return false;
+      }
+    }
+    if (address_size_ == 4) {
+      value &= 0xffffffffu;
+    }
+    *out = value;
+    return ok;
+  }
+
+private:
+  std::span<const uint8_t> bytes_;
+  uint64_t address_;
+  bool big_endian_;
+  uint8_t address_size_;
+};
+
+// Bytes of a fixed-size encoding, 0 for variable-length ones.
+size_t encoded_size(uint8_t encoding, uint8_t address_size) {
+  switch (encoding & kEncFormatMask) {
+    case kEncAbsptr:
+      return address_size;
+    case kEncUdata2:
+    case kEncSdata2:
+      return 2;
+    case kEncUdata4:
+    case kEncSdata4:
+      return 4;
+    case kEncUdata8:
+    case kEncSdata8:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Entry framing shared by CIEs and FDEs: length (with the 64-bit escape),
+// then the CIE id / CIE pointer field.
+bool read_entry_header(Reader* reader, size_t* end, size_t* id_pos, uint64_t* id) {
+  uint64_t length = reader->fixed(4);
+  bool wide = false;
+  if (length == 0xffffffffu) {
+    length = reader->fixed(8);
+    wide = true;
+  }
+  if (!reader->ok || length == 0 || !reader->has(static_cast<size_t>(length))) {
+    return false;
+  }
+  *end = reader->pos + static_cast<size_t>(length);
+  *id_pos = reader->pos;
+  *id = reader->fixed(wide ? 8 : 4);
+  return reader->ok;
+}
+
+struct FrameState {
+  CfaRuleKind cfa = CfaRuleKind::Undefined;
+  uint32_t cfa_register = 0;
+  int64_t cfa_offset = 0;
+  std::span<const uint8_t> cfa_expression{};
+  std::vector<RegisterRule> registers;
+
+  void set(const RegisterRule& rule) {
+    auto it = std::lower_bound(registers.begin(), registers.end(), rule.reg,
+                               [](const RegisterRule& r, uint32_t reg) { return r.reg < reg; });
+    if (it != registers.end() && it->reg == rule.reg) {
+      *it = rule;
+    } else {
+      registers.insert(it, rule);
+    }
+  }
+
+  // Back to the CIE's rule for reg, or to no rule.
+  void restore(uint32_t reg, const FrameState* initial) {
+    auto it = std::lower_bound(registers.begin(), registers.end(), reg,
+                               [](const RegisterRule& r, uint32_t value) { return r.reg < value; });
+    const RegisterRule* original = nullptr;
+    if (initial) {
+      auto found = std::lower_bound(initial->registers.begin(), initial->registers.end(), reg,
+                                    [](const RegisterRule& r, uint32_t value) { return r.reg < value; });
+      if (found != initial->registers.end() && found->reg == reg) {
+        original = &*found;
+      }
+    }
+    const bool present = it != registers.end() && it->reg == reg;
+    if (original && present) {
+      *it = *original;
+    } else if (original) {
+      registers.insert(it, *original);
+    } else if (present) {
+      registers.erase(it);
+    }
+  }
+};
+
+// Interprets a CFA program. Stops before the first advance past target,
+// leaving *location at the start of the row holding target and *row_end at
+// the advance (unchanged if the program ends first).
+bool execute(Reader* reader, size_t end, uint64_t code_align, int64_t data_align, uint8_t fde_encoding,
+             uint64_t target, const FrameState* initial, FrameState* state, uint64_t* location, uint64_t* row_end) {
+  std::vector<FrameState> remembered;
+  auto advance = [&](uint64_t next) {
+    if (next > target) {
+      *row_end = next;
+      return false;
+    }
+    *location = next;
+    return true;
+  };
+  auto rule = [&](uint32_t reg, RegisterRuleKind kind, int64_t offset) {
+    RegisterRule r{};
+    r.reg = reg;
+    r.kind = kind;
+    r.offset = offset;
+    state->set(r);
+  };
+
+  while (reader->ok && reader->pos < end) {
+    const uint8_t op = reader->u8();
+    const uint8_t operand = op & 0x3f;
+    switch (op & 0xc0) {
+      case kCfaAdvanceLoc:
+        if (!advance(*location + operand * code_align)) {
+          return true;
+        }
+        continue;
+      case kCfaOffset:
+        rule(operand, RegisterRuleKind::Offset, static_cast<int64_t>(reader->uleb()) * data_align);
+        continue;
+      case kCfaRestore:
+        state->restore(operand, initial);
+        continue;
+      default:
+        break;
+    }
+
+    switch (op) {
+      case kCfaNop:
+      case kCfaGnuWindowSave:
+        break;
+      case kCfaSetLoc: {
+        uint64_t next = 0;
+        if (!reader->encoded(fde_encoding, 0, &next)) {
+          return false;
+        }
+        if (!advance(next)) {
+          return true;
+        }
+        break;
+      }
+      case kCfaAdvanceLoc1:
+      case kCfaAdvanceLoc2:
+      case kCfaAdvanceLoc4: {
+        const size_t size = op == kCfaAdvanceLoc1 ? 1 : (op == kCfaAdvanceLoc2 ? 2 : 4);
+        if (!advance(*location + reader->fixed(size) * code_align)) {
+          return true;
+        }
+        break;
+      }
+      case kCfaOffsetExtended: {
+        const auto reg = static_cast<uint32_t>(reader->uleb());
+        rule(reg, RegisterRuleKind::Offset, static_cast<int64_t>(reader->uleb()) * data_align);
+        break;
+      }
+      case kCfaOffsetExtendedSf: {
+        const auto reg = static_cast<uint32_t>(reader->uleb());
+        rule(reg, RegisterRuleKind::Offset, reader->sleb() * data_align);
+        break;
+      }
+      case kCfaGnuNegativeOffsetExtended: {
+        const auto reg = static_cast<uint32_t>(reader->uleb());
+        rule(reg, RegisterRuleKind::Offset, -static_cast<int64_t>(reader->uleb()) * data_align);
+        break;
+      }
+      case kCfaValOffset: {
+        const auto reg = static_cast<uint32_t>(reader->uleb());
+        rule(reg, RegisterRuleKind::ValueOffset, static_cast<int64_t>(reader->uleb()) * data_align);
+        break;
+      }
+      case kCfaValOffsetSf: {
+        const auto reg = static_cast<uint32_t>(reader->uleb());
+        rule(reg, RegisterRuleKind::ValueOffset, reader->sleb() * data_align);
+        break;
+      }
+      case kCfaRestoreExtended:
+        state->restore(static_cast<uint32_t>(reader->uleb()), initial);
+        break;
+      case kCfaUndefined:
+        rule(static_cast<uint32_t>(reader->uleb()), RegisterRuleKind::Undefined, 0);
+        break;
+      case kCfaSameValue:
+        rule(static_cast<uint32_t>(reader->uleb()), RegisterRuleKind::SameValue, 0);
+        break;
+      case kCfaRegister: {
+        RegisterRule r{};
+        r.reg = static_cast<uint32_t>(reader->uleb());
+        r.kind = RegisterRuleKind::Register;
+        r.other = static_cast<uint32_t>(reader->uleb());
+        state->set(r);
+        break;
+      }
+      case kCfaExpression:
+      case kCfaValExpression: {
+        RegisterRule r{};
+        r.reg = static_cast<uint32_t>(reader->uleb());
+        r.kind = op == kCfaExpression ? RegisterRuleKind::Expression : RegisterRuleKind::ValueExpression;
+        r.expression = reader->block(static_cast<size_t>(reader->uleb()));
+        state->set(r);
+        break;
+      }
+      case kCfaRememberState:
+        remembered.push_back(*state);
+        break;
+      case kCfaRestoreState:
+        if (remembered.empty()) {
+          return false;
+        }
+        *state = std::move(remembered.back());
+        remembered.pop_back();
+        break;
+      case kCfaDefCfa:
+        state->cfa = CfaRuleKind::RegisterOffset;
+        state->cfa_register = static_cast<uint32_t>(reader->uleb());
+        state->cfa_offset = static_cast<int64_t>(reader->uleb());
+        break;
+      case kCfaDefCfaSf:
+        state->cfa = CfaRuleKind::RegisterOffset;
+        state->cfa_register = static_cast<uint32_t>(reader->uleb());
+        state->cfa_offset = reader->sleb() * data_align;
+        break;
+      case kCfaDefCfaRegister:
+        state->cfa = CfaRuleKind::RegisterOffset;
+        state->cfa_register = static_cast<uint32_t>(reader->uleb());
+        break;
+      case kCfaDefCfaOffset:
+        state->cfa_offset = static_cast<int64_t>(reader->uleb());
+        break;
+      case kCfaDefCfaOffsetSf:
+        state->cfa_offset = reader->sleb() * data_align;
+        break;
+      case kCfaDefCfaExpression:
+        state->cfa = CfaRuleKind::Expression;
+        state->cfa_expression = reader->block(static_cast<size_t>(reader->uleb()));
+        break;
+      case kCfaGnuArgsSize:
+        reader->uleb();
+        break;
+      default:
+        return false;
+    }
+  }
+  return reader->ok;
+}
+
+} // namespace
+
+bool CallFrameTable::eh_frame_address(std::span<const uint8_t> hdr, uint64_t hdr_address, bool big_endian,
+                                      uint8_t address_size, uint64_t* out) {
+  Reader reader(hdr, hdr_address, big_endian, address_size);
+  if (reader.u8() != 1) {
+    return false;
+  }
+  const uint8_t pointer_encoding = reader.u8();
+  reader.skip(2);
+  return reader.ok && reader.encoded(pointer_encoding, hdr_address, out);
+}
+
+bool CallFrameTable::attach(uint64_t eh_frame_address, std::vector<uint8_t> eh_frame, uint64_t hdr_address,
+                            std::vector<uint8_t> hdr, bool big_endian, uint8_t address_size, std::string* error) {
+  *this = CallFrameTable{};
+  if (address_size != 4 && address_size != 8) {
+    if (error) {
+      *error = "unsupported CFI address size";
+    }
+    return false;
+  }
+  eh_frame_address_ = eh_frame_address;
+  eh_frame_ = std::move(eh_frame);
+  hdr_address_ = hdr_address;
+  hdr_ = std::move(hdr);
+  big_endian_ = big_endian;
+  address_size_ = address_size;
+
+  // The search table is only usable with fixed-size entries that are
+  // absolute or relative to the header; anything else falls back to an
+  // index built from a walk of .eh_frame.
+  if (!hdr_.empty()) {
+    Reader reader(hdr_, hdr_address_, big_endian_, address_size_);
+    const uint8_t version = reader.u8();
+    const uint8_t pointer_encoding = reader.u8();
+    const uint8_t count_encoding = reader.u8();
+    const uint8_t table_encoding = reader.u8();
+    uint64_t pointer = 0;
+    uint64_t count = 0;
+    const size_t entry_size = encoded_size(table_encoding, address_size_);
+    const uint8_t application = table_encoding & kEncApplicationMask;
+    if (version == 1 && reader.encoded(pointer_encoding, hdr_address_, &pointer) &&
+        reader.encoded(count_encoding, hdr_address_, &count) && pointer == eh_frame_address_ && entry_size != 0 &&
+        (application == 0 || application == kEncDatarel) && count <= (hdr_.size() - reader.pos) / (2 * entry_size)) {
+      table_offset_ = reader.pos;
+      table_count_ = static_cast<size_t>(count);
+      table_encoding_ = table_encoding;
+      return true;
+    }
+  }
+
+  enumerate(&index_);
+  std::sort(index_.begin(), index_.end(),
+            [](const FrameDescription& a, const FrameDescription& b) { return a.start < b.start; });
+  return true;
+}
+
+bool CallFrameTable::empty() const { return table_count_ == 0 && index_.empty(); }
+
+size_t CallFrameTable::size() const { return table_count_ != 0 ? table_count_ : index_.size(); }
+
+bool CallFrameTable::has_search_table() const { return table_count_ != 0; }
+
+bool CallFrameTable::parse_cie(size_t offset, Cie* out) const {
+  Reader reader(eh_frame_, eh_frame_address_, big_endian_, address_size_);
+  reader.pos = offset;
+  size_t end = 0;
+  size_t id_pos = 0;
+  uint64_t id = 0;
+  if (!read_entry_header(&reader, &end, &id_pos, &id) || id != 0) {
+    return false;
+  }
+  *out = Cie{};
+  out->end = end;
+  const uint8_t version = reader.u8();
+  if (version != 1 && version != 3 && version != 4) {
+    return false;
+  }
+  std::string augmentation;
+  for (uint8_t c = reader.u8(); reader.ok && c != 0; c = reader.u8()) {
+    augmentation.push_back(static_cast<char>(c));
+  }
+  if (augmentation.rfind("eh", 0) == 0) {
+    reader.skip(address_size_);
+  }
+  if (version == 4) {
+    reader.skip(2);
+  }
+  out->code_align = reader.uleb();
+  out->data_align = reader.sleb();
+  out->return_address_register = version == 1 ? reader.u8() : static_cast<uint32_t>(reader.uleb());
+
+  if (!augmentation.empty() && augmentation[0] == 'z') {
+    out->augmented = true;
+    const size_t length = static_cast<size_t>(reader.uleb());
+    const size_t data_end = reader.pos + length;
+    for (size_t i = 1; i < augmentation.size() && reader.ok; ++i) {
+      switch (augmentation[i]) {
+        case 'R':
+          out->fde_encoding = reader.u8();
+          break;
+        case 'L':
+          reader.u8();
+          break;
+        case 'P': {
+          uint64_t personality = 0;
+          reader.encoded(reader.u8(), 0, &personality);
+          break;
+        }
+        case 'S':
+          out->signal_frame = true;
+          break;
+        default:
+          // Unknown letters ('B', 'G', ...) carry no data we need; the
+          // length lets us step over whatever follows.
+          i = augmentation.size();
+          break;
+      }
+    }
+    reader.pos = data_end;
+  } else if (!augmentation.empty() && augmentation != "eh") {
+    return false;
+  }
+  out->instructions = reader.pos;
+  return reader.ok && out->instructions <= end;
+}
+
+bool CallFrameTable::fde_cie(size_t offset, size_t* cie_offset) const {
+  Reader reader(eh_frame_, eh_frame_address_, big_endian_, address_size_);
+  reader.pos = offset;
+  size_t end = 0;
+  size_t id_pos = 0;
+  uint64_t id = 0;
+  if (!read_entry_header(&reader, &end, &id_pos, &id) || id == 0 || id > id_pos) {
+    return false;
+  }
+  *cie_offset = id_pos - static_cast<size_t>(id);
+  return true;
+}
+
+bool CallFrameTable::parse_fde(size_t offset, const Cie& cie, FrameDescription* out, size_t* instructions,
+                               size_t* end) const {
+  Reader reader(eh_frame_, eh_frame_address_, big_endian_, address_size_);
+  reader.pos = offset;
+  size_t id_pos = 0;
+  uint64_t id = 0;
+  if (!read_entry_header(&reader, end, &id_pos, &id) || id == 0) {
+    return false;
+  }
+  uint64_t start = 0;
+  uint64_t range = 0;
+  if (!reader.encoded(cie.fde_encoding, 0, &start) || !reader.encoded(cie.fde_encoding, 0, &range, false)) {
+    return false;
+  }
+  if (cie.augmented) {
+    reader.skip(static_cast<size_t>(reader.uleb()));
+  }
+  out->start = start;
+  out->end = start + range;
+  out->offset = offset;
+  *instructions = reader.pos;
+  return reader.ok && *instructions <= *end;
+}
+
+bool CallFrameTable::fde_at(size_t offset, FrameDescription* out) const {
+  size_t cie_offset = 0;
+  Cie cie;
+  size_t instructions = 0;
+  size_t end = 0;
+  return fde_cie(offset, &cie_offset) && parse_cie(cie_offset, &cie) &&
+         parse_fde(offset, cie, out, &instructions, &end);
+}
+
+bool CallFrameTable::find(uint64_t address, FrameDescription* out) const {
+  if (table_count_ != 0) {
+    const size_t entry_size = encoded_size(table_encoding_, address_size_);
+    Reader reader(hdr_, hdr_address_, big_endian_, address_size_);
+    auto initial_location = [&](size_t i) {
+      reader.pos = table_offset_ + i * 2 * entry_size;
+      uint64_t value = 0;
+      reader.encoded(table_encoding_, hdr_address_, &value);
+      return value;
+    };
+    // Last entry starting at or before address.
+    size_t low = 0;
+    size_t high = table_count_;
+    while (low < high) {
+      const size_t mid = low + (high - low) / 2;
+      if (initial_location(mid) <= address) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    if (low == 0) {
+      return false;
+    }
+    reader.pos = table_offset_ + (low - 1) * 2 * entry_size + entry_size;
+    uint64_t fde_address = 0;
+    if (!reader.encoded(table_encoding_, hdr_address_, &fde_address) || fde_address < eh_frame_address_ ||
+        fde_address - eh_frame_address_ >= eh_frame_.size()) {
+      return false;
+    }
+    FrameDescription fde;
+    if (!fde_at(static_cast<size_t>(fde_address - eh_frame_address_), &fde) || address >= fde.end) {
+      return false;
+    }
+    *out = fde;
+    return true;
+  }
+
+  auto it = std::upper_bound(index_.begin(), index_.end(), address,
+                             [](uint64_t value, const FrameDescription& fde) { return value < fde.start; });
+  if (it == index_.begin() || address >= (it - 1)->end) {
+    return false;
+  }
+  *out = *(it - 1);
+  return true;
+}
+
+bool CallFrameTable::row_at(uint64_t address, CallFrameRow* out, std::string* error) const {
+  auto fail = [error](const char* message) {
+    if (error) {
+      *error = message;
+    }
+    return false;
+  };
+  FrameDescription fde;
+  if (!find(address, &fde)) {
+    return fail("no FDE covers the address");
+  }
+  size_t cie_offset = 0;
+  Cie cie;
+  size_t instructions = 0;
+  size_t end = 0;
+  if (!fde_cie(static_cast<size_t>(fde.offset), &cie_offset) || !parse_cie(cie_offset, &cie) ||
+      !parse_fde(static_cast<size_t>(fde.offset), cie, &fde, &instructions, &end)) {
+    return fail("malformed FDE");
+  }
+
+  FrameState initial;
+  uint64_t location = fde.start;
+  uint64_t row_end = fde.end;
+  Reader reader(eh_frame_, eh_frame_address_, big_endian_, address_size_);
+  reader.pos = cie.instructions;
+  if (!execute(&reader, cie.end, cie.code_align, cie.data_align, cie.fde_encoding, UINT64_MAX, nullptr, &initial,
+               &location, &row_end)) {
+    return fail("malformed CIE instructions");
+  }
+  FrameState state = initial;
+  location = fde.start;
+  row_end = fde.end;
+  reader.pos = instructions;
+  if (!execute(&reader, end, cie.code_align, cie.data_align, cie.fde_encoding, address, &initial, &state, &location,
+               &row_end)) {
+    return fail("malformed FDE instructions");
+  }
+
+  out->start = location;
+  out->end = std::min(row_end, fde.end);
+  out->cfa = state.cfa;
+  out->cfa_register = state.cfa_register;
+  out->cfa_offset = state.cfa_offset;
+  out->cfa_expression = state.cfa_expression;
+  out->return_address_register = cie.return_address_register;
+  out->signal_frame = cie.signal_frame;
+  out->registers = std::move(state.registers);
+  return true;
+}
+
+size_t CallFrameTable::enumerate(std::vector<FrameDescription>* out) const {
+  const size_t before = out->size();
+  std::unordered_map<size_t, Cie> cies;
+  size_t last_cie = SIZE_MAX;
+  const Cie* cie = nullptr;
+  Reader reader(eh_frame_, eh_frame_address_, big_endian_, address_size_);
+  while (reader.pos < eh_frame_.size()) {
+    const size_t offset = reader.pos;
+    size_t end = 0;
+    size_t id_pos = 0;
+    uint64_t id = 0;
+    if (!read_entry_header(&reader, &end, &id_pos, &id)) {
+      // A zero length terminates the section.
+      break;
+    }
+    reader.pos = end;
+    if (id == 0 || id > id_pos) {
+      continue;
+    }
+    const size_t cie_offset = id_pos - static_cast<size_t>(id);
+    if (cie_offset != last_cie) {
+      auto it = cies.find(cie_offset);
+      if (it == cies.end()) {
+        Cie parsed;
+        if (!parse_cie(cie_offset, &parsed)) {
+          continue;
+        }
+        it = cies.emplace(cie_offset, parsed).first;
+      }
+      cie = &it->second;
+      last_cie = cie_offset;
+    }
+    FrameDescription fde;
+    size_t instructions = 0;
+    size_t fde_end = 0;
+    // Zero ranges are FDEs of code the linker discarded.
+    if (parse_fde(offset, *cie, &fde, &instructions, &fde_end) && fde.end > fde.start) {
+      out->push_back(fde);
+    }
+  }
+  return out->size() - before;
+}
+
+} // namespace ghirda::core
@@ -0,0 +1,91 @@
+#include "ghirda/core/data_item.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ghirda/core/reference.h"
+
+namespace ghirda::core {
+
+const char* data_item_type_name(DataItemType type) {
+  switch (type) {
+    case DataItemType::AsciiString:
+      return "ascii";
+    case DataItemType::Utf8String:
+      return "utf8";
+    case DataItemType::Utf16String:
+      return "utf16";
+  }
+  return "unknown";
+}
+
+void DataItemTable::add(const DataItem& item) {
+  if (!items_.empty() && item.address < items_.back().address) {
+    sorted_ = false;
+  }
+  items_.push_back(item);
+}
+
+void DataItemTable::add(std::span<const DataItem> items) {
+  if (items.empty()) {
+    return;
+  }
+  const auto by_address = [](const DataItem& a, const DataItem& b) { return a.address < b.address; };
+  if ((!items_.empty() && items.front().address < items_.back().address) ||
+      !std::is_sorted(items.begin(), items.end(), by_address)) {
+    sorted_ = false;
+  }
+  items_.insert(items_.end(), items.begin(), items.end());
+}
+
+void DataItemTable::reserve(size_t count) { items_.reserve(count); }
+
+void DataItemTable::finalize() {
+  const auto by_address = [](const DataItem& a, const DataItem& b) { return a.address < b.address; };
+  if (!sorted_) {
+    std::stable_sort(items_.begin(), items_.end(), by_address);
+    sorted_ = true;
+  }
+  size_t kept = 0;
+  for (size_t i = 0; i < items_.size(); ++i) {
+    if (kept != 0 && items_[i].address < items_[kept - 1].address + items_[kept - 1].size) {
+      continue;
+    }
+    items_[kept++] = items_[i];
+  }
+  items_.resize(kept);
+}
+
+size_t DataItemTable::size() const { return items_.size(); }
+bool DataItemTable::empty() const { return items_.empty(); }
+size_t DataItemTable::memory_usage() const { return items_.capacity() * sizeof(DataItem); }
+std::span<const DataItem> DataItemTable::items() const { return items_; }
+
+const DataItem* DataItemTable::at(uint64_t address) const {
+  const DataItem* item = containing(address);
+  return item != nullptr && item->address == address ? item : nullptr;
+}
+
+const DataItem* DataItemTable::containing(uint64_t address) const {
+  auto it = std::upper_bound(items_.begin(), items_.end(), address,
+                             [](uint64_t value, const DataItem& item) { return value < item.address; });
+  if (it == items_.begin()) {
+    return nullptr;
+  }
+  --it;
+  return address - it->address < it->size ? &*it : nullptr;
+}
+
+void DataItemTable::count_references(const ReferenceDatabase& references) {
+  std::vector<uint64_t> addresses(items_.size());
+  std::vector<uint32_t> counts(items_.size());
+  for (size_t i = 0; i < items_.size(); ++i) {
+    addresses[i] = items_[i].address;
+  }
+  references.count_to(addresses, counts);
+  for (size_t i = 0; i < items_.size(); ++i) {
+    items_[i].references = static_cast<uint16_t>(std::min<uint32_t>(counts[i], std::numeric_limits<uint16_t>::max()));
+  }
+}
+
+} // namespace ghirda::core
@@ -1,14 +1,51 @@
 #include "ghirda/core/memory_image.h"
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cstring>
+#include <span>
+#include <thread>
+#include <utility>
+
+#include "ghirda/core/byte_pattern.h"
 
 namespace ghirda::core {
 
+SegmentBytes::SegmentBytes(std::vector<uint8_t> bytes) : owned_(std::move(bytes)) {}
+
+SegmentBytes::SegmentBytes(const uint8_t* data, size_t size, std::shared_ptr<const void> keeper)
+    : view_(data), view_size_(size), keeper_(std::move(keeper)) {}
+
+const uint8_t* SegmentBytes::data() const { return keeper_ ? view_ : owned_.data(); }
+size_t SegmentBytes::size() const { return keeper_ ? view_size_ : owned_.size(); }
+bool SegmentBytes::empty() const { return size() == 0; }
+const uint8_t* SegmentBytes::begin() const { return data(); }
+const uint8_t* SegmentBytes::end() const { return data() + size(); }
+bool SegmentBytes::borrowed() const { return keeper_ != nullptr; }
+
+uint8_t* SegmentBytes::mutable_data() {
+  if (keeper_) {
+    owned_.assign(view_, view_ + view_size_);
+    view_ = nullptr;
+    view_size_ = 0;
+    keeper_.reset();
+  }
+  return owned_.data();
+}
+
 void MemoryImage::map_segment(uint64_t start, const std::vector<uint8_t>& bytes) {
   segments_.push_back(ImageSegment{start, bytes});
 }
 
+void MemoryImage::map_segment(uint64_t start, std::vector<uint8_t>&& bytes) {
+  segments_.push_back(ImageSegment{start, std::move(bytes)});
+}
+
+void MemoryImage::map_view(uint64_t start, const uint8_t* data, size_t size, std::shared_ptr<const void> keeper) {
+  segments_.push_back(ImageSegment{start, SegmentBytes(data, size, std::move(keeper))});
+}
+
 void MemoryImage::zero_fill(uint64_t start, uint64_t size) {
   std::vector<uint8_t> zeros(static_cast<size_t>(size), 0);
   segments_.push_back(ImageSegment{start, std::move(zeros)});
@@ -34,6 +71,8 @@ const ImageSegment* MemoryImage::find_segment(uint64_t address) const {
   return &(*it);
 }
 
+bool MemoryImage::contains(uint64_t address) const { return find_segment(address) != nullptr; }
+
 bool MemoryImage::read_u32(uint64_t address, uint32_t* value) const {
   const ImageSegment* seg = find_segment(address);
   if (!seg || address + sizeof(uint32_t) > seg->start + seg->data.size()) {
@@ -60,7 +99,7 @@ bool MemoryImage::write_u32(uint64_t address, uint32_t value) {
     return false;
   }
   size_t offset = static_cast<size_t>(address - seg->start);
-  std::memcpy(seg->data.data() + offset, &value, sizeof(uint32_t));
+  std::memcpy(seg->data.mutable_data() + offset, &value, sizeof(uint32_t));
   return true;
 }
 
@@ -70,10 +109,117 @@ bool MemoryImage::write_u64(uint64_t address, uint64_t value) {
     return false;
   }
   size_t offset = static_cast<size_t>(address - seg->start);
-  std::memcpy(seg->data.data() + offset, &value, sizeof(uint64_t));
+  std::memcpy(seg->data.mutable_data() + offset, &value, sizeof(uint64_t));
   return true;
 }
 
+size_t MemoryImage::apply_writes(std::vector<ImageWrite>* writes, bool big_endian) {
+  const bool swap = big_endian != (std::endian::native == std::endian::big);
+  const auto by_address = [](const ImageWrite& a, const ImageWrite& b) { return a.address < b.address; };
+  if (!std::is_sorted(writes->begin(), writes->end(), by_address)) {
+    std::stable_sort(writes->begin(), writes->end(), by_address);
+  }
+  std::vector<ImageSegment*> order;
+  order.reserve(segments_.size());
+  for (auto& seg : segments_) {
+    if (!seg.data.empty()) {
+      order.push_back(&seg);
+    }
+  }
+  std::sort(order.begin(), order.end(), [](const ImageSegment* a, const ImageSegment* b) { return a->start < b->start; });
+
+  size_t applied = 0;
+  size_t cursor = 0;
+  for (ImageWrite& write : *writes) {
+    while (cursor < order.size() && write.address >= order[cursor]->start + order[cursor]->data.size()) {
+      ++cursor;
+    }
+    if (cursor == order.size()) {
+      break;
+    }
+    ImageSegment& seg = *order[cursor];
+    if (write.address < seg.start || write.address + write.size > seg.start + seg.data.size() ||
+        (write.size != sizeof(uint32_t) && write.size != sizeof(uint64_t))) {
+      continue;
+    }
+    uint8_t* place = seg.data.mutable_data() + static_cast<size_t>(write.address - seg.start);
+    if (write.size == sizeof(uint32_t)) {
+      uint32_t value = static_cast<uint32_t>(write.value);
+      if (write.add) {
+        uint32_t stored = 0;
+        std::memcpy(&stored, place, sizeof(stored));
+        value += swap ? __builtin_bswap32(stored) : stored;
+      }
+      value = swap ? __builtin_bswap32(value) : value;
+      std::memcpy(place, &value, sizeof(value));
+    } else {
+      uint64_t value = write.value;
+      if (write.add) {
+        uint64_t stored = 0;
+        std::memcpy(&stored, place, sizeof(stored));
+        value += swap ? __builtin_bswap64(stored) : stored;
+      }
+      value = swap ? __builtin_bswap64(value) : value;
+      std::memcpy(place, &value, sizeof(value));
+    }
+    write.applied = true;
+    ++applied;
+  }
+  return applied;
+}
+
+size_t MemoryImage::search(const PatternSet& patterns, std::vector<PatternMatch>* out, size_t thread_count) const {
+  // Windows are large enough to amortise a worker's start, small enough to
+  // balance one big segment across workers.
+  constexpr size_t kWindow = size_t{1} << 20;
+  struct Window {
+    const ImageSegment* segment = nullptr;
+    size_t first = 0;
+    size_t last = 0;
+  };
+  std::vector<Window> windows;
+  for (const auto& seg : segments_) {
+    for (size_t first = 0; first < seg.data.size(); first += kWindow) {
+      windows.push_back(Window{&seg, first, std::min(seg.data.size(), first + kWindow)});
+    }
+  }
+  if (windows.empty() || !patterns.compiled()) {
+    return 0;
+  }
+
+  std::vector<std::vector<PatternMatch>> found(windows.size());
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next.fetch_add(1); i < windows.size(); i = next.fetch_add(1)) {
+      const Window& window = windows[i];
+      patterns.scan(std::span<const uint8_t>(window.segment->data), window.segment->start, &found[i], window.first,
+                    window.last);
+    }
+  };
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  thread_count = std::min(thread_count, windows.size());
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < thread_count; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const size_t before = out->size();
+  for (const auto& matches : found) {
+    out->insert(out->end(), matches.begin(), matches.end());
+  }
+  std::sort(out->begin() + static_cast<std::ptrdiff_t>(before), out->end(),
+            [](const PatternMatch& a, const PatternMatch& b) {
+              return a.address != b.address ? a.address < b.address : a.pattern < b.pattern;
+            });
+  return out->size() - before;
+}
+
 const std::vector<ImageSegment>& MemoryImage::segments() const { return segments_; }
 
 } // namespace ghirda::core
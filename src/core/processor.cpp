@@ -0,0 +1,29 @@
+#include "ghirda/core/processor.h"
+
+namespace ghirda::core {
+
+const char* processor_name(Processor processor) {
+  switch (processor) {
+    case Processor::X86:
+      return "x86";
+    case Processor::X86_64:
+      return "x86_64";
+    case Processor::Arm:
+      return "arm";
+    case Processor::Aarch64:
+      return "aarch64";
+    case Processor::RiscV:
+      return "riscv";
+    case Processor::Mips:
+      return "mips";
+    case Processor::PowerPc:
+      return "ppc";
+    case Processor::PowerPc64:
+      return "ppc64";
+    case Processor::Unknown:
+      break;
+  }
+  return "unknown";
+}
+
+} // namespace ghirda::core
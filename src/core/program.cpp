@@ -1,7 +1,12 @@
 #include "ghirda/core/program.h"
 
+#include <type_traits>
+#include <utility>
+
 namespace ghirda::core {
 
+static_assert(std::is_nothrow_move_constructible_v<Program>);
+
 Program::Program(std::string name) : name_(std::move(name)) {}
 
 const std::string& Program::name() const { return name_; }
@@ -18,22 +23,40 @@ const std::vector<AddressSpace>& Program::address_spaces() const { return addres
 void Program::add_symbol(const Symbol& symbol) { symbols_.push_back(symbol); }
 const std::vector<Symbol>& Program::symbols() const { return symbols_; }
 
+void Program::rename_symbol(size_t index, std::string name) { symbols_[index].name = std::move(name); }
+
 TypeSystem& Program::types() { return types_; }
 const TypeSystem& Program::types() const { return types_; }
 
-void Program::add_relocation(const Relocation& relocation) { relocations_.push_back(relocation); }
-const std::vector<Relocation>& Program::relocations() const { return relocations_; }
+void Program::add_relocation(const Relocation& relocation) { relocations_.add(relocation); }
+RelocationTable& Program::relocations() { return relocations_; }
+const RelocationTable& Program::relocations() const { return relocations_; }
+
+ReferenceDatabase& Program::references() { return references_; }
+const ReferenceDatabase& Program::references() const { return references_; }
+
+DataItemTable& Program::data_items() { return data_items_; }
+const DataItemTable& Program::data_items() const { return data_items_; }
 
 void Program::set_load_bias(uint64_t bias) { load_bias_ = bias; }
 uint64_t Program::load_bias() const { return load_bias_; }
 
+void Program::set_processor(Processor processor) { processor_ = processor; }
+Processor Program::processor() const { return processor_; }
+
 DebugInfo& Program::debug_info() { return debug_info_; }
 const DebugInfo& Program::debug_info() const { return debug_info_; }
 
+CallFrameTable& Program::call_frames() { return call_frames_; }
+const CallFrameTable& Program::call_frames() const { return call_frames_; }
+
 void Program::add_section(const Section& section) { sections_.push_back(section); }
 const std::vector<Program::Section>& Program::sections() const { return sections_; }
 
 void Program::add_segment(const Segment& segment) { segments_.push_back(segment); }
 const std::vector<Program::Segment>& Program::segments() const { return segments_; }
 
+void Program::add_function_start(const FunctionStart& start) { function_starts_.push_back(start); }
+const std::vector<Program::FunctionStart>& Program::function_starts() const { return function_starts_; }
+
 } // namespace ghirda::core
@@ -0,0 +1,312 @@
+#include "ghirda/core/reference.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <thread>
+
+namespace ghirda::core {
+namespace {
+
+// A run is one width byte followed by its entries, each the low width bytes
+// of zigzag(delta) << 3 | type, little-endian. Runs with a delta too wide for
+// that use kWideRun: 8 delta bytes and a type byte per entry.
+constexpr uint64_t kTypeBits = 3;
+constexpr uint64_t kTypeMask = (uint64_t{1} << kTypeBits) - 1;
+constexpr uint8_t kWideRun = 0;
+constexpr size_t kWideEntry = 9;
+// Decoding reads whole words, so the byte array ends with this much slack.
+constexpr size_t kTailPadding = 8;
+
+uint64_t zigzag(uint64_t delta) {
+  const int64_t value = static_cast<int64_t>(delta);
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+uint64_t unzigzag(uint64_t value) { return (value >> 1) ^ (~(value & 1) + 1); }
+
+void put_bytes(uint64_t value, size_t width, std::vector<uint8_t>* out) {
+  for (size_t i = 0; i < width; ++i) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+uint64_t load_word(const uint8_t* p) {
+  uint64_t word = 0;
+  std::memcpy(&word, p, sizeof(word));
+  if constexpr (std::endian::native == std::endian::big) {
+    word = __builtin_bswap64(word);
+  }
+  return word;
+}
+
+bool by_source(const Reference& a, const Reference& b) {
+  if (a.from != b.from) {
+    return a.from < b.from;
+  }
+  if (a.to != b.to) {
+    return a.to < b.to;
+  }
+  return a.type < b.type;
+}
+
+bool by_target(const Reference& a, const Reference& b) {
+  if (a.to != b.to) {
+    return a.to < b.to;
+  }
+  if (a.from != b.from) {
+    return a.from < b.from;
+  }
+  return a.type < b.type;
+}
+
+bool same(const Reference& a, const Reference& b) { return a.from == b.from && a.to == b.to && a.type == b.type; }
+
+} // namespace
+
+bool ReferenceDatabase::Index::find(uint64_t key, size_t* slot) const {
+  auto fence_it = std::upper_bound(fence.begin(), fence.end(), key);
+  if (fence_it == fence.begin()) {
+    return false;
+  }
+  const size_t block = static_cast<size_t>(fence_it - fence.begin()) - 1;
+  if ((fence[block] ^ key) >> 32 != 0) {
+    return false;
+  }
+  const auto begin = keys.begin() + fence_slots[block];
+  const auto end = block + 1 < fence.size() ? keys.begin() + fence_slots[block + 1] : keys.end();
+  const uint32_t low = static_cast<uint32_t>(key);
+  auto it = std::lower_bound(begin, end, low);
+  if (it == end || *it != low) {
+    return false;
+  }
+  *slot = static_cast<size_t>(it - keys.begin());
+  return true;
+}
+
+uint64_t ReferenceDatabase::Index::offset(size_t slot) const { return bases[slot >> kBlockShift] + offsets[slot]; }
+
+size_t ReferenceDatabase::Index::count(size_t slot) const {
+  const uint64_t begin = offset(slot);
+  const uint8_t width = bytes[begin];
+  const uint64_t length = offset(slot + 1) - begin - 1;
+  return static_cast<size_t>(length / (width == kWideRun ? kWideEntry : width));
+}
+
+size_t ReferenceDatabase::Index::memory_usage() const {
+  return fence.size() * sizeof(uint64_t) + fence_slots.size() * sizeof(uint32_t) + keys.size() * sizeof(uint32_t) +
+         bases.size() * sizeof(uint64_t) + offsets.size() * sizeof(uint32_t) + bytes.size();
+}
+
+template <typename Fn>
+void ReferenceDatabase::decode(const Index& index, size_t slot, uint64_t key, Fn&& fn) {
+  const uint8_t* cursor = index.bytes.data() + index.offset(slot);
+  const uint8_t* end = index.bytes.data() + index.offset(slot + 1);
+  uint64_t previous = key;
+  const uint8_t width = *cursor++;
+  if (width == kWideRun) {
+    for (; cursor < end; cursor += kWideEntry) {
+      previous += unzigzag(load_word(cursor));
+      fn(previous, static_cast<ReferenceType>(cursor[8]));
+    }
+    return;
+  }
+  const uint64_t mask = width == 8 ? ~uint64_t{0} : (uint64_t{1} << (8 * width)) - 1;
+  for (; cursor < end; cursor += width) {
+    const uint64_t word = load_word(cursor) & mask;
+    previous += unzigzag(word >> kTypeBits);
+    fn(previous, static_cast<ReferenceType>(word & kTypeMask));
+  }
+}
+
+void ReferenceDatabase::build(const std::vector<Reference>& sorted, bool by_target, Index* index) {
+  *index = Index{};
+  index->bytes.reserve(sorted.size() * 3 + kTailPadding);
+  auto key_of = [by_target](const Reference& r) { return by_target ? r.to : r.from; };
+  auto start_run = [index](size_t slot) {
+    const uint64_t at = index->bytes.size();
+    if ((slot & ((size_t{1} << Index::kBlockShift) - 1)) == 0) {
+      index->bases.push_back(at);
+    }
+    index->offsets.push_back(static_cast<uint32_t>(at - index->bases.back()));
+  };
+
+  std::vector<uint64_t> words;
+  for (size_t begin = 0; begin < sorted.size();) {
+    const uint64_t key = key_of(sorted[begin]);
+    size_t end = begin + 1;
+    while (end < sorted.size() && key_of(sorted[end]) == key) {
+      ++end;
+    }
+    if (index->fence.empty() || (index->fence.back() ^ key) >> 32 != 0 ||
+        index->keys.size() - index->fence_slots.back() >= Index::kFenceStride) {
+      index->fence.push_back(key);
+      index->fence_slots.push_back(static_cast<uint32_t>(index->keys.size()));
+    }
+    start_run(index->keys.size());
+    index->keys.push_back(static_cast<uint32_t>(key));
+
+    words.clear();
+    uint64_t previous = key;
+    bool wide = false;
+    uint64_t widest = 0;
+    for (size_t i = begin; i < end; ++i) {
+      const uint64_t other = by_target ? sorted[i].from : sorted[i].to;
+      const uint64_t delta = zigzag(other - previous);
+      previous = other;
+      wide = wide || (delta >> (64 - kTypeBits)) != 0;
+      words.push_back(delta);
+      widest |= delta << kTypeBits | static_cast<uint64_t>(sorted[i].type);
+    }
+    if (wide) {
+      index->bytes.push_back(kWideRun);
+      for (size_t i = begin; i < end; ++i) {
+        put_bytes(words[i - begin], 8, &index->bytes);
+        index->bytes.push_back(static_cast<uint8_t>(sorted[i].type));
+      }
+    } else {
+      const size_t width = std::max<size_t>(1, (std::bit_width(widest) + 7) / 8);
+      index->bytes.push_back(static_cast<uint8_t>(width));
+      for (size_t i = begin; i < end; ++i) {
+        put_bytes(words[i - begin] << kTypeBits | static_cast<uint64_t>(sorted[i].type), width, &index->bytes);
+      }
+    }
+    begin = end;
+  }
+  start_run(index->keys.size());
+  index->bytes.resize(index->bytes.size() + kTailPadding);
+  index->fence.shrink_to_fit();
+  index->fence_slots.shrink_to_fit();
+  index->keys.shrink_to_fit();
+  index->bases.shrink_to_fit();
+  index->offsets.shrink_to_fit();
+  index->bytes.shrink_to_fit();
+}
+
+void ReferenceDatabase::add(uint64_t from, uint64_t to, ReferenceType type) {
+  pending_.push_back(Reference{from, to, type});
+}
+
+void ReferenceDatabase::add(const Reference& reference) { pending_.push_back(reference); }
+
+void ReferenceDatabase::reserve(size_t count) { pending_.reserve(pending_.size() + count); }
+
+size_t ReferenceDatabase::pending() const { return pending_.size(); }
+
+void ReferenceDatabase::finalize(size_t thread_count) {
+  if (pending_.empty()) {
+    return;
+  }
+  std::vector<Reference> forward = all();
+  forward.insert(forward.end(), pending_.begin(), pending_.end());
+  pending_.clear();
+  pending_.shrink_to_fit();
+  std::sort(forward.begin(), forward.end(), by_source);
+  forward.erase(std::unique(forward.begin(), forward.end(), same), forward.end());
+  size_ = forward.size();
+
+  auto build_reverse = [&] {
+    std::vector<Reference> reverse = forward;
+    std::sort(reverse.begin(), reverse.end(), by_target);
+    build(reverse, true, &reverse_);
+  };
+  if (thread_count == 1) {
+    build_reverse();
+    build(forward, false, &forward_);
+    return;
+  }
+  std::thread reverse_thread(build_reverse);
+  build(forward, false, &forward_);
+  reverse_thread.join();
+}
+
+size_t ReferenceDatabase::size() const { return size_; }
+
+bool ReferenceDatabase::empty() const { return size_ == 0; }
+
+size_t ReferenceDatabase::memory_usage() const { return forward_.memory_usage() + reverse_.memory_usage(); }
+
+size_t ReferenceDatabase::references_from(uint64_t from, std::vector<Reference>* out) const {
+  size_t slot = 0;
+  if (!forward_.find(from, &slot)) {
+    return 0;
+  }
+  const size_t before = out->size();
+  decode(forward_, slot, from, [&](uint64_t to, ReferenceType type) { out->push_back(Reference{from, to, type}); });
+  return out->size() - before;
+}
+
+size_t ReferenceDatabase::references_to(uint64_t to, std::vector<Reference>* out) const {
+  size_t slot = 0;
+  if (!reverse_.find(to, &slot)) {
+    return 0;
+  }
+  const size_t before = out->size();
+  decode(reverse_, slot, to, [&](uint64_t from, ReferenceType type) { out->push_back(Reference{from, to, type}); });
+  return out->size() - before;
+}
+
+size_t ReferenceDatabase::callers(uint64_t target, std::vector<uint64_t>* out) const {
+  size_t slot = 0;
+  if (!reverse_.find(target, &slot)) {
+    return 0;
+  }
+  const size_t before = out->size();
+  decode(reverse_, slot, target, [&](uint64_t from, ReferenceType type) {
+    if (type == ReferenceType::Call) {
+      out->push_back(from);
+    }
+  });
+  return out->size() - before;
+}
+
+size_t ReferenceDatabase::count_to(uint64_t to) const {
+  size_t slot = 0;
+  return reverse_.find(to, &slot) ? reverse_.count(slot) : 0;
+}
+
+void ReferenceDatabase::count_to(std::span<const uint64_t> targets, std::span<uint32_t> counts) const {
+  const Index& index = reverse_;
+  size_t block = 0;
+  size_t slot = 0;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const uint64_t key = targets[i];
+    counts[i] = 0;
+    while (block + 1 < index.fence.size() && index.fence[block + 1] <= key) {
+      ++block;
+    }
+    if (index.fence.empty() || index.fence[block] > key || (index.fence[block] ^ key) >> 32 != 0) {
+      continue;
+    }
+    const auto begin = index.keys.begin() + std::max<size_t>(index.fence_slots[block], slot);
+    const auto end = block + 1 < index.fence.size() ? index.keys.begin() + index.fence_slots[block + 1] : index.keys.end();
+    const uint32_t low = static_cast<uint32_t>(key);
+    const auto it = std::lower_bound(begin, end, low);
+    slot = static_cast<size_t>(it - index.keys.begin());
+    if (it != end && *it == low) {
+      counts[i] = static_cast<uint32_t>(index.count(slot));
+    }
+  }
+}
+
+bool ReferenceDatabase::has_references_to(uint64_t to) const {
+  size_t slot = 0;
+  return reverse_.find(to, &slot);
+}
+
+std::vector<Reference> ReferenceDatabase::all() const {
+  std::vector<Reference> out;
+  out.reserve(size_);
+  for (size_t block = 0; block < forward_.fence.size(); ++block) {
+    const uint64_t high = forward_.fence[block] & ~uint64_t{0xffffffff};
+    const size_t end = block + 1 < forward_.fence.size() ? forward_.fence_slots[block + 1] : forward_.keys.size();
+    for (size_t slot = forward_.fence_slots[block]; slot < end; ++slot) {
+      const uint64_t from = high | forward_.keys[slot];
+      decode(forward_, slot, from,
+             [&](uint64_t to, ReferenceType type) { out.push_back(Reference{from, to, type}); });
+    }
+  }
+  return out;
+}
+
+} // namespace ghirda::core
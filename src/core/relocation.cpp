@@ -0,0 +1,47 @@
+#include "ghirda/core/relocation.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace ghirda::core {
+
+uint32_t RelocationTable::intern(std::string_view name) {
+  if (name.empty()) {
+    return Relocation::kNoSymbol;
+  }
+  const size_t hash = std::hash<std::string_view>{}(name);
+  auto range = ids_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (names_[it->second] == name) {
+      return it->second;
+    }
+  }
+  const uint32_t id = static_cast<uint32_t>(names_.size());
+  names_.emplace_back(name);
+  ids_.emplace(hash, id);
+  return id;
+}
+
+const std::string& RelocationTable::symbol_name(uint32_t id) const {
+  static const std::string kEmpty;
+  return id < names_.size() ? names_[id] : kEmpty;
+}
+
+size_t RelocationTable::symbol_count() const { return names_.size(); }
+
+void RelocationTable::add(const Relocation& relocation) { records_.push_back(relocation); }
+void RelocationTable::reserve(size_t count) { records_.reserve(count); }
+
+size_t RelocationTable::size() const { return records_.size(); }
+bool RelocationTable::empty() const { return records_.empty(); }
+const Relocation& RelocationTable::operator[](size_t index) const { return records_[index]; }
+std::vector<Relocation>::const_iterator RelocationTable::begin() const { return records_.begin(); }
+std::vector<Relocation>::const_iterator RelocationTable::end() const { return records_.end(); }
+const std::vector<Relocation>& RelocationTable::records() const { return records_; }
+
+size_t RelocationTable::count(RelocationStatus status) const {
+  return static_cast<size_t>(std::count_if(records_.begin(), records_.end(),
+                                           [status](const Relocation& r) { return r.status == status; }));
+}
+
+} // namespace ghirda::core
@@ -1,9 +1,129 @@
 #include "ghirda/core/type_system.h"
 
 namespace ghirda::core {
+namespace {
 
-void TypeSystem::add_type(const Type& type) { types_.push_back(type); }
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnvPrime = 0x100000001b3ull;
+
+uint64_t mix(uint64_t hash, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    hash ^= (value >> (8 * i)) & 0xff;
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+uint64_t mix(uint64_t hash, const std::string& value) {
+  for (unsigned char ch : value) {
+    hash ^= ch;
+    hash *= kFnvPrime;
+  }
+  return mix(hash, value.size());
+}
+
+} // namespace
+
+TypeId TypeSystem::add_type(const Type& type) {
+  const uint64_t hash = structural_hash(type);
+  auto range = by_hash_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (structurally_equal(types_[it->second], type)) {
+      ++duplicates_dropped_;
+      return it->second;
+    }
+  }
+
+  const TypeId id = static_cast<TypeId>(types_.size());
+  types_.push_back(type);
+  types_.back().id = id;
+  by_hash_.emplace(hash, id);
+  if (!type.name.empty() && !by_name_.emplace(type.name, id).second) {
+    ++name_collisions_;
+  }
+  return id;
+}
 
 const std::vector<Type>& TypeSystem::types() const { return types_; }
 
+const Type* TypeSystem::find(TypeId id) const {
+  if (id >= types_.size()) {
+    return nullptr;
+  }
+  return &types_[id];
+}
+
+const Type* TypeSystem::find(const std::string& name) const { return find(find_id(name)); }
+
+TypeId TypeSystem::find_id(const std::string& name) const {
+  auto it = by_name_.find(name);
+  if (it == by_name_.end()) {
+    return kInvalidTypeId;
+  }
+  return it->second;
+}
+
+void TypeSystem::link_members() {
+  for (auto& type : types_) {
+    const uint64_t old_hash = structural_hash(type);
+    bool linked = false;
+    for (auto& member : type.members) {
+      if (member.type_id == kInvalidTypeId) {
+        member.type_id = find_id(member.type_name);
+        linked |= member.type_id != kInvalidTypeId;
+      }
+    }
+    if (!linked) {
+      continue;
+    }
+    // Member ids are part of the hash; re-key the type under its new one.
+    auto range = by_hash_.equal_range(old_hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == type.id) {
+        by_hash_.erase(it);
+        break;
+      }
+    }
+    by_hash_.emplace(structural_hash(type), type.id);
+  }
+}
+
+size_t TypeSystem::duplicates_dropped() const { return duplicates_dropped_; }
+size_t TypeSystem::name_collisions() const { return name_collisions_; }
+
+uint64_t TypeSystem::structural_hash(const Type& type) {
+  uint64_t hash = kFnvOffset;
+  hash = mix(hash, static_cast<uint64_t>(type.kind));
+  hash = mix(hash, type.name);
+  hash = mix(hash, type.size);
+  hash = mix(hash, type.members.size());
+  for (const auto& member : type.members) {
+    hash = mix(hash, member.name);
+    hash = mix(hash, member.type_name);
+    hash = mix(hash, member.type_id);
+    hash = mix(hash, member.offset);
+    hash = mix(hash, member.size);
+    hash = mix(hash, member.bit_size);
+    hash = mix(hash, static_cast<uint64_t>(static_cast<int64_t>(member.bit_offset)));
+    hash = mix(hash, member.alignment);
+  }
+  return hash;
+}
+
+bool TypeSystem::structurally_equal(const Type& a, const Type& b) {
+  if (a.kind != b.kind || a.size != b.size || a.name != b.name || a.members.size() != b.members.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.members.size(); ++i) {
+    const TypeMember& ma = a.members[i];
+    const TypeMember& mb = b.members[i];
+    if (ma.name != mb.name || ma.type_name != mb.type_name || ma.type_id != mb.type_id || ma.offset != mb.offset ||
+        ma.size != mb.size || ma.bit_size != mb.bit_size || ma.bit_offset != mb.bit_offset ||
+        ma.alignment != mb.alignment) {
+      return false;
+    }
+  }
+  return true;
+}
+
 } // namespace ghirda::core
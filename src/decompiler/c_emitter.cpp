@@ -0,0 +1,254 @@
+#include "ghirda/decompiler/c_emitter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace ghirda::decompiler {
+namespace {
+
+constexpr size_t kStagingSize = 4096;
+constexpr uint32_t kIndentWidth = 2;
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+} // namespace
+
+ChunkedBuffer::ChunkedBuffer(size_t chunk_size) : chunk_size_(std::max<size_t>(chunk_size, 256)) {}
+
+bool ChunkedBuffer::write(const char* data, size_t size) {
+  while (size > 0) {
+    if (active_ == chunks_.size()) {
+      Chunk chunk{};
+      chunk.data = std::make_unique<char[]>(chunk_size_);
+      chunks_.push_back(std::move(chunk));
+    }
+    Chunk& chunk = chunks_[active_];
+    size_t room = chunk_size_ - chunk.used;
+    size_t count = std::min(room, size);
+    std::memcpy(chunk.data.get() + chunk.used, data, count);
+    chunk.used += count;
+    size_ += count;
+    data += count;
+    size -= count;
+    if (chunk.used == chunk_size_) {
+      ++active_;
+    }
+  }
+  return true;
+}
+
+size_t ChunkedBuffer::size() const { return size_; }
+
+void ChunkedBuffer::clear() {
+  for (auto& chunk : chunks_) {
+    chunk.used = 0;
+  }
+  active_ = 0;
+  size_ = 0;
+}
+
+bool ChunkedBuffer::drain_to(OutputSink* sink) const {
+  if (!sink) {
+    return false;
+  }
+  for (const auto& chunk : chunks_) {
+    if (chunk.used == 0) {
+      break;
+    }
+    if (!sink->write(chunk.data.get(), chunk.used)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ChunkedBuffer::append_to(std::string* out) const {
+  if (!out) {
+    return;
+  }
+  out->reserve(out->size() + size_);
+  for (const auto& chunk : chunks_) {
+    if (chunk.used == 0) {
+      break;
+    }
+    out->append(chunk.data.get(), chunk.used);
+  }
+}
+
+BufferPool::BufferPool(size_t chunk_size) : chunk_size_(chunk_size) {}
+
+std::unique_ptr<ChunkedBuffer> BufferPool::acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_.empty()) {
+    return std::make_unique<ChunkedBuffer>(chunk_size_);
+  }
+  auto buffer = std::move(free_.back());
+  free_.pop_back();
+  return buffer;
+}
+
+void BufferPool::release(std::unique_ptr<ChunkedBuffer> buffer) {
+  if (!buffer) {
+    return;
+  }
+  buffer->clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_.push_back(std::move(buffer));
+}
+
+FdSink::FdSink(int fd) : fd_(fd) {}
+
+bool FdSink::write(const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t count = ::write(fd_, data, size);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += count;
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+StringSink::StringSink(std::string* out) : out_(out) {}
+
+bool StringSink::write(const char* data, size_t size) {
+  if (!out_) {
+    return false;
+  }
+  out_->append(data, size);
+  return true;
+}
+
+CEmitter::CEmitter(OutputSink* sink, std::vector<Token>* tokens) : sink_(sink), tokens_(tokens) {
+  staging_.reserve(kStagingSize);
+  ok_ = sink_ != nullptr;
+}
+
+CEmitter::~CEmitter() { flush(); }
+
+void CEmitter::keyword(std::string_view text) { emit(TokenKind::Keyword, text); }
+void CEmitter::type_name(std::string_view text) { emit(TokenKind::Type, text); }
+void CEmitter::identifier(std::string_view text) { emit(TokenKind::Identifier, text); }
+void CEmitter::function_name(std::string_view text) { emit(TokenKind::Function, text); }
+void CEmitter::literal(std::string_view text) { emit(TokenKind::Literal, text); }
+void CEmitter::comment(std::string_view text) { emit(TokenKind::Comment, text); }
+void CEmitter::op(std::string_view text) { emit(TokenKind::Operator, text); }
+void CEmitter::punct(std::string_view text) { emit(TokenKind::Punctuation, text); }
+void CEmitter::space() { emit(TokenKind::Whitespace, " "); }
+
+void CEmitter::hex_literal(uint64_t value) {
+  char buf[18];
+  char* end = buf + sizeof(buf);
+  char* p = end;
+  do {
+    *--p = kHexDigits[value & 0xf];
+    value >>= 4;
+  } while (value != 0);
+  *--p = 'x';
+  *--p = '0';
+  emit(TokenKind::Literal, std::string_view(p, static_cast<size_t>(end - p)));
+}
+
+void CEmitter::newline() {
+  emit(TokenKind::Newline, "\n");
+  at_line_start_ = true;
+}
+
+void CEmitter::open_block() {
+  punct("{");
+  newline();
+  ++indent_;
+}
+
+void CEmitter::close_block() {
+  if (indent_ > 0) {
+    --indent_;
+  }
+  punct("}");
+}
+
+void CEmitter::set_address(uint64_t address) { address_ = address; }
+
+bool CEmitter::flush() {
+  if (!staging_.empty()) {
+    if (ok_ && !sink_->write(staging_.data(), staging_.size())) {
+      ok_ = false;
+    }
+    staging_.clear();
+  }
+  if (ok_ && !sink_->flush()) {
+    ok_ = false;
+  }
+  return ok_;
+}
+
+bool CEmitter::ok() const { return ok_; }
+
+uint64_t CEmitter::bytes_written() const { return written_; }
+
+void CEmitter::emit(TokenKind kind, std::string_view text) {
+  if (!ok_ || text.empty()) {
+    return;
+  }
+  if (at_line_start_ && kind != TokenKind::Newline) {
+    at_line_start_ = false;
+    write_indent();
+  }
+  if (tokens_) {
+    Token token{};
+    token.kind = kind;
+    token.offset = written_;
+    token.length = static_cast<uint32_t>(text.size());
+    token.address = address_;
+    tokens_->push_back(token);
+  }
+  stage(text.data(), text.size());
+}
+
+void CEmitter::write_indent() {
+  static const char kSpaces[] = "                                ";
+  size_t remaining = static_cast<size_t>(indent_) * kIndentWidth;
+  if (remaining == 0) {
+    return;
+  }
+  if (tokens_) {
+    Token token{};
+    token.kind = TokenKind::Whitespace;
+    token.offset = written_;
+    token.length = static_cast<uint32_t>(remaining);
+    token.address = address_;
+    tokens_->push_back(token);
+  }
+  while (remaining > 0) {
+    size_t count = std::min(remaining, sizeof(kSpaces) - 1);
+    stage(kSpaces, count);
+    remaining -= count;
+  }
+}
+
+void CEmitter::stage(const char* data, size_t size) {
+  written_ += size;
+  if (staging_.size() + size > kStagingSize) {
+    if (!staging_.empty()) {
+      if (!sink_->write(staging_.data(), staging_.size())) {
+        ok_ = false;
+      }
+      staging_.clear();
+    }
+    if (size >= kStagingSize) {
+      if (ok_ && !sink_->write(data, size)) {
+        ok_ = false;
+      }
+      return;
+    }
+  }
+  staging_.insert(staging_.end(), data, data + size);
+}
+
+} // namespace ghirda::decompiler
@@ -2,8 +2,22 @@
 
 namespace ghirda::decompiler {
 
-DecompileResult Decompiler::decompile_function(const ghirda::core::Program&, uint64_t) {
-  return DecompileResult{"/* decompiler not implemented */", false};
+DecompileResult Decompiler::decompile_function(const ghirda::core::Program& program, uint64_t entry) {
+  DecompileResult result{};
+  StringSink sink(&result.c_code);
+  CEmitter emitter(&sink);
+  result.success = decompile_function(program, entry, &emitter);
+  emitter.flush();
+  return result;
+}
+
+bool Decompiler::decompile_function(const ghirda::core::Program&, uint64_t entry, CEmitter* emitter) {
+  if (!emitter) {
+    return false;
+  }
+  emitter->set_address(entry);
+  emitter->comment("/* decompiler not implemented */");
+  return false;
 }
 
 } // namespace ghirda::decompiler
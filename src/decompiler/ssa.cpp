@@ -5,4 +5,7 @@ namespace ghirda::decompiler {
 void SSAGraph::add_value(const SSAValue& value) { values_.push_back(value); }
 const std::vector<SSAValue>& SSAGraph::values() const { return values_; }
 
+void SSAGraph::add_op(const SSAOp& op) { ops_.push_back(op); }
+const std::vector<SSAOp>& SSAGraph::ops() const { return ops_; }
+
 } // namespace ghirda::decompiler
@@ -0,0 +1,464 @@
+#include "ghirda/decompiler/type_propagation.h"
+
+#include <utility>
+
+namespace ghirda::decompiler {
+namespace {
+
+using ghirda::core::TypeKind;
+using ghirda::sleigh::OpCode;
+
+constexpr uint32_t kNoClass = UINT32_MAX;
+constexpr int kMaxDebugChain = 16;
+constexpr int kMaxArithmeticPasses = 4;
+
+struct ClassFact {
+  TypeKind kind = TypeKind::Void;
+  std::string name;
+  uint32_t size = 0;
+  uint32_t pointee = kNoClass;
+};
+
+class UnionFind {
+public:
+  explicit UnionFind(size_t count) {
+    parent_.resize(count);
+    rank_.resize(count);
+    facts_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      parent_[i] = static_cast<uint32_t>(i);
+    }
+  }
+
+  uint32_t find(uint32_t node) {
+    while (parent_[node] != node) {
+      parent_[node] = parent_[parent_[node]];
+      node = parent_[node];
+    }
+    return node;
+  }
+
+  uint32_t add() {
+    uint32_t node = static_cast<uint32_t>(parent_.size());
+    parent_.push_back(node);
+    rank_.push_back(0);
+    facts_.emplace_back();
+    return node;
+  }
+
+  ClassFact& fact(uint32_t node) { return facts_[find(node)]; }
+
+  uint32_t pointee(uint32_t node) {
+    uint32_t root = find(node);
+    if (facts_[root].pointee == kNoClass) {
+      uint32_t target = add();
+      facts_[root].pointee = target;
+    }
+    return find(facts_[root].pointee);
+  }
+
+  void mark(uint32_t node, TypeKind kind, uint32_t size) {
+    ClassFact& f = fact(node);
+    meet_kind(&f, kind);
+    if (f.size == 0) {
+      f.size = size;
+    }
+  }
+
+  void seed(uint32_t node, TypeKind kind, const std::string& name, uint32_t size) {
+    ClassFact& f = fact(node);
+    meet_kind(&f, kind);
+    if (f.name.empty()) {
+      f.name = name;
+    } else if (!name.empty() && f.name != name) {
+      ++conflicts_;
+    }
+    if (f.size == 0) {
+      f.size = size;
+    }
+  }
+
+  // Unifies two classes and, transitively, their pointee classes. Uses an
+  // explicit work stack so deep pointer chains cannot exhaust the call stack.
+  // Facts merge into the older class (first name wins); the root is picked by
+  // rank, so with path halving finds stay near-constant.
+  void unify(uint32_t a, uint32_t b) {
+    std::vector<std::pair<uint32_t, uint32_t>> work{{a, b}};
+    while (!work.empty()) {
+      auto [x, y] = work.back();
+      work.pop_back();
+      uint32_t rx = find(x);
+      uint32_t ry = find(y);
+      if (rx == ry) {
+        continue;
+      }
+      if (rx > ry) {
+        std::swap(rx, ry);
+      }
+      ClassFact& into = facts_[rx];
+      ClassFact& from = facts_[ry];
+      meet_kind(&into, from.kind);
+      if (into.name.empty()) {
+        into.name = std::move(from.name);
+      } else if (!from.name.empty() && into.name != from.name) {
+        ++conflicts_;
+      }
+      if (into.size == 0) {
+        into.size = from.size;
+      }
+      if (into.pointee == kNoClass) {
+        into.pointee = from.pointee;
+      } else if (from.pointee != kNoClass) {
+        work.emplace_back(into.pointee, from.pointee);
+      }
+      from = ClassFact{};
+      if (rank_[rx] < rank_[ry]) {
+        parent_[rx] = ry;
+        std::swap(facts_[rx], facts_[ry]);
+      } else {
+        parent_[ry] = rx;
+        if (rank_[rx] == rank_[ry]) {
+          ++rank_[rx];
+        }
+      }
+    }
+  }
+
+  size_t conflicts() const { return conflicts_; }
+  size_t size() const { return parent_.size(); }
+
+private:
+  void meet_kind(ClassFact* fact, TypeKind kind) {
+    if (kind == TypeKind::Void || fact->kind == kind) {
+      return;
+    }
+    if (fact->kind == TypeKind::Void) {
+      fact->kind = kind;
+      return;
+    }
+    if (fact->kind == TypeKind::Integer && kind == TypeKind::Pointer) {
+      fact->kind = TypeKind::Pointer;
+      return;
+    }
+    if (fact->kind == TypeKind::Pointer && kind == TypeKind::Integer) {
+      return;
+    }
+    ++conflicts_;
+  }
+
+  std::vector<uint32_t> parent_{};
+  std::vector<uint8_t> rank_{};
+  std::vector<ClassFact> facts_{};
+  size_t conflicts_ = 0;
+};
+
+TypeKind kind_from_debug(const ghirda::core::DebugType& dt) {
+  switch (dt.kind) {
+    case ghirda::core::DebugTypeKind::Base:
+      if (dt.name.find("float") != std::string::npos || dt.name.find("double") != std::string::npos) {
+        return TypeKind::Float;
+      }
+      return TypeKind::Integer;
+    case ghirda::core::DebugTypeKind::Pointer:
+    case ghirda::core::DebugTypeKind::Subroutine:
+      return TypeKind::Pointer;
+    case ghirda::core::DebugTypeKind::Struct:
+      return TypeKind::Struct;
+    case ghirda::core::DebugTypeKind::Union:
+      return TypeKind::Union;
+    case ghirda::core::DebugTypeKind::Array:
+      return TypeKind::Array;
+    case ghirda::core::DebugTypeKind::Enumeration:
+      return TypeKind::Integer;
+    default:
+      return TypeKind::Void;
+  }
+}
+
+std::string undefined_name(uint32_t size) { return "undefined" + std::to_string(size); }
+
+} // namespace
+
+TypePropagator::TypePropagator(const ghirda::core::Program& program) : program_(program) {
+  for (const auto& dt : program.debug_info().types) {
+    if (dt.die_offset != 0) {
+      debug_types_.emplace(dt.die_offset, &dt);
+    }
+  }
+
+  for (const auto& func : program.debug_info().functions) {
+    if (func.low_pc == 0 || func.return_type_ref == 0) {
+      continue;
+    }
+    SeedType seed = seed_from_debug(func.return_type_ref);
+    if (seed.kind != TypeKind::Void) {
+      return_types_.emplace(func.low_pc, std::move(seed));
+    }
+  }
+
+  for (const auto& sym : program.symbols()) {
+    if (sym.kind == ghirda::core::SymbolKind::External) {
+      import_slots_.insert(sym.address);
+      continue;
+    }
+    if (sym.kind != ghirda::core::SymbolKind::Data) {
+      continue;
+    }
+    const ghirda::core::Type* type = program.types().find(sym.name + "_t");
+    if (!type) {
+      continue;
+    }
+    SeedType seed{};
+    seed.kind = type->kind;
+    seed.name = type->name;
+    seed.size = type->size;
+    data_types_.emplace(sym.address, std::move(seed));
+  }
+}
+
+void TypePropagator::set_use_debug_info(bool enabled) { use_debug_info_ = enabled; }
+
+TypePropagator::SeedType TypePropagator::seed_from_debug(uint64_t type_ref) const {
+  SeedType seed{};
+  auto it = debug_types_.find(type_ref);
+  if (it == debug_types_.end()) {
+    return seed;
+  }
+  const ghirda::core::DebugType* dt = it->second;
+  seed.name = dt->name;
+  seed.size = dt->size;
+
+  for (int depth = 0; dt && depth < kMaxDebugChain; ++depth) {
+    bool qualifier = dt->kind == ghirda::core::DebugTypeKind::Typedef ||
+                     dt->kind == ghirda::core::DebugTypeKind::Const ||
+                     dt->kind == ghirda::core::DebugTypeKind::Volatile;
+    if (!qualifier) {
+      seed.kind = kind_from_debug(*dt);
+      if (seed.size == 0) {
+        seed.size = dt->size;
+      }
+      break;
+    }
+    if (seed.size == 0) {
+      seed.size = dt->size;
+    }
+    auto next = debug_types_.find(dt->type_ref);
+    dt = next == debug_types_.end() ? nullptr : next->second;
+  }
+  return seed;
+}
+
+bool TypePropagator::run(const SSAGraph& graph, TypePropagationResult* out, std::string* error) const {
+  if (!out) {
+    if (error) {
+      *error = "type propagation output is null";
+    }
+    return false;
+  }
+
+  const auto& values = graph.values();
+  const size_t value_count = values.size();
+
+  bool dense = true;
+  for (size_t i = 0; i < value_count; ++i) {
+    if (values[i].id != i) {
+      dense = false;
+      break;
+    }
+  }
+  std::unordered_map<uint64_t, uint32_t> index;
+  if (!dense) {
+    index.reserve(value_count);
+    for (size_t i = 0; i < value_count; ++i) {
+      index.emplace(values[i].id, static_cast<uint32_t>(i));
+    }
+  }
+  auto node_of = [&](uint64_t id) -> uint32_t {
+    if (dense) {
+      return id < value_count ? static_cast<uint32_t>(id) : kNoClass;
+    }
+    auto it = index.find(id);
+    return it == index.end() ? kNoClass : it->second;
+  };
+
+  UnionFind uf(value_count);
+  size_t seeded = 0;
+
+  for (size_t i = 0; i < value_count; ++i) {
+    if (values[i].is_constant) {
+      uf.mark(static_cast<uint32_t>(i), TypeKind::Integer, values[i].size);
+    }
+  }
+
+  auto constant_of = [&](uint32_t node, uint64_t* value) {
+    if (node == kNoClass || !values[node].is_constant) {
+      return false;
+    }
+    *value = values[node].constant;
+    return true;
+  };
+
+  std::vector<const SSAOp*> arithmetic;
+  for (const auto& op : graph.ops()) {
+    const uint32_t output = op.output == kNoSSAValue ? kNoClass : node_of(op.output);
+    const uint32_t in0 = op.inputs.empty() ? kNoClass : node_of(op.inputs[0]);
+    const uint32_t in1 = op.inputs.size() < 2 ? kNoClass : node_of(op.inputs[1]);
+
+    switch (op.opcode) {
+      case OpCode::Copy:
+        if (output != kNoClass && in0 != kNoClass && !values[in0].is_constant) {
+          uf.unify(output, in0);
+        }
+        break;
+      case OpCode::MultiEqual:
+        if (output == kNoClass) {
+          break;
+        }
+        for (uint64_t input : op.inputs) {
+          uint32_t node = node_of(input);
+          if (node != kNoClass && !values[node].is_constant) {
+            uf.unify(output, node);
+          }
+        }
+        break;
+      case OpCode::Load: {
+        if (in0 == kNoClass) {
+          break;
+        }
+        uf.mark(in0, TypeKind::Pointer, values[in0].size);
+        uint32_t target = uf.pointee(in0);
+        if (output != kNoClass) {
+          uf.unify(target, output);
+        }
+        uint64_t address = 0;
+        if (constant_of(in0, &address)) {
+          auto data = use_debug_info_ ? data_types_.find(address) : data_types_.end();
+          if (data != data_types_.end()) {
+            uf.seed(target, data->second.kind, data->second.name, data->second.size);
+            ++seeded;
+          } else if (output != kNoClass && import_slots_.count(address) != 0) {
+            uf.seed(output, TypeKind::Pointer, "code*", values[output].size);
+            ++seeded;
+          }
+        }
+        break;
+      }
+      case OpCode::Store: {
+        if (in0 == kNoClass) {
+          break;
+        }
+        uf.mark(in0, TypeKind::Pointer, values[in0].size);
+        uint32_t target = uf.pointee(in0);
+        if (in1 != kNoClass && !values[in1].is_constant) {
+          uf.unify(target, in1);
+        }
+        uint64_t address = 0;
+        if (use_debug_info_ && constant_of(in0, &address)) {
+          auto data = data_types_.find(address);
+          if (data != data_types_.end()) {
+            uf.seed(target, data->second.kind, data->second.name, data->second.size);
+            ++seeded;
+          }
+        }
+        break;
+      }
+      case OpCode::PtrAdd:
+        if (in0 != kNoClass) {
+          uf.mark(in0, TypeKind::Pointer, values[in0].size);
+          if (output != kNoClass) {
+            uf.unify(output, in0);
+          }
+        }
+        break;
+      case OpCode::PtrSub:
+        if (in0 != kNoClass) {
+          uf.mark(in0, TypeKind::Pointer, values[in0].size);
+        }
+        if (output != kNoClass) {
+          uf.mark(output, TypeKind::Pointer, values[output].size);
+        }
+        break;
+      case OpCode::IntAdd:
+      case OpCode::IntSub:
+        if (output != kNoClass) {
+          arithmetic.push_back(&op);
+        }
+        break;
+      case OpCode::Call: {
+        uint64_t target = 0;
+        if (use_debug_info_ && output != kNoClass && constant_of(in0, &target)) {
+          auto ret = return_types_.find(target);
+          if (ret != return_types_.end()) {
+            uf.seed(output, ret->second.kind, ret->second.name, ret->second.size);
+            ++seeded;
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // Pointer arithmetic through plain integer adds only resolves once one side
+  // is known to be a pointer; revisit the pending adds a bounded number of times.
+  for (int pass = 0; pass < kMaxArithmeticPasses && !arithmetic.empty(); ++pass) {
+    size_t kept = 0;
+    for (const SSAOp* op : arithmetic) {
+      uint32_t output = node_of(op->output);
+      uint32_t pointer = kNoClass;
+      for (uint64_t input : op->inputs) {
+        uint32_t node = node_of(input);
+        if (node != kNoClass && !values[node].is_constant && uf.fact(node).kind == TypeKind::Pointer) {
+          pointer = node;
+          break;
+        }
+      }
+      if (pointer != kNoClass) {
+        uf.unify(output, pointer);
+      } else {
+        arithmetic[kept++] = op;
+      }
+    }
+    if (kept == arithmetic.size()) {
+      break;
+    }
+    arithmetic.resize(kept);
+  }
+
+  out->types.assign(value_count, InferredType{});
+  std::vector<uint8_t> seen_root(uf.size(), 0);
+  size_t class_count = 0;
+  for (size_t i = 0; i < value_count; ++i) {
+    const uint32_t root = uf.find(static_cast<uint32_t>(i));
+    if (!seen_root[root]) {
+      seen_root[root] = 1;
+      ++class_count;
+    }
+    const ClassFact& fact = uf.fact(root);
+    InferredType& inferred = out->types[i];
+    inferred.size = values[i].size != 0 ? values[i].size : fact.size;
+    inferred.kind = fact.kind;
+    if (fact.kind == TypeKind::Pointer && fact.name.empty()) {
+      std::string base = "void";
+      if (fact.pointee != kNoClass) {
+        const ClassFact& target = uf.fact(fact.pointee);
+        if (!target.name.empty()) {
+          base = target.name;
+        }
+      }
+      inferred.name = base + "*";
+    } else if (!fact.name.empty()) {
+      inferred.name = fact.name;
+    } else {
+      inferred.name = undefined_name(inferred.size);
+    }
+  }
+
+  out->stats.classes = class_count;
+  out->stats.seeded = seeded;
+  out->stats.conflicts = uf.conflicts();
+  return true;
+}
+
+} // namespace ghirda::decompiler
@@ -0,0 +1,410 @@
+#include "ghirda/loader/byte_source.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ghirda::loader {
+namespace {
+
+constexpr size_t kCStringChunk = 256;
+
+bool open_fd(const std::string& path, int* fd, uint64_t* size, std::string* error) {
+  *fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (*fd < 0) {
+    if (error) {
+      *error = "failed to open file";
+    }
+    return false;
+  }
+  struct stat st{};
+  if (::fstat(*fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(*fd);
+    *fd = -1;
+    if (error) {
+      *error = "failed to stat file";
+    }
+    return false;
+  }
+  *size = static_cast<uint64_t>(st.st_size);
+  return true;
+}
+
+template <typename T>
+T byteswap_value(T value) {
+  if constexpr (sizeof(T) == 1) {
+    return value;
+  } else if constexpr (sizeof(T) == 2) {
+    return static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(value)));
+  } else if constexpr (sizeof(T) == 4) {
+    return static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(value)));
+  } else {
+    return static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(value)));
+  }
+}
+
+} // namespace
+
+ByteView::ByteView(const uint8_t* data, size_t size, std::shared_ptr<const void> owner)
+    : data_(data), size_(size), owner_(std::move(owner)) {}
+
+const uint8_t* ByteView::data() const { return data_; }
+size_t ByteView::size() const { return size_; }
+bool ByteView::empty() const { return size_ == 0; }
+std::span<const uint8_t> ByteView::span() const { return {data_, size_}; }
+const std::shared_ptr<const void>& ByteView::owner() const { return owner_; }
+uint8_t ByteView::operator[](size_t index) const { return data_[index]; }
+
+bool ByteView::subview(uint64_t offset, uint64_t size, ByteView* out) const {
+  if (offset > size_ || size > size_ - offset) {
+    return false;
+  }
+  *out = ByteView(data_ + offset, static_cast<size_t>(size), owner_);
+  return true;
+}
+
+bool ByteSource::contains(uint64_t offset, uint64_t size) const {
+  const uint64_t total = this->size();
+  return offset <= total && size <= total - offset;
+}
+
+const std::string& ByteSource::path() const { return path_; }
+
+bool ByteSource::read_blob(uint64_t offset, uint64_t size, std::vector<uint8_t>* out) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  out->resize(static_cast<size_t>(size));
+  if (size == 0) {
+    return true;
+  }
+  return read(offset, out->data(), static_cast<size_t>(size));
+}
+
+bool ByteSource::read_cstring(uint64_t offset, std::string* out, size_t max_length) const {
+  out->clear();
+  const uint64_t total = size();
+  while (offset < total && out->size() < max_length) {
+    uint64_t chunk = std::min<uint64_t>({kCStringChunk, total - offset, max_length - out->size()});
+    ByteView window;
+    if (!view(offset, chunk, &window)) {
+      return false;
+    }
+    const void* nul = std::memchr(window.data(), 0, window.size());
+    if (nul) {
+      out->append(reinterpret_cast<const char*>(window.data()),
+                  static_cast<const uint8_t*>(nul) - window.data());
+      return true;
+    }
+    out->append(reinterpret_cast<const char*>(window.data()), window.size());
+    offset += chunk;
+  }
+  return !out->empty();
+}
+
+MemoryByteSource::MemoryByteSource(std::vector<uint8_t> bytes)
+    : bytes_(std::make_shared<const std::vector<uint8_t>>(std::move(bytes))) {}
+
+MemoryByteSource::MemoryByteSource(std::shared_ptr<const std::vector<uint8_t>> bytes)
+    : bytes_(std::move(bytes)) {}
+
+uint64_t MemoryByteSource::size() const { return bytes_ ? bytes_->size() : 0; }
+
+bool MemoryByteSource::read(uint64_t offset, void* out, size_t size) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  if (size != 0) {
+    std::memcpy(out, bytes_->data() + offset, size);
+  }
+  return true;
+}
+
+bool MemoryByteSource::view(uint64_t offset, uint64_t size, ByteView* out) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  *out = ByteView(bytes_->data() + offset, static_cast<size_t>(size), bytes_);
+  return true;
+}
+
+struct MmapByteSource::Mapping {
+  const uint8_t* data = nullptr;
+  uint64_t size = 0;
+
+  ~Mapping() {
+    if (data && size != 0) {
+      ::munmap(const_cast<uint8_t*>(data), static_cast<size_t>(size));
+    }
+  }
+};
+
+MmapByteSource::MmapByteSource(std::shared_ptr<const Mapping> mapping) : mapping_(std::move(mapping)) {}
+
+std::unique_ptr<MmapByteSource> MmapByteSource::open(const std::string& path, std::string* error) {
+  int fd = -1;
+  uint64_t size = 0;
+  if (!open_fd(path, &fd, &size, error)) {
+    return nullptr;
+  }
+  auto mapping = std::make_shared<Mapping>();
+  mapping->size = size;
+  if (size != 0) {
+    void* addr = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      if (error) {
+        *error = "failed to map file";
+      }
+      return nullptr;
+    }
+    mapping->data = static_cast<const uint8_t*>(addr);
+  }
+  ::close(fd);
+  std::unique_ptr<MmapByteSource> source(new MmapByteSource(std::move(mapping)));
+  source->path_ = path;
+  return source;
+}
+
+uint64_t MmapByteSource::size() const { return mapping_->size; }
+
+bool MmapByteSource::read(uint64_t offset, void* out, size_t size) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  if (size != 0) {
+    std::memcpy(out, mapping_->data + offset, size);
+  }
+  return true;
+}
+
+bool MmapByteSource::view(uint64_t offset, uint64_t size, ByteView* out) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  *out = ByteView(mapping_->data + offset, static_cast<size_t>(size), mapping_);
+  return true;
+}
+
+PreadByteSource::PreadByteSource(int fd, uint64_t size, size_t readahead)
+    : fd_(fd), size_(size), readahead_(std::max<size_t>(readahead, 4096)) {}
+
+PreadByteSource::~PreadByteSource() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+std::unique_ptr<PreadByteSource> PreadByteSource::open(const std::string& path, std::string* error,
+                                                       size_t readahead) {
+  int fd = -1;
+  uint64_t size = 0;
+  if (!open_fd(path, &fd, &size, error)) {
+    return nullptr;
+  }
+  std::unique_ptr<PreadByteSource> source(new PreadByteSource(fd, size, readahead));
+  source->path_ = path;
+  return source;
+}
+
+uint64_t PreadByteSource::size() const { return size_; }
+
+bool PreadByteSource::pread_exact(uint64_t offset, void* out, size_t size) const {
+  auto* dst = static_cast<uint8_t*>(out);
+  while (size > 0) {
+    ssize_t count = ::pread(fd_, dst, size, static_cast<off_t>(offset));
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (count == 0) {
+      return false;
+    }
+    dst += count;
+    offset += static_cast<uint64_t>(count);
+    size -= static_cast<size_t>(count);
+  }
+  return true;
+}
+
+std::shared_ptr<const PreadByteSource::Block> PreadByteSource::block_for(uint64_t offset, uint64_t size) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (block_ && offset >= block_->offset && offset + size <= block_->offset + block_->bytes.size()) {
+    return block_;
+  }
+  auto block = std::make_shared<Block>();
+  block->offset = offset;
+  block->bytes.resize(static_cast<size_t>(std::min<uint64_t>(readahead_, size_ - offset)));
+  if (!pread_exact(offset, block->bytes.data(), block->bytes.size())) {
+    return nullptr;
+  }
+  block_ = block;
+  return block_;
+}
+
+bool PreadByteSource::read(uint64_t offset, void* out, size_t size) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  if (size == 0) {
+    return true;
+  }
+  if (size >= readahead_) {
+    return pread_exact(offset, out, size);
+  }
+  auto block = block_for(offset, size);
+  if (!block) {
+    return false;
+  }
+  std::memcpy(out, block->bytes.data() + (offset - block->offset), size);
+  return true;
+}
+
+bool PreadByteSource::view(uint64_t offset, uint64_t size, ByteView* out) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  if (size < readahead_) {
+    auto block = block_for(offset, size);
+    if (!block) {
+      return false;
+    }
+    *out = ByteView(block->bytes.data() + (offset - block->offset), static_cast<size_t>(size), block);
+    return true;
+  }
+  auto owned = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+  if (!pread_exact(offset, owned->data(), owned->size())) {
+    return false;
+  }
+  *out = ByteView(owned->data(), owned->size(), owned);
+  return true;
+}
+
+SubByteSource::SubByteSource(const ByteSource& parent, uint64_t base, uint64_t size)
+    : parent_(parent),
+      base_(std::min(base, parent.size())),
+      size_(std::min(size, parent.size() - std::min(base, parent.size()))) {
+  path_ = parent.path();
+}
+
+uint64_t SubByteSource::base() const { return base_; }
+uint64_t SubByteSource::size() const { return size_; }
+
+bool SubByteSource::read(uint64_t offset, void* out, size_t size) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  return parent_.read(base_ + offset, out, size);
+}
+
+bool SubByteSource::view(uint64_t offset, uint64_t size, ByteView* out) const {
+  if (!contains(offset, size)) {
+    return false;
+  }
+  return parent_.view(base_ + offset, size, out);
+}
+
+std::shared_ptr<ByteSource> open_byte_source(const std::string& path, std::string* error) {
+  std::string mmap_error;
+  if (auto source = MmapByteSource::open(path, &mmap_error)) {
+    return source;
+  }
+  return PreadByteSource::open(path, error);
+}
+
+ByteReader::ByteReader(ByteView view, Endian endian) : view_(std::move(view)), endian_(endian) {}
+
+uint64_t ByteReader::offset() const { return offset_; }
+uint64_t ByteReader::remaining() const { return view_.size() - offset_; }
+
+bool ByteReader::seek(uint64_t offset) {
+  if (offset > view_.size()) {
+    return false;
+  }
+  offset_ = offset;
+  return true;
+}
+
+bool ByteReader::skip(uint64_t count) {
+  if (count > remaining()) {
+    return false;
+  }
+  offset_ += count;
+  return true;
+}
+
+void ByteReader::set_endian(Endian endian) { endian_ = endian; }
+Endian ByteReader::endian() const { return endian_; }
+
+template <typename T>
+bool ByteReader::read_integer(T* value) {
+  if (sizeof(T) > remaining()) {
+    return false;
+  }
+  T raw{};
+  std::memcpy(&raw, view_.data() + offset_, sizeof(T));
+  const bool host_little = std::endian::native == std::endian::little;
+  if ((endian_ == Endian::Little) != host_little) {
+    raw = byteswap_value(raw);
+  }
+  *value = raw;
+  offset_ += sizeof(T);
+  return true;
+}
+
+bool ByteReader::read_u8(uint8_t* value) { return read_integer(value); }
+bool ByteReader::read_u16(uint16_t* value) { return read_integer(value); }
+bool ByteReader::read_u32(uint32_t* value) { return read_integer(value); }
+bool ByteReader::read_u64(uint64_t* value) { return read_integer(value); }
+
+bool ByteReader::read_bytes(void* out, size_t size) {
+  if (size > remaining()) {
+    return false;
+  }
+  if (size != 0) {
+    std::memcpy(out, view_.data() + offset_, size);
+  }
+  offset_ += size;
+  return true;
+}
+
+bool ByteReader::read_view(uint64_t size, ByteView* out) {
+  if (!view_.subview(offset_, size, out)) {
+    return false;
+  }
+  offset_ += size;
+  return true;
+}
+
+bool ByteReader::read_cstring(std::string* out) {
+  if (remaining() == 0) {
+    return false;
+  }
+  const uint8_t* start = view_.data() + offset_;
+  const void* nul = std::memchr(start, 0, static_cast<size_t>(remaining()));
+  if (!nul) {
+    return false;
+  }
+  size_t length = static_cast<const uint8_t*>(nul) - start;
+  out->assign(reinterpret_cast<const char*>(start), length);
+  offset_ += length + 1;
+  return true;
+}
+
+std::string read_string(const ByteView& table, uint64_t offset) {
+  if (offset >= table.size()) {
+    return {};
+  }
+  const char* start = reinterpret_cast<const char*>(table.data() + offset);
+  return std::string(start, strnlen(start, static_cast<size_t>(table.size() - offset)));
+}
+
+} // namespace ghirda::loader
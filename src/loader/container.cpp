@@ -0,0 +1,825 @@
+#include "ghirda/loader/container.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+#if defined(GHIRDA_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace ghirda::loader {
+namespace {
+
+constexpr char kArMagic[] = "!<arch>\n";
+constexpr char kArThinMagic[] = "!<thin>\n";
+constexpr size_t kArMagicSize = 8;
+constexpr size_t kArHeaderSize = 60;
+
+constexpr uint32_t kZipLocalHeader = 0x04034b50;
+constexpr uint32_t kZipCentralHeader = 0x02014b50;
+constexpr uint32_t kZipEndOfDirectory = 0x06054b50;
+constexpr uint32_t kZip64EndOfDirectory = 0x06064b50;
+constexpr uint32_t kZip64Locator = 0x07064b50;
+constexpr uint16_t kZip64ExtraId = 0x0001;
+constexpr size_t kZipEndSize = 22;
+constexpr size_t kZipLocatorSize = 20;
+constexpr size_t kZipLocalSize = 30;
+constexpr size_t kZipMaxComment = 0xffff;
+constexpr uint16_t kZipFlagEncrypted = 0x1;
+constexpr uint16_t kZipMethodStored = 0;
+constexpr uint16_t kZipMethodDeflate = 8;
+
+constexpr size_t kCpioNewcHeaderSize = 110;
+constexpr size_t kCpioOdcHeaderSize = 76;
+constexpr uint64_t kCpioTypeMask = 0170000;
+constexpr uint64_t kCpioTypeRegular = 0100000;
+constexpr char kCpioTrailer[] = "TRAILER!!!";
+
+constexpr uint64_t kIsoSystemArea = 16 * 2048;
+constexpr size_t kIsoDescriptorSize = 2048;
+constexpr uint8_t kIsoPrimaryVolume = 1;
+constexpr uint8_t kIsoTerminator = 255;
+constexpr size_t kIsoRootRecord = 156;
+constexpr size_t kIsoRecordMin = 34;
+constexpr uint8_t kIsoFlagDirectory = 0x02;
+constexpr uint8_t kIsoFlagMultiExtent = 0x80;
+constexpr size_t kIsoMaxDepth = 64;
+
+// deflate cannot expand better than ~1032:1.
+constexpr uint64_t kMaxExpansion = 1032;
+constexpr uint64_t kExpansionSlack = 1 << 20;
+
+void set_error(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+uint64_t align_up(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+bool parse_number(std::string_view text, unsigned base, uint64_t* out) {
+  while (!text.empty() && text.back() == ' ') {
+    text.remove_suffix(1);
+  }
+  if (text.empty()) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (char c : text) {
+    unsigned digit = 0;
+    if (c >= '0' && c <= '9') {
+      digit = static_cast<unsigned>(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      digit = static_cast<unsigned>(c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'F') {
+      digit = static_cast<unsigned>(c - 'A' + 10);
+    } else {
+      return false;
+    }
+    if (digit >= base || value > (UINT64_MAX - digit) / base) {
+      return false;
+    }
+    value = value * base + digit;
+  }
+  *out = value;
+  return true;
+}
+
+std::string_view field(const ByteView& header, size_t offset, size_t size) {
+  return std::string_view(reinterpret_cast<const char*>(header.data()) + offset, size);
+}
+
+bool is_gzip(const ByteSource& source, uint64_t offset = 0) {
+  uint8_t magic[3] = {};
+  return source.read(offset, magic, sizeof(magic)) && magic[0] == 0x1f && magic[1] == 0x8b && magic[2] == 8;
+}
+
+// First non-zero byte at or after offset, or the source size.
+uint64_t skip_zeros(const ByteSource& source, uint64_t offset) {
+  uint8_t chunk[4096];
+  while (offset < source.size()) {
+    const size_t size = static_cast<size_t>(std::min<uint64_t>(sizeof(chunk), source.size() - offset));
+    if (!source.read(offset, chunk, size)) {
+      return source.size();
+    }
+    uint8_t* end = chunk + size;
+    uint8_t* hit = std::find_if(chunk, end, [](uint8_t b) { return b != 0; });
+    offset += static_cast<uint64_t>(hit - chunk);
+    if (hit != end) {
+      break;
+    }
+  }
+  return offset;
+}
+
+bool iso_primary_volume(const ByteSource& source, uint64_t* offset) {
+  // Volume descriptors follow the system area until a terminator; the
+  // primary one is normally first.
+  for (uint64_t at = kIsoSystemArea; at + kIsoDescriptorSize <= source.size(); at += kIsoDescriptorSize) {
+    uint8_t head[6] = {};
+    if (!source.read(at, head, sizeof(head)) || std::memcmp(head + 1, "CD001", 5) != 0) {
+      return false;
+    }
+    if (head[0] == kIsoPrimaryVolume) {
+      *offset = at;
+      return true;
+    }
+    if (head[0] == kIsoTerminator) {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool list_ar(const ByteSource& source, std::vector<ContainerMember>* out, std::string* error) {
+  ByteView long_names;
+  uint64_t offset = kArMagicSize;
+  while (offset + kArHeaderSize <= source.size()) {
+    ByteView header;
+    uint64_t size = 0;
+    if (!source.view(offset, kArHeaderSize, &header) || field(header, 58, 2) != "`\n" ||
+        !parse_number(field(header, 48, 10), 10, &size) || size > source.size() - offset - kArHeaderSize) {
+      set_error(error, "malformed ar member header");
+      return false;
+    }
+    const uint64_t next = offset + kArHeaderSize + size + (size & 1);
+    ContainerMember member;
+    member.offset = offset + kArHeaderSize;
+    member.size = size;
+    std::string_view name = field(header, 0, 16);
+    while (!name.empty() && name.back() == ' ') {
+      name.remove_suffix(1);
+    }
+
+    uint64_t value = 0;
+    if (name == "//") {
+      // GNU long-name table: "name/\n" entries referenced as "/<offset>".
+      source.view(member.offset, size, &long_names);
+      offset = next;
+      continue;
+    }
+    if (name.size() > 1 && name[0] == '/' && parse_number(name.substr(1), 10, &value)) {
+      if (value >= long_names.size()) {
+        set_error(error, "ar long name out of range");
+        return false;
+      }
+      const char* begin = reinterpret_cast<const char*>(long_names.data()) + value;
+      const size_t limit = long_names.size() - static_cast<size_t>(value);
+      size_t length = 0;
+      while (length < limit && begin[length] != '\n' && !(begin[length] == '/' && length + 1 < limit &&
+                                                           begin[length + 1] == '\n')) {
+        ++length;
+      }
+      member.name.assign(begin, length);
+    } else if (name.size() > 3 && name.substr(0, 3) == "#1/" && parse_number(name.substr(3), 10, &value)) {
+      // BSD: the name is stored at the start of the member data.
+      ByteView stored;
+      if (value > size || !source.view(member.offset, value, &stored)) {
+        set_error(error, "ar BSD name out of range");
+        return false;
+      }
+      member.name.assign(reinterpret_cast<const char*>(stored.data()), stored.size());
+      member.name.erase(std::find(member.name.begin(), member.name.end(), '\0'), member.name.end());
+      member.offset += value;
+      member.size -= value;
+    } else {
+      if (name.size() > 1 && name.back() == '/') {
+        name.remove_suffix(1);
+      }
+      member.name.assign(name);
+    }
+    offset = next;
+
+    // Symbol indexes: GNU "/" and "/SYM64/", BSD "__.SYMDEF*".
+    if (member.name.empty() || member.name == "/" || member.name == "/SYM64/" ||
+        member.name.rfind("__.SYMDEF", 0) == 0) {
+      continue;
+    }
+    member.stored_size = member.size;
+    out->push_back(std::move(member));
+  }
+  return true;
+}
+
+bool zip64_fields(ByteReader extra, bool need_size, bool need_stored, bool need_offset, uint64_t* size,
+                  uint64_t* stored, uint64_t* local) {
+  while (extra.remaining() >= 4) {
+    uint16_t id = 0;
+    uint16_t length = 0;
+    extra.read_u16(&id);
+    extra.read_u16(&length);
+    if (id != kZip64ExtraId) {
+      if (!extra.skip(length)) {
+        return false;
+      }
+      continue;
+    }
+    // Only the fields whose 32-bit slots overflowed are present, in order.
+    return (!need_size || extra.read_u64(size)) && (!need_stored || extra.read_u64(stored)) &&
+           (!need_offset || extra.read_u64(local));
+  }
+  return !need_size && !need_stored && !need_offset;
+}
+
+bool list_zip(const ByteSource& source, std::vector<ContainerMember>* out, std::string* error) {
+  const uint64_t size = source.size();
+  if (size < kZipEndSize) {
+    set_error(error, "zip end of central directory not found");
+    return false;
+  }
+  const uint64_t tail_size = std::min<uint64_t>(size, kZipEndSize + kZipMaxComment);
+  ByteView tail;
+  if (!source.view(size - tail_size, tail_size, &tail)) {
+    set_error(error, "failed to read zip directory");
+    return false;
+  }
+  uint64_t end = UINT64_MAX;
+  for (size_t at = tail.size() - kZipEndSize + 1; at-- > 0;) {
+    const uint32_t word = static_cast<uint32_t>(tail[at]) | static_cast<uint32_t>(tail[at + 1]) << 8 |
+                          static_cast<uint32_t>(tail[at + 2]) << 16 | static_cast<uint32_t>(tail[at + 3]) << 24;
+    if (word == kZipEndOfDirectory) {
+      end = size - tail_size + at;
+      break;
+    }
+  }
+  if (end == UINT64_MAX) {
+    set_error(error, "zip end of central directory not found");
+    return false;
+  }
+
+  ByteView record;
+  source.view(end, kZipEndSize, &record);
+  ByteReader reader(record);
+  uint32_t signature = 0;
+  uint16_t entries16 = 0;
+  uint32_t directory_size32 = 0;
+  uint32_t directory_offset32 = 0;
+  reader.read_u32(&signature);
+  reader.skip(6);
+  reader.read_u16(&entries16);
+  reader.read_u32(&directory_size32);
+  reader.read_u32(&directory_offset32);
+  uint64_t entries = entries16;
+  uint64_t directory_size = directory_size32;
+  uint64_t directory_offset = directory_offset32;
+
+  ByteView locator;
+  if ((entries16 == 0xffff || directory_size32 == UINT32_MAX || directory_offset32 == UINT32_MAX) &&
+      end >= kZipLocatorSize && source.view(end - kZipLocatorSize, kZipLocatorSize, &locator)) {
+    ByteReader locator_reader(locator);
+    uint64_t end64 = 0;
+    locator_reader.read_u32(&signature);
+    locator_reader.skip(4);
+    locator_reader.read_u64(&end64);
+    ByteView record64;
+    if (signature == kZip64Locator && source.view(end64, 56, &record64)) {
+      ByteReader reader64(record64);
+      reader64.read_u32(&signature);
+      reader64.skip(28);
+      if (signature == kZip64EndOfDirectory) {
+        reader64.read_u64(&entries);
+        reader64.read_u64(&directory_size);
+        reader64.read_u64(&directory_offset);
+      }
+    }
+  }
+
+  ByteView directory;
+  if (!source.view(directory_offset, directory_size, &directory)) {
+    set_error(error, "zip central directory out of bounds");
+    return false;
+  }
+  ByteReader entry(directory);
+  out->reserve(std::min<uint64_t>(entries, directory_size / 46));
+  for (uint64_t i = 0; i < entries; ++i) {
+    uint16_t flags = 0;
+    uint16_t method = 0;
+    uint32_t stored32 = 0;
+    uint32_t size32 = 0;
+    uint16_t name_length = 0;
+    uint16_t extra_length = 0;
+    uint16_t comment_length = 0;
+    uint32_t local32 = 0;
+    ByteView name;
+    ByteView extra;
+    if (!entry.read_u32(&signature) || signature != kZipCentralHeader || !entry.skip(4) || !entry.read_u16(&flags) ||
+        !entry.read_u16(&method) || !entry.skip(8) || !entry.read_u32(&stored32) || !entry.read_u32(&size32) ||
+        !entry.read_u16(&name_length) || !entry.read_u16(&extra_length) || !entry.read_u16(&comment_length) ||
+        !entry.skip(8) || !entry.read_u32(&local32) || !entry.read_view(name_length, &name) ||
+        !entry.read_view(extra_length, &extra) || !entry.skip(comment_length)) {
+      set_error(error, "malformed zip central directory entry");
+      return false;
+    }
+    ContainerMember member;
+    member.name.assign(reinterpret_cast<const char*>(name.data()), name.size());
+    if (member.name.empty() || member.name.back() == '/') {
+      continue;
+    }
+    member.size = size32;
+    member.stored_size = stored32;
+    uint64_t local = local32;
+    if (!zip64_fields(ByteReader(extra), size32 == UINT32_MAX, stored32 == UINT32_MAX, local32 == UINT32_MAX,
+                      &member.size, &member.stored_size, &local)) {
+      set_error(error, "malformed zip64 extra field: " + member.name);
+      return false;
+    }
+
+    ByteView local_header;
+    if (!source.view(local, kZipLocalSize, &local_header)) {
+      set_error(error, "zip local header out of bounds: " + member.name);
+      return false;
+    }
+    ByteReader local_reader(local_header);
+    uint16_t local_name = 0;
+    uint16_t local_extra = 0;
+    local_reader.read_u32(&signature);
+    local_reader.seek(26);
+    local_reader.read_u16(&local_name);
+    local_reader.read_u16(&local_extra);
+    member.offset = local + kZipLocalSize + local_name + local_extra;
+    if (signature != kZipLocalHeader || !source.contains(member.offset, member.stored_size)) {
+      set_error(error, "zip member out of bounds: " + member.name);
+      return false;
+    }
+    if (flags & kZipFlagEncrypted) {
+      member.compression = MemberCompression::Unsupported;
+    } else if (method == kZipMethodStored) {
+      member.compression = MemberCompression::Stored;
+    } else if (method == kZipMethodDeflate) {
+      member.compression = MemberCompression::Deflate;
+    } else {
+      member.compression = MemberCompression::Unsupported;
+    }
+    out->push_back(std::move(member));
+  }
+  return true;
+}
+
+#if defined(GHIRDA_HAVE_ZLIB)
+bool inflate_stream(const uint8_t* data, size_t size, int window_bits, std::vector<uint8_t>* out,
+                    bool exact_size, std::string* error);
+#endif
+
+// Members of source are tagged with part for Container::open_member().
+// Archives that follow a trailer are listed too, as in early-microcode
+// initramfs images: zero padding is skipped, and a gzip-compressed archive
+// is inflated into a new entry of parts and listed as the next part.
+bool list_cpio(const ByteSource& source, uint32_t part, std::vector<ContainerMember>* out,
+               std::vector<std::shared_ptr<const ByteSource>>* parts, std::string* error) {
+  uint64_t offset = 0;
+  while (offset < source.size()) {
+    ByteView header;
+    uint64_t mode = 0;
+    uint64_t name_size = 0;
+    uint64_t file_size = 0;
+    uint64_t name_offset = 0;
+    uint64_t data = 0;
+    uint64_t next = 0;
+    if (source.view(offset, kCpioNewcHeaderSize, &header) &&
+        (field(header, 0, 6) == "070701" || field(header, 0, 6) == "070702")) {
+      if (!parse_number(field(header, 14, 8), 16, &mode) || !parse_number(field(header, 54, 8), 16, &file_size) ||
+          !parse_number(field(header, 94, 8), 16, &name_size)) {
+        set_error(error, "malformed cpio header");
+        return false;
+      }
+      name_offset = offset + kCpioNewcHeaderSize;
+      data = align_up(name_offset + name_size, 4);
+      next = align_up(data + file_size, 4);
+    } else if (source.view(offset, kCpioOdcHeaderSize, &header) && field(header, 0, 6) == "070707") {
+      if (!parse_number(field(header, 18, 6), 8, &mode) || !parse_number(field(header, 59, 6), 8, &name_size) ||
+          !parse_number(field(header, 65, 11), 8, &file_size)) {
+        set_error(error, "malformed cpio header");
+        return false;
+      }
+      name_offset = offset + kCpioOdcHeaderSize;
+      data = name_offset + name_size;
+      next = data + file_size;
+    } else {
+      set_error(error, "malformed cpio header");
+      return false;
+    }
+
+    std::string name;
+    if (name_size == 0 || !source.read_cstring(name_offset, &name, static_cast<size_t>(name_size)) ||
+        !source.contains(data, file_size)) {
+      set_error(error, "cpio entry out of bounds");
+      return false;
+    }
+    if (name == kCpioTrailer) {
+      offset = skip_zeros(source, next);
+      char magic[4] = {};
+      if (source.read(offset, magic, sizeof(magic)) && std::string_view(magic, sizeof(magic)) == "0707") {
+        continue;
+      }
+      if (!is_gzip(source, offset)) {
+        break;
+      }
+#if defined(GHIRDA_HAVE_ZLIB)
+      ByteView packed;
+      std::vector<uint8_t> bytes;
+      if (!source.view(offset, source.size() - offset, &packed) ||
+          !inflate_stream(packed.data(), packed.size(), 16 + MAX_WBITS, &bytes, false, error)) {
+        return false;
+      }
+      auto inflated = std::make_shared<MemoryByteSource>(std::move(bytes));
+      parts->push_back(inflated);
+      return list_cpio(*inflated, static_cast<uint32_t>(parts->size()), out, parts, error);
+#else
+      set_error(error, "compressed cpio archive needs zlib support");
+      return false;
+#endif
+    }
+    if ((mode & kCpioTypeMask) == kCpioTypeRegular) {
+      ContainerMember member;
+      member.name = std::move(name);
+      member.offset = data;
+      member.size = file_size;
+      member.stored_size = file_size;
+      member.part = part;
+      out->push_back(std::move(member));
+    }
+    offset = next;
+  }
+  return true;
+}
+
+bool list_iso(const ByteSource& source, std::vector<ContainerMember>* out, std::string* error) {
+  uint64_t volume = 0;
+  ByteView descriptor;
+  if (!iso_primary_volume(source, &volume) || !source.view(volume, kIsoDescriptorSize, &descriptor)) {
+    set_error(error, "ISO 9660 primary volume descriptor not found");
+    return false;
+  }
+  ByteReader reader(descriptor);
+  uint16_t block_size = 0;
+  uint32_t root_extent = 0;
+  uint32_t root_length = 0;
+  reader.seek(128);
+  reader.read_u16(&block_size);
+  reader.seek(kIsoRootRecord + 2);
+  reader.read_u32(&root_extent);
+  reader.seek(kIsoRootRecord + 10);
+  reader.read_u32(&root_length);
+  if (block_size == 0 || (block_size & (block_size - 1)) != 0) {
+    set_error(error, "unsupported ISO 9660 block size");
+    return false;
+  }
+
+  struct Directory {
+    uint64_t extent;
+    uint64_t length;
+    std::string path;
+    size_t depth;
+  };
+  std::vector<Directory> pending{{root_extent, root_length, std::string(), 0}};
+  std::unordered_set<uint64_t> visited{root_extent};
+  while (!pending.empty()) {
+    Directory dir = std::move(pending.back());
+    pending.pop_back();
+    ByteView records;
+    if (!source.view(dir.extent * block_size, dir.length, &records)) {
+      set_error(error, "ISO 9660 directory out of bounds");
+      return false;
+    }
+    size_t at = 0;
+    while (at < records.size()) {
+      const uint8_t length = records[at];
+      if (length == 0) {
+        // Records never straddle a block; the rest of this one is padding.
+        at = static_cast<size_t>(align_up(at + 1, block_size));
+        continue;
+      }
+      ByteView record;
+      if (length < kIsoRecordMin || !records.subview(at, length, &record)) {
+        set_error(error, "malformed ISO 9660 directory record");
+        return false;
+      }
+      at += length;
+      ByteReader fields(record);
+      uint32_t extent = 0;
+      uint32_t size = 0;
+      fields.seek(2);
+      fields.read_u32(&extent);
+      fields.seek(10);
+      fields.read_u32(&size);
+      const uint8_t flags = record[25];
+      const uint8_t name_length = record[32];
+      if (33u + name_length > record.size()) {
+        set_error(error, "malformed ISO 9660 directory record");
+        return false;
+      }
+      std::string name(reinterpret_cast<const char*>(record.data()) + 33, name_length);
+      if (name_length == 1 && (name[0] == '\0' || name[0] == '\1')) {
+        continue;
+      }
+      const std::string path = dir.path.empty() ? name : dir.path + "/" + name;
+      if (flags & kIsoFlagDirectory) {
+        if (dir.depth < kIsoMaxDepth && visited.insert(extent).second) {
+          pending.push_back(Directory{extent, size, path, dir.depth + 1});
+        }
+        continue;
+      }
+      // Files split over several extents are not contiguous; skip them.
+      if (flags & kIsoFlagMultiExtent) {
+        continue;
+      }
+      ContainerMember member;
+      member.name = path;
+      const size_t version = member.name.rfind(';');
+      if (version != std::string::npos) {
+        member.name.resize(version);
+      }
+      if (!member.name.empty() && member.name.back() == '.') {
+        member.name.pop_back();
+      }
+      member.offset = static_cast<uint64_t>(extent) * block_size;
+      member.size = size;
+      member.stored_size = size;
+      if (!source.contains(member.offset, member.size)) {
+        set_error(error, "ISO 9660 file out of bounds: " + member.name);
+        return false;
+      }
+      out->push_back(std::move(member));
+    }
+  }
+  std::sort(out->begin(), out->end(),
+            [](const ContainerMember& a, const ContainerMember& b) { return a.offset < b.offset; });
+  return true;
+}
+
+#if defined(GHIRDA_HAVE_ZLIB)
+// window_bits selects the wrapper: negative for raw deflate (zip), 16 + 15
+// for gzip, where concatenated members are inflated back to back.
+bool inflate_stream(const uint8_t* data, size_t size, int window_bits, std::vector<uint8_t>* out,
+                    bool exact_size, std::string* error) {
+  z_stream stream{};
+  if (inflateInit2(&stream, window_bits) != Z_OK) {
+    set_error(error, "zlib init failed");
+    return false;
+  }
+  const size_t limit = exact_size ? out->size() : static_cast<size_t>(size * kMaxExpansion + kExpansionSlack);
+  if (!exact_size) {
+    out->resize(std::min(limit, std::max<size_t>(size * 4, 4096)));
+  }
+  size_t in_done = 0;
+  size_t out_done = 0;
+  int status = Z_OK;
+  while (true) {
+    if (!exact_size && out_done == out->size() && out->size() < limit) {
+      out->resize(std::min(limit, out->size() * 2));
+    }
+    stream.next_in = const_cast<Bytef*>(data + in_done);
+    stream.avail_in = static_cast<uInt>(std::min<size_t>(size - in_done, UINT_MAX));
+    stream.next_out = out->data() + out_done;
+    stream.avail_out = static_cast<uInt>(std::min<size_t>(out->size() - out_done, UINT_MAX));
+    const uInt in_before = stream.avail_in;
+    const uInt out_before = stream.avail_out;
+    status = inflate(&stream, Z_NO_FLUSH);
+    in_done += in_before - stream.avail_in;
+    out_done += out_before - stream.avail_out;
+    if (status == Z_STREAM_END) {
+      if (window_bits < 0 || in_done == size || data[in_done] != 0x1f) {
+        break;
+      }
+      inflateReset(&stream);
+    } else if (status != Z_OK && !(status == Z_BUF_ERROR && in_done < size && out_done < out->size())) {
+      break;
+    }
+  }
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    set_error(error, "inflate failed");
+    return false;
+  }
+  if (exact_size && out_done != out->size()) {
+    set_error(error, "inflated size mismatch");
+    return false;
+  }
+  out->resize(out_done);
+  return true;
+}
+#endif
+
+// Keeps an in-memory parent alive for as long as a member view exists.
+class PinnedSubByteSource : public SubByteSource {
+public:
+  PinnedSubByteSource(std::shared_ptr<const ByteSource> parent, uint64_t base, uint64_t size)
+      : SubByteSource(*parent, base, size), parent_(std::move(parent)) {}
+
+private:
+  std::shared_ptr<const ByteSource> parent_{};
+};
+
+} // namespace
+
+const char* container_format_name(ContainerFormat format) {
+  switch (format) {
+    case ContainerFormat::Ar:
+      return "ar";
+    case ContainerFormat::Zip:
+      return "zip";
+    case ContainerFormat::Cpio:
+      return "cpio";
+    case ContainerFormat::Iso9660:
+      return "iso9660";
+    case ContainerFormat::Unknown:
+      break;
+  }
+  return "unknown";
+}
+
+ContainerFormat detect_container(const ByteSource& source) {
+  char magic[8] = {};
+  const size_t size = static_cast<size_t>(std::min<uint64_t>(source.size(), sizeof(magic)));
+  if (size != 0 && source.read(0, magic, size)) {
+    const std::string_view head(magic, size);
+    if (head == std::string_view(kArMagic, kArMagicSize)) {
+      return ContainerFormat::Ar;
+    }
+    if (head.substr(0, 4) == std::string_view("PK\3\4", 4) || head.substr(0, 4) == std::string_view("PK\5\6", 4)) {
+      return ContainerFormat::Zip;
+    }
+    const std::string_view cpio = head.substr(0, 6);
+    if (cpio == "070701" || cpio == "070702" || cpio == "070707") {
+      return ContainerFormat::Cpio;
+    }
+  }
+  uint64_t volume = 0;
+  return iso_primary_volume(source, &volume) ? ContainerFormat::Iso9660 : ContainerFormat::Unknown;
+}
+
+bool Container::open(const ByteSource& source, Container* out, std::string* error) {
+  *out = Container{};
+  out->source_ = &source;
+  if (is_gzip(source)) {
+#if defined(GHIRDA_HAVE_ZLIB)
+    ByteView packed;
+    std::vector<uint8_t> bytes;
+    if (!source.view(0, source.size(), &packed) ||
+        !inflate_stream(packed.data(), packed.size(), 16 + MAX_WBITS, &bytes, false, error)) {
+      return false;
+    }
+    out->inflated_ = std::make_shared<MemoryByteSource>(std::move(bytes));
+    out->source_ = out->inflated_.get();
+#else
+    set_error(error, "gzip input needs zlib support");
+    return false;
+#endif
+  }
+
+  const ByteSource& archive = *out->source_;
+  out->format_ = detect_container(archive);
+  switch (out->format_) {
+    case ContainerFormat::Ar:
+      return list_ar(archive, &out->members_, error);
+    case ContainerFormat::Zip:
+      return list_zip(archive, &out->members_, error);
+    case ContainerFormat::Cpio:
+      return list_cpio(archive, 0, &out->members_, &out->parts_, error);
+    case ContainerFormat::Iso9660:
+      return list_iso(archive, &out->members_, error);
+    case ContainerFormat::Unknown:
+      break;
+  }
+  char magic[kArMagicSize] = {};
+  if (archive.read(0, magic, sizeof(magic)) && std::memcmp(magic, kArThinMagic, kArMagicSize) == 0) {
+    set_error(error, "thin ar archives reference external files");
+  } else {
+    set_error(error, "unrecognized container format");
+  }
+  return false;
+}
+
+ContainerFormat Container::format() const { return format_; }
+
+bool Container::gzipped() const { return inflated_ != nullptr; }
+
+const std::vector<ContainerMember>& Container::members() const { return members_; }
+
+bool Container::open_member(size_t index, std::shared_ptr<const ByteSource>* out, std::string* error) const {
+  if (index >= members_.size()) {
+    set_error(error, "member index out of range");
+    return false;
+  }
+  const ContainerMember& member = members_[index];
+  switch (member.compression) {
+    case MemberCompression::Stored:
+      if (member.part != 0) {
+        *out = std::make_shared<PinnedSubByteSource>(parts_[member.part - 1], member.offset, member.size);
+      } else if (inflated_) {
+        *out = std::make_shared<PinnedSubByteSource>(inflated_, member.offset, member.size);
+      } else {
+        *out = std::make_shared<SubByteSource>(*source_, member.offset, member.size);
+      }
+      return true;
+    case MemberCompression::Deflate: {
+#if defined(GHIRDA_HAVE_ZLIB)
+      ByteView packed;
+      if (member.size > member.stored_size * kMaxExpansion + kExpansionSlack) {
+        set_error(error, member.name + ": implausible uncompressed size");
+        return false;
+      }
+      if (!source_->view(member.offset, member.stored_size, &packed)) {
+        set_error(error, member.name + ": failed to read member");
+        return false;
+      }
+      std::vector<uint8_t> bytes(static_cast<size_t>(member.size));
+      std::string inflate_error;
+      if (!inflate_stream(packed.data(), packed.size(), -MAX_WBITS, &bytes, true, &inflate_error)) {
+        set_error(error, member.name + ": " + inflate_error);
+        return false;
+      }
+      *out = std::make_shared<MemoryByteSource>(std::move(bytes));
+      return true;
+#else
+      set_error(error, member.name + ": deflated members need zlib support");
+      return false;
+#endif
+    }
+    case MemberCompression::Unsupported:
+      break;
+  }
+  set_error(error, member.name + ": unsupported compression or encryption");
+  return false;
+}
+
+bool load_container(const ByteSource& source, const LoaderRegistry& registry, const std::string& name,
+                    std::vector<ghirda::core::Program>* programs, std::vector<ContainerMemberResult>* results,
+                    std::string* error, const ContainerLoadOptions& options) {
+  programs->clear();
+  results->clear();
+  Container container;
+  if (!Container::open(source, &container, error)) {
+    return false;
+  }
+
+  const std::vector<ContainerMember>& members = container.members();
+  results->resize(members.size());
+  std::vector<std::unique_ptr<ghirda::core::Program>> slots(members.size());
+  std::vector<uint8_t> failed(members.size(), 0);
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    std::vector<LoaderMatch> matches;
+    while (true) {
+      const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= members.size()) {
+        break;
+      }
+      const ContainerMember& member = members[index];
+      ContainerMemberResult& result = (*results)[index];
+      result.member = member.name;
+      if (member.size == 0) {
+        continue;
+      }
+      if (member.size > options.max_member_size) {
+        result.error = "member exceeds size limit";
+        continue;
+      }
+      std::shared_ptr<const ByteSource> bytes;
+      if (!container.open_member(index, &bytes, &result.error) || !registry.probe(*bytes, &matches, &result.error)) {
+        continue;
+      }
+      if (matches.empty() || matches.front().confidence < options.min_confidence) {
+        continue;
+      }
+      result.loader = matches.front().name;
+      slots[index] = std::make_unique<ghirda::core::Program>(name + ":" + member.name);
+      result.loaded = registry.load_with(result.loader, *bytes, slots[index].get(), &result.error);
+      failed[index] = result.loaded ? 0 : 1;
+    }
+  };
+
+  size_t thread_count = options.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, members.size());
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  programs->reserve(programs->size() + slots.size());
+  for (size_t i = 0; i < members.size(); ++i) {
+    if ((*results)[i].loaded) {
+      programs->push_back(std::move(*slots[i]));
+    }
+  }
+  if (std::any_of(failed.begin(), failed.end(), [](uint8_t f) { return f != 0; })) {
+    set_error(error, "one or more members failed to load");
+    return false;
+  }
+  return true;
+}
+
+} // namespace ghirda::loader
@@ -0,0 +1,275 @@
+#include "ghirda/loader/debug_file.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include <unistd.h>
+
+#if defined(GHIRDA_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace ghirda::loader {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kIndexMagic[] = "ghirda-debug-index 1";
+constexpr char kBuildIdDir[] = ".build-id";
+constexpr char kDebugSuffix[] = ".debug";
+// ELF header plus one section header; anything smaller cannot carry a note.
+constexpr uintmax_t kMinElfSize = 128;
+
+#if !defined(GHIRDA_HAVE_ZLIB)
+constexpr std::array<uint32_t, 256> make_crc_table() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t c = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    }
+    table[i] = c;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> kCrcTable = make_crc_table();
+#endif
+
+std::string parent_dir(const std::string& path) {
+  fs::path parent = fs::path(path).parent_path();
+  return parent.empty() ? "." : parent.string();
+}
+
+bool is_file(const std::string& path) {
+  std::error_code ec;
+  return fs::is_regular_file(path, ec);
+}
+
+bool read_build_id_of(const ByteSource& source, std::string* build_id) {
+  std::vector<ElfSectionHeader> headers;
+  if (!read_elf_section_headers(source, &headers, nullptr)) {
+    return false;
+  }
+  ElfDebugLink link;
+  read_elf_debug_link(source, headers, &link);
+  *build_id = std::move(link.build_id);
+  return !build_id->empty();
+}
+
+} // namespace
+
+uint32_t gnu_debuglink_crc32(const ByteView& bytes, uint32_t crc) {
+#if defined(GHIRDA_HAVE_ZLIB)
+  const uint8_t* data = bytes.data();
+  size_t size = bytes.size();
+  uLong value = crc;
+  // crc32() takes a 32-bit length.
+  while (size > 0) {
+    const uInt chunk = static_cast<uInt>(std::min<size_t>(size, 1u << 30));
+    value = ::crc32(value, data, chunk);
+    data += chunk;
+    size -= chunk;
+  }
+  return static_cast<uint32_t>(value);
+#else
+  crc = ~crc;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    crc = kCrcTable[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+#endif
+}
+
+DebugFileResolver::DebugFileResolver() : roots_{kDefaultRoot} {}
+
+DebugFileResolver::DebugFileResolver(std::vector<std::string> roots) : roots_(std::move(roots)) {}
+
+void DebugFileResolver::add_root(std::string root) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  roots_.push_back(std::move(root));
+  index_rebuilt_ = false;
+}
+
+void DebugFileResolver::set_index_path(std::string path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_path_ = std::move(path);
+  index_loaded_ = false;
+  index_rebuilt_ = false;
+  index_.clear();
+}
+
+bool DebugFileResolver::find(const ElfDebugLink& link, const std::string& image_path, std::string* out_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (link.build_id.size() > 2) {
+    const std::string relative = std::string(kBuildIdDir) + "/" + link.build_id.substr(0, 2) + "/" +
+                                 link.build_id.substr(2) + kDebugSuffix;
+    for (const auto& root : roots_) {
+      std::string candidate = (fs::path(root) / relative).string();
+      if (is_file(candidate) && matches_build_id(candidate, link.build_id)) {
+        *out_path = std::move(candidate);
+        return true;
+      }
+    }
+  }
+
+  if (!link.debuglink.empty()) {
+    const std::string image_dir = parent_dir(image_path);
+    std::vector<std::string> candidates{
+        (fs::path(image_dir) / link.debuglink).string(),
+        (fs::path(image_dir) / ".debug" / link.debuglink).string(),
+    };
+    std::error_code ec;
+    const std::string absolute_dir = fs::absolute(fs::path(image_dir), ec).relative_path().string();
+    for (const auto& root : roots_) {
+      candidates.push_back((fs::path(root) / absolute_dir / link.debuglink).string());
+    }
+    for (auto& candidate : candidates) {
+      // The image's own directory may hold the unstripped original under the
+      // same name; the CRC tells them apart.
+      if (is_file(candidate) && !fs::equivalent(candidate, image_path, ec) &&
+          matches_crc(candidate, link.debuglink_crc)) {
+        *out_path = std::move(candidate);
+        return true;
+      }
+    }
+  }
+
+  return !link.build_id.empty() && find_in_index(link.build_id, out_path);
+}
+
+bool DebugFileResolver::matches_build_id(const std::string& path, const std::string& build_id) const {
+  auto source = open_byte_source(path, nullptr);
+  std::string found;
+  return source && read_build_id_of(*source, &found) && found == build_id;
+}
+
+bool DebugFileResolver::matches_crc(const std::string& path, uint32_t crc) const {
+  auto source = MmapByteSource::open(path, nullptr);
+  ByteView bytes;
+  return source && source->view(0, source->size(), &bytes) && gnu_debuglink_crc32(bytes) == crc;
+}
+
+bool DebugFileResolver::find_in_index(const std::string& build_id, std::string* out_path) {
+  if (index_path_.empty()) {
+    return false;
+  }
+  load_index();
+  auto it = index_.find(build_id);
+  if (it != index_.end() && is_file(it->second)) {
+    *out_path = it->second;
+    return true;
+  }
+  // A miss only triggers a rescan if the roots changed since the index was
+  // written, and at most once per resolver.
+  if (index_rebuilt_ || !index_stale()) {
+    return false;
+  }
+  rebuild_index();
+  save_index();
+  it = index_.find(build_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  *out_path = it->second;
+  return true;
+}
+
+void DebugFileResolver::load_index() {
+  if (index_loaded_) {
+    return;
+  }
+  index_loaded_ = true;
+  std::ifstream in(index_path_);
+  std::string line;
+  if (!std::getline(in, line) || line != kIndexMagic) {
+    return;
+  }
+  while (std::getline(in, line)) {
+    const size_t tab = line.find('\t');
+    if (tab != std::string::npos && tab != 0) {
+      index_.emplace(line.substr(0, tab), line.substr(tab + 1));
+    }
+  }
+}
+
+bool DebugFileResolver::index_stale() const {
+  std::error_code ec;
+  const auto written = fs::last_write_time(index_path_, ec);
+  if (ec) {
+    return true;
+  }
+  // Directory mtimes move when entries are added or removed; checking the
+  // roots and their first level is enough for package-managed trees.
+  for (const auto& root : roots_) {
+    if (fs::last_write_time(root, ec) > written && !ec) {
+      return true;
+    }
+    for (fs::directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end;
+         it.increment(ec)) {
+      std::error_code entry_ec;
+      if (it->is_directory(entry_ec) && it->last_write_time(entry_ec) > written && !entry_ec) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void DebugFileResolver::rebuild_index() {
+  index_rebuilt_ = true;
+  index_.clear();
+  for (const auto& root : roots_) {
+    std::error_code ec;
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+    for (fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+      std::error_code entry_ec;
+      // .build-id holds only symlinks to files found elsewhere in the tree.
+      if (it->path().filename() == kBuildIdDir) {
+        it.disable_recursion_pending();
+        continue;
+      }
+      if (!it->is_regular_file(entry_ec) || it->file_size(entry_ec) < kMinElfSize) {
+        continue;
+      }
+      const std::string path = it->path().string();
+      auto source = open_byte_source(path, nullptr);
+      std::string build_id;
+      if (source && read_build_id_of(*source, &build_id)) {
+        index_.emplace(std::move(build_id), path);
+      }
+    }
+  }
+}
+
+void DebugFileResolver::save_index() const {
+  std::error_code ec;
+  fs::create_directories(fs::path(index_path_).parent_path(), ec);
+  // Write beside the index and rename, so concurrent loaders never read a
+  // partial file.
+  const std::string temp = index_path_ + "." + std::to_string(::getpid()) + ".tmp";
+  bool written = false;
+  {
+    std::ofstream out(temp, std::ios::trunc);
+    if (out) {
+      out << kIndexMagic << '\n';
+      for (const auto& [build_id, path] : index_) {
+        out << build_id << '\t' << path << '\n';
+      }
+      out.close();
+      written = static_cast<bool>(out);
+    }
+  }
+  if (written) {
+    fs::rename(temp, index_path_, ec);
+  }
+  // Never leave a partial temp file behind in the cache directory.
+  if (!written || ec) {
+    fs::remove(temp, ec);
+  }
+}
+
+} // namespace ghirda::loader
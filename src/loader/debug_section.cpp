@@ -0,0 +1,287 @@
+#include "ghirda/loader/debug_section.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+#if defined(GHIRDA_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(GHIRDA_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace ghirda::loader {
+namespace {
+
+constexpr uint64_t kShfCompressed = 0x800;
+constexpr uint32_t kElfCompressZlib = 1;
+constexpr uint32_t kElfCompressZstd = 2;
+constexpr size_t kElf32ChdrSize = 12;
+constexpr size_t kElf64ChdrSize = 24;
+constexpr size_t kZdebugHeaderSize = 12;
+
+// deflate cannot expand better than ~1032:1; zstd can, but a declared size far
+// beyond that is far more likely a corrupt header than real debug info.
+constexpr uint64_t kMaxExpansion = 1032;
+constexpr uint64_t kExpansionSlack = 1 << 20;
+
+bool plausible_size(uint64_t stored, uint64_t declared) {
+  return declared <= stored * kMaxExpansion + kExpansionSlack;
+}
+
+#if defined(GHIRDA_HAVE_ZLIB)
+bool inflate_zlib(const uint8_t* data, size_t size, std::vector<uint8_t>* out, std::string* error) {
+  z_stream stream{};
+  if (inflateInit(&stream) != Z_OK) {
+    *error = "zlib init failed";
+    return false;
+  }
+  // Inflate straight into the final buffer; avail_* are 32-bit, so large
+  // sections are fed in UINT_MAX pieces.
+  size_t in_done = 0;
+  size_t out_done = 0;
+  int status = Z_OK;
+  while (status == Z_OK) {
+    stream.next_in = const_cast<Bytef*>(data + in_done);
+    stream.avail_in = static_cast<uInt>(std::min<size_t>(size - in_done, UINT_MAX));
+    stream.next_out = out->data() + out_done;
+    stream.avail_out = static_cast<uInt>(std::min<size_t>(out->size() - out_done, UINT_MAX));
+    const uInt in_before = stream.avail_in;
+    const uInt out_before = stream.avail_out;
+    status = inflate(&stream, Z_NO_FLUSH);
+    in_done += in_before - stream.avail_in;
+    out_done += out_before - stream.avail_out;
+    if (status == Z_BUF_ERROR && in_done < size && out_done < out->size()) {
+      status = Z_OK;
+    }
+  }
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    *error = "zlib inflate failed";
+    return false;
+  }
+  if (out_done != out->size()) {
+    *error = "zlib size mismatch";
+    return false;
+  }
+  return true;
+}
+#endif
+
+#if defined(GHIRDA_HAVE_ZSTD)
+bool inflate_zstd(const uint8_t* data, size_t size, std::vector<uint8_t>* out, std::string* error) {
+  size_t written = ZSTD_decompress(out->data(), out->size(), data, size);
+  if (ZSTD_isError(written)) {
+    *error = std::string("zstd: ") + ZSTD_getErrorName(written);
+    return false;
+  }
+  if (written != out->size()) {
+    *error = "zstd size mismatch";
+    return false;
+  }
+  return true;
+}
+#endif
+
+} // namespace
+
+DebugSection::DebugSection(std::string name, ByteView raw, SectionCompression compression,
+                           uint64_t uncompressed_size)
+    : name_(std::move(name)),
+      raw_(std::move(raw)),
+      compression_(compression),
+      size_(compression == SectionCompression::None ? raw_.size() : uncompressed_size) {
+  if (name_.rfind(".zdebug_", 0) == 0) {
+    name_ = ".debug_" + name_.substr(8);
+  }
+}
+
+std::shared_ptr<DebugSection> DebugSection::from_elf(const ByteSource& source, const std::string& name,
+                                                     uint64_t offset, uint64_t size, uint64_t flags, bool elf64,
+                                                     Endian endian, std::string* error) {
+  ByteView raw;
+  if (!source.view(offset, size, &raw)) {
+    if (error) {
+      *error = "section " + name + " is out of bounds";
+    }
+    return nullptr;
+  }
+
+  if ((flags & kShfCompressed) != 0) {
+    ByteReader reader(raw, endian);
+    uint32_t type = 0;
+    uint64_t expected = 0;
+    bool ok = reader.read_u32(&type);
+    if (elf64) {
+      ok = ok && reader.skip(sizeof(uint32_t)) && reader.read_u64(&expected) && reader.seek(kElf64ChdrSize);
+    } else {
+      uint32_t expected32 = 0;
+      ok = ok && reader.read_u32(&expected32) && reader.seek(kElf32ChdrSize);
+      expected = expected32;
+    }
+    ByteView payload;
+    if (!ok || !reader.read_view(reader.remaining(), &payload)) {
+      if (error) {
+        *error = "truncated compression header in " + name;
+      }
+      return nullptr;
+    }
+    SectionCompression compression = SectionCompression::None;
+    if (type == kElfCompressZlib) {
+      compression = SectionCompression::Zlib;
+    } else if (type == kElfCompressZstd) {
+      compression = SectionCompression::Zstd;
+    } else {
+      if (error) {
+        *error = "unknown compression type " + std::to_string(type) + " in " + name;
+      }
+      return nullptr;
+    }
+    return std::make_shared<DebugSection>(name, std::move(payload), compression, expected);
+  }
+
+  if (name.rfind(".zdebug_", 0) == 0 && raw.size() >= kZdebugHeaderSize &&
+      std::memcmp(raw.data(), "ZLIB", 4) == 0) {
+    ByteReader reader(raw, Endian::Big);
+    uint64_t expected = 0;
+    ByteView payload;
+    reader.skip(4);
+    reader.read_u64(&expected);
+    reader.read_view(reader.remaining(), &payload);
+    return std::make_shared<DebugSection>(name, std::move(payload), SectionCompression::Zlib, expected);
+  }
+
+  return std::make_shared<DebugSection>(name, std::move(raw));
+}
+
+const std::string& DebugSection::name() const { return name_; }
+SectionCompression DebugSection::compression() const { return compression_; }
+uint64_t DebugSection::stored_size() const { return raw_.size(); }
+uint64_t DebugSection::size() const { return size_; }
+
+const ByteView* DebugSection::view() const {
+  if (compression_ == SectionCompression::None) {
+    return &raw_;
+  }
+  if (!done_.load(std::memory_order_acquire)) {
+    std::call_once(once_, [this]() {
+      materialize();
+      done_.store(true, std::memory_order_release);
+    });
+  }
+  return ok_ ? &inflated_ : nullptr;
+}
+
+bool DebugSection::materialized() const {
+  return compression_ == SectionCompression::None || done_.load(std::memory_order_acquire);
+}
+
+const std::string& DebugSection::error() const { return error_; }
+
+void DebugSection::materialize() const {
+  ok_ = decompress_section(compression_, raw_.data(), raw_.size(), size_, &bytes_, &error_);
+  if (ok_) {
+    inflated_ = ByteView(bytes_.data(), bytes_.size());
+  } else {
+    error_ = name_ + ": " + error_;
+    bytes_.clear();
+    bytes_.shrink_to_fit();
+  }
+}
+
+bool compression_supported(SectionCompression compression) {
+  switch (compression) {
+    case SectionCompression::None:
+      return true;
+    case SectionCompression::Zlib:
+#if defined(GHIRDA_HAVE_ZLIB)
+      return true;
+#else
+      return false;
+#endif
+    case SectionCompression::Zstd:
+#if defined(GHIRDA_HAVE_ZSTD)
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+bool decompress_section(SectionCompression compression, const uint8_t* data, size_t size, uint64_t expected_size,
+                        std::vector<uint8_t>* out, std::string* error) {
+  std::string local_error;
+  std::string* err = error ? error : &local_error;
+  if (compression == SectionCompression::None) {
+    out->assign(data, data + size);
+    return true;
+  }
+  if (!compression_supported(compression)) {
+    *err = compression == SectionCompression::Zlib ? "built without zlib support" : "built without zstd support";
+    return false;
+  }
+  if (!plausible_size(size, expected_size)) {
+    *err = "implausible uncompressed size";
+    return false;
+  }
+  out->resize(static_cast<size_t>(expected_size));
+  if (expected_size == 0) {
+    return true;
+  }
+#if defined(GHIRDA_HAVE_ZLIB)
+  if (compression == SectionCompression::Zlib) {
+    return inflate_zlib(data, size, out, err);
+  }
+#endif
+#if defined(GHIRDA_HAVE_ZSTD)
+  if (compression == SectionCompression::Zstd) {
+    return inflate_zstd(data, size, out, err);
+  }
+#endif
+  return false;
+}
+
+void prefetch_debug_sections(const std::vector<std::shared_ptr<DebugSection>>& sections, uint64_t min_size,
+                             size_t thread_count) {
+  std::vector<const DebugSection*> pending;
+  for (const auto& section : sections) {
+    if (section && section->compression() != SectionCompression::None && section->size() >= min_size &&
+        !section->materialized()) {
+      pending.push_back(section.get());
+    }
+  }
+  if (pending.empty()) {
+    return;
+  }
+  // Largest first so the longest inflate starts immediately.
+  std::sort(pending.begin(), pending.end(),
+            [](const DebugSection* a, const DebugSection* b) { return a->size() > b->size(); });
+
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    while (true) {
+      size_t index = next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= pending.size()) {
+        break;
+      }
+      pending[index]->view();
+    }
+  };
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, pending.size());
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace ghirda::loader
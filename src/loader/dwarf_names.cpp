@@ -0,0 +1,313 @@
+#include "ghirda/loader/dwarf_names.h"
+
+#include <cstring>
+
+#include "ghirda/loader/byte_source.h"
+
+namespace ghirda::loader {
+namespace {
+
+constexpr uint32_t kDwarfIdxCompileUnit = 1;
+constexpr uint32_t kDwarfIdxDieOffset = 3;
+
+constexpr uint32_t kDwarfFormData1 = 0x0b;
+constexpr uint32_t kDwarfFormData2 = 0x05;
+constexpr uint32_t kDwarfFormData4 = 0x06;
+constexpr uint32_t kDwarfFormData8 = 0x07;
+constexpr uint32_t kDwarfFormUdata = 0x0f;
+constexpr uint32_t kDwarfFormSdata = 0x0d;
+constexpr uint32_t kDwarfFormFlagPresent = 0x19;
+constexpr uint32_t kDwarfFormRef1 = 0x11;
+constexpr uint32_t kDwarfFormRef2 = 0x12;
+constexpr uint32_t kDwarfFormRef4 = 0x13;
+constexpr uint32_t kDwarfFormRef8 = 0x14;
+constexpr uint32_t kDwarfFormRefUdata = 0x15;
+constexpr uint32_t kDwarfFormRefSig8 = 0x20;
+
+bool read_uleb(ByteReader& reader, uint64_t* value) {
+  uint64_t result = 0;
+  uint32_t shift = 0;
+  while (true) {
+    uint8_t byte = 0;
+    if (!reader.read_u8(&byte)) {
+      return false;
+    }
+    if (shift < 64) {
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    }
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+    shift += 7;
+  }
+  *value = result;
+  return true;
+}
+
+bool read_index_value(ByteReader& reader, uint32_t form, uint64_t* value) {
+  *value = 0;
+  switch (form) {
+    case kDwarfFormData1:
+    case kDwarfFormRef1: {
+      uint8_t v = 0;
+      if (!reader.read_u8(&v)) {
+        return false;
+      }
+      *value = v;
+      return true;
+    }
+    case kDwarfFormData2:
+    case kDwarfFormRef2: {
+      uint16_t v = 0;
+      if (!reader.read_u16(&v)) {
+        return false;
+      }
+      *value = v;
+      return true;
+    }
+    case kDwarfFormData4:
+    case kDwarfFormRef4: {
+      uint32_t v = 0;
+      if (!reader.read_u32(&v)) {
+        return false;
+      }
+      *value = v;
+      return true;
+    }
+    case kDwarfFormData8:
+    case kDwarfFormRef8:
+    case kDwarfFormRefSig8:
+      return reader.read_u64(value);
+    case kDwarfFormUdata:
+    case kDwarfFormRefUdata:
+    case kDwarfFormSdata:
+      return read_uleb(reader, value);
+    case kDwarfFormFlagPresent:
+      *value = 1;
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+uint32_t DwarfNameIndex::hash(const std::string& name) {
+  uint32_t h = 5381;
+  for (unsigned char ch : name) {
+    if (ch >= 'A' && ch <= 'Z') {
+      ch = static_cast<unsigned char>(ch - 'A' + 'a');
+    }
+    h = h * 33 + ch;
+  }
+  return h;
+}
+
+bool DwarfNameIndex::parse(const ByteView* names, const ByteView* debug_str,
+                           std::string* error) {
+  names_ = names;
+  debug_str_ = debug_str;
+  units_.clear();
+  if (!names || !debug_str) {
+    return false;
+  }
+
+  ByteReader reader(*names);
+  while (reader.remaining() > 0) {
+    Unit unit{};
+    uint32_t length32 = 0;
+    uint64_t length = 0;
+    if (!reader.read_u32(&length32)) {
+      break;
+    }
+    length = length32;
+    if (length32 == 0xffffffffu) {
+      unit.offset_size = 8;
+      if (!reader.read_u64(&length)) {
+        break;
+      }
+    }
+    if (length > reader.remaining()) {
+      if (error) {
+        *error = "truncated .debug_names unit";
+      }
+      return false;
+    }
+    unit.end = reader.offset() + length;
+
+    uint16_t version = 0;
+    uint16_t padding = 0;
+    uint32_t foreign_type_unit_count = 0;
+    uint32_t abbrev_table_size = 0;
+    uint32_t augmentation_size = 0;
+    if (!reader.read_u16(&version) || !reader.read_u16(&padding) || !reader.read_u32(&unit.comp_unit_count) ||
+        !reader.read_u32(&unit.local_type_unit_count) || !reader.read_u32(&foreign_type_unit_count) ||
+        !reader.read_u32(&unit.bucket_count) || !reader.read_u32(&unit.name_count) ||
+        !reader.read_u32(&abbrev_table_size) || !reader.read_u32(&augmentation_size) ||
+        !reader.skip(augmentation_size)) {
+      if (error) {
+        *error = "truncated .debug_names header";
+      }
+      return false;
+    }
+    if (version != 5) {
+      reader.seek(unit.end);
+      continue;
+    }
+
+    // The fixed-size arrays follow back to back; check them against the unit
+    // once so lookups can index them without further bounds checks.
+    const uint64_t off = unit.offset_size;
+    unit.cu_list = reader.offset();
+    const uint64_t tu_list = unit.cu_list + off * unit.comp_unit_count;
+    const uint64_t foreign_list = tu_list + off * unit.local_type_unit_count;
+    unit.buckets = foreign_list + 8ull * foreign_type_unit_count;
+    unit.hashes = unit.buckets + 4ull * unit.bucket_count;
+    unit.string_offsets = unit.hashes + (unit.bucket_count != 0 ? 4ull * unit.name_count : 0);
+    unit.entry_offsets = unit.string_offsets + off * unit.name_count;
+    const uint64_t abbrev_start = unit.entry_offsets + off * unit.name_count;
+    unit.entry_pool = abbrev_start + abbrev_table_size;
+    if (unit.entry_pool > unit.end || !reader.seek(abbrev_start)) {
+      if (error) {
+        *error = "malformed .debug_names unit";
+      }
+      return false;
+    }
+
+    while (reader.offset() < unit.entry_pool) {
+      uint64_t code = 0;
+      uint64_t tag = 0;
+      if (!read_uleb(reader, &code) || code == 0 || !read_uleb(reader, &tag)) {
+        break;
+      }
+      Abbrev abbrev{};
+      abbrev.tag = static_cast<uint32_t>(tag);
+      while (true) {
+        uint64_t index = 0;
+        uint64_t form = 0;
+        if (!read_uleb(reader, &index) || !read_uleb(reader, &form)) {
+          return false;
+        }
+        if (index == 0 && form == 0) {
+          break;
+        }
+        abbrev.attributes.push_back(IndexAttr{static_cast<uint32_t>(index), static_cast<uint32_t>(form)});
+      }
+      unit.abbrevs.emplace_back(code, std::move(abbrev));
+    }
+
+    units_.push_back(std::move(unit));
+    reader.seek(units_.back().end);
+  }
+  return true;
+}
+
+bool DwarfNameIndex::empty() const { return units_.empty(); }
+
+size_t DwarfNameIndex::name_count() const {
+  size_t count = 0;
+  for (const auto& unit : units_) {
+    count += unit.name_count;
+  }
+  return count;
+}
+
+uint64_t DwarfNameIndex::read_offset(const Unit& unit, uint64_t at) const {
+  uint64_t value = 0;
+  std::memcpy(&value, names_->data() + at, unit.offset_size);
+  return value;
+}
+
+bool DwarfNameIndex::name_matches(const Unit& unit, uint32_t index, const std::string& name) const {
+  uint64_t str_offset = read_offset(unit, unit.string_offsets + static_cast<uint64_t>(index) * unit.offset_size);
+  if (str_offset >= debug_str_->size()) {
+    return false;
+  }
+  const char* start = reinterpret_cast<const char*>(debug_str_->data() + str_offset);
+  size_t available = debug_str_->size() - str_offset;
+  return name.size() < available && std::memcmp(start, name.data(), name.size()) == 0 && start[name.size()] == '\0';
+}
+
+bool DwarfNameIndex::read_entries(const Unit& unit, uint32_t index, std::vector<DwarfNameEntry>* out) const {
+  uint64_t entry = read_offset(unit, unit.entry_offsets + static_cast<uint64_t>(index) * unit.offset_size);
+  ByteReader reader(ByteView(names_->data(), static_cast<size_t>(unit.end)));
+  if (!reader.seek(unit.entry_pool + entry)) {
+    return false;
+  }
+  while (true) {
+    uint64_t code = 0;
+    if (!read_uleb(reader, &code) || code == 0) {
+      return true;
+    }
+    const Abbrev* abbrev = nullptr;
+    for (const auto& [abbrev_code, candidate] : unit.abbrevs) {
+      if (abbrev_code == code) {
+        abbrev = &candidate;
+        break;
+      }
+    }
+    if (!abbrev) {
+      return false;
+    }
+    uint64_t cu_index = 0;
+    uint64_t die_offset = 0;
+    bool has_die = false;
+    for (const auto& attr : abbrev->attributes) {
+      uint64_t value = 0;
+      if (!read_index_value(reader, attr.form, &value)) {
+        return false;
+      }
+      if (attr.index == kDwarfIdxCompileUnit) {
+        cu_index = value;
+      } else if (attr.index == kDwarfIdxDieOffset) {
+        die_offset = value;
+        has_die = true;
+      }
+    }
+    // Entries for type units (or a CU index past the list) cannot be mapped to
+    // a .debug_info offset here.
+    if (!has_die || cu_index >= unit.comp_unit_count) {
+      continue;
+    }
+    DwarfNameEntry result{};
+    result.tag = abbrev->tag;
+    result.unit_offset = read_offset(unit, unit.cu_list + cu_index * unit.offset_size);
+    result.die_offset = result.unit_offset + die_offset;
+    out->push_back(result);
+  }
+}
+
+bool DwarfNameIndex::lookup(const std::string& name, std::vector<DwarfNameEntry>* out) const {
+  out->clear();
+  const uint32_t h = hash(name);
+  for (const auto& unit : units_) {
+    if (unit.bucket_count == 0) {
+      for (uint32_t i = 0; i < unit.name_count; ++i) {
+        if (name_matches(unit, i, name)) {
+          read_entries(unit, i, out);
+        }
+      }
+      continue;
+    }
+    uint32_t bucket = 0;
+    std::memcpy(&bucket, names_->data() + unit.buckets + 4ull * (h % unit.bucket_count), sizeof(bucket));
+    if (bucket == 0) {
+      continue;
+    }
+    // Bucket values are 1-based name indices; names sharing a bucket are
+    // contiguous in the hash array.
+    for (uint32_t i = bucket - 1; i < unit.name_count; ++i) {
+      uint32_t name_hash = 0;
+      std::memcpy(&name_hash, names_->data() + unit.hashes + 4ull * i, sizeof(name_hash));
+      if (name_hash % unit.bucket_count != h % unit.bucket_count) {
+        break;
+      }
+      if (name_hash == h && name_matches(unit, i, name)) {
+        read_entries(unit, i, out);
+      }
+    }
+  }
+  return !out->empty();
+}
+
+} // namespace ghirda::loader
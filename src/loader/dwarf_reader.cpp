@@ -1,11 +1,16 @@
 #include "ghirda/loader/dwarf_reader.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "ghirda/loader/split_dwarf.h"
 
 namespace ghirda::loader {
 namespace {
 
 constexpr uint32_t kDwarfTagCompileUnit = 0x11;
+constexpr uint32_t kDwarfTagSkeletonUnit = 0x4a;
 constexpr uint32_t kDwarfTagSubprogram = 0x2e;
 constexpr uint32_t kDwarfTagBaseType = 0x24;
 constexpr uint32_t kDwarfTagPointerType = 0x0f;
@@ -34,6 +39,15 @@ constexpr uint32_t kDwarfAtBitSize = 0x0d;
 constexpr uint32_t kDwarfAtBitOffset = 0x0c;
 constexpr uint32_t kDwarfAtDataBitOffset = 0x6b;
 constexpr uint32_t kDwarfAtAlignment = 0x88;
+constexpr uint32_t kDwarfAtRanges = 0x55;
+constexpr uint32_t kDwarfAtStrOffsetsBase = 0x72;
+constexpr uint32_t kDwarfAtAddrBase = 0x73;
+constexpr uint32_t kDwarfAtRnglistsBase = 0x74;
+constexpr uint32_t kDwarfAtGnuAddrBase = 0x2133;
+constexpr uint32_t kDwarfAtCompDir = 0x1b;
+constexpr uint32_t kDwarfAtDwoName = 0x76;
+constexpr uint32_t kDwarfAtGnuDwoName = 0x2130;
+constexpr uint32_t kDwarfAtGnuDwoId = 0x2131;
 
 constexpr uint32_t kDwarfFormAddr = 0x01;
 constexpr uint32_t kDwarfFormData1 = 0x0b;
@@ -58,6 +72,50 @@ constexpr uint32_t kDwarfFormBlock1 = 0x0a;
 constexpr uint32_t kDwarfFormBlock2 = 0x03;
 constexpr uint32_t kDwarfFormBlock4 = 0x04;
 constexpr uint32_t kDwarfFormBlock = 0x09;
+constexpr uint32_t kDwarfFormIndirect = 0x16;
+constexpr uint32_t kDwarfFormStrx = 0x1a;
+constexpr uint32_t kDwarfFormAddrx = 0x1b;
+constexpr uint32_t kDwarfFormRefSup4 = 0x1c;
+constexpr uint32_t kDwarfFormStrpSup = 0x1d;
+constexpr uint32_t kDwarfFormData16 = 0x1e;
+constexpr uint32_t kDwarfFormLineStrp = 0x1f;
+constexpr uint32_t kDwarfFormRefSig8 = 0x20;
+constexpr uint32_t kDwarfFormImplicitConst = 0x21;
+constexpr uint32_t kDwarfFormLoclistx = 0x22;
+constexpr uint32_t kDwarfFormRnglistx = 0x23;
+constexpr uint32_t kDwarfFormRefSup8 = 0x24;
+constexpr uint32_t kDwarfFormStrx1 = 0x25;
+constexpr uint32_t kDwarfFormStrx2 = 0x26;
+constexpr uint32_t kDwarfFormStrx3 = 0x27;
+constexpr uint32_t kDwarfFormStrx4 = 0x28;
+constexpr uint32_t kDwarfFormAddrx1 = 0x29;
+constexpr uint32_t kDwarfFormAddrx2 = 0x2a;
+constexpr uint32_t kDwarfFormAddrx3 = 0x2b;
+constexpr uint32_t kDwarfFormAddrx4 = 0x2c;
+constexpr uint32_t kDwarfFormGnuAddrIndex = 0x1f01;
+constexpr uint32_t kDwarfFormGnuStrIndex = 0x1f02;
+constexpr uint32_t kDwarfFormGnuRefAlt = 0x1f20;
+constexpr uint32_t kDwarfFormGnuStrpAlt = 0x1f21;
+
+constexpr uint8_t kDwarfUnitSkeleton = 0x04;
+constexpr uint8_t kDwarfUnitSplitCompile = 0x05;
+constexpr uint8_t kDwarfUnitType = 0x02;
+constexpr uint8_t kDwarfUnitSplitType = 0x06;
+
+constexpr uint32_t kDwarfLnctPath = 0x1;
+constexpr uint32_t kDwarfLnctDirectoryIndex = 0x2;
+
+constexpr uint8_t kLineExtEndSequence = 1;
+constexpr uint8_t kLineExtSetAddress = 2;
+
+constexpr uint8_t kRleEndOfList = 0;
+constexpr uint8_t kRleBaseAddressx = 1;
+constexpr uint8_t kRleStartxEndx = 2;
+constexpr uint8_t kRleStartxLength = 3;
+constexpr uint8_t kRleOffsetPair = 4;
+constexpr uint8_t kRleBaseAddress = 5;
+constexpr uint8_t kRleStartEnd = 6;
+constexpr uint8_t kRleStartLength = 7;
 
 constexpr uint8_t kLineOpCopy = 1;
 constexpr uint8_t kLineOpAdvancePc = 2;
@@ -79,13 +137,75 @@ std::string join_path(const std::string& dir, const std::string& file) {
   return dir + "/" + file;
 }
 
-bool is_high_pc_offset_form(uint32_t form) {
-  return form != kDwarfFormAddr;
+bool is_address_form(uint32_t form) {
+  switch (form) {
+    case kDwarfFormAddr:
+    case kDwarfFormAddrx:
+    case kDwarfFormAddrx1:
+    case kDwarfFormAddrx2:
+    case kDwarfFormAddrx3:
+    case kDwarfFormAddrx4:
+    case kDwarfFormGnuAddrIndex:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string c_string_at(const ByteView* data, uint64_t offset) {
+  if (!data || offset >= data->size()) {
+    return {};
+  }
+  const char* start = reinterpret_cast<const char*>(data->data() + offset);
+  return std::string(start, strnlen(start, data->size() - offset));
 }
 
 } // namespace
 
-DwarfReader::DwarfReader(DwarfSections sections) : sections_(sections) {}
+bool DwarfSection::present() const { return section != nullptr; }
+
+const ByteView* DwarfSection::view() const { return section ? section->view() : nullptr; }
+
+DwarfSection* dwarf_section_slot(DwarfSections* sections, const std::string& name) {
+  std::string key;
+  if (name.rfind(".debug_", 0) == 0) {
+    key = name.substr(7);
+  } else if (name.rfind(".zdebug_", 0) == 0) {
+    key = name.substr(8);
+  } else if (name.rfind("__debug_", 0) == 0) {
+    // Mach-O section names are capped at 16 characters.
+    key = name.substr(8);
+    if (key == "str_offs") {
+      key = "str_offsets";
+    }
+  } else {
+    return nullptr;
+  }
+  if (key == "info") {
+    return &sections->debug_info;
+  } else if (key == "abbrev") {
+    return &sections->debug_abbrev;
+  } else if (key == "line") {
+    return &sections->debug_line;
+  } else if (key == "str") {
+    return &sections->debug_str;
+  } else if (key == "str_offsets") {
+    return &sections->debug_str_offsets;
+  } else if (key == "addr") {
+    return &sections->debug_addr;
+  } else if (key == "line_str") {
+    return &sections->debug_line_str;
+  } else if (key == "rnglists") {
+    return &sections->debug_rnglists;
+  } else if (key == "names") {
+    return &sections->debug_names;
+  }
+  return nullptr;
+}
+
+DwarfReader::DwarfReader(DwarfSections sections) : sections_(std::move(sections)) {}
+
+void DwarfReader::set_split_resolver(SplitDwarfResolver* resolver) { split_resolver_ = resolver; }
 
 bool DwarfReader::Cursor::can_read(size_t count) const {
   return data && offset + count <= data->size();
@@ -198,6 +318,36 @@ bool DwarfReader::Cursor::read_cstring(std::string* out) {
   return true;
 }
 
+bool DwarfReader::Cursor::read_sized(uint8_t size, uint64_t* value) {
+  if (size > 8 || !can_read(size)) {
+    return false;
+  }
+  uint64_t result = 0;
+  for (uint8_t i = 0; i < size; ++i) {
+    result |= static_cast<uint64_t>((*data)[offset + i]) << (8 * i);
+  }
+  *value = result;
+  offset += size;
+  return true;
+}
+
+bool DwarfReader::Cursor::read_initial_length(uint64_t* length, uint8_t* offset_size) {
+  uint32_t length32 = 0;
+  if (!read_u32(&length32)) {
+    return false;
+  }
+  if (length32 == 0xffffffffu) {
+    *offset_size = 8;
+    return read_u64(length);
+  }
+  if (length32 >= 0xfffffff0u) {
+    return false;
+  }
+  *offset_size = 4;
+  *length = length32;
+  return true;
+}
+
 bool DwarfReader::Cursor::skip(size_t count) {
   if (!can_read(count)) {
     return false;
@@ -206,25 +356,54 @@ bool DwarfReader::Cursor::skip(size_t count) {
   return true;
 }
 
-std::string DwarfReader::read_str(uint64_t offset) const {
-  if (!sections_.debug_str.data || offset >= sections_.debug_str.data->size()) {
+std::string DwarfReader::read_str(uint64_t offset) const { return c_string_at(sections_.debug_str.view(), offset); }
+
+std::string DwarfReader::read_line_str(uint64_t offset) const {
+  return c_string_at(sections_.debug_line_str.view(), offset);
+}
+
+std::string DwarfReader::read_str_index(const UnitContext& unit, uint64_t index) const {
+  Cursor cursor{sections_.debug_str_offsets.view(), 0};
+  uint64_t base = unit.str_offsets_base;
+  // Split units carry no DW_AT_str_offsets_base; their table starts right
+  // after the v5 contribution header.
+  if (base == 0 && unit.version >= 5) {
+    base = unit.offset_size == 8 ? 16 : 8;
+  }
+  cursor.offset = static_cast<size_t>(base + index * unit.offset_size);
+  uint64_t offset = 0;
+  if (!cursor.read_sized(unit.offset_size, &offset)) {
     return {};
   }
-  const auto* data = sections_.debug_str.data;
-  const char* start = reinterpret_cast<const char*>(data->data() + offset);
-  return std::string(start);
+  return read_str(offset);
+}
+
+uint64_t DwarfReader::read_addr_index(const UnitContext& unit, uint64_t index) const {
+  Cursor cursor{sections_.debug_addr.view(), static_cast<size_t>(unit.addr_base + index * unit.address_size)};
+  uint64_t address = 0;
+  cursor.read_sized(unit.address_size, &address);
+  return address;
 }
 
 bool DwarfReader::parse(ghirda::core::DebugInfo* out, std::string* error) {
-  if (!sections_.debug_info.data || !sections_.debug_abbrev.data) {
+  if (!sections_.debug_info.present() || !sections_.debug_abbrev.present()) {
     if (error) {
       *error = "missing debug sections";
     }
     return false;
   }
+  for (const DwarfSection* required : {&sections_.debug_info, &sections_.debug_abbrev}) {
+    if (!required->view()) {
+      if (error) {
+        *error = required->section->error();
+      }
+      return false;
+    }
+  }
 
-  Cursor cursor{sections_.debug_info.data, 0};
-  while (cursor.offset < sections_.debug_info.data->size()) {
+  Cursor cursor{sections_.debug_info.view(), 0};
+  next_split_bias_ = std::max(next_split_bias_, offset_bias_ + cursor.data->size());
+  while (cursor.offset < cursor.data->size()) {
     if (!parse_unit(cursor, out, error)) {
       return false;
     }
@@ -233,60 +412,149 @@ bool DwarfReader::parse(ghirda::core::DebugInfo* out, std::string* error) {
   return true;
 }
 
-bool DwarfReader::parse_unit(Cursor& cursor, ghirda::core::DebugInfo* out, std::string* error) {
-  uint32_t unit_length = 0;
-  if (!cursor.read_u32(&unit_length)) {
+bool DwarfReader::read_unit_header(Cursor& cursor, UnitContext* unit, std::string* error) {
+  *unit = UnitContext{};
+  unit->offset = cursor.offset;
+  uint64_t unit_length = 0;
+  if (!cursor.read_initial_length(&unit_length, &unit->offset_size)) {
+    if (error) {
+      *error = "invalid unit length";
+    }
     return false;
   }
-  uint64_t unit_start = cursor.offset - 4;
+  if (unit_length > cursor.data->size() - cursor.offset) {
+    if (error) {
+      *error = "truncated unit";
+    }
+    return false;
+  }
+  unit->end = cursor.offset + unit_length;
   if (unit_length == 0) {
+    unit->die_start = unit->end;
     return true;
   }
-  if (unit_length == 0xffffffffu) {
+
+  if (!cursor.read_u16(&unit->version)) {
+    return false;
+  }
+  if (unit->version < 2 || unit->version > 5) {
     if (error) {
-      *error = "DWARF64 not supported";
+      *error = "unsupported DWARF version " + std::to_string(unit->version);
     }
     return false;
   }
 
-  size_t unit_end = cursor.offset + unit_length;
-  uint16_t version = 0;
-  if (!cursor.read_u16(&version)) {
-    return false;
+  if (unit->version >= 5) {
+    if (!cursor.read_u8(&unit->unit_type) || !cursor.read_u8(&unit->address_size) ||
+        !cursor.read_sized(unit->offset_size, &unit->abbrev_offset)) {
+      return false;
+    }
+    if (unit->unit_type == kDwarfUnitSkeleton || unit->unit_type == kDwarfUnitSplitCompile) {
+      if (!cursor.read_u64(&unit->dwo_id)) {
+        return false;
+      }
+      unit->has_dwo_id = true;
+    } else if (unit->unit_type == kDwarfUnitType || unit->unit_type == kDwarfUnitSplitType) {
+      uint64_t signature = 0;
+      uint64_t type_offset = 0;
+      if (!cursor.read_u64(&signature) || !cursor.read_sized(unit->offset_size, &type_offset)) {
+        return false;
+      }
+    }
+  } else {
+    if (!cursor.read_sized(unit->offset_size, &unit->abbrev_offset) || !cursor.read_u8(&unit->address_size)) {
+      return false;
+    }
   }
-  if (version < 4) {
+  if (unit->address_size != 4 && unit->address_size != 8) {
     if (error) {
-      *error = "DWARF version < 4 not supported";
+      *error = "unsupported address size";
     }
     return false;
   }
+  unit->die_start = cursor.offset;
+  return true;
+}
 
-  uint32_t abbrev_offset = 0;
-  if (!cursor.read_u32(&abbrev_offset)) {
+bool DwarfReader::parse_unit(Cursor& cursor, ghirda::core::DebugInfo* out, std::string* error) {
+  UnitContext unit{};
+  if (!read_unit_header(cursor, &unit, error)) {
     return false;
   }
+  if (unit.die_start == unit.end) {
+    cursor.offset = unit.end;
+    return true;
+  }
 
-  uint8_t address_size = 0;
-  if (!cursor.read_u8(&address_size)) {
+  const AbbrevTable* abbrev = abbrev_table(unit.abbrev_offset, error);
+  if (!abbrev) {
     return false;
   }
+  scan_unit_bases(unit, *abbrev, &unit);
+  if (split_unit_) {
+    unit.addr_base = skeleton_.addr_base;
+    unit.base_address = skeleton_.base_address;
+    // Split units index .debug_rnglists.dwo from just past its header.
+    if (unit.rnglists_base == 0 && unit.version >= 5) {
+      unit.rnglists_base = unit.offset_size == 8 ? 20 : 12;
+    }
+  }
 
-  std::unordered_map<uint32_t, AbbrevEntry> abbrev;
-  if (!parse_abbrev_table(abbrev_offset, &abbrev, error)) {
+  Cursor dies{cursor.data, static_cast<size_t>(unit.die_start)};
+  if (!parse_die_tree(dies, *abbrev, unit, out, error)) {
     return false;
   }
 
-  if (!parse_die_tree(cursor, abbrev, address_size, unit_start, out, error)) {
-    return false;
+  const bool skeleton = unit.unit_type == kDwarfUnitSkeleton || (unit.version < 5 && unit.has_dwo_id);
+  if (skeleton && split_resolver_ && !split_unit_) {
+    parse_split_unit(unit, out);
   }
 
-  cursor.offset = unit_end;
+  cursor.offset = unit.end;
   return true;
 }
 
-bool DwarfReader::parse_abbrev_table(uint64_t offset, std::unordered_map<uint32_t, AbbrevEntry>* table,
-                                     std::string* error) {
-  Cursor cursor{sections_.debug_abbrev.data, static_cast<size_t>(offset)};
+void DwarfReader::parse_split_unit(const UnitContext& skeleton, ghirda::core::DebugInfo* out) {
+  std::string name = skeleton.dwo_name;
+  if (name.empty()) {
+    char id[24];
+    std::snprintf(id, sizeof(id), "0x%016llx", static_cast<unsigned long long>(skeleton.dwo_id));
+    name = id;
+  }
+
+  DwarfSections split{};
+  if (!split_resolver_->resolve(skeleton.dwo_id, skeleton.dwo_name, skeleton.comp_dir, &split, nullptr)) {
+    out->unresolved_split_units.push_back(std::move(name));
+    return;
+  }
+  // addrx forms in the split unit index the skeleton image's .debug_addr.
+  split.debug_addr = sections_.debug_addr;
+
+  DwarfReader reader(std::move(split));
+  reader.split_unit_ = true;
+  reader.skeleton_ = skeleton;
+  reader.offset_bias_ = next_split_bias_;
+  std::string split_error;
+  if (!reader.parse(out, &split_error)) {
+    out->unresolved_split_units.push_back(std::move(name));
+  }
+  next_split_bias_ = std::max(next_split_bias_, reader.next_split_bias_);
+}
+
+const DwarfReader::AbbrevTable* DwarfReader::abbrev_table(uint64_t offset, std::string* error) {
+  auto it = abbrev_cache_.find(offset);
+  if (it != abbrev_cache_.end()) {
+    return &it->second;
+  }
+  AbbrevTable table;
+  if (!parse_abbrev_table(offset, &table, error)) {
+    return nullptr;
+  }
+  return &abbrev_cache_.emplace(offset, std::move(table)).first->second;
+}
+
+bool DwarfReader::parse_abbrev_table(uint64_t offset, AbbrevTable* table, std::string* error) {
+  Cursor cursor{sections_.debug_abbrev.view(), static_cast<size_t>(offset)};
   if (!cursor.data || cursor.offset >= cursor.data->size()) {
     if (error) {
       *error = "invalid abbrev offset";
@@ -330,7 +598,11 @@ bool DwarfReader::parse_abbrev_table(uint64_t offset, std::unordered_map<uint32_
       if (attr_name == 0 && attr_form == 0) {
         break;
       }
-      entry.attributes.push_back(AbbrevAttr{static_cast<uint32_t>(attr_name), static_cast<uint32_t>(attr_form)});
+      AbbrevAttr attr{static_cast<uint32_t>(attr_name), static_cast<uint32_t>(attr_form), 0};
+      if (attr.form == kDwarfFormImplicitConst && !cursor.read_sleb(&attr.implicit_const)) {
+        return false;
+      }
+      entry.attributes.push_back(attr);
     }
 
     (*table)[entry.code] = entry;
@@ -339,7 +611,42 @@ bool DwarfReader::parse_abbrev_table(uint64_t offset, std::unordered_map<uint32_
   return true;
 }
 
-bool DwarfReader::read_form(Cursor& cursor, uint32_t form, uint8_t address_size, uint64_t unit_offset,
+bool DwarfReader::scan_unit_bases(const UnitContext& unit, const AbbrevTable& abbrev, UnitContext* out) {
+  // strx/addrx/rnglistx values on the unit DIE itself may precede the base
+  // attributes they depend on, so pick the bases up in a separate pass.
+  Cursor cursor{sections_.debug_info.view(), static_cast<size_t>(unit.die_start)};
+  uint64_t code = 0;
+  if (!cursor.read_uleb(&code) || code == 0) {
+    return false;
+  }
+  auto it = abbrev.find(static_cast<uint32_t>(code));
+  if (it == abbrev.end()) {
+    return false;
+  }
+  for (const auto& attr : it->second.attributes) {
+    uint64_t value = 0;
+    if (!read_form(cursor, attr.form, attr.implicit_const, unit, &value, nullptr, nullptr)) {
+      return false;
+    }
+    switch (attr.name) {
+      case kDwarfAtStrOffsetsBase:
+        out->str_offsets_base = value;
+        break;
+      case kDwarfAtAddrBase:
+      case kDwarfAtGnuAddrBase:
+        out->addr_base = value;
+        break;
+      case kDwarfAtRnglistsBase:
+        out->rnglists_base = value;
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+bool DwarfReader::read_form(Cursor& cursor, uint32_t form, int64_t implicit_const, const UnitContext& unit,
                             uint64_t* uvalue, int64_t* svalue, std::string* str_value) {
   if (uvalue) {
     *uvalue = 0;
@@ -351,65 +658,40 @@ bool DwarfReader::read_form(Cursor& cursor, uint32_t form, uint8_t address_size,
     str_value->clear();
   }
 
-  switch (form) {
-    case kDwarfFormAddr: {
-      uint64_t value = 0;
-      if (address_size == 8) {
-        if (!cursor.read_u64(&value)) {
-          return false;
-        }
-      } else {
-        uint32_t value32 = 0;
-        if (!cursor.read_u32(&value32)) {
-          return false;
-        }
-        value = value32;
-      }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
-    }
-    case kDwarfFormData1: {
-      uint8_t value = 0;
-      if (!cursor.read_u8(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
-    }
-    case kDwarfFormData2: {
-      uint16_t value = 0;
-      if (!cursor.read_u16(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
+  auto set_u = [&](uint64_t value) {
+    if (uvalue) {
+      *uvalue = value;
     }
-    case kDwarfFormData4: {
-      uint32_t value = 0;
-      if (!cursor.read_u32(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
+    return true;
+  };
+  auto read_fixed = [&](uint8_t size, uint64_t bias) {
+    uint64_t value = 0;
+    if (!cursor.read_sized(size, &value)) {
+      return false;
     }
-    case kDwarfFormData8: {
-      uint64_t value = 0;
-      if (!cursor.read_u64(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
+    return set_u(bias + value);
+  };
+  auto read_strx = [&](uint64_t index) {
+    if (str_value) {
+      *str_value = read_str_index(unit, index);
     }
+    return true;
+  };
+
+  switch (form) {
+    case kDwarfFormAddr:
+      return read_fixed(unit.address_size, 0);
+    case kDwarfFormData1:
+    case kDwarfFormFlag:
+      return read_fixed(1, 0);
+    case kDwarfFormData2:
+      return read_fixed(2, 0);
+    case kDwarfFormData4:
+      return read_fixed(4, 0);
+    case kDwarfFormData8:
+      return read_fixed(8, 0);
+    case kDwarfFormData16:
+      return cursor.skip(16);
     case kDwarfFormSdata: {
       int64_t value = 0;
       if (!cursor.read_sleb(&value)) {
@@ -425,11 +707,13 @@ bool DwarfReader::read_form(Cursor& cursor, uint32_t form, uint8_t address_size,
       if (!cursor.read_uleb(&value)) {
         return false;
       }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
+      return set_u(value);
     }
+    case kDwarfFormImplicitConst:
+      if (svalue) {
+        *svalue = implicit_const;
+      }
+      return set_u(static_cast<uint64_t>(implicit_const));
     case kDwarfFormString: {
       if (!str_value) {
         std::string tmp;
@@ -438,8 +722,8 @@ bool DwarfReader::read_form(Cursor& cursor, uint32_t form, uint8_t address_size,
       return cursor.read_cstring(str_value);
     }
     case kDwarfFormStrp: {
-      uint32_t offset = 0;
-      if (!cursor.read_u32(&offset)) {
+      uint64_t offset = 0;
+      if (!cursor.read_sized(unit.offset_size, &offset)) {
         return false;
       }
       if (str_value) {
@@ -447,101 +731,87 @@ bool DwarfReader::read_form(Cursor& cursor, uint32_t form, uint8_t address_size,
       }
       return true;
     }
-    case kDwarfFormSecOffset: {
-      uint32_t value = 0;
-      if (!cursor.read_u32(&value)) {
+    case kDwarfFormLineStrp: {
+      uint64_t offset = 0;
+      if (!cursor.read_sized(unit.offset_size, &offset)) {
         return false;
       }
-      if (uvalue) {
-        *uvalue = value;
+      if (str_value) {
+        *str_value = read_line_str(offset);
       }
       return true;
     }
-    case kDwarfFormFlag: {
-      uint8_t value = 0;
-      if (!cursor.read_u8(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = value;
-      }
-      return true;
+    case kDwarfFormStrx:
+    case kDwarfFormGnuStrIndex: {
+      uint64_t index = 0;
+      return cursor.read_uleb(&index) && read_strx(index);
     }
-    case kDwarfFormFlagPresent: {
-      if (uvalue) {
-        *uvalue = 1;
-      }
-      return true;
+    case kDwarfFormStrx1:
+    case kDwarfFormStrx2:
+    case kDwarfFormStrx3:
+    case kDwarfFormStrx4: {
+      uint64_t index = 0;
+      return cursor.read_sized(static_cast<uint8_t>(form - kDwarfFormStrx1 + 1), &index) && read_strx(index);
     }
-    case kDwarfFormRef1: {
-      uint8_t value = 0;
-      if (!cursor.read_u8(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = unit_offset + value;
-      }
-      return true;
+    case kDwarfFormAddrx:
+    case kDwarfFormGnuAddrIndex: {
+      uint64_t index = 0;
+      return cursor.read_uleb(&index) && set_u(read_addr_index(unit, index));
     }
-    case kDwarfFormRef2: {
-      uint16_t value = 0;
-      if (!cursor.read_u16(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = unit_offset + value;
-      }
-      return true;
+    case kDwarfFormAddrx1:
+    case kDwarfFormAddrx2:
+    case kDwarfFormAddrx3:
+    case kDwarfFormAddrx4: {
+      uint64_t index = 0;
+      return cursor.read_sized(static_cast<uint8_t>(form - kDwarfFormAddrx1 + 1), &index) &&
+             set_u(read_addr_index(unit, index));
     }
-    case kDwarfFormRef4: {
-      uint32_t value = 0;
-      if (!cursor.read_u32(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = unit_offset + value;
-      }
-      return true;
-    }
-    case kDwarfFormRef8: {
-      uint64_t value = 0;
-      if (!cursor.read_u64(&value)) {
-        return false;
-      }
-      if (uvalue) {
-        *uvalue = unit_offset + value;
-      }
-      return true;
+    case kDwarfFormSecOffset:
+      return read_fixed(unit.offset_size, 0);
+    case kDwarfFormLoclistx:
+    case kDwarfFormRnglistx: {
+      uint64_t index = 0;
+      return cursor.read_uleb(&index) && set_u(index);
     }
+    case kDwarfFormFlagPresent:
+      return set_u(1);
+    case kDwarfFormRef1:
+      return read_fixed(1, offset_bias_ + unit.offset);
+    case kDwarfFormRef2:
+      return read_fixed(2, offset_bias_ + unit.offset);
+    case kDwarfFormRef4:
+      return read_fixed(4, offset_bias_ + unit.offset);
+    case kDwarfFormRef8:
+      return read_fixed(8, offset_bias_ + unit.offset);
     case kDwarfFormRefUdata: {
       uint64_t value = 0;
       if (!cursor.read_uleb(&value)) {
         return false;
       }
-      if (uvalue) {
-        *uvalue = unit_offset + value;
-      }
-      return true;
+      return set_u(offset_bias_ + unit.offset + value);
     }
-    case kDwarfFormRefAddr: {
-      uint64_t value = 0;
-      if (address_size == 8) {
-        if (!cursor.read_u64(&value)) {
-          return false;
-        }
-      } else {
-        uint32_t value32 = 0;
-        if (!cursor.read_u32(&value32)) {
-          return false;
-        }
-        value = value32;
-      }
-      if (uvalue) {
-        *uvalue = value;
+    case kDwarfFormRefAddr:
+      return read_fixed(unit.version <= 2 ? unit.address_size : unit.offset_size, offset_bias_);
+    case kDwarfFormRefSig8:
+      // Type-unit signatures do not name a .debug_info offset.
+      return cursor.skip(8);
+    case kDwarfFormRefSup4:
+      return cursor.skip(4);
+    case kDwarfFormRefSup8:
+      return cursor.skip(8);
+    case kDwarfFormStrpSup:
+    case kDwarfFormGnuRefAlt:
+    case kDwarfFormGnuStrpAlt:
+      return cursor.skip(unit.offset_size);
+    case kDwarfFormIndirect: {
+      uint64_t actual = 0;
+      if (!cursor.read_uleb(&actual) || actual == kDwarfFormIndirect) {
+        return false;
       }
-      return true;
+      return read_form(cursor, static_cast<uint32_t>(actual), implicit_const, unit, uvalue, svalue, str_value);
     }
-    case kDwarfFormExprloc: {
+    case kDwarfFormExprloc:
+    case kDwarfFormBlock: {
       uint64_t length = 0;
       if (!cursor.read_uleb(&length)) {
         return false;
@@ -569,30 +839,226 @@ bool DwarfReader::read_form(Cursor& cursor, uint32_t form, uint8_t address_size,
       }
       return cursor.skip(length);
     }
-    case kDwarfFormBlock: {
-      uint64_t length = 0;
-      if (!cursor.read_uleb(&length)) {
+    default:
+      return false;
+  }
+}
+
+bool DwarfReader::read_ranges(const UnitContext& unit, uint64_t value, uint32_t form,
+                              std::vector<std::pair<uint64_t, uint64_t>>* ranges) {
+  ranges->clear();
+  const auto* data = sections_.debug_rnglists.view();
+  if (!data || unit.version < 5) {
+    return false;
+  }
+  uint64_t offset = value;
+  if (form == kDwarfFormRnglistx) {
+    Cursor table{data, static_cast<size_t>(unit.rnglists_base + value * unit.offset_size)};
+    if (!table.read_sized(unit.offset_size, &offset)) {
+      return false;
+    }
+    offset += unit.rnglists_base;
+  }
+
+  Cursor cursor{data, static_cast<size_t>(offset)};
+  uint64_t base = unit.base_address;
+  while (true) {
+    uint8_t kind = 0;
+    if (!cursor.read_u8(&kind)) {
+      return false;
+    }
+    uint64_t a = 0;
+    uint64_t b = 0;
+    switch (kind) {
+      case kRleEndOfList:
+        return !ranges->empty();
+      case kRleBaseAddressx:
+        if (!cursor.read_uleb(&a)) {
+          return false;
+        }
+        base = read_addr_index(unit, a);
+        break;
+      case kRleStartxEndx:
+        if (!cursor.read_uleb(&a) || !cursor.read_uleb(&b)) {
+          return false;
+        }
+        ranges->emplace_back(read_addr_index(unit, a), read_addr_index(unit, b));
+        break;
+      case kRleStartxLength:
+        if (!cursor.read_uleb(&a) || !cursor.read_uleb(&b)) {
+          return false;
+        }
+        a = read_addr_index(unit, a);
+        ranges->emplace_back(a, a + b);
+        break;
+      case kRleOffsetPair:
+        if (!cursor.read_uleb(&a) || !cursor.read_uleb(&b)) {
+          return false;
+        }
+        ranges->emplace_back(base + a, base + b);
+        break;
+      case kRleBaseAddress:
+        if (!cursor.read_sized(unit.address_size, &base)) {
+          return false;
+        }
+        break;
+      case kRleStartEnd:
+        if (!cursor.read_sized(unit.address_size, &a) || !cursor.read_sized(unit.address_size, &b)) {
+          return false;
+        }
+        ranges->emplace_back(a, b);
+        break;
+      case kRleStartLength:
+        if (!cursor.read_sized(unit.address_size, &a) || !cursor.read_uleb(&b)) {
+          return false;
+        }
+        ranges->emplace_back(a, a + b);
+        break;
+      default:
         return false;
-      }
-      return cursor.skip(static_cast<size_t>(length));
     }
-    default:
+  }
+}
+
+void DwarfReader::resolve_pc_range(const UnitContext& unit, Die* die) {
+  if (die->high_pc != 0 && die->low_pc != 0 && die->high_pc_is_offset) {
+    die->high_pc = die->low_pc + die->high_pc;
+  }
+  if (die->low_pc != 0 || die->ranges_form == 0) {
+    return;
+  }
+  // Functions split into hot/cold parts only have DW_AT_ranges; report the
+  // covering interval.
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  if (!read_ranges(unit, die->ranges, die->ranges_form, &ranges)) {
+    return;
+  }
+  uint64_t low = UINT64_MAX;
+  uint64_t high = 0;
+  for (const auto& [start, end] : ranges) {
+    if (start < end) {
+      low = std::min(low, start);
+      high = std::max(high, end);
+    }
+  }
+  if (low < high) {
+    die->low_pc = low;
+    die->high_pc = high;
+  }
+}
+
+bool DwarfReader::read_die(Cursor& cursor, const AbbrevTable& abbrev, const UnitContext& unit, Die* die,
+                           std::string* error) {
+  *die = Die{};
+  die->offset = offset_bias_ + cursor.offset;
+  uint64_t code = 0;
+  if (!cursor.read_uleb(&code)) {
+    return false;
+  }
+  if (code == 0) {
+    return true;
+  }
+  auto it = abbrev.find(static_cast<uint32_t>(code));
+  if (it == abbrev.end()) {
+    if (error) {
+      *error = "unknown abbrev code";
+    }
+    return false;
+  }
+  die->abbrev = &it->second;
+
+  for (const auto& attr : it->second.attributes) {
+    uint64_t uvalue = 0;
+    int64_t svalue = 0;
+    std::string str_value;
+    const bool wants_string = attr.name == kDwarfAtName || attr.name == kDwarfAtDwoName ||
+                              attr.name == kDwarfAtGnuDwoName || attr.name == kDwarfAtCompDir;
+    if (!read_form(cursor, attr.form, attr.implicit_const, unit, &uvalue, &svalue,
+                   wants_string ? &str_value : nullptr)) {
+      if (error && error->empty()) {
+        *error = "unsupported attribute form " + std::to_string(attr.form);
+      }
       return false;
+    }
+
+    switch (attr.name) {
+      case kDwarfAtName:
+        die->name = std::move(str_value);
+        break;
+      case kDwarfAtLowPc:
+        die->low_pc = uvalue;
+        break;
+      case kDwarfAtHighPc:
+        die->high_pc = uvalue;
+        die->high_pc_is_offset = !is_address_form(attr.form);
+        break;
+      case kDwarfAtRanges:
+        die->ranges = uvalue;
+        die->ranges_form = attr.form;
+        break;
+      case kDwarfAtStmtList:
+        die->stmt_list = uvalue;
+        die->has_stmt_list = true;
+        break;
+      case kDwarfAtByteSize:
+        die->byte_size = uvalue;
+        break;
+      case kDwarfAtType:
+        die->type_ref = uvalue;
+        break;
+      case kDwarfAtDataMemberLocation:
+        die->member_location = uvalue;
+        break;
+      case kDwarfAtUpperBound:
+        die->upper_bound = uvalue;
+        break;
+      case kDwarfAtLowerBound:
+        die->lower_bound = uvalue;
+        break;
+      case kDwarfAtCount:
+        die->count = uvalue;
+        break;
+      case kDwarfAtBitSize:
+        die->bit_size = uvalue;
+        break;
+      case kDwarfAtBitOffset:
+        die->bit_offset = static_cast<int64_t>(uvalue);
+        break;
+      case kDwarfAtDataBitOffset:
+        die->data_bit_offset = static_cast<int64_t>(uvalue);
+        break;
+      case kDwarfAtAlignment:
+        die->alignment = uvalue;
+        break;
+      case kDwarfAtDwoName:
+      case kDwarfAtGnuDwoName:
+        die->dwo_name = std::move(str_value);
+        break;
+      case kDwarfAtCompDir:
+        die->comp_dir = std::move(str_value);
+        break;
+      case kDwarfAtGnuDwoId:
+        die->dwo_id = uvalue;
+        die->has_dwo_id = true;
+        break;
+      default:
+        break;
+    }
   }
+  return true;
 }
 
-bool DwarfReader::parse_die_tree(Cursor& cursor, const std::unordered_map<uint32_t, AbbrevEntry>& abbrev,
-                                 uint8_t address_size, uint64_t unit_offset, ghirda::core::DebugInfo* out,
-                                 std::string* error) {
+bool DwarfReader::parse_die_tree(Cursor& cursor, const AbbrevTable& abbrev, UnitContext& unit,
+                                 ghirda::core::DebugInfo* out, std::string* error) {
   std::vector<bool> has_children_stack;
   std::vector<int> type_stack;
 
-  while (cursor.offset < cursor.data->size()) {
-    uint64_t code = 0;
-    if (!cursor.read_uleb(&code)) {
+  Die die;
+  while (cursor.offset < unit.end) {
+    if (!read_die(cursor, abbrev, unit, &die, error)) {
       return false;
     }
-    if (code == 0) {
+    if (!die.abbrev) {
       if (has_children_stack.empty()) {
         return true;
       }
@@ -600,118 +1066,48 @@ bool DwarfReader::parse_die_tree(Cursor& cursor, const std::unordered_map<uint32
       if (!type_stack.empty()) {
         type_stack.pop_back();
       }
+      if (has_children_stack.empty()) {
+        return true;
+      }
       continue;
     }
 
-    auto it = abbrev.find(static_cast<uint32_t>(code));
-    if (it == abbrev.end()) {
-      if (error) {
-        *error = "unknown abbrev code";
-      }
-      return false;
-    }
+    const AbbrevEntry& entry = *die.abbrev;
 
-    const AbbrevEntry& entry = it->second;
-    uint64_t die_offset = cursor.offset;
-    uint64_t low_pc = 0;
-    uint64_t high_pc = 0;
-    uint64_t stmt_list = 0;
-    uint64_t byte_size = 0;
-    uint64_t type_ref = 0;
-    uint64_t member_location = 0;
-    uint64_t upper_bound = 0;
-    uint64_t lower_bound = 0;
-    uint64_t count = 0;
-    uint64_t bit_size = 0;
-    int64_t bit_offset = -1;
-    int64_t data_bit_offset = -1;
-    uint64_t alignment = 0;
-    std::string name;
-    uint32_t high_pc_form = 0;
-
-    for (const auto& attr : entry.attributes) {
-      uint64_t uvalue = 0;
-      int64_t svalue = 0;
-      std::string str_value;
-      if (!read_form(cursor, attr.form, address_size, unit_offset, &uvalue, &svalue, &str_value)) {
-        return false;
+    if (entry.tag == kDwarfTagCompileUnit || entry.tag == kDwarfTagSkeletonUnit) {
+      unit.dwo_name = std::move(die.dwo_name);
+      unit.comp_dir = std::move(die.comp_dir);
+      if (die.has_dwo_id) {
+        unit.dwo_id = die.dwo_id;
+        unit.has_dwo_id = true;
       }
-
-      switch (attr.name) {
-        case kDwarfAtName:
-          name = str_value;
-          break;
-        case kDwarfAtLowPc:
-          low_pc = uvalue;
-          break;
-        case kDwarfAtHighPc:
-          high_pc = uvalue;
-          high_pc_form = attr.form;
-          break;
-        case kDwarfAtStmtList:
-          stmt_list = uvalue;
-          break;
-        case kDwarfAtByteSize:
-          byte_size = uvalue;
-          break;
-        case kDwarfAtType:
-          type_ref = uvalue;
-          break;
-        case kDwarfAtDataMemberLocation:
-          member_location = uvalue;
-          break;
-        case kDwarfAtUpperBound:
-          upper_bound = uvalue;
-          break;
-        case kDwarfAtLowerBound:
-          lower_bound = uvalue;
-          break;
-        case kDwarfAtCount:
-          count = uvalue;
-          break;
-        case kDwarfAtBitSize:
-          bit_size = uvalue;
-          break;
-        case kDwarfAtBitOffset:
-          bit_offset = static_cast<int64_t>(uvalue);
-          break;
-        case kDwarfAtDataBitOffset:
-          data_bit_offset = static_cast<int64_t>(uvalue);
-          break;
-        case kDwarfAtAlignment:
-          alignment = uvalue;
-          break;
-        default:
-          break;
+      if (!split_unit_) {
+        unit.base_address = die.low_pc;
+        if (die.has_stmt_list) {
+          parse_line_program(die.stmt_list, unit, out, error);
+        }
       }
     }
 
-    if (high_pc != 0 && low_pc != 0 && is_high_pc_offset_form(high_pc_form)) {
-      high_pc = low_pc + high_pc;
-    }
-
-    if (entry.tag == kDwarfTagCompileUnit && stmt_list != 0) {
-      parse_line_program(stmt_list, out, error);
-    }
-
-    if (entry.tag == kDwarfTagSubprogram && !name.empty()) {
+    if (entry.tag == kDwarfTagSubprogram && !die.name.empty()) {
+      resolve_pc_range(unit, &die);
       ghirda::core::DebugFunction func{};
-      func.name = name;
-      func.low_pc = low_pc;
-      func.high_pc = high_pc;
-      func.return_type_ref = type_ref;
+      func.name = die.name;
+      func.low_pc = die.low_pc;
+      func.high_pc = die.high_pc;
+      func.return_type_ref = die.type_ref;
       out->functions.push_back(func);
     }
 
     if (entry.tag == kDwarfTagMember) {
       if (!type_stack.empty() && type_stack.back() >= 0) {
         ghirda::core::DebugMember member{};
-        member.name = name;
-        member.type_ref = type_ref;
-        member.offset = member_location;
-        member.bit_size = static_cast<uint32_t>(bit_size);
-        member.bit_offset = static_cast<int32_t>(data_bit_offset >= 0 ? data_bit_offset : bit_offset);
-        member.alignment = static_cast<uint32_t>(alignment);
+        member.name = die.name;
+        member.type_ref = die.type_ref;
+        member.offset = die.member_location;
+        member.bit_size = static_cast<uint32_t>(die.bit_size);
+        member.bit_offset = static_cast<int32_t>(die.data_bit_offset >= 0 ? die.data_bit_offset : die.bit_offset);
+        member.alignment = static_cast<uint32_t>(die.alignment);
         out->types[static_cast<size_t>(type_stack.back())].members.push_back(member);
       }
     }
@@ -720,9 +1116,9 @@ bool DwarfReader::parse_die_tree(Cursor& cursor, const std::unordered_map<uint32
       if (!type_stack.empty() && type_stack.back() >= 0) {
         auto& parent = out->types[static_cast<size_t>(type_stack.back())];
         if (parent.kind == ghirda::core::DebugTypeKind::Array) {
-          uint64_t range_count = count;
-          if (range_count == 0 && upper_bound >= lower_bound) {
-            range_count = upper_bound - lower_bound + 1;
+          uint64_t range_count = die.count;
+          if (range_count == 0 && die.upper_bound >= die.lower_bound) {
+            range_count = die.upper_bound - die.lower_bound + 1;
           }
           if (range_count != 0) {
             parent.array_count = range_count;
@@ -738,16 +1134,19 @@ bool DwarfReader::parse_die_tree(Cursor& cursor, const std::unordered_map<uint32
         entry.tag == kDwarfTagConstType || entry.tag == kDwarfTagVolatileType ||
         entry.tag == kDwarfTagEnumerationType || entry.tag == kDwarfTagSubroutineType) {
       ghirda::core::DebugType type{};
-      type.name = name;
-      type.size = static_cast<uint32_t>(byte_size);
-      type.type_ref = type_ref;
-      type.die_offset = die_offset;
+      type.name = die.name;
+      type.size = static_cast<uint32_t>(die.byte_size);
+      type.type_ref = die.type_ref;
+      type.die_offset = die.offset;
       switch (entry.tag) {
         case kDwarfTagBaseType:
           type.kind = ghirda::core::DebugTypeKind::Base;
           break;
         case kDwarfTagPointerType:
           type.kind = ghirda::core::DebugTypeKind::Pointer;
+          if (type.size == 0) {
+            type.size = unit.address_size;
+          }
           break;
         case kDwarfTagStructureType:
           type.kind = ghirda::core::DebugTypeKind::Struct;
@@ -777,12 +1176,10 @@ bool DwarfReader::parse_die_tree(Cursor& cursor, const std::unordered_map<uint32
           type.kind = ghirda::core::DebugTypeKind::Unknown;
           break;
       }
-      if (!type.name.empty()) {
-        out->types.push_back(type);
-        if (entry.has_children) {
-          type_stack.push_back(static_cast<int>(out->types.size() - 1));
-          pushed_type = true;
-        }
+      out->types.push_back(type);
+      if (entry.has_children) {
+        type_stack.push_back(static_cast<int>(out->types.size() - 1));
+        pushed_type = true;
       }
     }
 
@@ -797,17 +1194,114 @@ bool DwarfReader::parse_die_tree(Cursor& cursor, const std::unordered_map<uint32
   return true;
 }
 
-bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* out, std::string* error) {
-  if (!sections_.debug_line.data) {
+bool DwarfReader::has_name_index() {
+  if (!names_loaded_) {
+    names_loaded_ = true;
+    const auto* names = sections_.debug_names.view();
+    const auto* strings = sections_.debug_str.view();
+    if (names && strings) {
+      names_.parse(names, strings, nullptr);
+    }
+  }
+  return !names_.empty();
+}
+
+bool DwarfReader::find_function(const std::string& name, ghirda::core::DebugFunction* out, std::string* error) {
+  if (!sections_.debug_info.view() || !sections_.debug_abbrev.view()) {
+    if (error) {
+      *error = "missing debug sections";
+    }
+    return false;
+  }
+
+  if (!has_name_index()) {
+    ghirda::core::DebugInfo info;
+    if (!parse(&info, error)) {
+      return false;
+    }
+    for (const auto& func : info.functions) {
+      if (func.name == name) {
+        *out = func;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<DwarfNameEntry> entries;
+  if (!names_.lookup(name, &entries)) {
+    return false;
+  }
+  for (const auto& entry : entries) {
+    if (entry.tag != kDwarfTagSubprogram) {
+      continue;
+    }
+    Cursor cursor{sections_.debug_info.view(), static_cast<size_t>(entry.unit_offset)};
+    UnitContext unit{};
+    if (!read_unit_header(cursor, &unit, error)) {
+      return false;
+    }
+    const AbbrevTable* abbrev = abbrev_table(unit.abbrev_offset, error);
+    if (!abbrev) {
+      return false;
+    }
+    scan_unit_bases(unit, *abbrev, &unit);
+
+    // The unit DIE supplies the base address for offset-pair ranges.
+    Cursor unit_cursor{cursor.data, static_cast<size_t>(unit.die_start)};
+    Die unit_die;
+    if (read_die(unit_cursor, *abbrev, unit, &unit_die, error)) {
+      unit.base_address = unit_die.low_pc;
+    }
+
+    Cursor die_cursor{cursor.data, static_cast<size_t>(entry.die_offset)};
+    Die die;
+    if (entry.die_offset >= unit.end || !read_die(die_cursor, *abbrev, unit, &die, error) || !die.abbrev) {
+      continue;
+    }
+    // Declarations carry no pc range; keep looking for the definition.
+    resolve_pc_range(unit, &die);
+    out->name = die.name.empty() ? name : die.name;
+    out->low_pc = die.low_pc;
+    out->high_pc = die.high_pc;
+    out->return_type_ref = die.type_ref;
+    if (die.low_pc != 0) {
+      return true;
+    }
+  }
+  return !out->name.empty();
+}
+
+bool DwarfReader::read_line_entry_formats(Cursor& cursor, std::vector<std::pair<uint64_t, uint64_t>>* formats) {
+  uint8_t count = 0;
+  if (!cursor.read_u8(&count)) {
+    return false;
+  }
+  formats->clear();
+  for (uint8_t i = 0; i < count; ++i) {
+    uint64_t content = 0;
+    uint64_t form = 0;
+    if (!cursor.read_uleb(&content) || !cursor.read_uleb(&form)) {
+      return false;
+    }
+    formats->emplace_back(content, form);
+  }
+  return true;
+}
+
+bool DwarfReader::parse_line_program(uint64_t offset, const UnitContext& unit, ghirda::core::DebugInfo* out,
+                                     std::string* error) {
+  if (!sections_.debug_line.view()) {
     return false;
   }
 
-  Cursor cursor{sections_.debug_line.data, static_cast<size_t>(offset)};
-  uint32_t unit_length = 0;
-  if (!cursor.read_u32(&unit_length)) {
+  Cursor cursor{sections_.debug_line.view(), static_cast<size_t>(offset)};
+  UnitContext line_unit = unit;
+  uint64_t unit_length = 0;
+  if (!cursor.read_initial_length(&unit_length, &line_unit.offset_size)) {
     return false;
   }
-  if (unit_length == 0 || unit_length == 0xffffffffu) {
+  if (unit_length == 0 || unit_length > cursor.data->size() - cursor.offset) {
     return false;
   }
   size_t unit_end = cursor.offset + unit_length;
@@ -816,15 +1310,23 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
   if (!cursor.read_u16(&header.version)) {
     return false;
   }
-  if (header.version < 4) {
+  if (header.version < 2 || header.version > 5) {
     if (error) {
-      *error = "DWARF line version < 4 not supported";
+      *error = "unsupported DWARF line version " + std::to_string(header.version);
     }
     return false;
   }
+  line_unit.version = header.version;
 
-  uint32_t header_length = 0;
-  if (!cursor.read_u32(&header_length)) {
+  if (header.version >= 5) {
+    uint8_t segment_selector_size = 0;
+    if (!cursor.read_u8(&line_unit.address_size) || !cursor.read_u8(&segment_selector_size)) {
+      return false;
+    }
+  }
+
+  uint64_t header_length = 0;
+  if (!cursor.read_sized(line_unit.offset_size, &header_length)) {
     return false;
   }
   size_t header_end = cursor.offset + header_length;
@@ -832,7 +1334,7 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
   if (!cursor.read_u8(&header.min_inst_length)) {
     return false;
   }
-  if (!cursor.read_u8(&header.max_ops_per_inst)) {
+  if (header.version >= 4 && !cursor.read_u8(&header.max_ops_per_inst)) {
     return false;
   }
   if (!cursor.read_u8(&header.default_is_stmt)) {
@@ -847,6 +1349,9 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
   if (!cursor.read_u8(&header.opcode_base)) {
     return false;
   }
+  if (header.line_range == 0) {
+    return false;
+  }
 
   header.standard_opcode_lengths.resize(header.opcode_base > 0 ? header.opcode_base - 1 : 0);
   for (size_t i = 0; i < header.standard_opcode_lengths.size(); ++i) {
@@ -855,42 +1360,109 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
     }
   }
 
-  while (cursor.offset < header_end) {
-    std::string dir;
-    if (!cursor.read_cstring(&dir)) {
+  if (header.version >= 5) {
+    // v5 describes each directory/file entry with a (content, form) list.
+    std::vector<std::pair<uint64_t, uint64_t>> formats;
+    uint64_t count = 0;
+    if (!read_line_entry_formats(cursor, &formats) || !cursor.read_uleb(&count)) {
       return false;
     }
-    if (dir.empty()) {
-      break;
+    for (uint64_t i = 0; i < count; ++i) {
+      std::string dir;
+      for (const auto& [content, form] : formats) {
+        std::string str_value;
+        if (!read_form(cursor, static_cast<uint32_t>(form), 0, line_unit, nullptr, nullptr, &str_value)) {
+          return false;
+        }
+        if (content == kDwarfLnctPath) {
+          dir = std::move(str_value);
+        }
+      }
+      header.include_dirs.push_back(std::move(dir));
     }
-    header.include_dirs.push_back(dir);
-  }
-
-  while (cursor.offset < header_end) {
-    std::string name;
-    if (!cursor.read_cstring(&name)) {
+    if (!read_line_entry_formats(cursor, &formats) || !cursor.read_uleb(&count)) {
       return false;
     }
-    if (name.empty()) {
-      break;
+    for (uint64_t i = 0; i < count; ++i) {
+      LineFile file;
+      for (const auto& [content, form] : formats) {
+        uint64_t uvalue = 0;
+        std::string str_value;
+        if (!read_form(cursor, static_cast<uint32_t>(form), 0, line_unit, &uvalue, nullptr, &str_value)) {
+          return false;
+        }
+        if (content == kDwarfLnctPath) {
+          file.name = std::move(str_value);
+        } else if (content == kDwarfLnctDirectoryIndex) {
+          file.dir_index = static_cast<uint32_t>(uvalue);
+        }
+      }
+      header.files.push_back(std::move(file));
     }
-    uint64_t dir_index = 0;
-    uint64_t mod_time = 0;
-    uint64_t length = 0;
-    if (!cursor.read_uleb(&dir_index) || !cursor.read_uleb(&mod_time) || !cursor.read_uleb(&length)) {
-      return false;
+  } else {
+    header.include_dirs.emplace_back();
+    header.files.emplace_back();
+    while (cursor.offset < header_end) {
+      std::string dir;
+      if (!cursor.read_cstring(&dir)) {
+        return false;
+      }
+      if (dir.empty()) {
+        break;
+      }
+      header.include_dirs.push_back(dir);
+    }
+
+    while (cursor.offset < header_end) {
+      std::string name;
+      if (!cursor.read_cstring(&name)) {
+        return false;
+      }
+      if (name.empty()) {
+        break;
+      }
+      uint64_t dir_index = 0;
+      uint64_t mod_time = 0;
+      uint64_t length = 0;
+      if (!cursor.read_uleb(&dir_index) || !cursor.read_uleb(&mod_time) || !cursor.read_uleb(&length)) {
+        return false;
+      }
+      LineFile file;
+      file.name = name;
+      file.dir_index = static_cast<uint32_t>(dir_index);
+      header.files.push_back(file);
     }
-    LineFile file;
-    file.name = name;
-    file.dir_index = static_cast<uint32_t>(dir_index);
-    header.files.push_back(file);
   }
+  cursor.offset = header_end;
 
   uint64_t address = 0;
   uint32_t line = 1;
   uint32_t file = 1;
   bool is_stmt = header.default_is_stmt != 0;
 
+  std::vector<std::string> paths(header.files.size());
+  auto emit_row = [&]() {
+    if (file == 0 && header.version < 5) {
+      return;
+    }
+    if (file >= header.files.size()) {
+      return;
+    }
+    if (paths[file].empty()) {
+      const auto& f = header.files[file];
+      std::string dir;
+      if (f.dir_index < header.include_dirs.size()) {
+        dir = header.include_dirs[f.dir_index];
+      }
+      paths[file] = (!f.name.empty() && f.name.front() == '/') ? f.name : join_path(dir, f.name);
+    }
+    ghirda::core::DebugLineEntry entry{};
+    entry.address = address;
+    entry.line = line;
+    entry.file = paths[file];
+    out->lines.push_back(entry);
+  };
+
   while (cursor.offset < unit_end) {
     uint8_t opcode = 0;
     if (!cursor.read_u8(&opcode)) {
@@ -899,18 +1471,22 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
 
     if (opcode == 0) {
       uint64_t ext_len = 0;
-      if (!cursor.read_uleb(&ext_len)) {
+      if (!cursor.read_uleb(&ext_len) || ext_len == 0) {
         return false;
       }
       uint8_t sub = 0;
       if (!cursor.read_u8(&sub)) {
         return false;
       }
-      if (sub == 1) {
+      if (sub == kLineExtEndSequence) {
         address = 0;
         line = 1;
         file = 1;
         is_stmt = header.default_is_stmt != 0;
+      } else if (sub == kLineExtSetAddress && ext_len - 1 <= 8) {
+        if (!cursor.read_sized(static_cast<uint8_t>(ext_len - 1), &address)) {
+          return false;
+        }
       } else {
         if (!cursor.skip(ext_len - 1)) {
           return false;
@@ -921,21 +1497,9 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
 
     if (opcode < header.opcode_base) {
       switch (opcode) {
-        case kLineOpCopy: {
-          if (file > 0 && file <= header.files.size()) {
-            const auto& f = header.files[file - 1];
-            std::string dir;
-            if (f.dir_index > 0 && f.dir_index <= header.include_dirs.size()) {
-              dir = header.include_dirs[f.dir_index - 1];
-            }
-            ghirda::core::DebugLineEntry entry{};
-            entry.address = address;
-            entry.line = line;
-            entry.file = join_path(dir, f.name);
-            out->lines.push_back(entry);
-          }
+        case kLineOpCopy:
+          emit_row();
           break;
-        }
         case kLineOpAdvancePc: {
           uint64_t advance = 0;
           if (!cursor.read_uleb(&advance)) {
@@ -1017,18 +1581,7 @@ bool DwarfReader::parse_line_program(uint64_t offset, ghirda::core::DebugInfo* o
     int64_t advance_line = header.line_base + static_cast<int8_t>(adjusted % header.line_range);
     address += advance_addr;
     line = static_cast<uint32_t>(static_cast<int64_t>(line) + advance_line);
-    if (file > 0 && file <= header.files.size()) {
-      const auto& f = header.files[file - 1];
-      std::string dir;
-      if (f.dir_index > 0 && f.dir_index <= header.include_dirs.size()) {
-        dir = header.include_dirs[f.dir_index - 1];
-      }
-      ghirda::core::DebugLineEntry entry{};
-      entry.address = address;
-      entry.line = line;
-      entry.file = join_path(dir, f.name);
-      out->lines.push_back(entry);
-    }
+    emit_row();
   }
 
   return true;
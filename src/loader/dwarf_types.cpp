@@ -0,0 +1,374 @@
+#include "ghirda/loader/dwarf_types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+namespace ghirda::loader {
+namespace {
+
+constexpr uint32_t kNoNode = UINT32_MAX;
+constexpr size_t kParallelThreshold = 4096;
+
+constexpr uint8_t kStateUnvisited = 0;
+constexpr uint8_t kStateActive = 1;
+constexpr uint8_t kStateDone = 2;
+
+bool has_type_ref(ghirda::core::DebugTypeKind kind) {
+  switch (kind) {
+    case ghirda::core::DebugTypeKind::Pointer:
+    case ghirda::core::DebugTypeKind::Const:
+    case ghirda::core::DebugTypeKind::Volatile:
+    case ghirda::core::DebugTypeKind::Typedef:
+    case ghirda::core::DebugTypeKind::Array:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Typedef, const and volatile take their target's kind in compute(); alone
+// (no DW_AT_type) they alias void.
+ghirda::core::TypeKind to_type_kind(ghirda::core::DebugTypeKind kind) {
+  switch (kind) {
+    case ghirda::core::DebugTypeKind::Base:
+    case ghirda::core::DebugTypeKind::Enumeration:
+      return ghirda::core::TypeKind::Integer;
+    case ghirda::core::DebugTypeKind::Pointer:
+    case ghirda::core::DebugTypeKind::Subroutine:
+      return ghirda::core::TypeKind::Pointer;
+    case ghirda::core::DebugTypeKind::Struct:
+      return ghirda::core::TypeKind::Struct;
+    case ghirda::core::DebugTypeKind::Union:
+      return ghirda::core::TypeKind::Union;
+    case ghirda::core::DebugTypeKind::Array:
+      return ghirda::core::TypeKind::Array;
+    default:
+      return ghirda::core::TypeKind::Void;
+  }
+}
+
+uint32_t find_root(std::vector<uint32_t>& parent, uint32_t node) {
+  while (parent[node] != node) {
+    parent[node] = parent[parent[node]];
+    node = parent[node];
+  }
+  return node;
+}
+
+// Name used when spelling a derived type; anonymous aggregates keep no name
+// of their own.
+std::string display_name(const ResolvedType* type) {
+  if (!type) {
+    return "void";
+  }
+  if (!type->name.empty()) {
+    return type->name;
+  }
+  switch (type->kind) {
+    case ghirda::core::TypeKind::Struct:
+      return "struct <anonymous>";
+    case ghirda::core::TypeKind::Union:
+      return "union <anonymous>";
+    default:
+      return "void";
+  }
+}
+
+} // namespace
+
+DwarfTypeResolver::DwarfTypeResolver(const ghirda::core::DebugInfo& debug_info) : debug_info_(debug_info) {
+  const auto& types = debug_info_.types;
+  index_.reserve(types.size());
+  for (size_t i = 0; i < types.size(); ++i) {
+    if (types[i].die_offset != 0) {
+      index_.emplace(types[i].die_offset, static_cast<uint32_t>(i));
+    }
+  }
+
+  target_.assign(types.size(), kNoNode);
+  for (size_t i = 0; i < types.size(); ++i) {
+    if (!has_type_ref(types[i].kind)) {
+      continue;
+    }
+    auto it = index_.find(types[i].type_ref);
+    if (it != index_.end()) {
+      target_[i] = it->second;
+    }
+  }
+  results_.resize(types.size());
+}
+
+void DwarfTypeResolver::resolve(size_t thread_count) {
+  const size_t count = results_.size();
+  std::vector<uint8_t> state(count, kStateUnvisited);
+
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  if (count < kParallelThreshold || thread_count == 1) {
+    std::vector<uint32_t> all(count);
+    std::iota(all.begin(), all.end(), 0u);
+    resolve_component(all, &state);
+    return;
+  }
+
+  std::vector<uint32_t> parent(count);
+  std::iota(parent.begin(), parent.end(), 0u);
+  for (size_t i = 0; i < count; ++i) {
+    if (target_[i] == kNoNode) {
+      continue;
+    }
+    uint32_t a = find_root(parent, static_cast<uint32_t>(i));
+    uint32_t b = find_root(parent, target_[i]);
+    if (a != b) {
+      parent[std::max(a, b)] = std::min(a, b);
+    }
+  }
+
+  std::unordered_map<uint32_t, size_t> slot;
+  std::vector<std::vector<uint32_t>> components;
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t root = find_root(parent, static_cast<uint32_t>(i));
+    auto [it, inserted] = slot.emplace(root, components.size());
+    if (inserted) {
+      components.emplace_back();
+    }
+    components[it->second].push_back(static_cast<uint32_t>(i));
+  }
+  std::sort(components.begin(), components.end(),
+            [](const auto& a, const auto& b) { return a.size() > b.size(); });
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    while (true) {
+      size_t index = next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= components.size()) {
+        break;
+      }
+      resolve_component(components[index], &state);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, components.size());
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void DwarfTypeResolver::resolve_component(const std::vector<uint32_t>& nodes, std::vector<uint8_t>* state) {
+  std::vector<uint32_t> chain;
+  for (uint32_t start : nodes) {
+    if ((*state)[start] == kStateDone) {
+      continue;
+    }
+    chain.clear();
+    uint32_t node = start;
+    while (node != kNoNode && (*state)[node] == kStateUnvisited) {
+      (*state)[node] = kStateActive;
+      chain.push_back(node);
+      node = target_[node];
+    }
+    if (node != kNoNode && (*state)[node] == kStateActive) {
+      const auto& dt = debug_info_.types[node];
+      results_[node] = ResolvedType{dt.name, dt.size, to_type_kind(dt.kind)};
+    }
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      results_[*it] = compute(*it);
+      (*state)[*it] = kStateDone;
+    }
+  }
+}
+
+const ResolvedType* DwarfTypeResolver::target_of(uint32_t node) const {
+  if (target_[node] == kNoNode) {
+    return nullptr;
+  }
+  return &results_[target_[node]];
+}
+
+ResolvedType DwarfTypeResolver::compute(uint32_t node) const {
+  const ghirda::core::DebugType& dt = debug_info_.types[node];
+  ResolvedType out{dt.name, dt.size, to_type_kind(dt.kind)};
+  const ResolvedType* target = target_of(node);
+  const std::string target_name = display_name(target);
+  const uint32_t target_size = target ? target->size : 0;
+
+  switch (dt.kind) {
+    case ghirda::core::DebugTypeKind::Pointer:
+      // The reader sizes pointers without DW_AT_byte_size from their unit.
+      out.name = target_name + "*";
+      break;
+    case ghirda::core::DebugTypeKind::Const:
+      out.name = "const " + target_name;
+      out.kind = target ? target->kind : ghirda::core::TypeKind::Void;
+      if (out.size == 0) {
+        out.size = target_size;
+      }
+      break;
+    case ghirda::core::DebugTypeKind::Volatile:
+      out.name = "volatile " + target_name;
+      out.kind = target ? target->kind : ghirda::core::TypeKind::Void;
+      if (out.size == 0) {
+        out.size = target_size;
+      }
+      break;
+    case ghirda::core::DebugTypeKind::Typedef:
+      if (out.name.empty()) {
+        out.name = target_name;
+      }
+      out.kind = target ? target->kind : ghirda::core::TypeKind::Void;
+      if (out.size == 0) {
+        out.size = target_size;
+      }
+      break;
+    case ghirda::core::DebugTypeKind::Array: {
+      const std::string& base = target_name;
+      if (dt.array_count != 0) {
+        out.name = base + "[" + std::to_string(dt.array_count) + "]";
+      } else {
+        out.name = base + "[]";
+      }
+      if (out.size == 0 && target_size != 0 && dt.array_count != 0) {
+        out.size = static_cast<uint32_t>(target_size * dt.array_count);
+      }
+      break;
+    }
+    case ghirda::core::DebugTypeKind::Enumeration:
+      if (out.name.empty() && dt.die_offset != 0) {
+        out.name = "enum_" + std::to_string(dt.die_offset);
+      }
+      break;
+    case ghirda::core::DebugTypeKind::Subroutine:
+      out.name = out.name.empty() ? "fn" : out.name;
+      break;
+    default:
+      break;
+  }
+  return out;
+}
+
+const ResolvedType* DwarfTypeResolver::find(uint64_t die_offset) const {
+  auto it = index_.find(die_offset);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  return &results_[it->second];
+}
+
+void DwarfTypeResolver::emit(ghirda::core::TypeSystem* types) const {
+  if (!types) {
+    return;
+  }
+  const auto& debug_types = debug_info_.types;
+  // Anonymous structs and unions are added unnamed, so identical ones merge.
+  const auto emitted = [&](uint32_t node) {
+    const auto& dt = debug_types[node];
+    const bool aggregate =
+        dt.kind == ghirda::core::DebugTypeKind::Struct || dt.kind == ghirda::core::DebugTypeKind::Union;
+    if (dt.die_offset == 0 || (results_[node].name.empty() && !aggregate)) {
+      return false;
+    }
+    auto owner = index_.find(dt.die_offset);
+    return owner != index_.end() && owner->second == node;
+  };
+  const auto member_node = [&](const ghirda::core::DebugMember& member) {
+    auto it = index_.find(member.type_ref);
+    return it == index_.end() ? kNoNode : it->second;
+  };
+  const auto has_members = [&](uint32_t node) {
+    const auto kind = debug_types[node].kind;
+    return kind == ghirda::core::DebugTypeKind::Struct || kind == ghirda::core::DebugTypeKind::Union;
+  };
+
+  // Member types are added before their struct so the struct is interned with
+  // their ids; a by-value cycle (malformed input) falls back to link_members().
+  std::vector<ghirda::core::TypeId> ids(debug_types.size(), ghirda::core::kInvalidTypeId);
+  std::vector<uint8_t> state(debug_types.size(), kStateUnvisited);
+  std::vector<std::pair<uint32_t, size_t>> stack;
+  for (uint32_t root = 0; root < debug_types.size(); ++root) {
+    if (state[root] != kStateUnvisited || !emitted(root)) {
+      continue;
+    }
+    state[root] = kStateActive;
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      const uint32_t node = stack.back().first;
+      const auto& dt = debug_types[node];
+      if (has_members(node) && stack.back().second < dt.members.size()) {
+        const uint32_t child = member_node(dt.members[stack.back().second++]);
+        if (child != kNoNode && state[child] == kStateUnvisited && emitted(child)) {
+          state[child] = kStateActive;
+          stack.emplace_back(child, 0);
+        }
+        continue;
+      }
+      stack.pop_back();
+
+      ghirda::core::Type type_def{};
+      type_def.kind = results_[node].kind;
+      type_def.name = results_[node].name;
+      type_def.size = results_[node].size;
+      if (has_members(node)) {
+        for (const auto& member : dt.members) {
+          ghirda::core::TypeMember tm{};
+          tm.name = member.name;
+          const uint32_t child = member_node(member);
+          const ResolvedType* member_type = child == kNoNode ? nullptr : &results_[child];
+          tm.type_name = member_type ? member_type->name : "void";
+          tm.type_id = child == kNoNode ? ghirda::core::kInvalidTypeId : ids[child];
+          tm.size = member_type ? member_type->size : 0;
+          tm.offset = static_cast<uint32_t>(member.offset);
+          tm.bit_size = member.bit_size;
+          tm.bit_offset = member.bit_offset;
+          tm.alignment = member.alignment;
+          if (tm.size == 0 && tm.bit_size != 0) {
+            tm.size = static_cast<uint32_t>((tm.bit_size + 7) / 8);
+          }
+          type_def.members.push_back(tm);
+        }
+      }
+      ids[node] = types->add_type(type_def);
+      state[node] = kStateDone;
+    }
+  }
+  types->link_members();
+}
+
+bool ingest_dwarf(const DwarfSections& sections, ghirda::core::Program* program, std::string* error,
+                  SplitDwarfResolver* split_resolver) {
+  if (!program) {
+    if (error) {
+      *error = "program output is null";
+    }
+    return false;
+  }
+
+  bool ok = true;
+  if (sections.debug_info.present() && sections.debug_abbrev.present()) {
+    DwarfReader reader(sections);
+    reader.set_split_resolver(split_resolver);
+    std::string dwarf_error;
+    if (!reader.parse(&program->debug_info(), &dwarf_error)) {
+      ok = false;
+      if (error) {
+        *error = "DWARF parse failed: " + dwarf_error;
+      }
+    }
+  }
+
+  if (!program->debug_info().types.empty()) {
+    DwarfTypeResolver resolver(program->debug_info());
+    resolver.resolve();
+    resolver.emit(&program->types());
+  }
+  return ok;
+}
+
+} // namespace ghirda::loader
@@ -1,13 +1,9 @@
 #include "ghirda/loader/elf_loader.h"
 
 #include <algorithm>
-#include <array>
+#include <bit>
 #include <cstdint>
-#include <fstream>
-#include <functional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "ghirda/core/address_space.h"
@@ -15,22 +11,54 @@
 #include "ghirda/core/relocation.h"
 #include "ghirda/core/symbol.h"
 #include "ghirda/core/type_system.h"
+#include "ghirda/loader/debug_section.h"
 #include "ghirda/loader/dwarf_reader.h"
+#include "ghirda/loader/dwarf_types.h"
+#include "ghirda/loader/elf_format.h"
+#include "ghirda/loader/elf_sections.h"
+#include "ghirda/loader/relocation_batch.h"
+#include "ghirda/loader/split_dwarf.h"
 
 namespace ghirda::loader {
 namespace {
 
-constexpr std::array<uint8_t, 4> kElfMagic{0x7f, 'E', 'L', 'F'};
-constexpr uint16_t kElfClass64 = 2;
-constexpr uint16_t kElfDataLittle = 1;
+constexpr uint32_t kElfTypeRelocatable = 1;
 constexpr uint32_t kElfTypeExecutable = 2;
 constexpr uint32_t kElfTypeShared = 3;
 constexpr uint32_t kElfPtLoad = 1;
+constexpr uint32_t kElfPtDynamic = 2;
+constexpr uint32_t kElfPtGnuEhFrame = 0x6474e550;
 constexpr uint32_t kElfShtSymtab = 2;
 constexpr uint32_t kElfShtStrtab = 3;
 constexpr uint32_t kElfShtRela = 4;
 constexpr uint32_t kElfShtRel = 9;
 constexpr uint32_t kElfShtDynsym = 11;
+constexpr uint32_t kElfShtRelr = 19;
+constexpr uint32_t kElfShtNobits = 8;
+constexpr uint64_t kElfShfWrite = 0x1;
+constexpr uint64_t kElfShfAlloc = 0x2;
+constexpr uint64_t kElfShfExecinstr = 0x4;
+// Where the allocated sections of a relocatable object are laid out.
+constexpr uint64_t kRelocatableBase = 0x10000;
+
+constexpr uint16_t kElfMachine386 = 3;
+constexpr uint16_t kElfMachineMips = 8;
+constexpr uint16_t kElfMachinePpc = 20;
+constexpr uint16_t kElfMachinePpc64 = 21;
+constexpr uint16_t kElfMachineArm = 40;
+constexpr uint16_t kElfMachineX86_64 = 62;
+constexpr uint16_t kElfMachineAarch64 = 183;
+constexpr uint16_t kElfMachineRiscv = 243;
+
+constexpr uint64_t kElfDtNull = 0;
+constexpr uint64_t kElfDtInit = 12;
+constexpr uint64_t kElfDtFini = 13;
+constexpr uint64_t kElfDtInitArray = 25;
+constexpr uint64_t kElfDtFiniArray = 26;
+constexpr uint64_t kElfDtInitArraySz = 27;
+constexpr uint64_t kElfDtFiniArraySz = 28;
+constexpr uint64_t kElfDtPreinitArray = 32;
+constexpr uint64_t kElfDtPreinitArraySz = 33;
 
 constexpr uint8_t kElfSttNotype = 0;
 constexpr uint8_t kElfSttObject = 1;
@@ -39,102 +67,61 @@ constexpr uint8_t kElfSttSection = 3;
 
 constexpr uint32_t kRelaX86_64_64 = 1;
 constexpr uint32_t kRelaX86_64_PC32 = 2;
+constexpr uint32_t kRelaX86_64_PLT32 = 4;
+constexpr uint32_t kRelaX86_64_GotPcRel = 9;
+constexpr uint32_t kRelaX86_64_GotPcRelX = 41;
+constexpr uint32_t kRelaX86_64_RexGotPcRelX = 42;
 constexpr uint32_t kRelaX86_64_32 = 10;
 constexpr uint32_t kRelaX86_64_32S = 11;
 constexpr uint32_t kRelaX86_64_GlobDat = 6;
 constexpr uint32_t kRelaX86_64_JumpSlot = 7;
 constexpr uint32_t kRelaX86_64_Relative = 8;
-
-struct Elf64Header {
-  uint8_t ident[16];
-  uint16_t type;
-  uint16_t machine;
-  uint32_t version;
-  uint64_t entry;
-  uint64_t phoff;
-  uint64_t shoff;
-  uint32_t flags;
-  uint16_t ehsize;
-  uint16_t phentsize;
-  uint16_t phnum;
-  uint16_t shentsize;
-  uint16_t shnum;
-  uint16_t shstrndx;
-};
-
-struct Elf64Phdr {
-  uint32_t type;
-  uint32_t flags;
-  uint64_t offset;
-  uint64_t vaddr;
-  uint64_t paddr;
-  uint64_t filesz;
-  uint64_t memsz;
-  uint64_t align;
-};
-
-struct Elf64Shdr {
-  uint32_t name;
-  uint32_t type;
-  uint64_t flags;
-  uint64_t addr;
-  uint64_t offset;
-  uint64_t size;
-  uint32_t link;
-  uint32_t info;
-  uint64_t addralign;
-  uint64_t entsize;
-};
-
-struct Elf64Sym {
-  uint32_t name;
-  uint8_t info;
-  uint8_t other;
-  uint16_t shndx;
-  uint64_t value;
-  uint64_t size;
-};
-
-struct Elf64Rela {
-  uint64_t offset;
-  uint64_t info;
-  int64_t addend;
-};
-
-struct Elf64Rel {
-  uint64_t offset;
-  uint64_t info;
-};
-
-bool read_exact(std::ifstream& in, void* data, size_t size) {
-  in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
-  return in.good();
-}
-
-bool read_blob(std::ifstream& in, uint64_t offset, uint64_t size, std::vector<uint8_t>* out) {
-  out->assign(static_cast<size_t>(size), 0);
-  in.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
-  if (!in) {
-    return false;
-  }
-  in.read(reinterpret_cast<char*>(out->data()), static_cast<std::streamsize>(size));
-  return in.good();
-}
-
-std::string read_string(const std::vector<uint8_t>& table, uint32_t offset) {
-  if (offset >= table.size()) {
-    return {};
-  }
-  const char* start = reinterpret_cast<const char*>(table.data() + offset);
-  return std::string(start);
-}
+constexpr uint32_t kRelaX86_64_PC64 = 24;
+
+constexpr uint32_t kRel386_32 = 1;
+constexpr uint32_t kRel386_PC32 = 2;
+constexpr uint32_t kRel386_PLT32 = 4;
+constexpr uint32_t kRel386_GlobDat = 6;
+constexpr uint32_t kRel386_JumpSlot = 7;
+constexpr uint32_t kRel386_Relative = 8;
+
+constexpr uint32_t kRelArm_Abs32 = 2;
+constexpr uint32_t kRelArm_Rel32 = 3;
+constexpr uint32_t kRelArm_GlobDat = 21;
+constexpr uint32_t kRelArm_JumpSlot = 22;
+constexpr uint32_t kRelArm_Relative = 23;
+
+constexpr uint32_t kRelMips_32 = 2;
+constexpr uint32_t kRelMips_Rel32 = 3;
+
+constexpr uint32_t kRelaPpc_Addr32 = 1;
+constexpr uint32_t kRelaPpc_GlobDat = 20;
+constexpr uint32_t kRelaPpc_Relative = 22;
+constexpr uint32_t kRelaPpc_Rel32 = 26;
+constexpr uint32_t kRelaPpc64_Addr64 = 38;
+
+constexpr uint32_t kRelaAarch64_Abs64 = 257;
+constexpr uint32_t kRelaAarch64_Abs32 = 258;
+constexpr uint32_t kRelaAarch64_Prel64 = 260;
+constexpr uint32_t kRelaAarch64_Prel32 = 261;
+constexpr uint32_t kRelaAarch64_Jump26 = 282;
+constexpr uint32_t kRelaAarch64_Call26 = 283;
+constexpr uint32_t kRelaAarch64_GlobDat = 1025;
+constexpr uint32_t kRelaAarch64_JumpSlot = 1026;
+constexpr uint32_t kRelaAarch64_Relative = 1027;
+
+constexpr uint32_t kRelaRiscv_32 = 1;
+constexpr uint32_t kRelaRiscv_64 = 2;
+constexpr uint32_t kRelaRiscv_Relative = 3;
+constexpr uint32_t kRelaRiscv_JumpSlot = 5;
+constexpr uint32_t kRelaRiscv_32Pcrel = 57;
+
+// Compressed debug sections at least this large are inflated concurrently up
+// front; smaller ones decode lazily when the DWARF reader first touches them.
+constexpr uint64_t kDebugPrefetchThreshold = 256 * 1024;
 
 uint8_t symbol_type(uint8_t info) { return static_cast<uint8_t>(info & 0x0f); }
 
-uint32_t reloc_type(uint64_t info) { return static_cast<uint32_t>(info & 0xffffffffu); }
-
-uint32_t reloc_sym_index(uint64_t info) { return static_cast<uint32_t>(info >> 32u); }
-
 ghirda::core::SymbolKind to_symbol_kind(uint8_t type) {
   switch (type) {
     case kElfSttFunc:
@@ -148,97 +135,287 @@ ghirda::core::SymbolKind to_symbol_kind(uint8_t type) {
   }
 }
 
-bool apply_reloc(uint32_t type, uint64_t address, uint64_t symbol_value, int64_t addend,
-                 uint64_t load_bias, ghirda::core::MemoryImage* image, std::string* note) {
-  if (!image) {
-    if (note) {
-      *note = "no memory image";
-    }
-    return false;
-  }
+// What a relocation stores, independent of the machine's numbering. S is the
+// symbol value, A the addend, P the place, B the slide. Word kinds take the
+// size of the ELF class.
+enum class RelocKind : uint8_t {
+  Unsupported,
+  Abs64,    // S + A + B
+  Abs32,    // S + A + B, truncated
+  Pc64,     // S + A + B - P
+  Pc32,     // S + A + B - P, truncated
+  Slot,     // S + B, word
+  Relative, // B + A, word
+  Branch26, // (S + A + B - P) >> 2 into the low 26 bits of an instruction
+};
 
-  const uint64_t place = address + load_bias;
-  switch (type) {
-    case kRelaX86_64_64: {
-      uint64_t value = symbol_value + static_cast<uint64_t>(addend) + load_bias;
-      return image->write_u64(place, value);
-    }
-    case kRelaX86_64_PC32: {
-      uint64_t value = symbol_value + static_cast<uint64_t>(addend) + load_bias;
-      uint64_t result = value - place;
-      return image->write_u32(place, static_cast<uint32_t>(result));
-    }
-    case kRelaX86_64_32: {
-      uint64_t value = symbol_value + static_cast<uint64_t>(addend) + load_bias;
-      return image->write_u32(place, static_cast<uint32_t>(value));
-    }
-    case kRelaX86_64_32S: {
-      int64_t value = static_cast<int64_t>(symbol_value) + addend + static_cast<int64_t>(load_bias);
-      return image->write_u32(place, static_cast<uint32_t>(value));
-    }
-    case kRelaX86_64_GlobDat:
-    case kRelaX86_64_JumpSlot: {
-      uint64_t value = symbol_value + load_bias;
-      return image->write_u64(place, value);
-    }
-    case kRelaX86_64_Relative: {
-      uint64_t value = load_bias + static_cast<uint64_t>(addend);
-      return image->write_u64(place, value);
-    }
-    default:
-      if (note) {
-        *note = "unsupported relocation";
+RelocKind reloc_kind(uint16_t machine, bool elf64, uint32_t type) {
+  switch (machine) {
+    case kElfMachineX86_64:
+      switch (type) {
+        case kRelaX86_64_64:
+          return RelocKind::Abs64;
+        // Objects have no PLT or GOT yet: calls and GOT loads resolve against
+        // the symbol itself, as the linker does when it relaxes them.
+        case kRelaX86_64_PC32:
+        case kRelaX86_64_PLT32:
+        case kRelaX86_64_GotPcRel:
+        case kRelaX86_64_GotPcRelX:
+        case kRelaX86_64_RexGotPcRelX:
+          return RelocKind::Pc32;
+        case kRelaX86_64_32:
+        case kRelaX86_64_32S:
+          return RelocKind::Abs32;
+        case kRelaX86_64_PC64:
+          return RelocKind::Pc64;
+        case kRelaX86_64_GlobDat:
+        case kRelaX86_64_JumpSlot:
+          return RelocKind::Slot;
+        case kRelaX86_64_Relative:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
       }
-      return false;
+    case kElfMachine386:
+      switch (type) {
+        case kRel386_32:
+          return RelocKind::Abs32;
+        case kRel386_PC32:
+        case kRel386_PLT32:
+          return RelocKind::Pc32;
+        case kRel386_GlobDat:
+        case kRel386_JumpSlot:
+          return RelocKind::Slot;
+        case kRel386_Relative:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
+      }
+    case kElfMachineArm:
+      switch (type) {
+        case kRelArm_Abs32:
+          return RelocKind::Abs32;
+        case kRelArm_Rel32:
+          return RelocKind::Pc32;
+        case kRelArm_GlobDat:
+        case kRelArm_JumpSlot:
+          return RelocKind::Slot;
+        case kRelArm_Relative:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
+      }
+    case kElfMachineMips:
+      // MIPS64 packs three types into r_info and resolves GOT entries without
+      // relocations; only the 32-bit data relocations are taken.
+      if (elf64) {
+        return RelocKind::Unsupported;
+      }
+      switch (type) {
+        case kRelMips_32:
+          return RelocKind::Abs32;
+        case kRelMips_Rel32:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
+      }
+    case kElfMachinePpc:
+    case kElfMachinePpc64:
+      switch (type) {
+        case kRelaPpc_Addr32:
+          return RelocKind::Abs32;
+        case kRelaPpc64_Addr64:
+          return elf64 ? RelocKind::Abs64 : RelocKind::Unsupported;
+        case kRelaPpc_Rel32:
+          return RelocKind::Pc32;
+        // PowerPC GOT entries include the addend.
+        case kRelaPpc_GlobDat:
+          return elf64 ? RelocKind::Abs64 : RelocKind::Abs32;
+        case kRelaPpc_Relative:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
+      }
+    case kElfMachineAarch64:
+      switch (type) {
+        // AArch64 GOT and PLT slots include the addend.
+        case kRelaAarch64_Abs64:
+        case kRelaAarch64_GlobDat:
+        case kRelaAarch64_JumpSlot:
+          return RelocKind::Abs64;
+        case kRelaAarch64_Abs32:
+          return RelocKind::Abs32;
+        case kRelaAarch64_Prel64:
+          return RelocKind::Pc64;
+        case kRelaAarch64_Prel32:
+          return RelocKind::Pc32;
+        case kRelaAarch64_Jump26:
+        case kRelaAarch64_Call26:
+          return RelocKind::Branch26;
+        case kRelaAarch64_Relative:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
+      }
+    case kElfMachineRiscv:
+      switch (type) {
+        case kRelaRiscv_64:
+          return elf64 ? RelocKind::Abs64 : RelocKind::Unsupported;
+        case kRelaRiscv_32:
+          return RelocKind::Abs32;
+        case kRelaRiscv_32Pcrel:
+          return RelocKind::Pc32;
+        case kRelaRiscv_JumpSlot:
+          return RelocKind::Slot;
+        case kRelaRiscv_Relative:
+          return RelocKind::Relative;
+        default:
+          return RelocKind::Unsupported;
+      }
+    default:
+      return RelocKind::Unsupported;
   }
 }
 
-} // namespace
-
-bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, std::string* error) {
-  if (!program) {
-    if (error) {
-      *error = "program output is null";
-    }
-    return false;
+ghirda::core::Processor to_processor(uint16_t machine) {
+  using ghirda::core::Processor;
+  switch (machine) {
+    case kElfMachine386:
+      return Processor::X86;
+    case kElfMachineX86_64:
+      return Processor::X86_64;
+    case kElfMachineArm:
+      return Processor::Arm;
+    case kElfMachineAarch64:
+      return Processor::Aarch64;
+    case kElfMachineRiscv:
+      return Processor::RiscV;
+    case kElfMachineMips:
+      return Processor::Mips;
+    case kElfMachinePpc:
+      return Processor::PowerPc;
+    case kElfMachinePpc64:
+      return Processor::PowerPc64;
+    default:
+      return Processor::Unknown;
   }
+}
 
-  std::ifstream in(path, std::ios::binary);
-  if (!in) {
-    if (error) {
-      *error = "failed to open file";
-    }
-    return false;
+uint32_t relative_type(uint16_t machine) {
+  switch (machine) {
+    case kElfMachineArm:
+      return kRelArm_Relative;
+    case kElfMachinePpc:
+    case kElfMachinePpc64:
+      return kRelaPpc_Relative;
+    case kElfMachineAarch64:
+      return kRelaAarch64_Relative;
+    case kElfMachineRiscv:
+      return kRelaRiscv_Relative;
+    default:
+      return kRelaX86_64_Relative;
   }
+}
 
-  Elf64Header header{};
-  if (!read_exact(in, &header, sizeof(header))) {
-    if (error) {
-      *error = "failed to read ELF header";
-    }
-    return false;
+// Computes the size-byte word a relocation stores at place. Sets uses_addend
+// for the kinds whose result includes A, so REL entries (addend held in
+// place) can add the value to the stored word instead.
+bool compute_reloc(RelocKind kind, uint8_t word_size, uint64_t place, uint64_t symbol_value, int64_t addend,
+                   uint64_t slide, uint64_t* value, uint8_t* size, bool* uses_addend) {
+  const uint64_t target = symbol_value + static_cast<uint64_t>(addend) + slide;
+  *uses_addend = true;
+  switch (kind) {
+    case RelocKind::Abs64:
+      *value = target;
+      *size = sizeof(uint64_t);
+      return true;
+    case RelocKind::Abs32:
+      *value = target;
+      *size = sizeof(uint32_t);
+      return true;
+    case RelocKind::Pc64:
+      *value = target - place;
+      *size = sizeof(uint64_t);
+      return true;
+    case RelocKind::Pc32:
+      *value = target - place;
+      *size = sizeof(uint32_t);
+      return true;
+    case RelocKind::Slot:
+      *value = symbol_value + slide;
+      *size = word_size;
+      *uses_addend = false;
+      return true;
+    case RelocKind::Relative:
+      *value = slide + static_cast<uint64_t>(addend);
+      *size = word_size;
+      return true;
+    case RelocKind::Branch26:
+      *value = static_cast<uint64_t>(static_cast<int64_t>(target - place) >> 2) & 0x3ffffffu;
+      *size = sizeof(uint32_t);
+      return true;
+    default:
+      return false;
   }
+}
 
-  if (!std::equal(std::begin(kElfMagic), std::end(kElfMagic), header.ident)) {
-    if (error) {
-      *error = "not an ELF file";
+// Expands an SHT_RELR table: an even entry is the next relocated address, an
+// odd entry a bitmap of the word-size-minus-one words that follow it. Each
+// word gets the slide added in place.
+template <typename Word>
+void add_relr(const std::vector<Word>& entries, uint32_t type, uint64_t slide, RelocationBatch* batch) {
+  constexpr unsigned kBitmapWords = sizeof(Word) * 8 - 1;
+  size_t count = 0;
+  for (Word entry : entries) {
+    count += (entry & 1) == 0 ? 1 : static_cast<size_t>(std::popcount(static_cast<Word>(entry >> 1)));
+  }
+  batch->reserve(count);
+
+  ghirda::core::Relocation relocation{};
+  relocation.type = type;
+  uint64_t where = 0;
+  for (Word entry : entries) {
+    if ((entry & 1) == 0) {
+      relocation.address = entry + slide;
+      batch->add(relocation, slide, sizeof(Word));
+      where = static_cast<uint64_t>(entry) + sizeof(Word);
+      continue;
     }
-    return false;
+    for (Word bitmap = entry >> 1; bitmap != 0; bitmap &= bitmap - 1) {
+      relocation.address = where + slide + static_cast<uint64_t>(std::countr_zero(bitmap)) * sizeof(Word);
+      batch->add(relocation, slide, sizeof(Word));
+    }
+    where += kBitmapWords * sizeof(Word);
   }
+}
 
-  if (header.ident[4] != kElfClass64 || header.ident[5] != kElfDataLittle) {
-    if (error) {
-      *error = "unsupported ELF class or endianness";
+// Copies size bytes at address out of the one image segment holding them.
+bool read_image(const ghirda::core::MemoryImage& image, uint64_t address, uint64_t size, std::vector<uint8_t>* out) {
+  for (const ghirda::core::ImageSegment& segment : image.segments()) {
+    const uint64_t offset = address - segment.start;
+    if (address >= segment.start && offset <= segment.data.size() && size <= segment.data.size() - offset) {
+      out->assign(segment.data.begin() + offset, segment.data.begin() + offset + size);
+      return true;
     }
-    return false;
   }
+  return false;
+}
 
-  if (header.type != kElfTypeExecutable && header.type != kElfTypeShared) {
-    if (error) {
-      *error = "unsupported ELF type";
-    }
-    return false;
+// Symbol values in a relocatable object are offsets into their section.
+template <typename Sym>
+uint64_t symbol_address(const Sym& sym, const std::vector<ElfSectionHeader>& sections, bool relocatable) {
+  if (relocatable && sym.shndx != 0 && sym.shndx < sections.size()) {
+    return sections[sym.shndx].addr + sym.value;
   }
+  return sym.value;
+}
+
+// Maps every PT_LOAD segment at its link-time address.
+template <typename Format>
+bool map_segments(const ByteSource& source, const typename Format::Header& header,
+                  std::vector<typename Format::Phdr>* phdrs, ghirda::core::Program* program, uint64_t* min_vaddr,
+                  uint64_t* max_vaddr, std::string* error) {
+  using Phdr = typename Format::Phdr;
 
   if (header.phoff == 0 || header.phnum == 0) {
     if (error) {
@@ -247,34 +424,22 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
     return false;
   }
 
-  if (header.phentsize != sizeof(Elf64Phdr)) {
+  if (header.phentsize != sizeof(Phdr)) {
     if (error) {
       *error = "unexpected program header size";
     }
     return false;
   }
 
-  in.seekg(static_cast<std::streamoff>(header.phoff), std::ios::beg);
-  if (!in) {
+  if (!read_elf_table<Format>(source, header.phoff, header.phnum, phdrs)) {
     if (error) {
-      *error = "failed to seek to program headers";
+      *error = "failed to read program headers";
     }
     return false;
   }
 
-  uint64_t min_vaddr = UINT64_MAX;
-  uint64_t max_vaddr = 0;
   bool found_load = false;
-
-  for (uint16_t i = 0; i < header.phnum; ++i) {
-    Elf64Phdr phdr{};
-    if (!read_exact(in, &phdr, sizeof(phdr))) {
-      if (error) {
-        *error = "failed to read program header";
-      }
-      return false;
-    }
-
+  for (const Phdr& phdr : *phdrs) {
     if (phdr.type != kElfPtLoad || phdr.memsz == 0) {
       continue;
     }
@@ -295,7 +460,7 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
     program->add_segment(seg);
 
     std::vector<uint8_t> bytes;
-    if (!read_blob(in, phdr.offset, phdr.filesz, &bytes)) {
+    if (!source.read_blob(phdr.offset, phdr.filesz, &bytes)) {
       if (error) {
         *error = "failed to read segment bytes";
       }
@@ -304,11 +469,11 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
 
     program->memory_image().map_segment(phdr.vaddr, bytes);
     if (phdr.memsz > phdr.filesz) {
-      program->memory_image().zero_fill(phdr.vaddr + phdr.filesz, phdr.memsz - phdr.filesz);
+      program->memory_image().zero_fill(static_cast<uint64_t>(phdr.vaddr) + phdr.filesz, phdr.memsz - phdr.filesz);
     }
 
-    min_vaddr = std::min(min_vaddr, phdr.vaddr);
-    max_vaddr = std::max(max_vaddr, phdr.vaddr + phdr.memsz);
+    *min_vaddr = std::min<uint64_t>(*min_vaddr, phdr.vaddr);
+    *max_vaddr = std::max<uint64_t>(*max_vaddr, static_cast<uint64_t>(phdr.vaddr) + phdr.memsz);
     found_load = true;
   }
 
@@ -318,72 +483,283 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
     }
     return false;
   }
+  return true;
+}
 
-  if (min_vaddr < max_vaddr) {
-    program->add_address_space(ghirda::core::AddressSpace("ram", min_vaddr, max_vaddr - min_vaddr));
-  }
+// Relocatable objects have no program headers: their allocated sections are
+// laid out in index order from kRelocatableBase, each at its own alignment,
+// and the assigned address is written back into the section table. An
+// object with nothing allocated maps nothing and is still loaded.
+bool map_sections(const ByteSource& source, std::vector<ElfSectionHeader>* sections, ghirda::core::Program* program,
+                  uint64_t* min_vaddr, uint64_t* max_vaddr, std::string* error) {
+  uint64_t next = kRelocatableBase;
+  for (ElfSectionHeader& shdr : *sections) {
+    if ((shdr.flags & kElfShfAlloc) == 0 || shdr.size == 0) {
+      continue;
+    }
+    const uint64_t align = std::max<uint64_t>(shdr.addralign, 1);
+    const uint64_t start = (next + align - 1) / align * align;
+    if (start < next || shdr.size > UINT64_MAX - start) {
+      if (error) {
+        *error = "section layout overflows the address space";
+      }
+      return false;
+    }
 
-  if (header.type == kElfTypeShared) {
-    program->set_load_bias(min_vaddr);
-  } else {
-    program->set_load_bias(0);
+    ghirda::core::MemoryRegion region{};
+    region.start = start;
+    region.size = shdr.size;
+    region.readable = true;
+    region.writable = (shdr.flags & kElfShfWrite) != 0;
+    region.executable = (shdr.flags & kElfShfExecinstr) != 0;
+    program->memory_map().add_region(region);
+
+    if (shdr.type == kElfShtNobits) {
+      program->memory_image().zero_fill(start, shdr.size);
+    } else {
+      std::vector<uint8_t> bytes;
+      if (!source.read_blob(shdr.offset, shdr.size, &bytes)) {
+        if (error) {
+          *error = "failed to read section bytes";
+        }
+        return false;
+      }
+      program->memory_image().map_segment(start, std::move(bytes));
+    }
+
+    shdr.addr = start;
+    next = start + shdr.size;
+    *min_vaddr = std::min(*min_vaddr, start);
+    *max_vaddr = std::max(*max_vaddr, next);
   }
+  return true;
+}
 
-  if (header.shoff == 0 || header.shnum == 0) {
-    return true;
+// Attaches .eh_frame (found via PT_GNU_EH_FRAME if unsectioned) and records each FDE as a function start.
+template <typename Format>
+void attach_call_frames(const ByteSource& source, const std::vector<typename Format::Phdr>& phdrs,
+                        const std::vector<ElfSectionHeader>& sections, bool relocatable,
+                        ghirda::core::Program* program) {
+  constexpr uint8_t kAddressSize = Format::kElf64 ? 8 : 4;
+  uint64_t frame_address = 0;
+  uint64_t frame_offset = 0;
+  uint64_t frame_size = 0;
+  uint64_t hdr_address = 0;
+  uint64_t hdr_offset = 0;
+  uint64_t hdr_size = 0;
+  for (const ElfSectionHeader& shdr : sections) {
+    if (shdr.type == kElfShtNobits || shdr.addr == 0) {
+      continue;
+    }
+    if (shdr.name == ".eh_frame") {
+      frame_address = shdr.addr;
+      frame_offset = shdr.offset;
+      frame_size = shdr.size;
+    } else if (shdr.name == ".eh_frame_hdr") {
+      hdr_address = shdr.addr;
+      hdr_offset = shdr.offset;
+      hdr_size = shdr.size;
+    }
+  }
+  if (hdr_size == 0) {
+    for (const auto& phdr : phdrs) {
+      if (phdr.type == kElfPtGnuEhFrame) {
+        hdr_address = phdr.vaddr;
+        hdr_offset = phdr.offset;
+        hdr_size = phdr.filesz;
+      }
+    }
   }
 
-  if (header.shentsize != sizeof(Elf64Shdr)) {
-    if (error) {
-      *error = "unexpected section header size";
+  std::vector<uint8_t> hdr;
+  if (hdr_size != 0 && !source.read_blob(hdr_offset, hdr_size, &hdr)) {
+    hdr.clear();
+  }
+  if (frame_size == 0 && !hdr.empty() &&
+      ghirda::core::CallFrameTable::eh_frame_address(hdr, hdr_address, Format::kBigEndian, kAddressSize,
+                                                     &frame_address)) {
+    for (const auto& phdr : phdrs) {
+      if (phdr.type == kElfPtLoad && frame_address >= phdr.vaddr && frame_address - phdr.vaddr < phdr.filesz) {
+        frame_offset = phdr.offset + (frame_address - phdr.vaddr);
+        frame_size = phdr.filesz - (frame_address - phdr.vaddr);
+      }
     }
-    return false;
+  }
+  std::vector<uint8_t> frames;
+  if (frame_size == 0) {
+    return;
+  }
+  // An object's frames are read from the image, where their relocations
+  // have been applied.
+  if (relocatable ? !read_image(program->memory_image(), frame_address, frame_size, &frames)
+                  : !source.read_blob(frame_offset, frame_size, &frames)) {
+    return;
   }
 
-  std::vector<Elf64Shdr> sections(header.shnum);
-  in.seekg(static_cast<std::streamoff>(header.shoff), std::ios::beg);
-  if (!in) {
-    if (error) {
-      *error = "failed to seek to section headers";
+  ghirda::core::CallFrameTable& table = program->call_frames();
+  if (!table.attach(frame_address, std::move(frames), hdr_address, std::move(hdr), Format::kBigEndian, kAddressSize,
+                    nullptr)) {
+    return;
+  }
+  std::vector<ghirda::core::FrameDescription> fdes;
+  table.enumerate(&fdes);
+  for (const auto& fde : fdes) {
+    ghirda::core::Program::FunctionStart start{};
+    start.address = fde.start;
+    start.size = fde.end - fde.start;
+    start.source = ghirda::core::Program::FunctionStartSource::ExceptionTable;
+    program->add_function_start(start);
+  }
+}
+
+// Records DT_INIT, DT_FINI and the preinit, init and fini array entries as
+// entry points, since the dynamic loader calls them. Array entries are read
+// from the image, after their relocations have been applied.
+template <typename Format>
+void add_dynamic_starts(const ByteSource& source, const std::vector<typename Format::Phdr>& phdrs, uint16_t machine,
+                        ghirda::core::Program* program) {
+  using Word = typename Format::Addr;
+  std::vector<Word> dynamic;
+  for (const auto& phdr : phdrs) {
+    if (phdr.type == kElfPtDynamic) {
+      read_elf_table<Format>(source, phdr.offset, static_cast<size_t>(phdr.filesz / sizeof(Word)), &dynamic);
+      break;
     }
-    return false;
   }
 
-  for (uint16_t i = 0; i < header.shnum; ++i) {
-    if (!read_exact(in, &sections[i], sizeof(Elf64Shdr))) {
-      if (error) {
-        *error = "failed to read section header";
+  std::vector<uint64_t> starts;
+  // Address and size of the preinit, init and fini arrays.
+  uint64_t arrays[3][2] = {};
+  for (size_t i = 0; i + 1 < dynamic.size() && dynamic[i] != kElfDtNull; i += 2) {
+    const uint64_t value = dynamic[i + 1];
+    switch (dynamic[i]) {
+      case kElfDtInit:
+      case kElfDtFini:
+        starts.push_back(value);
+        break;
+      case kElfDtPreinitArray:
+        arrays[0][0] = value;
+        break;
+      case kElfDtPreinitArraySz:
+        arrays[0][1] = value;
+        break;
+      case kElfDtInitArray:
+        arrays[1][0] = value;
+        break;
+      case kElfDtInitArraySz:
+        arrays[1][1] = value;
+        break;
+      case kElfDtFiniArray:
+        arrays[2][0] = value;
+        break;
+      case kElfDtFiniArraySz:
+        arrays[2][1] = value;
+        break;
+      default:
+        break;
+    }
+  }
+  const ghirda::core::MemoryImage& image = program->memory_image();
+  for (const auto& [address, size] : arrays) {
+    for (uint64_t offset = 0; address != 0 && offset + sizeof(Word) <= size; offset += sizeof(Word)) {
+      Word entry = 0;
+      bool read = false;
+      if constexpr (Format::kElf64) {
+        read = image.read_u64(address + offset, &entry);
+      } else {
+        read = image.read_u32(address + offset, &entry);
       }
-      return false;
+      if (!read) {
+        break;
+      }
+      if constexpr (Format::kSwap) {
+        entry = swap_bytes(entry);
+      }
+      starts.push_back(entry);
     }
   }
 
-  if (header.shstrndx >= sections.size()) {
+  for (uint64_t address : starts) {
+    // Empty slots hold 0 or -1.
+    if (address == 0 || address == static_cast<Word>(~Word{0})) {
+      continue;
+    }
+    ghirda::core::Program::FunctionStart start{};
+    start.address = machine == kElfMachineArm ? address & ~uint64_t{1} : address;
+    start.source = ghirda::core::Program::FunctionStartSource::EntryPoint;
+    program->add_function_start(start);
+  }
+}
+
+// Maps the image, its symbols and relocations for one ELF class and byte
+// order, and hands back the section table for the debug-info stage.
+template <typename Format>
+bool load_image(const ByteSource& source, ghirda::core::Program* program, std::vector<ElfSectionHeader>* sections,
+                bool* relocatable_out, std::string* error) {
+  using Phdr = typename Format::Phdr;
+  using Sym = typename Format::Sym;
+  using Word = typename Format::Addr;
+
+  typename Format::Header header{};
+  if (!read_elf_record<Format>(source, 0, &header)) {
     if (error) {
-      *error = "invalid section string table index";
+      *error = "failed to read ELF header";
     }
     return false;
   }
 
-  std::vector<uint8_t> shstrtab;
-  if (!read_blob(in, sections[header.shstrndx].offset, sections[header.shstrndx].size, &shstrtab)) {
+  const bool relocatable = header.type == kElfTypeRelocatable;
+  *relocatable_out = relocatable;
+  if (!relocatable && header.type != kElfTypeExecutable && header.type != kElfTypeShared) {
     if (error) {
-      *error = "failed to read section string table";
+      *error = "unsupported ELF type";
     }
     return false;
   }
 
-  std::vector<std::vector<uint8_t>> string_tables(sections.size());
-  std::vector<std::vector<Elf64Sym>> symbol_tables(sections.size());
+  if (!read_elf_section_table<Format>(source, header, sections, error)) {
+    return false;
+  }
+
+  std::vector<Phdr> phdrs;
+  uint64_t min_vaddr = UINT64_MAX;
+  uint64_t max_vaddr = 0;
+  if (relocatable ? !map_sections(source, sections, program, &min_vaddr, &max_vaddr, error)
+                  : !map_segments<Format>(source, header, &phdrs, program, &min_vaddr, &max_vaddr, error)) {
+    return false;
+  }
+
+  if (min_vaddr < max_vaddr) {
+    program->add_address_space(ghirda::core::AddressSpace("ram", min_vaddr, max_vaddr - min_vaddr));
+  }
 
-  for (size_t i = 0; i < sections.size(); ++i) {
-    const Elf64Shdr& shdr = sections[i];
+  program->set_processor(to_processor(header.machine));
+  if (header.type == kElfTypeShared) {
+    program->set_load_bias(min_vaddr);
+  } else if (relocatable) {
+    program->set_load_bias(kRelocatableBase);
+  } else {
+    program->set_load_bias(0);
+  }
+  if (header.entry != 0) {
+    ghirda::core::Program::FunctionStart start{};
+    start.address = header.entry;
+    start.source = ghirda::core::Program::FunctionStartSource::EntryPoint;
+    program->add_function_start(start);
+  }
+
+  std::vector<ByteView> string_tables(sections->size());
+  std::vector<std::vector<Sym>> symbol_tables(sections->size());
+
+  for (size_t i = 0; i < sections->size(); ++i) {
+    const ElfSectionHeader& shdr = (*sections)[i];
     ghirda::core::Program::Section sec{};
-    sec.name = read_string(shstrtab, shdr.name);
+    sec.name = shdr.name;
     sec.address = shdr.addr;
     sec.size = shdr.size;
     sec.file_offset = shdr.offset;
     sec.flags = shdr.flags;
+    sec.executable = (shdr.flags & kElfShfExecinstr) != 0;
     if (!sec.name.empty()) {
       program->add_section(sec);
     }
@@ -391,54 +767,29 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
       continue;
     }
 
-    if (shdr.entsize != sizeof(Elf64Sym) || shdr.size == 0) {
+    if (shdr.entsize != sizeof(Sym) || shdr.size == 0) {
       continue;
     }
 
-    if (shdr.link >= sections.size() || sections[shdr.link].type != kElfShtStrtab) {
+    if (shdr.link >= sections->size() || (*sections)[shdr.link].type != kElfShtStrtab) {
       continue;
     }
 
-    std::vector<uint8_t> strtab;
-    if (!read_blob(in, sections[shdr.link].offset, sections[shdr.link].size, &strtab)) {
+    ByteView strtab;
+    if (!source.view((*sections)[shdr.link].offset, (*sections)[shdr.link].size, &strtab)) {
       continue;
     }
     string_tables[i] = std::move(strtab);
 
     const size_t sym_count = static_cast<size_t>(shdr.size / shdr.entsize);
-    symbol_tables[i].resize(sym_count);
-
-    in.seekg(static_cast<std::streamoff>(shdr.offset), std::ios::beg);
-    if (!in) {
-      continue;
-    }
-
-    for (size_t idx = 0; idx < sym_count; ++idx) {
-      if (!read_exact(in, &symbol_tables[i][idx], sizeof(Elf64Sym))) {
-        symbol_tables[i].resize(idx);
-        break;
-      }
-    }
+    read_elf_table<Format>(source, shdr.offset, sym_count, &symbol_tables[i]);
   }
 
-  for (size_t i = 0; i < sections.size(); ++i) {
-    const Elf64Shdr& shdr = sections[i];
-    if (shdr.type != kElfShtSymtab && shdr.type != kElfShtDynsym) {
-      continue;
-    }
-
-    if (shdr.entsize != sizeof(Elf64Sym) || shdr.size == 0) {
-      continue;
-    }
-
-    if (i >= string_tables.size()) {
-      continue;
-    }
-
+  for (size_t i = 0; i < sections->size(); ++i) {
     const auto& strtab = string_tables[i];
     const auto& syms = symbol_tables[i];
 
-    for (const auto& sym : syms) {
+    for (const Sym& sym : syms) {
       const uint8_t type = symbol_type(sym.info);
       if (type == kElfSttNotype && sym.name == 0) {
         continue;
@@ -451,8 +802,12 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
 
       ghirda::core::Symbol symbol{};
       symbol.name = name;
-      symbol.address = sym.value;
+      symbol.address = symbol_address(sym, *sections, relocatable);
       symbol.kind = to_symbol_kind(type);
+      // Thumb functions carry the mode in bit 0 of their value.
+      if (header.machine == kElfMachineArm && type == kElfSttFunc) {
+        symbol.address &= ~uint64_t{1};
+      }
       program->add_symbol(symbol);
 
       if (symbol.kind == ghirda::core::SymbolKind::Data && sym.size > 0) {
@@ -465,9 +820,13 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
     }
   }
 
-  for (size_t i = 0; i < sections.size(); ++i) {
-    const Elf64Shdr& shdr = sections[i];
-    if (shdr.type != kElfShtRela && shdr.type != kElfShtRel) {
+  // Segments are mapped at their link-time addresses and object sections at
+  // their assigned ones, so relocations resolve with no slide; load_bias()
+  // only records the image base.
+  const uint64_t slide = 0;
+  RelocationBatch relocations(program, Format::kBigEndian ? Endian::Big : Endian::Little);
+  for (const ElfSectionHeader& shdr : *sections) {
+    if (shdr.type != kElfShtRela && shdr.type != kElfShtRel && shdr.type != kElfShtRelr) {
       continue;
     }
 
@@ -475,311 +834,238 @@ bool ElfLoader::load(const std::string& path, ghirda::core::Program* program, st
       continue;
     }
 
-    if (shdr.link >= sections.size()) {
+    const size_t rel_count = static_cast<size_t>(shdr.size / shdr.entsize);
+    if (shdr.type == kElfShtRelr) {
+      std::vector<Word> entries;
+      if (shdr.entsize == sizeof(Word) && read_elf_table<Format>(source, shdr.offset, rel_count, &entries)) {
+        add_relr(entries, relative_type(header.machine), slide, &relocations);
+      }
       continue;
     }
 
+    if (shdr.link >= sections->size()) {
+      continue;
+    }
+    // Object relocations are offsets into their target section; those
+    // patching unallocated sections (debug info) are not applied.
+    uint64_t target = 0;
+    if (relocatable) {
+      if (shdr.info >= sections->size() || (*sections)[shdr.info].addr == 0) {
+        continue;
+      }
+      target = (*sections)[shdr.info].addr;
+    }
+
     const auto& symtab = symbol_tables[shdr.link];
     const auto& strtab = string_tables[shdr.link];
 
-    const size_t rel_count = static_cast<size_t>(shdr.size / shdr.entsize);
-    in.seekg(static_cast<std::streamoff>(shdr.offset), std::ios::beg);
-    if (!in) {
-      continue;
+    std::vector<typename Format::Rela> relas;
+    std::vector<typename Format::Rel> rels;
+    if (shdr.type == kElfShtRela) {
+      if (shdr.entsize != sizeof(typename Format::Rela) ||
+          !read_elf_table<Format>(source, shdr.offset, rel_count, &relas)) {
+        continue;
+      }
+    } else {
+      if (shdr.entsize != sizeof(typename Format::Rel) ||
+          !read_elf_table<Format>(source, shdr.offset, rel_count, &rels)) {
+        continue;
+      }
     }
 
+    relocations.reserve(rel_count);
     for (size_t idx = 0; idx < rel_count; ++idx) {
       ghirda::core::Relocation relocation{};
-      uint32_t type = 0;
       uint32_t sym_index = 0;
-      int64_t addend = 0;
-
       if (shdr.type == kElfShtRela) {
-        if (shdr.entsize != sizeof(Elf64Rela)) {
-          break;
-        }
-        Elf64Rela rela{};
-        if (!read_exact(in, &rela, sizeof(rela))) {
-          break;
-        }
-        relocation.address = rela.offset;
-        type = reloc_type(rela.info);
-        sym_index = reloc_sym_index(rela.info);
-        addend = rela.addend;
+        const auto& rela = relas[idx];
+        relocation.address = rela.offset + target;
+        relocation.type = Format::reloc_type(rela.info);
+        relocation.addend = rela.addend;
+        sym_index = Format::reloc_sym(rela.info);
       } else {
-        if (shdr.entsize != sizeof(Elf64Rel)) {
-          break;
-        }
-        Elf64Rel rel{};
-        if (!read_exact(in, &rel, sizeof(rel))) {
-          break;
-        }
-        relocation.address = rel.offset;
-        type = reloc_type(rel.info);
-        sym_index = reloc_sym_index(rel.info);
-        uint64_t raw_addend = 0;
-        if (!program->memory_image().read_u64(rel.offset + program->load_bias(), &raw_addend)) {
-          relocation.note = "addend read failed";
-        }
-        addend = static_cast<int64_t>(raw_addend);
-      }
-
-      relocation.type = type;
-      relocation.addend = addend;
-      if (sym_index < symtab.size()) {
-        std::string name = read_string(strtab, symtab[sym_index].name);
-        relocation.symbol = name;
+        const auto& rel = rels[idx];
+        relocation.address = rel.offset + target;
+        relocation.type = Format::reloc_type(rel.info);
+        sym_index = Format::reloc_sym(rel.info);
       }
 
       uint64_t symbol_value = 0;
+      bool undefined = false;
       if (sym_index < symtab.size()) {
-        symbol_value = symtab[sym_index].value;
+        undefined = sym_index != 0 && symtab[sym_index].shndx == 0;
+        relocation.symbol = relocations.intern(read_string(strtab, symtab[sym_index].name));
+        symbol_value = symbol_address(symtab[sym_index], *sections, relocatable);
       }
 
-      std::string note;
-      bool applied = apply_reloc(type, relocation.address, symbol_value, addend, program->load_bias(),
-                                 &program->memory_image(), &note);
-      relocation.applied = applied;
-      if (!note.empty() && relocation.note.empty()) {
-        relocation.note = note;
+      relocation.address += slide;
+      uint64_t value = 0;
+      uint8_t size = 0;
+      bool uses_addend = false;
+      const RelocKind kind = reloc_kind(header.machine, Format::kElf64, relocation.type);
+      // Branch fields keep the rest of the instruction, which is always
+      // little-endian, so they are not patched in big-endian images.
+      uint32_t instruction = 0;
+      if ((kind == RelocKind::Branch26 &&
+           (Format::kBigEndian || !program->memory_image().read_u32(relocation.address, &instruction))) ||
+          !compute_reloc(kind, sizeof(Word), relocation.address, symbol_value, relocation.addend, slide, &value, &size,
+                         &uses_addend)) {
+        relocation.status = ghirda::core::RelocationStatus::Unsupported;
+        relocations.record(relocation);
+        continue;
       }
-      if (!applied && relocation.note.empty()) {
-        relocation.note = "relocation not applied";
+      if (kind == RelocKind::Branch26) {
+        value |= instruction & ~uint64_t{0x3ffffff};
+        uses_addend = false;
+      }
+      // Imports resolve to zero here, which is not a reference to anything.
+      const bool pointer = !undefined && (kind == RelocKind::Abs64 || kind == RelocKind::Abs32 ||
+                                          kind == RelocKind::Slot || kind == RelocKind::Relative);
+      if (shdr.type == kElfShtRel && uses_addend) {
+        relocations.add(relocation, value, size, pointer);
+      } else {
+        relocations.store(relocation, value, size, pointer);
       }
-      program->add_relocation(relocation);
     }
   }
+  relocations.commit();
+  add_dynamic_starts<Format>(source, phdrs, header.machine, program);
+  attach_call_frames<Format>(source, phdrs, *sections, relocatable, program);
+  return true;
+}
 
-  DwarfSections dwarf_sections{};
-  std::vector<uint8_t> debug_info;
-  std::vector<uint8_t> debug_abbrev;
-  std::vector<uint8_t> debug_line;
-  std::vector<uint8_t> debug_str;
-
-  for (size_t i = 0; i < sections.size(); ++i) {
-    const Elf64Shdr& shdr = sections[i];
-    std::string name = read_string(shstrtab, shdr.name);
-    if (name == ".debug_info") {
-      read_blob(in, shdr.offset, shdr.size, &debug_info);
-      dwarf_sections.debug_info.data = &debug_info;
-    } else if (name == ".debug_abbrev") {
-      read_blob(in, shdr.offset, shdr.size, &debug_abbrev);
-      dwarf_sections.debug_abbrev.data = &debug_abbrev;
-    } else if (name == ".debug_line") {
-      read_blob(in, shdr.offset, shdr.size, &debug_line);
-      dwarf_sections.debug_line.data = &debug_line;
-    } else if (name == ".debug_str") {
-      read_blob(in, shdr.offset, shdr.size, &debug_str);
-      dwarf_sections.debug_str.data = &debug_str;
-    }
-  }
-
-  if (dwarf_sections.debug_info.data && dwarf_sections.debug_abbrev.data) {
-    DwarfReader reader(dwarf_sections);
-    std::string dwarf_error;
-    if (!reader.parse(&program->debug_info(), &dwarf_error)) {
-      if (error && error->empty()) {
-        *error = "DWARF parse failed: " + dwarf_error;
-      }
-    }
+// Stripped images: takes the DWARF from the separate debug file instead and
+// returns its path, or an empty string when there is none. Its sections keep
+// the mapping alive for as long as the reader needs them.
+std::string use_debug_file(const ByteSource& source, const ElfDebugLink& debug_link, DebugFileResolver* debug_files,
+                           DwarfSections* dwarf_sections, std::vector<std::shared_ptr<DebugSection>>* debug_sections) {
+  std::string debug_path;
+  if (!debug_files || debug_link.empty() || !debug_files->find(debug_link, source.path(), &debug_path)) {
+    return {};
+  }
+  std::shared_ptr<ByteSource> debug_source = open_byte_source(debug_path, nullptr);
+  std::vector<ElfSectionHeader> debug_headers;
+  if (!debug_source || !read_elf_section_headers(*debug_source, &debug_headers, nullptr)) {
+    return {};
   }
+  *dwarf_sections = DwarfSections{};
+  debug_sections->clear();
+  collect_dwarf_sections(*debug_source, debug_headers, false, dwarf_sections, debug_sections, nullptr);
+  return debug_path;
+}
 
-  if (!program->debug_info().types.empty()) {
-    std::unordered_map<uint64_t, const ghirda::core::DebugType*> type_map;
-    for (const auto& dt : program->debug_info().types) {
-      if (dt.die_offset != 0) {
-        type_map[dt.die_offset] = &dt;
-      }
-    }
+} // namespace
 
-    std::unordered_set<uint64_t> emitting;
+void ElfLoader::set_debug_file_resolver(std::shared_ptr<DebugFileResolver> resolver) {
+  debug_files_ = std::move(resolver);
+}
 
-    std::function<std::pair<std::string, uint32_t>(const ghirda::core::DebugType*)> resolve_type =
-        [&](const ghirda::core::DebugType* dt) -> std::pair<std::string, uint32_t> {
-      if (!dt) {
-        return {"", 0};
-      }
-      if (dt->die_offset != 0) {
-        if (emitting.count(dt->die_offset) != 0) {
-          return {dt->name, dt->size};
-        }
-        emitting.insert(dt->die_offset);
-      }
+uint32_t ElfLoader::probe(std::span<const uint8_t> header) const {
+  static constexpr uint8_t kMagic[] = {0x7f, 'E', 'L', 'F'};
+  if (header.size() < 6 || !std::equal(std::begin(kMagic), std::end(kMagic), header.begin()) ||
+      (header[4] != 1 && header[4] != 2) || (header[5] != 1 && header[5] != 2)) {
+    return 0;
+  }
+  if (header.size() < 18) {
+    return 60;
+  }
+  // Still claim cores, so load() reports why they are refused instead of
+  // another loader mapping them as something else.
+  const uint16_t type = header[5] == 2 ? static_cast<uint16_t>(header[16] << 8 | header[17])
+                                       : static_cast<uint16_t>(header[17] << 8 | header[16]);
+  return type == kElfTypeRelocatable || type == kElfTypeExecutable || type == kElfTypeShared ? 100 : 50;
+}
 
-      std::string name = dt->name;
-      uint32_t size = dt->size;
+bool ElfLoader::load(const ByteSource& source, ghirda::core::Program* program, std::string* error) {
+  if (!program) {
+    if (error) {
+      *error = "program output is null";
+    }
+    return false;
+  }
 
-      auto resolve_ref = [&](uint64_t ref) -> std::pair<std::string, uint32_t> {
-        auto it = type_map.find(ref);
-        if (it == type_map.end()) {
-          return {"", 0};
-        }
-        return resolve_type(it->second);
-      };
-
-      switch (dt->kind) {
-        case ghirda::core::DebugTypeKind::Pointer: {
-          auto target = resolve_ref(dt->type_ref);
-          std::string base = target.first.empty() ? "void" : target.first;
-          name = base + "*";
-          if (size == 0) {
-            size = 8;
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Const: {
-          auto target = resolve_ref(dt->type_ref);
-          if (!target.first.empty()) {
-            name = "const " + target.first;
-          }
-          if (size == 0) {
-            size = target.second;
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Volatile: {
-          auto target = resolve_ref(dt->type_ref);
-          if (!target.first.empty()) {
-            name = "volatile " + target.first;
-          }
-          if (size == 0) {
-            size = target.second;
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Typedef: {
-          auto target = resolve_ref(dt->type_ref);
-          if (name.empty() && !target.first.empty()) {
-            name = target.first;
-          }
-          if (size == 0) {
-            size = target.second;
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Array: {
-          auto target = resolve_ref(dt->type_ref);
-          std::string base = target.first.empty() ? "void" : target.first;
-          if (dt->array_count != 0) {
-            name = base + "[" + std::to_string(dt->array_count) + "]";
-          } else {
-            name = base + "[]";
-          }
-          if (size == 0 && target.second != 0 && dt->array_count != 0) {
-            size = static_cast<uint32_t>(target.second * dt->array_count);
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Union:
-        case ghirda::core::DebugTypeKind::Struct: {
-          if (name.empty() && dt->die_offset != 0) {
-            name = (dt->kind == ghirda::core::DebugTypeKind::Union ? "union_" : "struct_") +
-                   std::to_string(dt->die_offset);
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Enumeration: {
-          if (name.empty() && dt->die_offset != 0) {
-            name = "enum_" + std::to_string(dt->die_offset);
-          }
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Subroutine: {
-          name = name.empty() ? "fn" : name;
-          if (size == 0) {
-            size = 8;
-          }
-          break;
-        }
-        default:
-          break;
-      }
+  ElfIdent ident;
+  if (!read_elf_ident(source, &ident, error)) {
+    return false;
+  }
 
-      if (dt->die_offset != 0) {
-        emitting.erase(dt->die_offset);
-      }
+  std::vector<ElfSectionHeader> headers;
+  bool relocatable = false;
+  const bool loaded = with_elf_format(ident, [&](auto format) {
+    return load_image<decltype(format)>(source, program, &headers, &relocatable, error);
+  });
+  if (!loaded) {
+    return false;
+  }
+  // An object's DWARF still needs its .rela.debug_* applied, so it is not read.
+  if (headers.empty() || relocatable) {
+    return true;
+  }
 
-      return {name, size};
-    };
+  DwarfSections dwarf_sections{};
+  std::vector<std::shared_ptr<DebugSection>> debug_sections;
+  std::string section_error;
+  if (!collect_dwarf_sections(source, headers, false, &dwarf_sections, &debug_sections, &section_error)) {
+    if (error && error->empty()) {
+      *error = section_error;
+    }
+  }
 
-    std::unordered_set<uint64_t> emitted;
-    for (const auto& dt : program->debug_info().types) {
-      if (dt.die_offset == 0 || emitted.count(dt.die_offset) != 0) {
-        continue;
-      }
-      auto resolved = resolve_type(&dt);
-      if (resolved.first.empty()) {
-        continue;
-      }
-      ghirda::core::Type type_def{};
-      std::string name = resolved.first;
-      uint32_t size = resolved.second;
-
-      switch (dt.kind) {
-        case ghirda::core::DebugTypeKind::Base:
-          type_def.kind = ghirda::core::TypeKind::Integer;
-          break;
-        case ghirda::core::DebugTypeKind::Pointer: {
-          type_def.kind = ghirda::core::TypeKind::Pointer;
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Struct:
-          type_def.kind = ghirda::core::TypeKind::Struct;
-          break;
-        case ghirda::core::DebugTypeKind::Union:
-          type_def.kind = ghirda::core::TypeKind::Union;
-          break;
-        case ghirda::core::DebugTypeKind::Array:
-          type_def.kind = ghirda::core::TypeKind::Array;
-          break;
-        case ghirda::core::DebugTypeKind::Typedef: {
-          type_def.kind = ghirda::core::TypeKind::Integer;
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Const:
-        case ghirda::core::DebugTypeKind::Volatile: {
-          type_def.kind = ghirda::core::TypeKind::Integer;
-          break;
-        }
-        case ghirda::core::DebugTypeKind::Enumeration:
-          type_def.kind = ghirda::core::TypeKind::Integer;
-          break;
-        case ghirda::core::DebugTypeKind::Subroutine:
-          type_def.kind = ghirda::core::TypeKind::Pointer;
-          break;
-        default:
-          type_def.kind = ghirda::core::TypeKind::Void;
-          break;
-      }
+  ElfDebugLink debug_link;
+  read_elf_debug_link(source, headers, &debug_link);
+  program->debug_info().build_id = debug_link.build_id;
+  if (!dwarf_sections.debug_info.present()) {
+    program->debug_info().debug_file =
+        use_debug_file(source, debug_link, debug_files_.get(), &dwarf_sections, &debug_sections);
+  }
 
-      if (name.empty()) { continue; }
-      type_def.name = name;
-      type_def.size = size;
-      if ((dt.kind == ghirda::core::DebugTypeKind::Struct ||
-           dt.kind == ghirda::core::DebugTypeKind::Union) &&
-          !dt.members.empty()) {
-        for (const auto& member : dt.members) {
-          ghirda::core::TypeMember tm{};
-          tm.name = member.name;
-          auto resolved = resolve_type(type_map.count(member.type_ref) ? type_map[member.type_ref] : nullptr);
-          tm.type_name = resolved.first.empty() ? "void" : resolved.first;
-          tm.size = resolved.second;
-          tm.offset = static_cast<uint32_t>(member.offset);
-          tm.bit_size = member.bit_size;
-          tm.bit_offset = member.bit_offset;
-          tm.alignment = member.alignment;
-          if (tm.size == 0 && tm.bit_size != 0) {
-            tm.size = static_cast<uint32_t>((tm.bit_size + 7) / 8);
-          }
-          type_def.members.push_back(tm);
-        }
+  // The DWARF reader decodes little-endian units only.
+  if (ident.endian == Endian::Little && dwarf_sections.debug_info.present() &&
+      dwarf_sections.debug_abbrev.present()) {
+    prefetch_debug_sections(debug_sections, kDebugPrefetchThreshold);
+    // Skeleton units from -gsplit-dwarf are resolved against <image>.dwp or
+    // their .dwo files only when the reader reaches them.
+    SplitDwarfResolver split_resolver(source.path());
+    std::string dwarf_error;
+    if (!ingest_dwarf(dwarf_sections, program, &dwarf_error, &split_resolver)) {
+      if (error && error->empty()) {
+        *error = dwarf_error;
       }
-      program->types().add_type(type_def);
-      emitted.insert(dt.die_offset);
     }
   }
 
   return true;
 }
 
+bool ElfLoader::find_debug_function(const ByteSource& source, const std::string& name,
+                                    ghirda::core::DebugFunction* out, bool* indexed, std::string* error) {
+  ElfIdent ident;
+  std::vector<ElfSectionHeader> headers;
+  if (!read_elf_ident(source, &ident, error) || !read_elf_section_headers(source, &headers, error)) {
+    return false;
+  }
+  DwarfSections dwarf_sections{};
+  std::vector<std::shared_ptr<DebugSection>> debug_sections;
+  if (!collect_dwarf_sections(source, headers, false, &dwarf_sections, &debug_sections, error)) {
+    return false;
+  }
+  if (!dwarf_sections.debug_info.present()) {
+    ElfDebugLink debug_link;
+    read_elf_debug_link(source, headers, &debug_link);
+    use_debug_file(source, debug_link, debug_files_.get(), &dwarf_sections, &debug_sections);
+  }
+  if (ident.endian != Endian::Little) {
+    if (error) {
+      *error = "DWARF reader decodes little-endian units only";
+    }
+    return false;
+  }
+
+  DwarfReader reader(dwarf_sections);
+  if (indexed) {
+    *indexed = reader.has_name_index();
+  }
+  return reader.find_function(name, out, error);
+}
+
 } // namespace ghirda::loader
@@ -0,0 +1,161 @@
+#include "ghirda/loader/elf_sections.h"
+
+#include <algorithm>
+#include <array>
+
+namespace ghirda::loader {
+namespace {
+
+constexpr std::array<uint8_t, 4> kElfMagic{0x7f, 'E', 'L', 'F'};
+constexpr uint8_t kElfClass32 = 1;
+constexpr uint8_t kElfClass64 = 2;
+constexpr uint8_t kElfDataLittle = 1;
+constexpr uint8_t kElfDataBig = 2;
+constexpr uint32_t kElfShtNote = 7;
+constexpr uint32_t kNtGnuBuildId = 3;
+constexpr char kDwoSuffix[] = ".dwo";
+constexpr char kDebuglinkName[] = ".gnu_debuglink";
+constexpr size_t kDwoSuffixLength = sizeof(kDwoSuffix) - 1;
+
+uint64_t align4(uint64_t value) { return (value + 3) & ~uint64_t{3}; }
+
+std::string to_hex(const ByteView& bytes) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string out;
+  out.reserve(bytes.size() * 2);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    out.push_back(kDigits[bytes[i] >> 4]);
+    out.push_back(kDigits[bytes[i] & 0x0f]);
+  }
+  return out;
+}
+
+bool read_build_id(const ByteView& notes, Endian endian, std::string* out) {
+  ByteReader reader(notes, endian);
+  while (reader.remaining() >= 12) {
+    uint32_t name_size = 0;
+    uint32_t desc_size = 0;
+    uint32_t type = 0;
+    reader.read_u32(&name_size);
+    reader.read_u32(&desc_size);
+    reader.read_u32(&type);
+    ByteView name;
+    ByteView desc;
+    if (!reader.read_view(name_size, &name) || !reader.seek(align4(reader.offset())) ||
+        !reader.read_view(desc_size, &desc)) {
+      return false;
+    }
+    reader.seek(std::min<uint64_t>(align4(reader.offset()), notes.size()));
+    if (type == kNtGnuBuildId && name_size == 4 && std::equal(name.data(), name.data() + 4, "GNU") &&
+        !desc.empty()) {
+      *out = to_hex(desc);
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+bool read_elf_ident(const ByteSource& source, ElfIdent* out, std::string* error) {
+  uint8_t ident[16] = {};
+  if (!source.read(0, ident, sizeof(ident)) || !std::equal(kElfMagic.begin(), kElfMagic.end(), ident)) {
+    if (error) {
+      *error = "not an ELF file";
+    }
+    return false;
+  }
+  if ((ident[4] != kElfClass32 && ident[4] != kElfClass64) ||
+      (ident[5] != kElfDataLittle && ident[5] != kElfDataBig)) {
+    if (error) {
+      *error = "unsupported ELF class or endianness";
+    }
+    return false;
+  }
+  out->elf64 = ident[4] == kElfClass64;
+  out->endian = ident[5] == kElfDataBig ? Endian::Big : Endian::Little;
+  return true;
+}
+
+bool read_elf_section_headers(const ByteSource& source, std::vector<ElfSectionHeader>* out, std::string* error) {
+  out->clear();
+  ElfIdent ident;
+  if (!read_elf_ident(source, &ident, error)) {
+    return false;
+  }
+  return with_elf_format(ident, [&](auto format) {
+    using Format = decltype(format);
+    typename Format::Header header{};
+    if (!read_elf_record<Format>(source, 0, &header)) {
+      if (error) {
+        *error = "failed to read ELF header";
+      }
+      return false;
+    }
+    return read_elf_section_table<Format>(source, header, out, error);
+  });
+}
+
+bool collect_dwarf_sections(const ByteSource& source, const std::vector<ElfSectionHeader>& headers, bool split,
+                            DwarfSections* out, std::vector<std::shared_ptr<DebugSection>>* all_sections,
+                            std::string* error) {
+  ElfIdent ident;
+  read_elf_ident(source, &ident, nullptr);
+  bool ok = true;
+  for (const ElfSectionHeader& header : headers) {
+    std::string name = header.name;
+    const bool dwo = name.size() > kDwoSuffixLength &&
+                     name.compare(name.size() - kDwoSuffixLength, kDwoSuffixLength, kDwoSuffix) == 0;
+    if (dwo != split) {
+      continue;
+    }
+    if (dwo) {
+      name.resize(name.size() - kDwoSuffixLength);
+    }
+    DwarfSection* slot = dwarf_section_slot(out, name);
+    if (!slot) {
+      continue;
+    }
+    std::string section_error;
+    auto section = DebugSection::from_elf(source, header.name, header.offset, header.size, header.flags,
+                                          ident.elf64, ident.endian, &section_error);
+    if (!section) {
+      if (ok && error) {
+        *error = section_error;
+      }
+      ok = false;
+      continue;
+    }
+    slot->section = section;
+    if (all_sections) {
+      all_sections->push_back(std::move(section));
+    }
+  }
+  return ok;
+}
+
+bool ElfDebugLink::empty() const { return build_id.empty() && debuglink.empty(); }
+
+void read_elf_debug_link(const ByteSource& source, const std::vector<ElfSectionHeader>& headers,
+                         ElfDebugLink* out) {
+  *out = ElfDebugLink{};
+  ElfIdent ident;
+  read_elf_ident(source, &ident, nullptr);
+  for (const ElfSectionHeader& header : headers) {
+    ByteView bytes;
+    if (header.type == kElfShtNote && out->build_id.empty()) {
+      if (source.view(header.offset, header.size, &bytes)) {
+        read_build_id(bytes, ident.endian, &out->build_id);
+      }
+    } else if (header.name == kDebuglinkName && source.view(header.offset, header.size, &bytes)) {
+      // NUL-terminated name, padded to 4 bytes, then the CRC.
+      std::string name = read_string(bytes, 0);
+      ByteReader reader(bytes, ident.endian);
+      if (!name.empty() && reader.seek(align4(name.size() + 1)) && reader.read_u32(&out->debuglink_crc)) {
+        out->debuglink = std::move(name);
+      }
+    }
+  }
+}
+
+} // namespace ghirda::loader
@@ -2,4 +2,20 @@
 
 namespace ghirda::loader {
 
+uint32_t Loader::probe(std::span<const uint8_t>) const { return 0; }
+
+bool Loader::load(const std::string& path, ghirda::core::Program* program, std::string* error) {
+  if (!program) {
+    if (error) {
+      *error = "program output is null";
+    }
+    return false;
+  }
+  auto source = open_byte_source(path, error);
+  if (!source) {
+    return false;
+  }
+  return load(*source, program, error);
+}
+
 } // namespace ghirda::loader
@@ -0,0 +1,173 @@
+#include "ghirda/loader/loader_registry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "ghirda/loader/elf_loader.h"
+#include "ghirda/loader/macho_loader.h"
+#include "ghirda/loader/pe_loader.h"
+#include "ghirda/loader/raw_loader.h"
+
+namespace ghirda::loader {
+namespace {
+
+bool view_header(const ByteSource& source, ByteView* out, std::string* error) {
+  const uint64_t size = std::min<uint64_t>(source.size(), LoaderRegistry::kProbeSize);
+  if (size == 0) {
+    if (error) {
+      *error = "empty input";
+    }
+    return false;
+  }
+  if (!source.view(0, size, out)) {
+    if (error) {
+      *error = "failed to read header";
+    }
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+LoaderRegistry LoaderRegistry::with_builtin_loaders() {
+  LoaderRegistry registry;
+  registry.add("elf", [] { return std::make_unique<ElfLoader>(); });
+  registry.add("pe", [] { return std::make_unique<PeLoader>(); });
+  registry.add("macho", [] { return std::make_unique<MachoLoader>(); });
+  registry.add("raw", [] { return std::make_unique<RawLoader>(); });
+  return registry;
+}
+
+void LoaderRegistry::add(std::string name, LoaderFactory factory) {
+  std::unique_ptr<Loader> prober = factory ? factory() : nullptr;
+  for (Entry& entry : entries_) {
+    if (entry.name == name) {
+      entry.factory = std::move(factory);
+      entry.prober = std::move(prober);
+      return;
+    }
+  }
+  entries_.push_back(Entry{std::move(name), std::move(factory), std::move(prober)});
+}
+
+bool LoaderRegistry::contains(const std::string& name) const {
+  return std::any_of(entries_.begin(), entries_.end(), [&](const Entry& entry) { return entry.name == name; });
+}
+
+std::vector<std::string> LoaderRegistry::names() const {
+  std::vector<std::string> out;
+  out.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    out.push_back(entry.name);
+  }
+  return out;
+}
+
+std::vector<LoaderMatch> LoaderRegistry::probe(std::span<const uint8_t> header) const {
+  std::vector<LoaderMatch> matches;
+  for (const Entry& entry : entries_) {
+    const uint32_t confidence = entry.prober ? std::min<uint32_t>(entry.prober->probe(header), 100) : 0;
+    if (confidence != 0) {
+      matches.push_back(LoaderMatch{entry.name, confidence});
+    }
+  }
+  std::stable_sort(matches.begin(), matches.end(),
+                   [](const LoaderMatch& a, const LoaderMatch& b) { return a.confidence > b.confidence; });
+  return matches;
+}
+
+bool LoaderRegistry::probe(const ByteSource& source, std::vector<LoaderMatch>* matches, std::string* error) const {
+  matches->clear();
+  ByteView header;
+  if (!view_header(source, &header, error)) {
+    return false;
+  }
+  *matches = probe(header.span());
+  return true;
+}
+
+std::vector<LoaderMatch> LoaderRegistry::probe_all(std::span<const ByteSource* const> sources,
+                                                   size_t thread_count) const {
+  std::vector<LoaderMatch> results(sources.size());
+  std::atomic<size_t> next{0};
+  auto worker = [&] {
+    std::vector<LoaderMatch> matches;
+    for (size_t i = next.fetch_add(1); i < sources.size(); i = next.fetch_add(1)) {
+      if (sources[i] && probe(*sources[i], &matches, nullptr) && !matches.empty()) {
+        results[i] = std::move(matches.front());
+      }
+    }
+  };
+
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, sources.size());
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return results;
+}
+
+std::unique_ptr<Loader> LoaderRegistry::create(const std::string& name) const {
+  for (const Entry& entry : entries_) {
+    if (entry.name == name) {
+      return entry.factory ? entry.factory() : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+bool LoaderRegistry::load(const ByteSource& source, ghirda::core::Program* program, std::string* error,
+                          std::string* loader_name) const {
+  std::vector<LoaderMatch> matches;
+  if (!probe(source, &matches, error)) {
+    return false;
+  }
+  if (matches.empty()) {
+    if (error) {
+      *error = "no loader recognizes the input format";
+    }
+    return false;
+  }
+  if (loader_name) {
+    *loader_name = matches.front().name;
+  }
+  return load_with(matches.front().name, source, program, error);
+}
+
+bool LoaderRegistry::load(const std::string& path, ghirda::core::Program* program, std::string* error,
+                          std::string* loader_name) const {
+  if (!program) {
+    if (error) {
+      *error = "program output is null";
+    }
+    return false;
+  }
+  auto source = open_byte_source(path, error);
+  if (!source) {
+    return false;
+  }
+  return load(*source, program, error, loader_name);
+}
+
+bool LoaderRegistry::load_with(const std::string& name, const ByteSource& source, ghirda::core::Program* program,
+                               std::string* error) const {
+  std::unique_ptr<Loader> loader = create(name);
+  if (!loader) {
+    if (error) {
+      *error = "unknown loader: " + name;
+    }
+    return false;
+  }
+  return loader->load(source, program, error);
+}
+
+} // namespace ghirda::loader
@@ -0,0 +1,657 @@
+#include "ghirda/loader/macho_fixups.h"
+
+#include <algorithm>
+
+#include "ghirda/loader/relocation_batch.h"
+
+namespace ghirda::loader {
+namespace {
+
+// Rebase/bind opcode streams (mach-o/loader.h).
+constexpr uint8_t kOpcodeMask = 0xf0;
+constexpr uint8_t kImmediateMask = 0x0f;
+
+constexpr uint8_t kRebaseDone = 0x00;
+constexpr uint8_t kRebaseSetType = 0x10;
+constexpr uint8_t kRebaseSetSegmentOffset = 0x20;
+constexpr uint8_t kRebaseAddAddrUleb = 0x30;
+constexpr uint8_t kRebaseAddAddrImmScaled = 0x40;
+constexpr uint8_t kRebaseImmTimes = 0x50;
+constexpr uint8_t kRebaseUlebTimes = 0x60;
+constexpr uint8_t kRebaseAddAddrUlebOnce = 0x70;
+constexpr uint8_t kRebaseUlebTimesSkipping = 0x80;
+
+constexpr uint8_t kBindDone = 0x00;
+constexpr uint8_t kBindSetDylibImm = 0x10;
+constexpr uint8_t kBindSetDylibUleb = 0x20;
+constexpr uint8_t kBindSetDylibSpecial = 0x30;
+constexpr uint8_t kBindSetSymbol = 0x40;
+constexpr uint8_t kBindSetType = 0x50;
+constexpr uint8_t kBindSetAddend = 0x60;
+constexpr uint8_t kBindSetSegmentOffset = 0x70;
+constexpr uint8_t kBindAddAddrUleb = 0x80;
+constexpr uint8_t kBindDo = 0x90;
+constexpr uint8_t kBindDoAddAddrUleb = 0xa0;
+constexpr uint8_t kBindDoAddAddrImmScaled = 0xb0;
+constexpr uint8_t kBindDoUlebTimesSkipping = 0xc0;
+
+constexpr uint8_t kBindSymbolNonWeakDefinition = 0x8;
+
+constexpr uint32_t kTypePointer = 1;
+constexpr uint32_t kTypeTextAbsolute32 = 2;
+constexpr uint32_t kTypeTextPcrel32 = 3;
+
+// Chained fixups (mach-o/fixup-chains.h).
+constexpr uint16_t kPtrArm64e = 1;
+constexpr uint16_t kPtr64 = 2;
+constexpr uint16_t kPtr64Offset = 6;
+constexpr uint16_t kPtrArm64eKernel = 7;
+constexpr uint16_t kPtrArm64eUserland = 9;
+constexpr uint16_t kPtrArm64eFirmware = 10;
+constexpr uint16_t kPtrArm64eUserland24 = 12;
+
+constexpr uint32_t kImport = 1;
+constexpr uint32_t kImportAddend = 2;
+constexpr uint32_t kImportAddend64 = 3;
+
+constexpr uint16_t kPageStartNone = 0xffff;
+constexpr uint16_t kPageStartMulti = 0x8000;
+
+constexpr uint32_t kNoSymbol = ghirda::core::Relocation::kNoSymbol;
+
+struct Fixup {
+  uint64_t address = 0;
+  uint64_t value = 0;
+  int64_t addend = 0;
+  uint32_t symbol = kNoSymbol;
+  uint32_t type = 0;
+  uint8_t size = 8;
+  bool write = true;
+};
+
+struct ChainedImport {
+  uint32_t symbol = kNoSymbol;
+  int64_t library = 0;
+  int64_t addend = 0;
+};
+
+bool read_uleb(ByteReader& reader, uint64_t* value) {
+  uint64_t result = 0;
+  unsigned shift = 0;
+  uint8_t byte = 0;
+  do {
+    if (!reader.read_u8(&byte)) {
+      return false;
+    }
+    if (shift < 64) {
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    }
+    shift += 7;
+  } while ((byte & 0x80) != 0);
+  *value = result;
+  return true;
+}
+
+bool read_sleb(ByteReader& reader, int64_t* value) {
+  int64_t result = 0;
+  unsigned shift = 0;
+  uint8_t byte = 0;
+  do {
+    if (!reader.read_u8(&byte)) {
+      return false;
+    }
+    if (shift < 64) {
+      result |= static_cast<int64_t>(byte & 0x7f) << shift;
+    }
+    shift += 7;
+  } while ((byte & 0x80) != 0);
+  if (shift < 64 && (byte & 0x40) != 0) {
+    result |= -(int64_t{1} << shift);
+  }
+  *value = result;
+  return true;
+}
+
+int64_t sign_extend(uint64_t value, unsigned bits) {
+  const uint64_t sign = uint64_t{1} << (bits - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+uint64_t bits(uint64_t value, unsigned low, unsigned count) { return (value >> low) & ((uint64_t{1} << count) - 1); }
+
+class FixupSet {
+public:
+  FixupSet(const MachoImageLayout& layout, ghirda::core::Program* program) : layout_(layout), batch_(program) {}
+
+  uint32_t intern(const std::string& name) { return batch_.intern(name); }
+
+  // Address a bind resolves to: the image's own definition for self, flat
+  // and weak lookups, otherwise nothing is known beyond the addend.
+  uint64_t bind_target(uint32_t symbol, int64_t library) const {
+    if (library > 0 || symbol == kNoSymbol) {
+      return 0;
+    }
+    auto it = layout_.defined.find(batch_.symbol_name(symbol));
+    return it == layout_.defined.end() ? 0 : it->second;
+  }
+
+  void add(const Fixup& fixup) {
+    ghirda::core::Relocation reloc{};
+    reloc.address = fixup.address;
+    reloc.type = fixup.type;
+    reloc.addend = fixup.addend;
+    reloc.symbol = fixup.symbol;
+    reloc.size = fixup.size;
+    if (fixup.write) {
+      batch_.store(reloc, fixup.value, fixup.size);
+    } else {
+      batch_.record(reloc);
+    }
+  }
+
+  void unsupported(uint64_t address, uint32_t type) {
+    ghirda::core::Relocation reloc{};
+    reloc.address = address;
+    reloc.type = type;
+    reloc.status = ghirda::core::RelocationStatus::Unsupported;
+    batch_.record(reloc);
+  }
+
+  void commit() { batch_.commit(); }
+
+private:
+  const MachoImageLayout& layout_;
+  RelocationBatch batch_;
+};
+
+bool segment_address(const MachoImageLayout& layout, uint64_t segment, uint64_t offset, uint64_t* address) {
+  if (segment >= layout.segments.size()) {
+    return false;
+  }
+  *address = layout.segments[segment].vmaddr + offset;
+  return true;
+}
+
+bool decode_rebases(const ByteView& stream, const MachoImageLayout& layout, FixupSet* fixups) {
+  ByteReader reader(stream);
+  uint32_t type = kTypePointer;
+  uint64_t address = 0;
+  bool have_segment = false;
+  auto rebase = [&]() {
+    Fixup fixup;
+    fixup.address = address;
+    fixup.type = type;
+    // Slide is zero: the stored pointer is already the target.
+    fixup.write = false;
+    fixups->add(fixup);
+    address += sizeof(uint64_t);
+  };
+
+  uint8_t byte = 0;
+  while (reader.read_u8(&byte)) {
+    const uint8_t immediate = byte & kImmediateMask;
+    uint64_t count = 0;
+    uint64_t skip = 0;
+    switch (byte & kOpcodeMask) {
+      case kRebaseDone:
+        return true;
+      case kRebaseSetType:
+        type = immediate;
+        break;
+      case kRebaseSetSegmentOffset: {
+        uint64_t offset = 0;
+        if (!read_uleb(reader, &offset) || !segment_address(layout, immediate, offset, &address)) {
+          return false;
+        }
+        have_segment = true;
+        break;
+      }
+      case kRebaseAddAddrUleb:
+        if (!read_uleb(reader, &skip)) {
+          return false;
+        }
+        address += skip;
+        break;
+      case kRebaseAddAddrImmScaled:
+        address += immediate * sizeof(uint64_t);
+        break;
+      case kRebaseImmTimes:
+      case kRebaseUlebTimes:
+        count = immediate;
+        if ((byte & kOpcodeMask) == kRebaseUlebTimes && !read_uleb(reader, &count)) {
+          return false;
+        }
+        for (uint64_t i = 0; have_segment && i < count; ++i) {
+          rebase();
+        }
+        break;
+      case kRebaseAddAddrUlebOnce:
+        if (!have_segment || !read_uleb(reader, &skip)) {
+          return false;
+        }
+        rebase();
+        address += skip;
+        break;
+      case kRebaseUlebTimesSkipping:
+        if (!have_segment || !read_uleb(reader, &count) || !read_uleb(reader, &skip)) {
+          return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+          rebase();
+          address += skip;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+// Lazy bind streams are a sequence of independent entries each ending in
+// BIND_OPCODE_DONE, so DONE only ends the stream for the other kinds.
+bool decode_binds(const ByteView& stream, const MachoImageLayout& layout, bool lazy, bool weak, FixupSet* fixups) {
+  ByteReader reader(stream);
+  uint32_t type = kTypePointer;
+  uint32_t symbol = kNoSymbol;
+  bool skip_symbol = false;
+  int64_t library = 0;
+  int64_t addend = 0;
+  uint64_t address = 0;
+  bool have_segment = false;
+  auto bind = [&]() {
+    if (!have_segment || symbol == kNoSymbol || skip_symbol) {
+      return;
+    }
+    Fixup fixup;
+    fixup.address = address;
+    fixup.type = type;
+    fixup.symbol = symbol;
+    fixup.addend = addend;
+    const uint64_t target = fixups->bind_target(symbol, weak ? 0 : library) + static_cast<uint64_t>(addend);
+    switch (type) {
+      case kTypePointer:
+        fixup.value = target;
+        break;
+      case kTypeTextAbsolute32:
+        fixup.value = target;
+        fixup.size = sizeof(uint32_t);
+        break;
+      case kTypeTextPcrel32:
+        fixup.value = target - (address + sizeof(uint32_t));
+        fixup.size = sizeof(uint32_t);
+        break;
+      default:
+        fixup.write = false;
+        break;
+    }
+    fixups->add(fixup);
+  };
+
+  uint8_t byte = 0;
+  while (reader.read_u8(&byte)) {
+    const uint8_t immediate = byte & kImmediateMask;
+    uint64_t value = 0;
+    uint64_t skip = 0;
+    switch (byte & kOpcodeMask) {
+      case kBindDone:
+        if (!lazy) {
+          return true;
+        }
+        break;
+      case kBindSetDylibImm:
+        library = immediate;
+        break;
+      case kBindSetDylibUleb:
+        if (!read_uleb(reader, &value)) {
+          return false;
+        }
+        library = static_cast<int64_t>(value);
+        break;
+      case kBindSetDylibSpecial:
+        library = immediate == 0 ? 0 : static_cast<int8_t>(kOpcodeMask | immediate);
+        break;
+      case kBindSetSymbol: {
+        std::string name;
+        if (!reader.read_cstring(&name)) {
+          return false;
+        }
+        symbol = fixups->intern(name);
+        // Weak bind entries flagged non-weak only announce a strong
+        // definition; they do not patch anything.
+        skip_symbol = weak && (immediate & kBindSymbolNonWeakDefinition) != 0;
+        break;
+      }
+      case kBindSetType:
+        type = immediate;
+        break;
+      case kBindSetAddend:
+        if (!read_sleb(reader, &addend)) {
+          return false;
+        }
+        break;
+      case kBindSetSegmentOffset:
+        if (!read_uleb(reader, &value) || !segment_address(layout, immediate, value, &address)) {
+          return false;
+        }
+        have_segment = true;
+        break;
+      case kBindAddAddrUleb:
+        if (!read_uleb(reader, &skip)) {
+          return false;
+        }
+        address += skip;
+        break;
+      case kBindDo:
+        bind();
+        address += sizeof(uint64_t);
+        break;
+      case kBindDoAddAddrUleb:
+        if (!read_uleb(reader, &skip)) {
+          return false;
+        }
+        bind();
+        address += sizeof(uint64_t) + skip;
+        break;
+      case kBindDoAddAddrImmScaled:
+        bind();
+        address += sizeof(uint64_t) + immediate * sizeof(uint64_t);
+        break;
+      case kBindDoUlebTimesSkipping: {
+        uint64_t count = 0;
+        if (!read_uleb(reader, &count) || !read_uleb(reader, &skip)) {
+          return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+          bind();
+          address += sizeof(uint64_t) + skip;
+        }
+        break;
+      }
+      default:
+        // BIND_OPCODE_THREADED belongs to the pre-chained arm64e format.
+        return false;
+    }
+  }
+  return true;
+}
+
+bool stride_of(uint16_t format, uint32_t* stride) {
+  switch (format) {
+    case kPtrArm64e:
+    case kPtrArm64eUserland:
+    case kPtrArm64eUserland24:
+      *stride = 8;
+      return true;
+    case kPtr64:
+    case kPtr64Offset:
+    case kPtrArm64eKernel:
+    case kPtrArm64eFirmware:
+      *stride = 4;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Decodes one 64-bit chained pointer. Returns the distance to the next
+// fixup in strides (0 ends the chain).
+uint64_t decode_chained_pointer(uint16_t format, uint64_t raw, uint64_t base, uint64_t address,
+                                const std::vector<ChainedImport>& imports, const FixupSet& fixups, Fixup* out) {
+  out->address = address;
+  out->type = format;
+  out->size = sizeof(uint64_t);
+  uint32_t ordinal = 0;
+  int64_t addend = 0;
+  bool bind = false;
+  uint64_t next = 0;
+
+  if (format == kPtr64 || format == kPtr64Offset) {
+    next = bits(raw, 51, 12);
+    bind = bits(raw, 63, 1) != 0;
+    if (bind) {
+      ordinal = static_cast<uint32_t>(bits(raw, 0, 24));
+      addend = static_cast<int64_t>(bits(raw, 24, 8));
+    } else {
+      const uint64_t target = bits(raw, 0, 36);
+      out->value = (format == kPtr64Offset ? base + target : target) | (bits(raw, 36, 8) << 56);
+    }
+  } else {
+    next = bits(raw, 51, 11);
+    bind = bits(raw, 62, 1) != 0;
+    const bool auth = bits(raw, 63, 1) != 0;
+    const bool wide_ordinal = format == kPtrArm64eUserland24;
+    if (bind) {
+      ordinal = static_cast<uint32_t>(bits(raw, 0, wide_ordinal ? 24 : 16));
+      if (!auth) {
+        addend = sign_extend(bits(raw, 32, 19), 19);
+      }
+    } else if (auth) {
+      // Authenticated rebases always hold an offset from the image base.
+      out->value = base + bits(raw, 0, 32);
+    } else {
+      const uint64_t target = bits(raw, 0, 43);
+      const bool offset = format != kPtrArm64e && format != kPtrArm64eFirmware;
+      out->value = (offset ? base + target : target) | (bits(raw, 43, 8) << 56);
+    }
+  }
+
+  if (bind) {
+    if (ordinal < imports.size()) {
+      const ChainedImport& import = imports[ordinal];
+      out->symbol = import.symbol;
+      out->addend = import.addend + addend;
+      out->value = fixups.bind_target(import.symbol, import.library) + static_cast<uint64_t>(out->addend);
+    } else {
+      out->addend = addend;
+      out->value = static_cast<uint64_t>(addend);
+    }
+  }
+  return next;
+}
+
+bool read_chained_imports(const ByteView& data, uint32_t imports_offset, uint32_t symbols_offset, uint32_t count,
+                          uint32_t format, FixupSet* fixups, std::vector<ChainedImport>* imports) {
+  ByteView table;
+  ByteView symbols;
+  const uint64_t entry_size = format == kImportAddend64 ? 16 : (format == kImportAddend ? 8 : 4);
+  if (!data.subview(imports_offset, entry_size * count, &table) ||
+      !data.subview(symbols_offset, data.size() - std::min<uint64_t>(symbols_offset, data.size()), &symbols)) {
+    return false;
+  }
+  ByteReader reader(table);
+  imports->reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    ChainedImport import;
+    uint64_t name_offset = 0;
+    if (format == kImportAddend64) {
+      uint64_t word = 0;
+      uint64_t addend = 0;
+      reader.read_u64(&word);
+      reader.read_u64(&addend);
+      import.library = sign_extend(bits(word, 0, 16), 16);
+      name_offset = bits(word, 32, 32);
+      import.addend = static_cast<int64_t>(addend);
+    } else {
+      uint32_t word = 0;
+      reader.read_u32(&word);
+      import.library = sign_extend(bits(word, 0, 8), 8);
+      name_offset = bits(word, 9, 23);
+      if (format == kImportAddend) {
+        uint32_t addend = 0;
+        reader.read_u32(&addend);
+        import.addend = static_cast<int32_t>(addend);
+      } else if (format != kImport) {
+        return false;
+      }
+    }
+    import.symbol = fixups->intern(read_string(symbols, name_offset));
+    imports->push_back(import);
+  }
+  return true;
+}
+
+} // namespace
+
+bool apply_dyld_info(const ByteSource& source, const MachoImageLayout& layout, const MachoDyldInfo& info,
+                     ghirda::core::Program* program, std::string* error) {
+  FixupSet fixups(layout, program);
+  struct Stream {
+    uint32_t offset;
+    uint32_t size;
+    const char* name;
+    bool lazy;
+    bool weak;
+  };
+  const Stream binds[] = {
+      {info.bind_off, info.bind_size, "bind", false, false},
+      {info.weak_bind_off, info.weak_bind_size, "weak bind", false, true},
+      {info.lazy_bind_off, info.lazy_bind_size, "lazy bind", true, false},
+  };
+
+  bool ok = true;
+  auto fail = [&](const std::string& message) {
+    ok = false;
+    if (error && error->empty()) {
+      *error = message;
+    }
+  };
+  ByteView stream;
+  if (info.rebase_size != 0) {
+    if (!source.view(info.rebase_off, info.rebase_size, &stream) || !decode_rebases(stream, layout, &fixups)) {
+      fail("malformed rebase opcodes");
+    }
+  }
+  for (const Stream& bind : binds) {
+    if (bind.size == 0) {
+      continue;
+    }
+    if (!source.view(bind.offset, bind.size, &stream) ||
+        !decode_binds(stream, layout, bind.lazy, bind.weak, &fixups)) {
+      fail(std::string("malformed ") + bind.name + " opcodes");
+    }
+  }
+  // Whatever decoded before a malformed opcode is still applied.
+  fixups.commit();
+  return ok;
+}
+
+bool apply_chained_fixups(const ByteSource& source, const MachoImageLayout& layout, uint32_t data_offset,
+                          uint32_t data_size, ghirda::core::Program* program, std::string* error) {
+  auto fail = [&](const char* message) {
+    if (error && error->empty()) {
+      *error = message;
+    }
+    return false;
+  };
+  ByteView data;
+  if (!source.view(data_offset, data_size, &data)) {
+    return fail("chained fixups out of bounds");
+  }
+  ByteReader header(data);
+  uint32_t version = 0;
+  uint32_t starts_offset = 0;
+  uint32_t imports_offset = 0;
+  uint32_t symbols_offset = 0;
+  uint32_t imports_count = 0;
+  uint32_t imports_format = 0;
+  uint32_t symbols_format = 0;
+  if (!header.read_u32(&version) || !header.read_u32(&starts_offset) || !header.read_u32(&imports_offset) ||
+      !header.read_u32(&symbols_offset) || !header.read_u32(&imports_count) || !header.read_u32(&imports_format) ||
+      !header.read_u32(&symbols_format) || version != 0) {
+    return fail("unsupported chained fixups header");
+  }
+
+  FixupSet fixups(layout, program);
+  std::vector<ChainedImport> imports;
+  // Compressed symbol names (symbols_format 1) are not produced by ld64.
+  if (symbols_format != 0 || !read_chained_imports(data, imports_offset, symbols_offset, imports_count,
+                                                   imports_format, &fixups, &imports)) {
+    return fail("unsupported chained fixups imports");
+  }
+
+  // Chained offsets are relative to the mach header, which starts the first
+  // segment with file content.
+  uint64_t base = 0;
+  for (const MachoSegment& seg : layout.segments) {
+    if (seg.fileoff == 0 && seg.filesize != 0) {
+      base = seg.vmaddr;
+      break;
+    }
+  }
+
+  ByteReader starts(data);
+  uint32_t segment_count = 0;
+  if (!starts.seek(starts_offset) || !starts.read_u32(&segment_count)) {
+    return fail("malformed chained starts");
+  }
+  bool ok = true;
+  for (uint32_t s = 0; s < segment_count && s < layout.segments.size(); ++s) {
+    uint32_t info_offset = 0;
+    if (!starts.seek(starts_offset + 4ull + 4ull * s) || !starts.read_u32(&info_offset)) {
+      ok = fail("malformed chained starts");
+      break;
+    }
+    if (info_offset == 0) {
+      continue;
+    }
+    ByteReader info(data);
+    uint32_t size = 0;
+    uint16_t page_size = 0;
+    uint16_t format = 0;
+    uint64_t segment_offset = 0;
+    uint32_t max_valid_pointer = 0;
+    uint16_t page_count = 0;
+    if (!info.seek(static_cast<uint64_t>(starts_offset) + info_offset) || !info.read_u32(&size) ||
+        !info.read_u16(&page_size) || !info.read_u16(&format) || !info.read_u64(&segment_offset) ||
+        !info.read_u32(&max_valid_pointer) || !info.read_u16(&page_count)) {
+      ok = fail("malformed chained segment starts");
+      continue;
+    }
+    const MachoSegment& seg = layout.segments[s];
+    uint32_t stride = 0;
+    if (!stride_of(format, &stride)) {
+      fixups.unsupported(seg.vmaddr, format);
+      continue;
+    }
+    // Chains are walked over the file bytes of the segment, which one view
+    // covers; the MemoryImage is only touched by the batched commit.
+    ByteView contents;
+    if (!source.view(seg.fileoff, seg.filesize, &contents)) {
+      ok = fail("chained fixup segment out of bounds");
+      continue;
+    }
+    const uint64_t segment_address = base + segment_offset;
+    for (uint16_t page = 0; page < page_count; ++page) {
+      uint16_t start = 0;
+      if (!info.read_u16(&start)) {
+        break;
+      }
+      // Multi-start pages only occur in 32-bit formats.
+      if (start == kPageStartNone || (start & kPageStartMulti) != 0) {
+        continue;
+      }
+      uint64_t address = segment_address + static_cast<uint64_t>(page) * page_size + start;
+      while (true) {
+        const uint64_t file_offset = address - seg.vmaddr;
+        uint64_t raw = 0;
+        ByteView slot;
+        if (address < seg.vmaddr || !contents.subview(file_offset, sizeof(raw), &slot) ||
+            !ByteReader(slot).read_u64(&raw)) {
+          break;
+        }
+        Fixup fixup;
+        const uint64_t next = decode_chained_pointer(format, raw, base, address, imports, fixups, &fixup);
+        fixups.add(fixup);
+        if (next == 0) {
+          break;
+        }
+        address += next * stride;
+      }
+    }
+  }
+  fixups.commit();
+  return ok;
+}
+
+} // namespace ghirda::loader
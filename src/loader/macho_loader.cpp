@@ -1,15 +1,18 @@
 #include "ghirda/loader/macho_loader.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
-#include <fstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "ghirda/core/address_space.h"
 #include "ghirda/core/memory_map.h"
 #include "ghirda/core/relocation.h"
 #include "ghirda/core/symbol.h"
+#include "ghirda/loader/dwarf_types.h"
+#include "ghirda/loader/macho_fixups.h"
 
 namespace ghirda::loader {
 namespace {
@@ -100,6 +103,37 @@ struct DysymtabCommand {
   uint32_t nlocrel;
 };
 
+struct DyldInfoCommand {
+  uint32_t cmd;
+  uint32_t cmdsize;
+  uint32_t rebase_off;
+  uint32_t rebase_size;
+  uint32_t bind_off;
+  uint32_t bind_size;
+  uint32_t weak_bind_off;
+  uint32_t weak_bind_size;
+  uint32_t lazy_bind_off;
+  uint32_t lazy_bind_size;
+  uint32_t export_off;
+  uint32_t export_size;
+};
+
+struct LinkeditDataCommand {
+  uint32_t cmd;
+  uint32_t cmdsize;
+  uint32_t dataoff;
+  uint32_t datasize;
+};
+
+struct DylibCommand {
+  uint32_t cmd;
+  uint32_t cmdsize;
+  uint32_t name_offset;
+  uint32_t timestamp;
+  uint32_t current_version;
+  uint32_t compatibility_version;
+};
+
 struct RelocationInfo {
   int32_t r_address;
   uint32_t r_symbolnum : 24,
@@ -114,33 +148,71 @@ constexpr uint32_t kMachMagic64 = 0xfeedfacf;
 constexpr uint32_t kLcSegment64 = 0x19;
 constexpr uint32_t kLcSymtab = 0x2;
 constexpr uint32_t kLcDysymtab = 0xb;
-
-bool read_exact(std::ifstream& in, void* data, size_t size) {
-  in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
-  return in.good();
-}
-
-bool read_blob(std::ifstream& in, uint64_t offset, uint64_t size, std::vector<uint8_t>* out) {
-  out->assign(static_cast<size_t>(size), 0);
-  in.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
-  if (!in) {
-    return false;
+constexpr uint32_t kLcLoadDylib = 0xc;
+constexpr uint32_t kLcLazyLoadDylib = 0x20;
+constexpr uint32_t kLcDyldInfo = 0x22;
+constexpr uint32_t kLcReqDyld = 0x80000000;
+constexpr uint32_t kLcLoadWeakDylib = 0x18 | kLcReqDyld;
+constexpr uint32_t kLcReexportDylib = 0x1f | kLcReqDyld;
+constexpr uint32_t kLcDyldInfoOnly = 0x22 | kLcReqDyld;
+constexpr uint32_t kLcLoadUpwardDylib = 0x23 | kLcReqDyld;
+constexpr uint32_t kLcDyldChainedFixups = 0x34 | kLcReqDyld;
+
+constexpr uint32_t kMachoAttrPureInstructions = 0x80000000u;
+constexpr uint32_t kMachoAttrSomeInstructions = 0x400;
+
+constexpr uint8_t kNlistStab = 0xe0;
+constexpr uint8_t kNlistTypeMask = 0x0e;
+constexpr uint8_t kNlistSect = 0x0e;
+
+constexpr uint32_t kFatMagic = 0xcafebabe;
+constexpr uint32_t kFatMagic64 = 0xcafebabf;
+// Java class files share kFatMagic; their version field lands where nfat_arch
+// would be and is always >= 45, so a real fat header stays well below that.
+constexpr uint32_t kMaxFatArches = 32;
+
+constexpr uint32_t kCpuArchAbi64 = 0x01000000;
+constexpr uint32_t kCpuArchAbi64_32 = 0x02000000;
+constexpr uint32_t kCpuTypeX86 = 7;
+constexpr uint32_t kCpuTypeArm = 12;
+constexpr uint32_t kCpuTypePowerPc = 18;
+constexpr uint32_t kCpuSubtypeMask = 0x00ffffff;
+constexpr uint32_t kCpuSubtypeArm64e = 2;
+
+ghirda::core::Processor to_processor(uint32_t cputype) {
+  switch (cputype) {
+    case kCpuTypeX86:
+      return ghirda::core::Processor::X86;
+    case kCpuTypeX86 | kCpuArchAbi64:
+      return ghirda::core::Processor::X86_64;
+    case kCpuTypeArm:
+      return ghirda::core::Processor::Arm;
+    case kCpuTypeArm | kCpuArchAbi64:
+    case kCpuTypeArm | kCpuArchAbi64_32:
+      return ghirda::core::Processor::Aarch64;
+    case kCpuTypePowerPc:
+      return ghirda::core::Processor::PowerPc;
+    case kCpuTypePowerPc | kCpuArchAbi64:
+      return ghirda::core::Processor::PowerPc64;
+    default:
+      return ghirda::core::Processor::Unknown;
   }
-  in.read(reinterpret_cast<char*>(out->data()), static_cast<std::streamsize>(size));
-  return in.good();
 }
 
-std::string read_string(const std::vector<uint8_t>& table, uint32_t offset) {
-  if (offset >= table.size()) {
-    return {};
+template <typename T>
+bool read_table(const ByteSource& source, uint64_t offset, size_t count, std::vector<T>* out) {
+  out->resize(count);
+  if (count == 0) {
+    return true;
   }
-  const char* start = reinterpret_cast<const char*>(table.data() + offset);
-  return std::string(start);
+  if (count > source.size() / sizeof(T) || !source.read(offset, out->data(), count * sizeof(T))) {
+    out->clear();
+    return false;
+  }
+  return true;
 }
 
-} // namespace
-
-bool MachoLoader::load(const std::string& path, ghirda::core::Program* program, std::string* error) {
+bool load_thin(const ByteSource& source, ghirda::core::Program* program, std::string* error) {
   if (!program) {
     if (error) {
       *error = "program output is null";
@@ -148,21 +220,14 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
     return false;
   }
 
-  std::ifstream in(path, std::ios::binary);
-  if (!in) {
-    if (error) {
-      *error = "failed to open file";
-    }
-    return false;
-  }
-
   MachHeader64 header{};
-  if (!read_exact(in, &header, sizeof(header)) || header.magic != kMachMagic64) {
+  if (!source.read(0, &header, sizeof(header)) || header.magic != kMachMagic64) {
     if (error) {
       *error = "unsupported Mach-O header";
     }
     return false;
   }
+  program->set_processor(to_processor(header.cputype));
 
   uint64_t min_vaddr = UINT64_MAX;
   uint64_t max_vaddr = 0;
@@ -170,28 +235,52 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
   SymtabCommand symtab{};
   DysymtabCommand dysymtab{};
   bool has_symtab = false;
+  DwarfSections dwarf_sections{};
+  MachoImageLayout layout{};
+  DyldInfoCommand dyld_info{};
+  bool has_dyld_info = false;
+  LinkeditDataCommand chained_fixups{};
+  bool has_chained_fixups = false;
+
+  ByteView commands;
+  if (!source.view(sizeof(MachHeader64), header.sizeofcmds, &commands)) {
+    if (error) {
+      *error = "failed to read load commands";
+    }
+    return false;
+  }
 
-  std::streamoff cmd_offset = sizeof(MachHeader64);
+  uint64_t cmd_offset = 0;
   for (uint32_t i = 0; i < header.ncmds; ++i) {
-    in.seekg(cmd_offset, std::ios::beg);
+    ByteReader cursor(commands);
     LoadCommand lc{};
-    if (!read_exact(in, &lc, sizeof(lc)) || lc.cmdsize < sizeof(LoadCommand)) {
+    if (!cursor.seek(cmd_offset) || !cursor.read_bytes(&lc, sizeof(lc)) || lc.cmdsize < sizeof(LoadCommand) ||
+        lc.cmdsize > commands.size() - cmd_offset) {
       if (error) {
         *error = "failed to read load command";
       }
       return false;
     }
+    cursor.seek(cmd_offset);
 
     if (lc.cmd == kLcSegment64 && lc.cmdsize >= sizeof(SegmentCommand64)) {
       SegmentCommand64 seg{};
-      in.seekg(cmd_offset, std::ios::beg);
-      if (!read_exact(in, &seg, sizeof(seg))) {
+      if (!cursor.read_bytes(&seg, sizeof(seg))) {
         if (error) {
           *error = "failed to read segment";
         }
         return false;
       }
 
+      MachoSegment layout_seg{};
+      layout_seg.name = std::string(seg.segname, seg.segname + 16);
+      layout_seg.name.erase(std::find(layout_seg.name.begin(), layout_seg.name.end(), '\0'), layout_seg.name.end());
+      layout_seg.vmaddr = seg.vmaddr;
+      layout_seg.vmsize = seg.vmsize;
+      layout_seg.fileoff = seg.fileoff;
+      layout_seg.filesize = seg.filesize;
+      layout.segments.push_back(std::move(layout_seg));
+
       ghirda::core::Program::Segment ps{};
       ps.vaddr = seg.vmaddr;
       ps.memsz = seg.vmsize;
@@ -209,7 +298,7 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
 
       if (seg.filesize != 0) {
         std::vector<uint8_t> bytes;
-        if (!read_blob(in, seg.fileoff, seg.filesize, &bytes)) {
+        if (!source.read_blob(seg.fileoff, seg.filesize, &bytes)) {
           if (error) {
             *error = "failed to read segment bytes";
           }
@@ -224,11 +313,9 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
       min_vaddr = std::min(min_vaddr, seg.vmaddr);
       max_vaddr = std::max(max_vaddr, seg.vmaddr + seg.vmsize);
 
-      std::streamoff sect_offset = cmd_offset + sizeof(SegmentCommand64);
       for (uint32_t s = 0; s < seg.nsects; ++s) {
         Section64 sect{};
-        in.seekg(sect_offset, std::ios::beg);
-        if (!read_exact(in, &sect, sizeof(sect))) {
+        if (!cursor.read_bytes(&sect, sizeof(sect))) {
           if (error) {
             *error = "failed to read section";
           }
@@ -241,18 +328,36 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
         sec.size = sect.size;
         sec.file_offset = sect.offset;
         sec.flags = sect.flags;
+        sec.executable = (sect.flags & (kMachoAttrPureInstructions | kMachoAttrSomeInstructions)) != 0;
         if (!sec.name.empty()) {
           program->add_section(sec);
         }
-        sect_offset += sizeof(Section64);
+        std::string segname(sect.segname, sect.segname + 16);
+        segname.erase(std::find(segname.begin(), segname.end(), '\0'), segname.end());
+        if (segname == "__DWARF") {
+          DwarfSection* slot = dwarf_section_slot(&dwarf_sections, sec.name);
+          ByteView raw;
+          if (slot && source.view(sect.offset, sect.size, &raw)) {
+            slot->section = std::make_shared<DebugSection>(sec.name, std::move(raw));
+          }
+        }
       }
     } else if (lc.cmd == kLcSymtab && lc.cmdsize >= sizeof(SymtabCommand)) {
-      in.seekg(cmd_offset, std::ios::beg);
-      read_exact(in, &symtab, sizeof(symtab));
-      has_symtab = true;
+      has_symtab = cursor.read_bytes(&symtab, sizeof(symtab));
     } else if (lc.cmd == kLcDysymtab && lc.cmdsize >= sizeof(DysymtabCommand)) {
-      in.seekg(cmd_offset, std::ios::beg);
-      read_exact(in, &dysymtab, sizeof(dysymtab));
+      cursor.read_bytes(&dysymtab, sizeof(dysymtab));
+    } else if ((lc.cmd == kLcDyldInfo || lc.cmd == kLcDyldInfoOnly) && lc.cmdsize >= sizeof(DyldInfoCommand)) {
+      has_dyld_info = cursor.read_bytes(&dyld_info, sizeof(dyld_info));
+    } else if (lc.cmd == kLcDyldChainedFixups && lc.cmdsize >= sizeof(LinkeditDataCommand)) {
+      has_chained_fixups = cursor.read_bytes(&chained_fixups, sizeof(chained_fixups));
+    } else if ((lc.cmd == kLcLoadDylib || lc.cmd == kLcLoadWeakDylib || lc.cmd == kLcReexportDylib ||
+                lc.cmd == kLcLazyLoadDylib || lc.cmd == kLcLoadUpwardDylib) &&
+               lc.cmdsize >= sizeof(DylibCommand)) {
+      DylibCommand dylib{};
+      cursor.read_bytes(&dylib, sizeof(dylib));
+      ByteView command;
+      commands.subview(cmd_offset, lc.cmdsize, &command);
+      layout.dylibs.push_back(dylib.name_offset < lc.cmdsize ? read_string(command, dylib.name_offset) : "");
     }
 
     cmd_offset += lc.cmdsize;
@@ -263,18 +368,19 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
   }
 
   if (has_symtab) {
-    std::vector<uint8_t> strtab;
-    if (read_blob(in, symtab.stroff, symtab.strsize, &strtab)) {
-      in.seekg(static_cast<std::streamoff>(symtab.symoff), std::ios::beg);
-      for (uint32_t i = 0; i < symtab.nsyms; ++i) {
-        Nlist64 sym{};
-        if (!read_exact(in, &sym, sizeof(sym))) {
-          break;
-        }
+    ByteView strtab;
+    std::vector<Nlist64> nlists;
+    if (source.view(symtab.stroff, symtab.strsize, &strtab) &&
+        read_table(source, symtab.symoff, symtab.nsyms, &nlists)) {
+      const bool need_defined = has_dyld_info || has_chained_fixups;
+      for (const Nlist64& sym : nlists) {
         std::string name = read_string(strtab, sym.n_strx);
         if (name.empty()) {
           continue;
         }
+        if (need_defined && (sym.n_type & kNlistStab) == 0 && (sym.n_type & kNlistTypeMask) == kNlistSect) {
+          layout.defined.emplace(name, sym.n_value);
+        }
         ghirda::core::Symbol s{};
         s.name = name;
         s.address = sym.n_value;
@@ -285,22 +391,311 @@ bool MachoLoader::load(const std::string& path, ghirda::core::Program* program,
   }
 
   if (dysymtab.nlocrel > 0 && dysymtab.locreloff != 0) {
-    in.seekg(static_cast<std::streamoff>(dysymtab.locreloff), std::ios::beg);
-    for (uint32_t i = 0; i < dysymtab.nlocrel; ++i) {
-      RelocationInfo rel{};
-      if (!read_exact(in, &rel, sizeof(rel))) {
-        break;
-      }
+    std::vector<RelocationInfo> relocs;
+    read_table(source, dysymtab.locreloff, dysymtab.nlocrel, &relocs);
+    program->relocations().reserve(program->relocations().size() + relocs.size());
+    for (const RelocationInfo& rel : relocs) {
       ghirda::core::Relocation r{};
       r.address = static_cast<uint64_t>(rel.r_address);
       r.type = rel.r_type;
-      r.applied = false;
-      r.note = "macho reloc";
       program->add_relocation(r);
     }
   }
 
+  // Chained fixups supersede the opcode streams when both are present.
+  std::string fixup_error;
+  if (has_chained_fixups && chained_fixups.datasize != 0) {
+    apply_chained_fixups(source, layout, chained_fixups.dataoff, chained_fixups.datasize, program, &fixup_error);
+  } else if (has_dyld_info) {
+    MachoDyldInfo info{};
+    info.rebase_off = dyld_info.rebase_off;
+    info.rebase_size = dyld_info.rebase_size;
+    info.bind_off = dyld_info.bind_off;
+    info.bind_size = dyld_info.bind_size;
+    info.weak_bind_off = dyld_info.weak_bind_off;
+    info.weak_bind_size = dyld_info.weak_bind_size;
+    info.lazy_bind_off = dyld_info.lazy_bind_off;
+    info.lazy_bind_size = dyld_info.lazy_bind_size;
+    apply_dyld_info(source, layout, info, program, &fixup_error);
+  }
+  if (!fixup_error.empty() && error && error->empty()) {
+    *error = fixup_error;
+  }
+
+  if (dwarf_sections.debug_info.present() && dwarf_sections.debug_abbrev.present()) {
+    std::string dwarf_error;
+    if (!ingest_dwarf(dwarf_sections, program, &dwarf_error)) {
+      if (error && error->empty()) {
+        *error = dwarf_error;
+      }
+    }
+  }
+
+  return true;
+}
+
+std::string arch_name(uint32_t cputype, uint32_t cpusubtype) {
+  const uint32_t subtype = cpusubtype & kCpuSubtypeMask;
+  switch (cputype) {
+    case kCpuTypeX86:
+      return "i386";
+    case kCpuTypeX86 | kCpuArchAbi64:
+      return subtype == 8 ? "x86_64h" : "x86_64";
+    case kCpuTypeArm:
+      return subtype == 11 ? "armv7s" : (subtype == 12 ? "armv7k" : "armv7");
+    case kCpuTypeArm | kCpuArchAbi64:
+      return subtype == kCpuSubtypeArm64e ? "arm64e" : "arm64";
+    case kCpuTypeArm | kCpuArchAbi64_32:
+      return "arm64_32";
+    case kCpuTypePowerPc:
+      return "ppc";
+    case kCpuTypePowerPc | kCpuArchAbi64:
+      return "ppc64";
+    default:
+      return "cpu" + std::to_string(cputype);
+  }
+}
+
+uint32_t host_cputype() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return kCpuTypeX86 | kCpuArchAbi64;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  return kCpuTypeArm | kCpuArchAbi64;
+#else
+  return 0;
+#endif
+}
+
+size_t preferred_slice(const std::vector<MachoSlice>& slices) {
+  const uint32_t host = host_cputype();
+  for (size_t i = 0; i < slices.size(); ++i) {
+    if (host != 0 && slices[i].cputype == host) {
+      return i;
+    }
+  }
+  for (size_t i = 0; i < slices.size(); ++i) {
+    if ((slices[i].cputype & kCpuArchAbi64) != 0) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+bool load_slice_at(const ByteSource& source, const MachoSlice& slice, ghirda::core::Program* program,
+                   std::string* error) {
+  if (slice.offset == 0 && slice.size == source.size()) {
+    return load_thin(source, program, error);
+  }
+  SubByteSource window(source, slice.offset, slice.size);
+  if (!load_thin(window, program, error)) {
+    if (error && !error->empty()) {
+      *error = slice.arch + ": " + *error;
+    }
+    return false;
+  }
   return true;
 }
 
+} // namespace
+
+bool MachoLoader::is_fat(const ByteSource& source) {
+  ByteView head;
+  if (!source.view(0, sizeof(uint32_t) * 2, &head)) {
+    return false;
+  }
+  ByteReader reader(head, Endian::Big);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  reader.read_u32(&magic);
+  reader.read_u32(&count);
+  return (magic == kFatMagic || magic == kFatMagic64) && count != 0 && count <= kMaxFatArches;
+}
+
+bool MachoLoader::list_slices(const ByteSource& source, std::vector<MachoSlice>* slices, std::string* error) {
+  slices->clear();
+  if (!is_fat(source)) {
+    MachHeader64 header{};
+    if (!source.read(0, &header, sizeof(header)) || header.magic != kMachMagic64) {
+      if (error) {
+        *error = "unsupported Mach-O header";
+      }
+      return false;
+    }
+    MachoSlice thin{};
+    thin.cputype = header.cputype;
+    thin.cpusubtype = header.cpusubtype;
+    thin.size = source.size();
+    thin.arch = arch_name(header.cputype, header.cpusubtype);
+    slices->push_back(thin);
+    return true;
+  }
+
+  ByteView head;
+  source.view(0, sizeof(uint32_t) * 2, &head);
+  ByteReader header(head, Endian::Big);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  header.read_u32(&magic);
+  header.read_u32(&count);
+
+  // fat_arch is five 32-bit fields; fat_arch_64 widens offset/size and pads.
+  const bool wide = magic == kFatMagic64;
+  const uint64_t entry_size = wide ? 32 : 20;
+  ByteView table;
+  if (!source.view(sizeof(uint32_t) * 2, entry_size * count, &table)) {
+    if (error) {
+      *error = "truncated fat header";
+    }
+    return false;
+  }
+  ByteReader reader(table, Endian::Big);
+  for (uint32_t i = 0; i < count; ++i) {
+    MachoSlice slice{};
+    reader.read_u32(&slice.cputype);
+    reader.read_u32(&slice.cpusubtype);
+    if (wide) {
+      uint32_t reserved = 0;
+      reader.read_u64(&slice.offset);
+      reader.read_u64(&slice.size);
+      reader.read_u32(&slice.align);
+      reader.read_u32(&reserved);
+    } else {
+      uint32_t offset = 0;
+      uint32_t size = 0;
+      reader.read_u32(&offset);
+      reader.read_u32(&size);
+      reader.read_u32(&slice.align);
+      slice.offset = offset;
+      slice.size = size;
+    }
+    if (!source.contains(slice.offset, slice.size) || slice.size == 0) {
+      if (error) {
+        *error = "fat slice " + std::to_string(i) + " is out of bounds";
+      }
+      slices->clear();
+      return false;
+    }
+    slice.arch = arch_name(slice.cputype, slice.cpusubtype);
+    slices->push_back(slice);
+  }
+  return true;
+}
+
+uint32_t MachoLoader::probe(std::span<const uint8_t> header) const {
+  ByteReader reader(ByteView(header.data(), header.size()));
+  uint32_t magic = 0;
+  if (!reader.read_u32(&magic)) {
+    return 0;
+  }
+  if (magic == kMachMagic64) {
+    return 100;
+  }
+  // Fat headers are big-endian; the arch count bound keeps Java class files out.
+  reader.seek(0);
+  reader.set_endian(Endian::Big);
+  uint32_t count = 0;
+  reader.read_u32(&magic);
+  if ((magic == kFatMagic || magic == kFatMagic64) && reader.read_u32(&count) && count != 0 &&
+      count <= kMaxFatArches) {
+    return 90;
+  }
+  return 0;
+}
+
+bool MachoLoader::load(const ByteSource& source, ghirda::core::Program* program, std::string* error) {
+  if (!is_fat(source)) {
+    return load_thin(source, program, error);
+  }
+  std::vector<MachoSlice> slices;
+  if (!list_slices(source, &slices, error)) {
+    return false;
+  }
+  return load_slice_at(source, slices[preferred_slice(slices)], program, error);
+}
+
+bool MachoLoader::load_slice(const ByteSource& source, size_t index, ghirda::core::Program* program,
+                             std::string* error) {
+  std::vector<MachoSlice> slices;
+  if (!list_slices(source, &slices, error)) {
+    return false;
+  }
+  if (index >= slices.size()) {
+    if (error) {
+      *error = "slice index out of range";
+    }
+    return false;
+  }
+  return load_slice_at(source, slices[index], program, error);
+}
+
+bool MachoLoader::load_slice(const ByteSource& source, const std::string& arch, ghirda::core::Program* program,
+                             std::string* error) {
+  std::vector<MachoSlice> slices;
+  if (!list_slices(source, &slices, error)) {
+    return false;
+  }
+  for (const auto& slice : slices) {
+    if (slice.arch == arch) {
+      return load_slice_at(source, slice, program, error);
+    }
+  }
+  if (error) {
+    *error = "no slice for architecture " + arch;
+  }
+  return false;
+}
+
+bool MachoLoader::load_all(const ByteSource& source, const std::string& name,
+                           std::vector<ghirda::core::Program>* programs, std::vector<std::string>* errors,
+                           size_t thread_count) {
+  std::vector<MachoSlice> slices;
+  std::string list_error;
+  if (!list_slices(source, &slices, &list_error)) {
+    if (errors) {
+      errors->assign(1, list_error);
+    }
+    return false;
+  }
+
+  programs->clear();
+  programs->reserve(slices.size());
+  for (const auto& slice : slices) {
+    programs->emplace_back(name + ":" + slice.arch);
+  }
+  std::vector<std::string> slice_errors(slices.size());
+  std::vector<uint8_t> loaded(slices.size(), 0);
+
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    while (true) {
+      size_t index = next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= slices.size()) {
+        break;
+      }
+      loaded[index] = load_slice_at(source, slices[index], &(*programs)[index], &slice_errors[index]) ? 1 : 0;
+      if (!loaded[index] && slice_errors[index].empty()) {
+        slice_errors[index] = slices[index].arch + ": load failed";
+      }
+    }
+  };
+
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, slices.size());
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (errors) {
+    *errors = std::move(slice_errors);
+  }
+  return std::all_of(loaded.begin(), loaded.end(), [](uint8_t ok) { return ok != 0; });
+}
+
 } // namespace ghirda::loader
@@ -0,0 +1,183 @@
+#include "ghirda/loader/msf_file.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace ghirda::loader {
+namespace {
+
+constexpr char kMsfMagic[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0";
+constexpr size_t kMsfMagicSize = 32;
+constexpr uint32_t kNilStreamSize = 0xffffffffu;
+
+struct SuperBlock {
+  char magic[kMsfMagicSize];
+  uint32_t block_size;
+  uint32_t free_block_map_block;
+  uint32_t num_blocks;
+  uint32_t num_directory_bytes;
+  uint32_t unknown;
+  uint32_t block_map_addr;
+};
+
+// Large PDBs (/PDBPAGESIZE) use pages above 4 KiB to stay addressable.
+bool valid_block_size(uint32_t size) { return size >= 512 && size <= 32768 && (size & (size - 1)) == 0; }
+
+uint64_t block_count(uint64_t bytes, uint32_t block_size) { return (bytes + block_size - 1) / block_size; }
+
+} // namespace
+
+struct MsfFile::Stream {
+  std::once_flag once;
+  bool ok = false;
+  ByteView view;
+  std::vector<uint8_t> bytes;
+};
+
+bool MsfFile::is_msf(const ByteSource& source) {
+  char magic[kMsfMagicSize] = {};
+  return source.read(0, magic, sizeof(magic)) && std::memcmp(magic, kMsfMagic, sizeof(magic)) == 0;
+}
+
+MsfFile::MsfFile(std::shared_ptr<const ByteSource> source, uint32_t block_size)
+    : source_(std::move(source)), block_size_(block_size) {}
+
+MsfFile::~MsfFile() = default;
+
+std::unique_ptr<MsfFile> MsfFile::open(std::shared_ptr<const ByteSource> source, std::string* error) {
+  SuperBlock super{};
+  if (!source || !source->read(0, &super, sizeof(super)) ||
+      std::memcmp(super.magic, kMsfMagic, kMsfMagicSize) != 0) {
+    if (error) {
+      *error = "not an MSF 7.00 file";
+    }
+    return nullptr;
+  }
+  if (!valid_block_size(super.block_size) ||
+      static_cast<uint64_t>(super.num_blocks) * super.block_size > source->size()) {
+    if (error) {
+      *error = "malformed MSF superblock";
+    }
+    return nullptr;
+  }
+  std::unique_ptr<MsfFile> file(new MsfFile(std::move(source), super.block_size));
+  if (!file->read_directory(super.num_directory_bytes, error)) {
+    return nullptr;
+  }
+  return file;
+}
+
+bool MsfFile::read_directory(uint32_t directory_bytes, std::string* error) {
+  auto fail = [&](const char* message) {
+    if (error) {
+      *error = message;
+    }
+    return false;
+  };
+
+  // The block map lists the blocks holding the directory, which lists the
+  // blocks of every stream. The map itself spans as many blocks as it needs;
+  // the superblock ends with the array of their numbers.
+  const uint64_t directory_blocks = block_count(directory_bytes, block_size_);
+  const uint64_t map_blocks = block_count(directory_blocks * sizeof(uint32_t), block_size_);
+  const uint64_t map_list_offset = offsetof(SuperBlock, block_map_addr);
+  if (map_list_offset + map_blocks * sizeof(uint32_t) > block_size_) {
+    return fail("MSF directory too large");
+  }
+  std::vector<uint32_t> map_list(static_cast<size_t>(map_blocks));
+  if (!source_->read(map_list_offset, map_list.data(), map_list.size() * sizeof(uint32_t))) {
+    return fail("failed to read MSF block map");
+  }
+  std::vector<uint32_t> map(static_cast<size_t>(directory_blocks));
+  const size_t per_block = block_size_ / sizeof(uint32_t);
+  for (size_t i = 0; i < map_list.size(); ++i) {
+    const size_t first = i * per_block;
+    const size_t count = std::min(per_block, map.size() - first);
+    if (!source_->read(static_cast<uint64_t>(map_list[i]) * block_size_, map.data() + first,
+                       count * sizeof(uint32_t))) {
+      return fail("failed to read MSF block map");
+    }
+  }
+  std::vector<uint8_t> directory(static_cast<size_t>(directory_blocks) * block_size_);
+  for (size_t i = 0; i < map.size(); ++i) {
+    if (!source_->read(static_cast<uint64_t>(map[i]) * block_size_, directory.data() + i * block_size_,
+                       block_size_)) {
+      return fail("failed to read MSF directory");
+    }
+  }
+  directory.resize(directory_bytes);
+
+  ByteReader reader(ByteView(directory.data(), directory.size()));
+  uint32_t count = 0;
+  if (!reader.read_u32(&count) || count > reader.remaining() / sizeof(uint32_t)) {
+    return fail("malformed MSF directory");
+  }
+  sizes_.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t size = 0;
+    reader.read_u32(&size);
+    sizes_[i] = size == kNilStreamSize ? 0 : size;
+  }
+  blocks_.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint64_t blocks = block_count(sizes_[i], block_size_);
+    if (blocks > reader.remaining() / sizeof(uint32_t)) {
+      return fail("truncated MSF directory");
+    }
+    blocks_[i].resize(static_cast<size_t>(blocks));
+    reader.read_bytes(blocks_[i].data(), blocks_[i].size() * sizeof(uint32_t));
+  }
+  streams_.resize(count);
+  for (auto& stream : streams_) {
+    stream = std::make_unique<Stream>();
+  }
+  return true;
+}
+
+uint32_t MsfFile::block_size() const { return block_size_; }
+size_t MsfFile::stream_count() const { return sizes_.size(); }
+
+uint64_t MsfFile::stream_size(uint32_t index) const { return index < sizes_.size() ? sizes_[index] : 0; }
+
+const ByteView* MsfFile::stream(uint32_t index) const {
+  if (index >= streams_.size()) {
+    return nullptr;
+  }
+  Stream& stream = *streams_[index];
+  std::call_once(stream.once, [this, index]() { assemble(index); });
+  return stream.ok ? &stream.view : nullptr;
+}
+
+void MsfFile::assemble(uint32_t index) const {
+  Stream& stream = *streams_[index];
+  const std::vector<uint32_t>& blocks = blocks_[index];
+  const uint64_t size = sizes_[index];
+  if (blocks.empty()) {
+    stream.ok = true;
+    return;
+  }
+
+  const bool contiguous = std::adjacent_find(blocks.begin(), blocks.end(), [](uint32_t a, uint32_t b) {
+                            return b != a + 1;
+                          }) == blocks.end();
+  if (contiguous) {
+    stream.ok = source_->view(static_cast<uint64_t>(blocks.front()) * block_size_, size, &stream.view);
+    return;
+  }
+
+  stream.bytes.resize(static_cast<size_t>(size));
+  uint64_t done = 0;
+  for (uint32_t block : blocks) {
+    const size_t chunk = static_cast<size_t>(std::min<uint64_t>(block_size_, size - done));
+    if (!source_->read(static_cast<uint64_t>(block) * block_size_, stream.bytes.data() + done, chunk)) {
+      stream.bytes.clear();
+      return;
+    }
+    done += chunk;
+  }
+  stream.view = ByteView(stream.bytes.data(), stream.bytes.size());
+  stream.ok = true;
+}
+
+} // namespace ghirda::loader
@@ -0,0 +1,1140 @@
+#include "ghirda/loader/pdb_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#include "ghirda/loader/dwarf_types.h"
+
+namespace ghirda::loader {
+namespace {
+
+constexpr uint32_t kStreamInfo = 1;
+constexpr uint32_t kStreamTpi = 2;
+constexpr uint32_t kStreamDbi = 3;
+constexpr uint32_t kStreamIpi = 4;
+
+constexpr char kNamesStreamName[] = "/names";
+constexpr uint32_t kStringTableSignature = 0xeffeeffe;
+constexpr size_t kStringTableHeaderSize = 12;
+
+constexpr size_t kTpiHeaderSize = 56;
+constexpr size_t kDbiHeaderSize = 64;
+constexpr size_t kModInfoFixedSize = 64;
+constexpr size_t kSectionHeaderSize = 40;
+constexpr size_t kDbgHeaderSectionHdr = 5;
+constexpr uint32_t kFirstNonSimpleType = 0x1000;
+
+constexpr uint32_t kModuleSignatureC13 = 4;
+
+// Type leaves.
+constexpr uint16_t kLfModifier = 0x1001;
+constexpr uint16_t kLfPointer = 0x1002;
+constexpr uint16_t kLfProcedure = 0x1008;
+constexpr uint16_t kLfMFunction = 0x1009;
+constexpr uint16_t kLfFieldList = 0x1203;
+constexpr uint16_t kLfBitfield = 0x1205;
+constexpr uint16_t kLfArray = 0x1503;
+constexpr uint16_t kLfClass = 0x1504;
+constexpr uint16_t kLfStructure = 0x1505;
+constexpr uint16_t kLfUnion = 0x1506;
+constexpr uint16_t kLfEnum = 0x1507;
+constexpr uint16_t kLfInterface = 0x1519;
+constexpr uint16_t kLfFuncId = 0x1601;
+constexpr uint16_t kLfMFuncId = 0x1602;
+
+// Field list members.
+constexpr uint16_t kLfBClass = 0x1400;
+constexpr uint16_t kLfVBClass = 0x1401;
+constexpr uint16_t kLfIVBClass = 0x1402;
+constexpr uint16_t kLfIndex = 0x1404;
+constexpr uint16_t kLfVFuncTab = 0x1409;
+constexpr uint16_t kLfEnumerate = 0x1502;
+constexpr uint16_t kLfMember = 0x150d;
+constexpr uint16_t kLfStMember = 0x150e;
+constexpr uint16_t kLfMethod = 0x150f;
+constexpr uint16_t kLfNestType = 0x1510;
+constexpr uint16_t kLfOneMethod = 0x1511;
+
+// Numeric leaves.
+constexpr uint16_t kLfNumeric = 0x8000;
+constexpr uint16_t kLfChar = 0x8000;
+constexpr uint16_t kLfShort = 0x8001;
+constexpr uint16_t kLfUShort = 0x8002;
+constexpr uint16_t kLfLong = 0x8003;
+constexpr uint16_t kLfULong = 0x8004;
+constexpr uint16_t kLfQuadword = 0x8009;
+constexpr uint16_t kLfUQuadword = 0x800a;
+
+constexpr uint16_t kPropForwardRef = 0x0080;
+constexpr uint16_t kPropHasUniqueName = 0x0200;
+constexpr uint16_t kModifierConst = 0x0001;
+constexpr uint16_t kModifierVolatile = 0x0002;
+
+// Symbols.
+constexpr uint16_t kSPub32 = 0x110e;
+constexpr uint16_t kSLProc32 = 0x110f;
+constexpr uint16_t kSGProc32 = 0x1110;
+constexpr uint16_t kSLProc32Id = 0x1146;
+constexpr uint16_t kSGProc32Id = 0x1147;
+constexpr uint32_t kPubFunction = 0x2;
+
+// C13 debug subsections.
+constexpr uint32_t kDebugSLines = 0xf2;
+constexpr uint32_t kDebugSFileChecksums = 0xf4;
+constexpr uint32_t kDebugSIgnore = 0x80000000u;
+constexpr uint16_t kLinesHaveColumns = 0x0001;
+constexpr uint32_t kLineNumberMask = 0x00ffffff;
+
+struct FieldMember {
+  std::string name;
+  uint32_t type = 0;
+  uint64_t offset = 0;
+};
+
+struct Bitfield {
+  uint32_t type = 0;
+  uint8_t length = 0;
+  uint8_t position = 0;
+};
+
+uint64_t align4(uint64_t value) { return (value + 3) & ~uint64_t{3}; }
+
+bool read_numeric(ByteReader& reader, uint64_t* value) {
+  uint16_t leaf = 0;
+  if (!reader.read_u16(&leaf)) {
+    return false;
+  }
+  if (leaf < kLfNumeric) {
+    *value = leaf;
+    return true;
+  }
+  switch (leaf) {
+    case kLfChar: {
+      uint8_t v = 0;
+      bool ok = reader.read_u8(&v);
+      *value = static_cast<uint64_t>(static_cast<int8_t>(v));
+      return ok;
+    }
+    case kLfShort:
+    case kLfUShort: {
+      uint16_t v = 0;
+      bool ok = reader.read_u16(&v);
+      *value = leaf == kLfShort ? static_cast<uint64_t>(static_cast<int16_t>(v)) : v;
+      return ok;
+    }
+    case kLfLong:
+    case kLfULong: {
+      uint32_t v = 0;
+      bool ok = reader.read_u32(&v);
+      *value = leaf == kLfLong ? static_cast<uint64_t>(static_cast<int32_t>(v)) : v;
+      return ok;
+    }
+    case kLfQuadword:
+    case kLfUQuadword:
+      return reader.read_u64(value);
+    default:
+      return false;
+  }
+}
+
+// Built-in types below 0x1000: the low byte names the type, bits 8-11 the
+// pointer mode.
+bool simple_type(uint32_t index, std::string* name, uint32_t* size) {
+  switch (index & 0xff) {
+    case 0x03: *name = "void"; *size = 0; return true;
+    case 0x08: *name = "HRESULT"; *size = 4; return true;
+    case 0x10: *name = "signed char"; *size = 1; return true;
+    case 0x20: *name = "unsigned char"; *size = 1; return true;
+    case 0x70: *name = "char"; *size = 1; return true;
+    case 0x71: *name = "wchar_t"; *size = 2; return true;
+    case 0x7a: *name = "char16_t"; *size = 2; return true;
+    case 0x7b: *name = "char32_t"; *size = 4; return true;
+    case 0x7c: *name = "char8_t"; *size = 1; return true;
+    case 0x68: *name = "__int8"; *size = 1; return true;
+    case 0x69: *name = "unsigned __int8"; *size = 1; return true;
+    case 0x11:
+    case 0x72: *name = "short"; *size = 2; return true;
+    case 0x21:
+    case 0x73: *name = "unsigned short"; *size = 2; return true;
+    case 0x12: *name = "long"; *size = 4; return true;
+    case 0x22: *name = "unsigned long"; *size = 4; return true;
+    case 0x74: *name = "int"; *size = 4; return true;
+    case 0x75: *name = "unsigned int"; *size = 4; return true;
+    case 0x13:
+    case 0x76: *name = "__int64"; *size = 8; return true;
+    case 0x23:
+    case 0x77: *name = "unsigned __int64"; *size = 8; return true;
+    case 0x14:
+    case 0x78: *name = "__int128"; *size = 16; return true;
+    case 0x24:
+    case 0x79: *name = "unsigned __int128"; *size = 16; return true;
+    case 0x40: *name = "float"; *size = 4; return true;
+    case 0x41: *name = "double"; *size = 8; return true;
+    case 0x42: *name = "long double"; *size = 10; return true;
+    case 0x30: *name = "bool"; *size = 1; return true;
+    case 0x31: *name = "__bool16"; *size = 2; return true;
+    case 0x32: *name = "__bool32"; *size = 4; return true;
+    case 0x33: *name = "__bool64"; *size = 8; return true;
+    default: return false;
+  }
+}
+
+uint32_t simple_pointer_size(uint32_t index) {
+  switch ((index >> 8) & 0x0f) {
+    case 1: return 2;
+    case 2:
+    case 3:
+    case 4: return 4;
+    case 5: return 6;
+    case 6: return 8;
+    case 7: return 16;
+    default: return 0;
+  }
+}
+
+// Skips LF_PAD bytes between field list members.
+void skip_padding(ByteReader& reader) {
+  uint8_t pad = 0;
+  while (reader.read_u8(&pad)) {
+    if (pad < 0xf0) {
+      reader.seek(reader.offset() - 1);
+      return;
+    }
+    reader.seek(reader.offset() - 1 + std::max<uint8_t>(pad & 0x0f, 1));
+  }
+}
+
+void read_field_list(const ByteView& body, std::vector<FieldMember>* members, uint32_t* continuation) {
+  ByteReader reader(body);
+  while (reader.remaining() >= 2) {
+    uint16_t leaf = 0;
+    uint16_t attr = 0;
+    uint32_t type = 0;
+    uint64_t value = 0;
+    std::string name;
+    reader.read_u16(&leaf);
+    bool ok = true;
+    switch (leaf) {
+      case kLfMember:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type) && read_numeric(reader, &value) &&
+             reader.read_cstring(&name);
+        if (ok) {
+          members->push_back(FieldMember{std::move(name), type, value});
+        }
+        break;
+      case kLfEnumerate:
+        ok = reader.read_u16(&attr) && read_numeric(reader, &value) && reader.read_cstring(&name);
+        break;
+      case kLfBClass:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type) && read_numeric(reader, &value);
+        break;
+      case kLfVBClass:
+      case kLfIVBClass:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type) && reader.read_u32(&type) &&
+             read_numeric(reader, &value) && read_numeric(reader, &value);
+        break;
+      case kLfIndex:
+        ok = reader.read_u16(&attr) && reader.read_u32(continuation);
+        break;
+      case kLfVFuncTab:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type);
+        break;
+      case kLfStMember:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type) && reader.read_cstring(&name);
+        break;
+      case kLfMethod:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type) && reader.read_cstring(&name);
+        break;
+      case kLfNestType:
+        ok = reader.read_u16(&attr) && reader.read_u32(&type) && reader.read_cstring(&name);
+        break;
+      case kLfOneMethod: {
+        ok = reader.read_u16(&attr) && reader.read_u32(&type);
+        // Introducing virtual methods carry their vftable offset.
+        const uint16_t method_kind = (attr >> 2) & 0x7;
+        uint32_t vbase_offset = 0;
+        if (ok && (method_kind == 4 || method_kind == 6)) {
+          ok = reader.read_u32(&vbase_offset);
+        }
+        ok = ok && reader.read_cstring(&name);
+        break;
+      }
+      default:
+        // Members past an unknown leaf cannot be located.
+        return;
+    }
+    if (!ok) {
+      return;
+    }
+    skip_padding(reader);
+  }
+}
+
+bool read_udt_name(ByteReader& reader, uint16_t properties, std::string* name, std::string* key) {
+  if (!reader.read_cstring(name)) {
+    return false;
+  }
+  *key = *name;
+  std::string unique;
+  if ((properties & kPropHasUniqueName) != 0 && reader.read_cstring(&unique) && !unique.empty()) {
+    *key = std::move(unique);
+  }
+  return true;
+}
+
+} // namespace
+
+bool PdbTypeStream::parse(const MsfFile& msf, uint32_t stream, std::string* error) {
+  data_ = msf.stream(stream);
+  if (!data_ || data_->size() < kTpiHeaderSize) {
+    data_ = nullptr;
+    if (error) {
+      *error = "missing type stream";
+    }
+    return false;
+  }
+  ByteReader reader(*data_);
+  uint32_t version = 0;
+  uint16_t hash_stream = 0;
+  uint32_t index_offset = 0;
+  uint32_t index_length = 0;
+  reader.read_u32(&version);
+  reader.read_u32(&header_size_);
+  reader.read_u32(&begin_);
+  reader.read_u32(&end_);
+  reader.seek(20);
+  reader.read_u16(&hash_stream);
+  reader.seek(40);
+  reader.read_u32(&index_offset);
+  reader.read_u32(&index_length);
+  if (header_size_ < kTpiHeaderSize || header_size_ > data_->size() || end_ < begin_) {
+    data_ = nullptr;
+    if (error) {
+      *error = "malformed type stream header";
+    }
+    return false;
+  }
+
+  // The hash stream's index-offset buffer is the PDB's own skip list over
+  // the records; reading it touches a few KiB regardless of stream size.
+  const ByteView* hash = msf.stream(hash_stream);
+  ByteView pairs;
+  if (hash && hash->subview(index_offset, index_length, &pairs)) {
+    ByteReader pair_reader(pairs);
+    IndexOffset entry;
+    while (pair_reader.read_u32(&entry.index) && pair_reader.read_u32(&entry.offset)) {
+      if (entry.index >= begin_ && entry.index < end_ && (index_.empty() || entry.index > index_.back().index)) {
+        index_.push_back(entry);
+      }
+    }
+  }
+  if (index_.empty() || index_.front().index != begin_) {
+    index_.insert(index_.begin(), IndexOffset{begin_, 0});
+  }
+  return true;
+}
+
+bool PdbTypeStream::present() const { return data_ != nullptr; }
+uint32_t PdbTypeStream::begin() const { return begin_; }
+uint32_t PdbTypeStream::end() const { return end_; }
+
+bool PdbTypeStream::next_record(ByteReader& reader, uint16_t* kind, ByteView* body) const {
+  uint16_t length = 0;
+  if (!reader.read_u16(&length) || length < 2 || !reader.read_u16(kind)) {
+    return false;
+  }
+  return reader.read_view(length - 2u, body);
+}
+
+void PdbTypeStream::build_full_index() const {
+  std::vector<IndexOffset> index;
+  index.reserve(end_ - begin_);
+  ByteReader reader(*data_);
+  reader.seek(header_size_);
+  for (uint32_t i = begin_; i < end_; ++i) {
+    index.push_back(IndexOffset{i, static_cast<uint32_t>(reader.offset() - header_size_)});
+    uint16_t kind = 0;
+    ByteView body;
+    if (!next_record(reader, &kind, &body)) {
+      break;
+    }
+  }
+  index_ = std::move(index);
+  full_index_ = true;
+}
+
+bool PdbTypeStream::record(uint32_t index, uint16_t* kind, ByteView* body) const {
+  if (!data_ || index < begin_ || index >= end_) {
+    return false;
+  }
+  IndexOffset start;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Without a skip list from the hash stream, index every record once.
+    if (index_.size() == 1 && end_ - begin_ > 1 && !full_index_) {
+      build_full_index();
+    }
+    auto it = std::upper_bound(index_.begin(), index_.end(), index,
+                               [](uint32_t value, const IndexOffset& entry) { return value < entry.index; });
+    start = *(it - 1);
+  }
+  ByteReader reader(*data_);
+  if (!reader.seek(header_size_ + static_cast<uint64_t>(start.offset))) {
+    return false;
+  }
+  for (uint32_t i = start.index; i < index; ++i) {
+    if (!next_record(reader, kind, body)) {
+      return false;
+    }
+  }
+  return next_record(reader, kind, body);
+}
+
+std::unique_ptr<PdbFile> PdbFile::open(const std::string& path, std::string* error) {
+  std::shared_ptr<const ByteSource> source = open_byte_source(path, error);
+  if (!source) {
+    return nullptr;
+  }
+  return open(std::move(source), error);
+}
+
+std::unique_ptr<PdbFile> PdbFile::open(std::shared_ptr<const ByteSource> source, std::string* error) {
+  std::unique_ptr<PdbFile> pdb(new PdbFile());
+  pdb->msf_ = MsfFile::open(std::move(source), error);
+  if (!pdb->msf_ || !pdb->parse_info(error) || !pdb->parse_dbi(error)) {
+    return nullptr;
+  }
+  // Type streams are optional (stripped public PDBs have none).
+  pdb->tpi_.parse(*pdb->msf_, kStreamTpi, nullptr);
+  pdb->ipi_.parse(*pdb->msf_, kStreamIpi, nullptr);
+  return pdb;
+}
+
+bool PdbFile::parse_info(std::string* error) {
+  const ByteView* info = msf_->stream(kStreamInfo);
+  uint32_t version = 0;
+  uint32_t signature = 0;
+  ByteReader reader(info ? *info : ByteView());
+  if (!info || !reader.read_u32(&version) || !reader.read_u32(&signature) || !reader.read_u32(&age_) ||
+      !reader.read_bytes(guid_, sizeof(guid_))) {
+    if (error) {
+      *error = "missing PDB info stream";
+    }
+    return false;
+  }
+
+  // Named stream map: a string buffer followed by a hash table of
+  // (string offset, stream) pairs; only /names is needed.
+  uint32_t strings_size = 0;
+  ByteView strings;
+  uint32_t size = 0;
+  uint32_t capacity = 0;
+  uint32_t present_words = 0;
+  if (!reader.read_u32(&strings_size) || !reader.read_view(strings_size, &strings) || !reader.read_u32(&size) ||
+      !reader.read_u32(&capacity) || !reader.read_u32(&present_words) ||
+      present_words > reader.remaining() / sizeof(uint32_t)) {
+    return true;
+  }
+  std::vector<uint32_t> present(present_words);
+  reader.read_bytes(present.data(), present.size() * sizeof(uint32_t));
+  uint32_t deleted_words = 0;
+  if (!reader.read_u32(&deleted_words) || !reader.skip(deleted_words * 4ull)) {
+    return true;
+  }
+  for (uint32_t bucket = 0; bucket < capacity && bucket / 32 < present.size(); ++bucket) {
+    if ((present[bucket / 32] & (1u << (bucket % 32))) == 0) {
+      continue;
+    }
+    uint32_t key = 0;
+    uint32_t value = 0;
+    if (!reader.read_u32(&key) || !reader.read_u32(&value)) {
+      break;
+    }
+    if (read_string(strings, key) == kNamesStreamName) {
+      names_stream_ = value;
+    }
+  }
+  return true;
+}
+
+bool PdbFile::parse_dbi(std::string* error) {
+  const ByteView* dbi = msf_->stream(kStreamDbi);
+  if (!dbi || dbi->size() < kDbiHeaderSize) {
+    if (error) {
+      *error = "missing PDB DBI stream";
+    }
+    return false;
+  }
+  ByteReader reader(*dbi);
+  uint16_t sym_records = 0;
+  int32_t sizes[7] = {};
+  reader.seek(20);
+  reader.read_u16(&sym_records);
+  symbol_records_stream_ = sym_records;
+  reader.seek(24);
+  for (int32_t& size : sizes) {
+    uint32_t value = 0;
+    reader.read_u32(&value);
+    size = static_cast<int32_t>(value);
+  }
+  const int32_t mod_info_size = sizes[0];
+  const int32_t section_contrib_size = sizes[1];
+  const int32_t section_map_size = sizes[2];
+  const int32_t source_info_size = sizes[3];
+  const int32_t type_server_size = sizes[4];
+  const int32_t optional_dbg_size = sizes[6];
+  uint32_t ec_size = 0;
+  reader.read_u32(&ec_size);
+  for (int32_t size : {mod_info_size, section_contrib_size, section_map_size, source_info_size, type_server_size,
+                       optional_dbg_size}) {
+    if (size < 0) {
+      if (error) {
+        *error = "malformed DBI header";
+      }
+      return false;
+    }
+  }
+
+  ByteView mod_info;
+  if (!dbi->subview(kDbiHeaderSize, static_cast<uint64_t>(mod_info_size), &mod_info)) {
+    if (error) {
+      *error = "truncated DBI module info";
+    }
+    return false;
+  }
+  ByteReader mods(mod_info);
+  while (mods.remaining() >= kModInfoFixedSize) {
+    const uint64_t start = mods.offset();
+    PdbModule module;
+    uint16_t stream = 0;
+    mods.seek(start + 34);
+    mods.read_u16(&stream);
+    mods.read_u32(&module.symbols_size);
+    mods.read_u32(&module.c11_size);
+    mods.read_u32(&module.c13_size);
+    mods.seek(start + kModInfoFixedSize);
+    module.stream = stream;
+    if (!mods.read_cstring(&module.name) || !mods.read_cstring(&module.object_name)) {
+      break;
+    }
+    modules_.push_back(std::move(module));
+    if (!mods.seek(std::min<uint64_t>(align4(mods.offset()), mod_info.size()))) {
+      break;
+    }
+  }
+
+  const uint64_t optional_offset = kDbiHeaderSize + static_cast<uint64_t>(mod_info_size) + section_contrib_size +
+                                   section_map_size + source_info_size + type_server_size + ec_size;
+  ByteView optional;
+  if (dbi->subview(optional_offset, static_cast<uint64_t>(optional_dbg_size), &optional) &&
+      optional.size() >= (kDbgHeaderSectionHdr + 1) * sizeof(uint16_t)) {
+    ByteReader streams(optional);
+    uint16_t section_headers = 0;
+    streams.seek(kDbgHeaderSectionHdr * sizeof(uint16_t));
+    streams.read_u16(&section_headers);
+    section_header_stream_ = section_headers;
+  }
+  if (const ByteView* headers = msf_->stream(section_header_stream_)) {
+    for (uint64_t offset = 0; offset + kSectionHeaderSize <= headers->size(); offset += kSectionHeaderSize) {
+      uint32_t virtual_address = 0;
+      std::memcpy(&virtual_address, headers->data() + offset + 12, sizeof(virtual_address));
+      section_addresses_.push_back(virtual_address);
+    }
+  }
+  return true;
+}
+
+bool PdbFile::matches(const uint8_t guid[16], uint32_t age) const {
+  return std::memcmp(guid_, guid, sizeof(guid_)) == 0 && age_ == age;
+}
+
+uint32_t PdbFile::age() const { return age_; }
+
+void PdbFile::set_image_base(uint64_t image_base) { image_base_ = image_base; }
+
+uint64_t PdbFile::address_of(uint16_t segment, uint32_t offset) const {
+  if (segment == 0 || segment > section_addresses_.size()) {
+    return 0;
+  }
+  return image_base_ + section_addresses_[segment - 1] + offset;
+}
+
+const std::vector<PdbModule>& PdbFile::modules() const { return modules_; }
+const PdbTypeStream& PdbFile::tpi() const { return tpi_; }
+const PdbTypeStream& PdbFile::ipi() const { return ipi_; }
+
+std::string PdbFile::name_at(uint32_t offset) const {
+  const ByteView* names = msf_->stream(names_stream_);
+  uint32_t signature = 0;
+  if (!names || names->size() < kStringTableHeaderSize) {
+    return {};
+  }
+  std::memcpy(&signature, names->data(), sizeof(signature));
+  if (signature != kStringTableSignature) {
+    return {};
+  }
+  return read_string(*names, kStringTableHeaderSize + static_cast<uint64_t>(offset));
+}
+
+bool PdbFile::read_publics(std::vector<PdbSymbol>* out) const {
+  const ByteView* records = msf_->stream(symbol_records_stream_);
+  if (!records) {
+    return false;
+  }
+  ByteReader reader(*records);
+  while (reader.remaining() >= 4) {
+    uint16_t length = 0;
+    uint16_t kind = 0;
+    reader.read_u16(&length);
+    const uint64_t next = reader.offset() + length;
+    if (length < 2 || !reader.read_u16(&kind)) {
+      break;
+    }
+    if (kind == kSPub32) {
+      uint32_t flags = 0;
+      uint32_t offset = 0;
+      uint16_t segment = 0;
+      PdbSymbol symbol;
+      if (reader.read_u32(&flags) && reader.read_u32(&offset) && reader.read_u16(&segment) &&
+          reader.read_cstring(&symbol.name)) {
+        symbol.address = address_of(segment, offset);
+        symbol.function = (flags & kPubFunction) != 0;
+        out->push_back(std::move(symbol));
+      }
+    }
+    if (!reader.seek(next)) {
+      break;
+    }
+  }
+  return true;
+}
+
+void PdbFile::build_public_index() const {
+  const ByteView* records = msf_->stream(symbol_records_stream_);
+  if (!records) {
+    return;
+  }
+  ByteReader reader(*records);
+  while (reader.remaining() >= 4) {
+    const uint64_t start = reader.offset();
+    uint16_t length = 0;
+    uint16_t kind = 0;
+    reader.read_u16(&length);
+    reader.read_u16(&kind);
+    if (length < 2) {
+      break;
+    }
+    if (kind == kSPub32 && reader.skip(10)) {
+      std::string name;
+      if (reader.read_cstring(&name)) {
+        public_offsets_.emplace(std::move(name), static_cast<uint32_t>(start));
+      }
+    }
+    if (!reader.seek(start + 2 + length)) {
+      break;
+    }
+  }
+}
+
+bool PdbFile::find_public(const std::string& name, PdbSymbol* out) const {
+  uint32_t record = 0;
+  {
+    std::lock_guard<std::mutex> lock(publics_mutex_);
+    if (!publics_indexed_) {
+      publics_indexed_ = true;
+      build_public_index();
+    }
+    auto it = public_offsets_.find(name);
+    if (it == public_offsets_.end()) {
+      return false;
+    }
+    record = it->second;
+  }
+  ByteReader reader(*msf_->stream(symbol_records_stream_));
+  uint32_t flags = 0;
+  uint32_t offset = 0;
+  uint16_t segment = 0;
+  if (!reader.seek(record + 4ull) || !reader.read_u32(&flags) || !reader.read_u32(&offset) ||
+      !reader.read_u16(&segment)) {
+    return false;
+  }
+  out->name = name;
+  out->address = address_of(segment, offset);
+  out->function = (flags & kPubFunction) != 0;
+  return true;
+}
+
+uint32_t PdbFile::return_type_of(uint32_t type_index, bool item_id) const {
+  uint16_t kind = 0;
+  ByteView body;
+  if (item_id) {
+    // S_*PROC32_ID symbols name an IPI function id, which names the type.
+    if (!ipi_.record(type_index, &kind, &body) || (kind != kLfFuncId && kind != kLfMFuncId)) {
+      return 0;
+    }
+    ByteReader reader(body);
+    reader.skip(4);
+    if (!reader.read_u32(&type_index)) {
+      return 0;
+    }
+  }
+  if (!tpi_.record(type_index, &kind, &body) || (kind != kLfProcedure && kind != kLfMFunction)) {
+    return 0;
+  }
+  uint32_t return_type = 0;
+  ByteReader reader(body);
+  reader.read_u32(&return_type);
+  return return_type;
+}
+
+bool PdbFile::read_module_functions(size_t module, std::vector<ghirda::core::DebugFunction>* out) const {
+  if (module >= modules_.size()) {
+    return false;
+  }
+  const PdbModule& info = modules_[module];
+  const ByteView* stream = msf_->stream(info.stream);
+  ByteView symbols;
+  if (!stream || !stream->subview(0, info.symbols_size, &symbols)) {
+    return false;
+  }
+  ByteReader reader(symbols);
+  uint32_t signature = 0;
+  if (!reader.read_u32(&signature) || signature != kModuleSignatureC13) {
+    return false;
+  }
+  while (reader.remaining() >= 4) {
+    const uint64_t start = reader.offset();
+    uint16_t length = 0;
+    uint16_t kind = 0;
+    reader.read_u16(&length);
+    reader.read_u16(&kind);
+    if (length < 2) {
+      break;
+    }
+    if (kind == kSGProc32 || kind == kSLProc32 || kind == kSGProc32Id || kind == kSLProc32Id) {
+      uint32_t code_size = 0;
+      uint32_t type_index = 0;
+      uint32_t offset = 0;
+      uint16_t segment = 0;
+      uint8_t flags = 0;
+      ghirda::core::DebugFunction func;
+      // parent, end, next precede the code size; debug start/end follow it.
+      if (reader.skip(12) && reader.read_u32(&code_size) && reader.skip(8) && reader.read_u32(&type_index) &&
+          reader.read_u32(&offset) && reader.read_u16(&segment) && reader.read_u8(&flags) &&
+          reader.read_cstring(&func.name)) {
+        func.low_pc = address_of(segment, offset);
+        func.high_pc = func.low_pc + code_size;
+        func.return_type_ref = return_type_of(type_index, kind == kSGProc32Id || kind == kSLProc32Id);
+        out->push_back(std::move(func));
+      }
+    }
+    if (!reader.seek(start + 2 + length)) {
+      break;
+    }
+  }
+  return true;
+}
+
+bool PdbFile::read_module_lines(size_t module, std::vector<ghirda::core::DebugLineEntry>* out) const {
+  if (module >= modules_.size()) {
+    return false;
+  }
+  const PdbModule& info = modules_[module];
+  const ByteView* stream = msf_->stream(info.stream);
+  ByteView c13;
+  if (!stream ||
+      !stream->subview(static_cast<uint64_t>(info.symbols_size) + info.c11_size, info.c13_size, &c13)) {
+    return false;
+  }
+
+  // Line blocks refer to files by their offset in the checksum subsection,
+  // which may come after them; find it first.
+  ByteView checksums;
+  std::vector<ByteView> line_sections;
+  ByteReader reader(c13);
+  while (reader.remaining() >= 8) {
+    uint32_t kind = 0;
+    uint32_t length = 0;
+    ByteView body;
+    reader.read_u32(&kind);
+    reader.read_u32(&length);
+    if (!reader.read_view(length, &body)) {
+      break;
+    }
+    if ((kind & kDebugSIgnore) == 0) {
+      if (kind == kDebugSFileChecksums) {
+        checksums = body;
+      } else if (kind == kDebugSLines) {
+        line_sections.push_back(body);
+      }
+    }
+    reader.seek(std::min<uint64_t>(align4(reader.offset()), c13.size()));
+  }
+
+  std::unordered_map<uint32_t, std::string> files;
+  auto file_name = [&](uint32_t checksum_offset) -> const std::string& {
+    auto it = files.find(checksum_offset);
+    if (it != files.end()) {
+      return it->second;
+    }
+    uint32_t name_offset = 0;
+    ByteReader entry(checksums);
+    std::string name;
+    if (entry.seek(checksum_offset) && entry.read_u32(&name_offset)) {
+      name = name_at(name_offset);
+    }
+    return files.emplace(checksum_offset, std::move(name)).first->second;
+  };
+
+  for (const ByteView& section : line_sections) {
+    ByteReader lines(section);
+    uint32_t base_offset = 0;
+    uint16_t segment = 0;
+    uint16_t flags = 0;
+    uint32_t code_size = 0;
+    if (!lines.read_u32(&base_offset) || !lines.read_u16(&segment) || !lines.read_u16(&flags) ||
+        !lines.read_u32(&code_size)) {
+      continue;
+    }
+    const uint64_t base = address_of(segment, base_offset);
+    while (lines.remaining() >= 12) {
+      uint32_t file = 0;
+      uint32_t count = 0;
+      uint32_t block_size = 0;
+      const uint64_t block_start = lines.offset();
+      lines.read_u32(&file);
+      lines.read_u32(&count);
+      lines.read_u32(&block_size);
+      if (count > lines.remaining() / 8) {
+        break;
+      }
+      const std::string& name = file_name(file);
+      for (uint32_t i = 0; i < count; ++i) {
+        uint32_t offset = 0;
+        uint32_t line_flags = 0;
+        lines.read_u32(&offset);
+        lines.read_u32(&line_flags);
+        ghirda::core::DebugLineEntry entry;
+        entry.address = base + offset;
+        entry.file = name;
+        entry.line = line_flags & kLineNumberMask;
+        out->push_back(std::move(entry));
+      }
+      const uint64_t next = (flags & kLinesHaveColumns) != 0 ? block_start + block_size : lines.offset();
+      if (next <= block_start || !lines.seek(next)) {
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+bool PdbFile::read_types(std::vector<ghirda::core::DebugType>* out,
+                         std::unordered_map<uint32_t, uint32_t>* forward_refs) const {
+  using ghirda::core::DebugTypeKind;
+  if (!tpi_.present()) {
+    return false;
+  }
+  struct PendingUdt {
+    size_t slot = 0;
+    uint32_t field_list = 0;
+  };
+  std::unordered_map<uint32_t, std::vector<FieldMember>> field_lists;
+  std::unordered_map<uint32_t, uint32_t> continuations;
+  std::unordered_map<uint32_t, Bitfield> bitfields;
+  std::unordered_map<std::string, uint32_t> definitions;
+  std::vector<std::pair<uint32_t, std::string>> forwards;
+  std::vector<PendingUdt> udts;
+  std::unordered_map<uint32_t, size_t> slots;
+  std::unordered_set<uint32_t> simple;
+  auto note = [&](uint64_t index) {
+    if (index != 0 && index < kFirstNonSimpleType) {
+      simple.insert(static_cast<uint32_t>(index));
+    }
+  };
+
+  tpi_.for_each([&](uint32_t index, uint16_t kind, const ByteView& body) {
+    ByteReader reader(body);
+    ghirda::core::DebugType type;
+    type.die_offset = index;
+    uint32_t ref = 0;
+    switch (kind) {
+      case kLfModifier: {
+        uint16_t modifiers = 0;
+        if (!reader.read_u32(&ref) || !reader.read_u16(&modifiers)) {
+          return;
+        }
+        type.kind = (modifiers & kModifierConst) != 0      ? DebugTypeKind::Const
+                    : (modifiers & kModifierVolatile) != 0 ? DebugTypeKind::Volatile
+                                                           : DebugTypeKind::Typedef;
+        type.type_ref = ref;
+        break;
+      }
+      case kLfPointer: {
+        uint32_t attributes = 0;
+        if (!reader.read_u32(&ref) || !reader.read_u32(&attributes)) {
+          return;
+        }
+        type.kind = DebugTypeKind::Pointer;
+        type.type_ref = ref;
+        type.size = (attributes >> 13) & 0x3f;
+        break;
+      }
+      case kLfProcedure:
+      case kLfMFunction:
+        if (!reader.read_u32(&ref)) {
+          return;
+        }
+        type.kind = DebugTypeKind::Subroutine;
+        type.type_ref = ref;
+        break;
+      case kLfArray: {
+        uint32_t index_type = 0;
+        uint64_t size = 0;
+        if (!reader.read_u32(&ref) || !reader.read_u32(&index_type) || !read_numeric(reader, &size)) {
+          return;
+        }
+        type.kind = DebugTypeKind::Array;
+        type.type_ref = ref;
+        type.size = static_cast<uint32_t>(size);
+        break;
+      }
+      case kLfClass:
+      case kLfStructure:
+      case kLfInterface:
+      case kLfUnion:
+      case kLfEnum: {
+        uint16_t count = 0;
+        uint16_t properties = 0;
+        uint32_t fields = 0;
+        uint64_t size = 0;
+        std::string key;
+        bool ok = reader.read_u16(&count) && reader.read_u16(&properties);
+        if (kind == kLfEnum) {
+          ok = ok && reader.read_u32(&ref) && reader.read_u32(&fields);
+        } else {
+          // Classes carry derivation and vshape indices before their size.
+          ok = ok && reader.read_u32(&fields) && (kind == kLfUnion || reader.skip(8)) && read_numeric(reader, &size);
+        }
+        if (!ok || !read_udt_name(reader, properties, &type.name, &key)) {
+          return;
+        }
+        type.kind = kind == kLfEnum    ? DebugTypeKind::Enumeration
+                    : kind == kLfUnion ? DebugTypeKind::Union
+                                       : DebugTypeKind::Struct;
+        type.type_ref = ref;
+        type.size = static_cast<uint32_t>(size);
+        if ((properties & kPropForwardRef) != 0) {
+          forwards.emplace_back(index, std::move(key));
+        } else {
+          definitions.emplace(std::move(key), index);
+          if (kind != kLfEnum) {
+            udts.push_back(PendingUdt{out->size(), fields});
+          }
+        }
+        break;
+      }
+      case kLfFieldList: {
+        uint32_t continuation = 0;
+        read_field_list(body, &field_lists[index], &continuation);
+        if (continuation != 0) {
+          continuations.emplace(index, continuation);
+        }
+        return;
+      }
+      case kLfBitfield: {
+        Bitfield bitfield;
+        if (reader.read_u32(&bitfield.type) && reader.read_u8(&bitfield.length) &&
+            reader.read_u8(&bitfield.position)) {
+          bitfields.emplace(index, bitfield);
+        }
+        return;
+      }
+      default:
+        return;
+    }
+    note(type.type_ref);
+    slots.emplace(index, out->size());
+    out->push_back(std::move(type));
+  });
+
+  for (const PendingUdt& udt : udts) {
+    auto& members = (*out)[udt.slot].members;
+    // Long field lists are chained through LF_INDEX; bound the walk in case
+    // the chain loops.
+    uint32_t list = udt.field_list;
+    for (size_t hops = 0; list != 0 && hops < field_lists.size(); ++hops) {
+      auto fields = field_lists.find(list);
+      if (fields == field_lists.end()) {
+        break;
+      }
+      for (const FieldMember& field : fields->second) {
+        ghirda::core::DebugMember member;
+        member.name = field.name;
+        member.type_ref = field.type;
+        member.offset = field.offset;
+        auto bitfield = bitfields.find(field.type);
+        if (bitfield != bitfields.end()) {
+          member.type_ref = bitfield->second.type;
+          member.bit_size = bitfield->second.length;
+          member.bit_offset = static_cast<int32_t>(field.offset * 8 + bitfield->second.position);
+        }
+        note(member.type_ref);
+        members.push_back(std::move(member));
+      }
+      auto next = continuations.find(list);
+      list = next == continuations.end() ? 0 : next->second;
+    }
+  }
+
+  // Forward references stand in for definitions elsewhere in the stream;
+  // point every use at the definition and drop the stub. Undefined ones stay
+  // as empty records, like DWARF declarations.
+  std::unordered_map<uint32_t, uint32_t> redirect;
+  std::unordered_set<size_t> dropped;
+  for (const auto& [index, key] : forwards) {
+    auto definition = definitions.find(key);
+    if (definition != definitions.end()) {
+      redirect.emplace(index, definition->second);
+      dropped.insert(slots[index]);
+    }
+  }
+  auto target = [&](uint64_t ref) -> uint64_t {
+    auto it = redirect.find(static_cast<uint32_t>(ref));
+    return it == redirect.end() ? ref : it->second;
+  };
+  for (auto& type : *out) {
+    type.type_ref = target(type.type_ref);
+    for (auto& member : type.members) {
+      member.type_ref = target(member.type_ref);
+    }
+  }
+
+  // Built-in types are implied by their index; materialize the ones in use,
+  // pointer modes included.
+  std::vector<uint32_t> builtins(simple.begin(), simple.end());
+  for (uint32_t index : simple) {
+    if ((index & 0xf00) != 0 && simple.count(index & 0xff) == 0) {
+      builtins.push_back(index & 0xff);
+    }
+  }
+  std::sort(builtins.begin(), builtins.end());
+  builtins.erase(std::unique(builtins.begin(), builtins.end()), builtins.end());
+  for (uint32_t index : builtins) {
+    ghirda::core::DebugType type;
+    uint32_t size = 0;
+    if (!simple_type(index, &type.name, &size)) {
+      continue;
+    }
+    type.die_offset = index;
+    if ((index & 0xf00) != 0) {
+      type.kind = DebugTypeKind::Pointer;
+      type.name.clear();
+      type.type_ref = index & 0xff;
+      type.size = simple_pointer_size(index);
+    } else {
+      type.kind = DebugTypeKind::Base;
+      type.size = size;
+    }
+    slots.emplace(index, out->size());
+    out->push_back(std::move(type));
+  }
+
+  // Array lengths and enum sizes are implied by their element and underlying
+  // types.
+  auto size_of = [&](uint64_t index) -> uint32_t {
+    for (int depth = 0; depth < 16; ++depth) {
+      auto slot = slots.find(static_cast<uint32_t>(index));
+      if (slot == slots.end()) {
+        return 0;
+      }
+      const auto& type = (*out)[slot->second];
+      if (type.size != 0 || (type.kind != DebugTypeKind::Const && type.kind != DebugTypeKind::Volatile &&
+                             type.kind != DebugTypeKind::Typedef && type.kind != DebugTypeKind::Enumeration)) {
+        return type.size;
+      }
+      index = type.type_ref;
+    }
+    return 0;
+  };
+  for (auto& [index, slot] : slots) {
+    auto& type = (*out)[slot];
+    if (type.kind == DebugTypeKind::Array) {
+      const uint32_t element = size_of(type.type_ref);
+      type.array_count = element != 0 ? type.size / element : 0;
+    } else if (type.kind == DebugTypeKind::Enumeration && type.size == 0) {
+      type.size = size_of(type.type_ref);
+    }
+  }
+
+  if (!dropped.empty()) {
+    size_t slot = 0;
+    out->erase(std::remove_if(out->begin(), out->end(),
+                              [&](const ghirda::core::DebugType&) { return dropped.count(slot++) != 0; }),
+               out->end());
+  }
+  if (forward_refs) {
+    forward_refs->insert(redirect.begin(), redirect.end());
+  }
+  return true;
+}
+
+bool ingest_pdb(const PdbFile& pdb, ghirda::core::Program* program, const PdbIngestOptions& options,
+                std::string* error) {
+  if (!program) {
+    if (error) {
+      *error = "program output is null";
+    }
+    return false;
+  }
+  ghirda::core::DebugInfo& debug_info = program->debug_info();
+
+  if (options.publics) {
+    std::vector<PdbSymbol> publics;
+    pdb.read_publics(&publics);
+    for (auto& pub : publics) {
+      if (pub.address == 0) {
+        continue;
+      }
+      ghirda::core::Symbol sym;
+      sym.name = std::move(pub.name);
+      sym.address = pub.address;
+      sym.kind = pub.function ? ghirda::core::SymbolKind::Function : ghirda::core::SymbolKind::Data;
+      program->add_symbol(sym);
+    }
+  }
+
+  std::unordered_map<uint32_t, uint32_t> forward_refs;
+  const size_t first_type = debug_info.types.size();
+  if (options.types) {
+    pdb.read_types(&debug_info.types, &forward_refs);
+  }
+
+  for (size_t module = 0; module < pdb.modules().size(); ++module) {
+    if (options.functions) {
+      const size_t first = debug_info.functions.size();
+      pdb.read_module_functions(module, &debug_info.functions);
+      for (size_t i = first; i < debug_info.functions.size(); ++i) {
+        auto it = forward_refs.find(static_cast<uint32_t>(debug_info.functions[i].return_type_ref));
+        if (it != forward_refs.end()) {
+          debug_info.functions[i].return_type_ref = it->second;
+        }
+      }
+    }
+    if (options.lines) {
+      pdb.read_module_lines(module, &debug_info.lines);
+    }
+  }
+
+  // Type indices share the resolver with DWARF DIE offsets; the two never mix
+  // in one image.
+  if (debug_info.types.size() > first_type) {
+    DwarfTypeResolver resolver(debug_info);
+    resolver.resolve();
+    resolver.emit(&program->types());
+  }
+  return true;
+}
+
+} // namespace ghirda::loader
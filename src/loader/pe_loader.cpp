@@ -2,14 +2,17 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <fstream>
+#include <cstring>
+#include <filesystem>
 #include <string>
 #include <vector>
 
 #include "ghirda/core/address_space.h"
 #include "ghirda/core/memory_map.h"
 #include "ghirda/core/relocation.h"
+#include "ghirda/loader/relocation_batch.h"
 
 namespace ghirda::loader {
 namespace {
@@ -169,6 +172,23 @@ struct DebugDirectory {
   uint32_t address_of_raw_data;
   uint32_t pointer_to_raw_data;
 };
+
+struct DelayImportDescriptor {
+  uint32_t attributes;
+  uint32_t dll_name;
+  uint32_t module_handle;
+  uint32_t import_address_table;
+  uint32_t import_name_table;
+  uint32_t bound_import_address_table;
+  uint32_t unload_information_table;
+  uint32_t time_date_stamp;
+};
+
+struct RuntimeFunctionX64 {
+  uint32_t begin_address;
+  uint32_t end_address;
+  uint32_t unwind_info;
+};
 #pragma pack(pop)
 
 constexpr uint16_t kDosMagic = 0x5a4d;
@@ -178,112 +198,244 @@ constexpr uint16_t kOptMagic64 = 0x20b;
 
 constexpr uint32_t kDirExport = 0;
 constexpr uint32_t kDirImport = 1;
+constexpr uint32_t kDirException = 3;
 constexpr uint32_t kDirReloc = 5;
 constexpr uint32_t kDirDebug = 6;
-
+constexpr uint32_t kDirTls = 9;
+constexpr uint32_t kDirDelayImport = 13;
+
+constexpr uint16_t kMachineI386 = 0x14c;
+constexpr uint16_t kMachineArmNt = 0x1c4;
+constexpr uint16_t kMachineAmd64 = 0x8664;
+constexpr uint16_t kMachineArm64 = 0xaa64;
+constexpr uint32_t kScnCntCode = 0x20;
+constexpr uint32_t kScnMemExecute = 0x20000000u;
+constexpr uint32_t kDelayRvaBased = 0x1;
+constexpr uint8_t kUnwindChainInfo = 0x4;
+
+constexpr uint32_t kRelocAbsolute = 0;
 constexpr uint32_t kRelocHighLow = 3;
 constexpr uint32_t kRelocDir64 = 10;
 
 constexpr uint32_t kDebugTypeCodeView = 2;
 
-bool read_exact(std::ifstream& in, void* data, size_t size) {
-  in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
-  return in.good();
-}
-
-bool read_blob(std::ifstream& in, uint32_t file_offset, uint32_t size, std::vector<uint8_t>* out) {
-  out->assign(size, 0);
-  in.seekg(static_cast<std::streamoff>(file_offset), std::ios::beg);
-  if (!in) {
+template <typename T>
+bool read_table(const ByteSource& source, uint64_t offset, size_t count, std::vector<T>* out) {
+  out->resize(count);
+  if (count == 0) {
+    return true;
+  }
+  if (count > source.size() / sizeof(T) || !source.read(offset, out->data(), count * sizeof(T))) {
+    out->clear();
     return false;
   }
-  in.read(reinterpret_cast<char*>(out->data()), static_cast<std::streamsize>(size));
-  return in.good();
+  return true;
 }
 
-uint32_t rva_to_file_offset(uint32_t rva, uint32_t headers_size, const std::vector<SectionHeader>& sections) {
-  if (rva < headers_size) {
-    return rva;
+// Resolves RVAs against the section table. Each section's raw data is viewed
+// once and table walks slice that view, instead of searching the section
+// list and going back to the file for every entry.
+class ImageView {
+public:
+  ImageView(const ByteSource& source, uint32_t headers_size, const std::vector<SectionHeader>& sections)
+      : source_(source), headers_size_(headers_size), sections_(sections), views_(sections.size() + 1),
+        loaded_(sections.size() + 1, false) {}
+
+  // Bytes from rva to the end of the containing section's raw data.
+  bool at(uint32_t rva, ByteView* out) const {
+    uint32_t base = 0;
+    const ByteView* view = region(rva, &base);
+    return view && rva - base < view->size() && view->subview(rva - base, view->size() - (rva - base), out);
   }
-  for (const auto& sec : sections) {
-    uint32_t start = sec.virtual_address;
-    uint32_t end = sec.virtual_address + std::max(sec.virtual_size, sec.size_of_raw_data);
-    if (rva >= start && rva < end) {
-      return sec.pointer_to_raw_data + (rva - sec.virtual_address);
+
+  bool at(uint32_t rva, uint64_t size, ByteView* out) const {
+    uint32_t base = 0;
+    const ByteView* view = region(rva, &base);
+    return view && view->subview(rva - base, size, out);
+  }
+
+  bool cstring(uint32_t rva, std::string* out) const {
+    ByteView view;
+    return at(rva, &view) && ByteReader(view).read_cstring(out);
+  }
+
+  bool executable(uint32_t rva) const {
+    const size_t index = find(rva);
+    return index < sections_.size() && (sections_[index].characteristics & kScnMemExecute) != 0;
+  }
+
+private:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  // Section index, sections_.size() for the headers, kNone if unmapped.
+  size_t find(uint32_t rva) const {
+    if (rva < headers_size_) {
+      return sections_.size();
+    }
+    // Lookups cluster (a table and the strings it names), so try the last
+    // hit first.
+    for (size_t n = 0; n < sections_.size(); ++n) {
+      const size_t i = (last_ + n) % sections_.size();
+      const SectionHeader& sec = sections_[i];
+      if (rva >= sec.virtual_address &&
+          rva - sec.virtual_address < std::max(sec.virtual_size, sec.size_of_raw_data)) {
+        last_ = i;
+        return i;
+      }
     }
+    return kNone;
   }
-  return 0;
-}
 
-std::string read_string_at(std::ifstream& in, uint32_t file_offset) {
-  in.seekg(static_cast<std::streamoff>(file_offset), std::ios::beg);
-  if (!in) {
-    return {};
+  const ByteView* region(uint32_t rva, uint32_t* base) const {
+    const size_t index = find(rva);
+    if (index == kNone) {
+      return nullptr;
+    }
+    const bool headers = index == sections_.size();
+    if (!loaded_[index]) {
+      loaded_[index] = true;
+      const uint64_t offset = headers ? 0 : sections_[index].pointer_to_raw_data;
+      const uint64_t size = headers ? headers_size_ : sections_[index].size_of_raw_data;
+      if (offset < source_.size()) {
+        source_.view(offset, std::min<uint64_t>(size, source_.size() - offset), &views_[index]);
+      }
+    }
+    *base = headers ? 0 : sections_[index].virtual_address;
+    return &views_[index];
   }
-  std::string out;
-  char ch = 0;
-  while (in.get(ch)) {
-    if (ch == '\0') {
-      break;
+
+  const ByteSource& source_;
+  uint32_t headers_size_ = 0;
+  const std::vector<SectionHeader>& sections_;
+  mutable std::vector<ByteView> views_;
+  mutable std::vector<bool> loaded_;
+  mutable size_t last_ = 0;
+};
+
+ghirda::core::Processor to_processor(uint16_t machine) {
+  switch (machine) {
+    case kMachineI386:
+      return ghirda::core::Processor::X86;
+    case kMachineArmNt:
+      return ghirda::core::Processor::Arm;
+    case kMachineAmd64:
+      return ghirda::core::Processor::X86_64;
+    case kMachineArm64:
+      return ghirda::core::Processor::Aarch64;
+    default:
+      return ghirda::core::Processor::Unknown;
+  }
+}
+
+// Function bounds from the exception directory (.pdata). x64 and ARM64
+// tables are understood; records that only continue another function's
+// unwind information (chained or fragment entries) are not starts.
+template <typename AddStart>
+void add_exception_table(const ImageView& image, uint16_t machine, const ByteView& pdata, AddStart&& add_start) {
+  ByteReader reader(pdata);
+  if (machine == kMachineAmd64) {
+    RuntimeFunctionX64 entry{};
+    while (reader.read_bytes(&entry, sizeof(entry)) && entry.begin_address != 0) {
+      // An odd unwind RVA is the older encoding of a chained entry.
+      ByteView unwind;
+      if ((entry.unwind_info & 1) != 0 || entry.end_address <= entry.begin_address ||
+          !image.at(entry.unwind_info, 1, &unwind) || ((unwind[0] >> 3) & kUnwindChainInfo) != 0) {
+        continue;
+      }
+      add_start(entry.begin_address, entry.end_address - entry.begin_address,
+                ghirda::core::Program::FunctionStartSource::ExceptionTable);
+    }
+  } else if (machine == kMachineArm64) {
+    uint32_t begin = 0;
+    uint32_t unwind = 0;
+    while (reader.read_u32(&begin) && reader.read_u32(&unwind) && begin != 0) {
+      uint64_t length = 0;
+      switch (unwind & 3) {
+        case 0: {
+          // .xdata header: function length in words in the low 18 bits.
+          ByteView xdata;
+          uint32_t header = 0;
+          if (image.at(unwind, sizeof(header), &xdata) && ByteReader(xdata).read_u32(&header)) {
+            length = (header & 0x3ffffu) * 4ull;
+          }
+          break;
+        }
+        case 1:
+          length = ((unwind >> 2) & 0x7ffu) * 4ull;
+          break;
+        default:
+          // Packed fragment or reserved.
+          continue;
+      }
+      add_start(begin, length, ghirda::core::Program::FunctionStartSource::ExceptionTable);
     }
-    out.push_back(ch);
   }
-  return out;
 }
 
 } // namespace
 
-bool PeLoader::load(const std::string& path, ghirda::core::Program* program, std::string* error) {
-  if (!program) {
-    if (error) {
-      *error = "program output is null";
-    }
-    return false;
+uint32_t PeLoader::probe(std::span<const uint8_t> header) const {
+  ByteReader reader(ByteView(header.data(), header.size()));
+  uint16_t magic = 0;
+  uint32_t nt_offset = 0;
+  if (!reader.read_u16(&magic) || magic != kDosMagic || !reader.seek(offsetof(DosHeader, e_lfanew)) ||
+      !reader.read_u32(&nt_offset)) {
+    return 0;
+  }
+  uint32_t signature = 0;
+  if (!reader.seek(nt_offset) || !reader.read_u32(&signature)) {
+    // NT headers past the probe window: likely PE, confirmed by load().
+    return 40;
   }
+  // Plain DOS executables have no NT headers.
+  return signature == kNtSignature ? 100 : 0;
+}
 
-  std::ifstream in(path, std::ios::binary);
-  if (!in) {
+bool PeLoader::load(const ByteSource& source, ghirda::core::Program* program, std::string* error) {
+  if (!program) {
     if (error) {
-      *error = "failed to open file";
+      *error = "program output is null";
     }
     return false;
   }
 
   DosHeader dos{};
-  if (!read_exact(in, &dos, sizeof(dos)) || dos.e_magic != kDosMagic) {
+  if (!source.read(0, &dos, sizeof(dos)) || dos.e_magic != kDosMagic) {
     if (error) {
       *error = "invalid DOS header";
     }
     return false;
   }
 
-  in.seekg(static_cast<std::streamoff>(dos.e_lfanew), std::ios::beg);
+  uint64_t cursor_offset = dos.e_lfanew;
   uint32_t signature = 0;
-  if (!read_exact(in, &signature, sizeof(signature)) || signature != kNtSignature) {
+  if (!source.read(cursor_offset, &signature, sizeof(signature)) || signature != kNtSignature) {
     if (error) {
       *error = "invalid NT signature";
     }
     return false;
   }
 
+  cursor_offset += sizeof(signature);
+
   FileHeader file_header{};
-  if (!read_exact(in, &file_header, sizeof(file_header))) {
+  if (!source.read(cursor_offset, &file_header, sizeof(file_header))) {
     if (error) {
       *error = "failed to read file header";
     }
     return false;
   }
 
-  std::vector<uint8_t> optional_raw(file_header.size_of_optional_header);
-  if (!optional_raw.empty()) {
-    in.read(reinterpret_cast<char*>(optional_raw.data()), file_header.size_of_optional_header);
-    if (!in) {
-      if (error) {
-        *error = "failed to read optional header";
-      }
-      return false;
+  cursor_offset += sizeof(file_header);
+
+  std::vector<uint8_t> optional_raw;
+  if (!source.read_blob(cursor_offset, file_header.size_of_optional_header, &optional_raw)) {
+    if (error) {
+      *error = "failed to read optional header";
     }
+    return false;
   }
+  cursor_offset += file_header.size_of_optional_header;
 
   bool is_pe32 = false;
   uint64_t image_base = 0;
@@ -291,20 +443,23 @@ bool PeLoader::load(const std::string& path, ghirda::core::Program* program, std
   uint32_t headers_size = 0;
   DataDirectory dirs[16] = {};
   if (optional_raw.size() >= sizeof(uint16_t)) {
-    uint16_t magic = *reinterpret_cast<uint16_t*>(optional_raw.data());
+    uint16_t magic = 0;
+    std::memcpy(&magic, optional_raw.data(), sizeof(magic));
     if (magic == kOptMagic32 && optional_raw.size() >= sizeof(OptionalHeader32)) {
-      const auto* opt = reinterpret_cast<const OptionalHeader32*>(optional_raw.data());
+      OptionalHeader32 opt{};
+      std::memcpy(&opt, optional_raw.data(), sizeof(opt));
       is_pe32 = true;
-      image_base = opt->image_base;
-      entry_point = opt->address_of_entry_point;
-      headers_size = opt->size_of_headers;
-      std::copy(std::begin(opt->data_directory), std::end(opt->data_directory), dirs);
+      image_base = opt.image_base;
+      entry_point = opt.address_of_entry_point;
+      headers_size = opt.size_of_headers;
+      std::copy(std::begin(opt.data_directory), std::end(opt.data_directory), dirs);
     } else if (magic == kOptMagic64 && optional_raw.size() >= sizeof(OptionalHeader64)) {
-      const auto* opt = reinterpret_cast<const OptionalHeader64*>(optional_raw.data());
-      image_base = opt->image_base;
-      entry_point = opt->address_of_entry_point;
-      headers_size = opt->size_of_headers;
-      std::copy(std::begin(opt->data_directory), std::end(opt->data_directory), dirs);
+      OptionalHeader64 opt{};
+      std::memcpy(&opt, optional_raw.data(), sizeof(opt));
+      image_base = opt.image_base;
+      entry_point = opt.address_of_entry_point;
+      headers_size = opt.size_of_headers;
+      std::copy(std::begin(opt.data_directory), std::end(opt.data_directory), dirs);
     } else {
       if (error) {
         *error = "unsupported optional header";
@@ -313,14 +468,12 @@ bool PeLoader::load(const std::string& path, ghirda::core::Program* program, std
     }
   }
 
-  std::vector<SectionHeader> sections(file_header.number_of_sections);
-  for (uint16_t i = 0; i < file_header.number_of_sections; ++i) {
-    if (!read_exact(in, &sections[i], sizeof(SectionHeader))) {
-      if (error) {
-        *error = "failed to read section headers";
-      }
-      return false;
+  std::vector<SectionHeader> sections;
+  if (!read_table(source, cursor_offset, file_header.number_of_sections, &sections)) {
+    if (error) {
+      *error = "failed to read section headers";
     }
+    return false;
   }
 
   uint64_t min_vaddr = UINT64_MAX;
@@ -334,6 +487,7 @@ bool PeLoader::load(const std::string& path, ghirda::core::Program* program, std
     s.size = sec.virtual_size;
     s.file_offset = sec.pointer_to_raw_data;
     s.flags = sec.characteristics;
+    s.executable = (sec.characteristics & (kScnCntCode | kScnMemExecute)) != 0;
     if (!s.name.empty()) {
       program->add_section(s);
     }
@@ -358,7 +512,7 @@ bool PeLoader::load(const std::string& path, ghirda::core::Program* program, std
 
     if (sec.size_of_raw_data != 0) {
       std::vector<uint8_t> bytes;
-      if (!read_blob(in, sec.pointer_to_raw_data, sec.size_of_raw_data, &bytes)) {
+      if (!source.read_blob(sec.pointer_to_raw_data, sec.size_of_raw_data, &bytes)) {
         if (error) {
           *error = "failed to read section data";
         }
@@ -376,183 +530,280 @@ bool PeLoader::load(const std::string& path, ghirda::core::Program* program, std
     program->add_address_space(ghirda::core::AddressSpace("image", min_vaddr, max_vaddr - min_vaddr));
   }
   program->set_load_bias(image_base);
+  program->set_processor(to_processor(file_header.machine));
 
-  if (dirs[kDirExport].virtual_address != 0) {
-    uint32_t export_offset = rva_to_file_offset(dirs[kDirExport].virtual_address, headers_size, sections);
-    if (export_offset != 0) {
-      ExportDirectory exp{};
-      in.seekg(static_cast<std::streamoff>(export_offset), std::ios::beg);
-      if (read_exact(in, &exp, sizeof(exp))) {
-        uint32_t names_offset = rva_to_file_offset(exp.address_of_names, headers_size, sections);
-        uint32_t ord_offset = rva_to_file_offset(exp.address_of_name_ordinals, headers_size, sections);
-        uint32_t func_offset = rva_to_file_offset(exp.address_of_functions, headers_size, sections);
-        if (names_offset && ord_offset && func_offset) {
-          std::vector<uint32_t> name_rvas(exp.number_of_names);
-          in.seekg(static_cast<std::streamoff>(names_offset), std::ios::beg);
-          in.read(reinterpret_cast<char*>(name_rvas.data()), exp.number_of_names * sizeof(uint32_t));
-          std::vector<uint16_t> ordinals(exp.number_of_names);
-          in.seekg(static_cast<std::streamoff>(ord_offset), std::ios::beg);
-          in.read(reinterpret_cast<char*>(ordinals.data()), exp.number_of_names * sizeof(uint16_t));
-          std::vector<uint32_t> funcs(exp.number_of_functions);
-          in.seekg(static_cast<std::streamoff>(func_offset), std::ios::beg);
-          in.read(reinterpret_cast<char*>(funcs.data()), exp.number_of_functions * sizeof(uint32_t));
-
-          for (size_t i = 0; i < name_rvas.size(); ++i) {
-            uint32_t name_offset = rva_to_file_offset(name_rvas[i], headers_size, sections);
-            std::string name = read_string_at(in, name_offset);
-            if (name.empty()) {
-              continue;
-            }
-            uint16_t ord = ordinals[i];
-            if (ord >= funcs.size()) {
-              continue;
-            }
-            ghirda::core::Symbol sym{};
-            sym.name = name;
-            sym.address = image_base + funcs[ord];
-            sym.kind = ghirda::core::SymbolKind::Function;
-            program->add_symbol(sym);
-          }
-        }
-      }
+  const ImageView image(source, headers_size, sections);
+  const uint32_t pointer_size = is_pe32 ? 4 : 8;
+  auto read_pointer = [&](ByteReader& reader, uint64_t* value) {
+    if (!is_pe32) {
+      return reader.read_u64(value);
+    }
+    uint32_t value32 = 0;
+    if (!reader.read_u32(&value32)) {
+      return false;
     }
+    *value = value32;
+    return true;
+  };
+  auto add_function_start = [&](uint32_t rva, uint64_t size, ghirda::core::Program::FunctionStartSource from) {
+    ghirda::core::Program::FunctionStart start{};
+    start.address = image_base + rva;
+    start.size = size;
+    start.source = from;
+    program->add_function_start(start);
+  };
+
+  if (entry_point != 0) {
+    add_function_start(entry_point, 0, ghirda::core::Program::FunctionStartSource::EntryPoint);
   }
 
-  if (dirs[kDirImport].virtual_address != 0) {
-    uint32_t imp_offset = rva_to_file_offset(dirs[kDirImport].virtual_address, headers_size, sections);
-    if (imp_offset != 0) {
-      in.seekg(static_cast<std::streamoff>(imp_offset), std::ios::beg);
-      while (true) {
-        ImportDescriptor desc{};
-        if (!read_exact(in, &desc, sizeof(desc))) {
-          break;
-        }
-        std::streamoff next_desc = in.tellg();
-        if (desc.name == 0) {
-          break;
-        }
-        std::string dll = read_string_at(in, rva_to_file_offset(desc.name, headers_size, sections));
-        uint32_t thunk_rva = desc.original_first_thunk ? desc.original_first_thunk : desc.first_thunk;
-        uint32_t thunk_offset = rva_to_file_offset(thunk_rva, headers_size, sections);
-        if (thunk_offset == 0) {
-          in.seekg(next_desc, std::ios::beg);
-          continue;
-        }
-        in.seekg(static_cast<std::streamoff>(thunk_offset), std::ios::beg);
-        while (true) {
-          uint64_t thunk = 0;
-          if (is_pe32) {
-            uint32_t t32 = 0;
-            if (!read_exact(in, &t32, sizeof(t32))) {
-              break;
-            }
-            thunk = t32;
-          } else {
-            if (!read_exact(in, &thunk, sizeof(thunk))) {
-              break;
-            }
-          }
-          if (thunk == 0) {
+  if (dirs[kDirExport].virtual_address != 0) {
+    ByteView export_view;
+    ExportDirectory exp{};
+    if (image.at(dirs[kDirExport].virtual_address, &export_view) &&
+        ByteReader(export_view).read_bytes(&exp, sizeof(exp))) {
+      ByteView names_view;
+      ByteView ords_view;
+      ByteView funcs_view;
+      if (image.at(exp.address_of_names, &names_view) && image.at(exp.address_of_name_ordinals, &ords_view) &&
+          image.at(exp.address_of_functions, &funcs_view)) {
+        ByteReader names(names_view);
+        ByteReader ords(ords_view);
+        ByteReader funcs(funcs_view);
+        const uint32_t export_begin = dirs[kDirExport].virtual_address;
+        const uint32_t export_end = export_begin + dirs[kDirExport].size;
+        for (uint32_t i = 0; i < exp.number_of_names; ++i) {
+          uint32_t name_rva = 0;
+          uint16_t ord = 0;
+          if (!names.read_u32(&name_rva) || !ords.read_u16(&ord)) {
             break;
           }
-          if ((thunk & (is_pe32 ? 0x80000000u : 0x8000000000000000ull)) != 0) {
+          uint32_t func_rva = 0;
+          if (ord >= exp.number_of_functions || !funcs.seek(static_cast<uint64_t>(ord) * sizeof(uint32_t)) ||
+              !funcs.read_u32(&func_rva)) {
             continue;
           }
-          uint32_t hint_name_rva = static_cast<uint32_t>(thunk);
-          uint32_t hint_name_offset = rva_to_file_offset(hint_name_rva, headers_size, sections);
-          if (hint_name_offset == 0) {
+          std::string name;
+          if (!image.cstring(name_rva, &name) || name.empty()) {
             continue;
           }
-          in.seekg(static_cast<std::streamoff>(hint_name_offset + 2), std::ios::beg);
-          std::string func = read_string_at(in, hint_name_offset + 2);
-          if (!func.empty()) {
-            ghirda::core::Symbol sym{};
-            sym.name = dll + "!" + func;
-            sym.address = image_base + thunk_rva;
+          ghirda::core::Symbol sym{};
+          sym.name = name;
+          sym.address = image_base + func_rva;
+          // Forwarders point at a "dll.name" string inside the export
+          // directory; the code lives in the other module.
+          if (func_rva >= export_begin && func_rva < export_end) {
             sym.kind = ghirda::core::SymbolKind::External;
-            program->add_symbol(sym);
+          } else if (image.executable(func_rva)) {
+            sym.kind = ghirda::core::SymbolKind::Function;
+            add_function_start(func_rva, 0, ghirda::core::Program::FunctionStartSource::Export);
+          } else {
+            sym.kind = ghirda::core::SymbolKind::Data;
           }
+          program->add_symbol(sym);
         }
-        in.seekg(next_desc, std::ios::beg);
       }
     }
   }
 
+  // Names each IAT slot dll!name, or dll!#ordinal for imports by ordinal.
+  const uint64_t ordinal_flag = is_pe32 ? 0x80000000ull : 0x8000000000000000ull;
+  auto add_imports = [&](const std::string& dll, uint32_t names_rva, uint32_t iat_rva) {
+    ByteView thunk_view;
+    if (!image.at(names_rva, &thunk_view)) {
+      return;
+    }
+    ByteReader thunks(thunk_view);
+    uint64_t thunk = 0;
+    for (uint64_t slot = iat_rva; read_pointer(thunks, &thunk) && thunk != 0; slot += pointer_size) {
+      std::string func;
+      if ((thunk & ordinal_flag) != 0) {
+        func = "#" + std::to_string(thunk & 0xffff);
+      } else if (!image.cstring(static_cast<uint32_t>(thunk) + sizeof(uint16_t), &func) || func.empty()) {
+        continue;
+      }
+      ghirda::core::Symbol sym{};
+      sym.name = dll + "!" + func;
+      sym.address = image_base + slot;
+      sym.kind = ghirda::core::SymbolKind::External;
+      program->add_symbol(sym);
+    }
+  };
+
+  if (dirs[kDirImport].virtual_address != 0) {
+    ByteView import_view;
+    if (image.at(dirs[kDirImport].virtual_address, &import_view)) {
+      ByteReader descriptors(import_view);
+      ImportDescriptor desc{};
+      while (descriptors.read_bytes(&desc, sizeof(desc)) && desc.name != 0) {
+        std::string dll;
+        image.cstring(desc.name, &dll);
+        add_imports(dll, desc.original_first_thunk ? desc.original_first_thunk : desc.first_thunk, desc.first_thunk);
+      }
+    }
+  }
+
+  if (dirs[kDirDelayImport].virtual_address != 0) {
+    ByteView delay_view;
+    if (image.at(dirs[kDirDelayImport].virtual_address, &delay_view)) {
+      ByteReader descriptors(delay_view);
+      DelayImportDescriptor desc{};
+      while (descriptors.read_bytes(&desc, sizeof(desc)) && desc.dll_name != 0) {
+        // Pre-VC7 descriptors hold VAs rather than RVAs.
+        const uint32_t bias = (desc.attributes & kDelayRvaBased) != 0 ? 0 : static_cast<uint32_t>(image_base);
+        std::string dll;
+        image.cstring(desc.dll_name - bias, &dll);
+        add_imports(dll, desc.import_name_table - bias, desc.import_address_table - bias);
+      }
+    }
+  }
+
+  if (dirs[kDirTls].virtual_address != 0) {
+    ByteView tls_view;
+    uint64_t callbacks_va = 0;
+    if (image.at(dirs[kDirTls].virtual_address, &tls_view)) {
+      // AddressOfCallBacks follows the raw data range and the index address.
+      ByteReader tls(tls_view);
+      tls.skip(3ull * pointer_size);
+      read_pointer(tls, &callbacks_va);
+    }
+    ByteView callbacks_view;
+    if (callbacks_va > image_base && image.at(static_cast<uint32_t>(callbacks_va - image_base), &callbacks_view)) {
+      ByteReader callbacks(callbacks_view);
+      uint64_t callback = 0;
+      for (size_t i = 0; read_pointer(callbacks, &callback) && callback > image_base; ++i) {
+        const uint32_t rva = static_cast<uint32_t>(callback - image_base);
+        ghirda::core::Symbol sym{};
+        sym.name = "tls_callback_" + std::to_string(i);
+        sym.address = callback;
+        sym.kind = ghirda::core::SymbolKind::Function;
+        program->add_symbol(sym);
+        add_function_start(rva, 0, ghirda::core::Program::FunctionStartSource::TlsCallback);
+      }
+    }
+  }
+
+  if (dirs[kDirException].virtual_address != 0) {
+    ByteView pdata;
+    if (image.at(dirs[kDirException].virtual_address, dirs[kDirException].size, &pdata)) {
+      add_exception_table(image, file_header.machine, pdata, add_function_start);
+    }
+  }
+
   if (dirs[kDirReloc].virtual_address != 0) {
-    uint32_t reloc_offset = rva_to_file_offset(dirs[kDirReloc].virtual_address, headers_size, sections);
-    uint32_t reloc_size = dirs[kDirReloc].size;
-    if (reloc_offset != 0 && reloc_size != 0) {
-      uint32_t cursor = reloc_offset;
-      uint32_t end = reloc_offset + reloc_size;
-      while (cursor + sizeof(BaseRelocBlock) <= end) {
+    ByteView section_view;
+    ByteView reloc_view;
+    if (image.at(dirs[kDirReloc].virtual_address, &section_view)) {
+      section_view.subview(0, std::min<uint64_t>(dirs[kDirReloc].size, section_view.size()), &reloc_view);
+    }
+    if (!reloc_view.empty()) {
+      // The image is mapped at its preferred base, so the delta is zero and
+      // the relocations are only recorded; targets are still checked and
+      // become pointer references.
+      const uint64_t base_delta = 0;
+      RelocationBatch relocations(program);
+      ByteReader blocks(reloc_view);
+      while (blocks.remaining() >= sizeof(BaseRelocBlock)) {
         BaseRelocBlock block{};
-        in.seekg(static_cast<std::streamoff>(cursor), std::ios::beg);
-        if (!read_exact(in, &block, sizeof(block)) || block.block_size == 0) {
+        if (!blocks.read_bytes(&block, sizeof(block)) || block.block_size < sizeof(BaseRelocBlock)) {
           break;
         }
         uint32_t entry_count = (block.block_size - sizeof(BaseRelocBlock)) / sizeof(uint16_t);
-        std::vector<uint16_t> entries(entry_count);
-        in.read(reinterpret_cast<char*>(entries.data()), entry_count * sizeof(uint16_t));
-        for (uint16_t entry : entries) {
+        relocations.reserve(entry_count);
+        for (uint32_t e = 0; e < entry_count; ++e) {
+          uint16_t entry = 0;
+          if (!blocks.read_u16(&entry)) {
+            break;
+          }
           uint16_t type = entry >> 12;
           uint16_t offset = entry & 0x0fff;
-          uint64_t addr = image_base + block.page_rva + offset;
+          if (type == kRelocAbsolute) {
+            continue;
+          }
           ghirda::core::Relocation reloc{};
-          reloc.address = addr;
+          reloc.address = image_base + block.page_rva + offset;
           reloc.type = type;
-          reloc.symbol = "";
-          reloc.addend = 0;
-          if (type == kRelocHighLow) {
-            uint32_t value = 0;
-            if (program->memory_image().read_u32(addr, &value)) {
-              program->memory_image().write_u32(addr, value);
-              reloc.applied = true;
-            } else {
-              reloc.note = "reloc read failed";
-            }
-          } else if (type == kRelocDir64) {
-            uint64_t value = 0;
-            if (program->memory_image().read_u64(addr, &value)) {
-              program->memory_image().write_u64(addr, value);
-              reloc.applied = true;
-            } else {
-              reloc.note = "reloc read failed";
-            }
+          if (type != kRelocHighLow && type != kRelocDir64) {
+            reloc.status = ghirda::core::RelocationStatus::Unsupported;
+            relocations.record(reloc);
+            continue;
+          }
+          const uint8_t size = type == kRelocHighLow ? sizeof(uint32_t) : sizeof(uint64_t);
+          if (base_delta == 0) {
+            reloc.size = size;
+            relocations.record(reloc, true);
           } else {
-            reloc.note = "unsupported reloc";
+            relocations.add(reloc, base_delta, size);
           }
-          program->add_relocation(reloc);
         }
-        cursor += block.block_size;
       }
+      relocations.commit();
     }
   }
 
   if (dirs[kDirDebug].virtual_address != 0) {
-    uint32_t dbg_offset = rva_to_file_offset(dirs[kDirDebug].virtual_address, headers_size, sections);
-    if (dbg_offset != 0) {
-      size_t count = dirs[kDirDebug].size / sizeof(DebugDirectory);
-      in.seekg(static_cast<std::streamoff>(dbg_offset), std::ios::beg);
-      for (size_t i = 0; i < count; ++i) {
-        DebugDirectory dbg{};
-        if (!read_exact(in, &dbg, sizeof(dbg))) {
-          break;
+    ByteView debug_view;
+    if (image.at(dirs[kDirDebug].virtual_address, dirs[kDirDebug].size, &debug_view)) {
+      ByteReader entries(debug_view);
+      DebugDirectory dbg{};
+      while (entries.read_bytes(&dbg, sizeof(dbg))) {
+        ByteView cv;
+        if (dbg.type != kDebugTypeCodeView || dbg.pointer_to_raw_data == 0 || dbg.size_of_data <= 24 ||
+            !source.view(dbg.pointer_to_raw_data, dbg.size_of_data, &cv)) {
+          continue;
         }
-        if (dbg.type == kDebugTypeCodeView && dbg.pointer_to_raw_data != 0) {
-          std::vector<uint8_t> cv;
-          if (read_blob(in, dbg.pointer_to_raw_data, dbg.size_of_data, &cv) && cv.size() > 24) {
-            if (cv[0] == 'R' && cv[1] == 'S' && cv[2] == 'D' && cv[3] == 'S') {
-              std::string path(reinterpret_cast<const char*>(cv.data() + 24));
-              program->debug_info().pdb_path = path;
-            }
+        if (cv[0] == 'R' && cv[1] == 'S' && cv[2] == 'D' && cv[3] == 'S') {
+          program->debug_info().pdb_path = read_string(cv, 24);
+          uint32_t age = 0;
+          std::memcpy(&age, cv.data() + 20, sizeof(age));
+          if (pdb_enabled_ && !program->debug_info().pdb_path.empty()) {
+            load_pdb(source, cv.data() + 4, age, image_base, program);
           }
         }
       }
     }
   }
 
-  (void)entry_point;
   return true;
 }
 
+void PeLoader::add_pdb_search_dir(std::string dir) { pdb_search_dirs_.push_back(std::move(dir)); }
+
+void PeLoader::set_pdb_options(const PdbIngestOptions& options) { pdb_options_ = options; }
+
+void PeLoader::set_pdb_enabled(bool enabled) { pdb_enabled_ = enabled; }
+
+bool PeLoader::load_pdb(const ByteSource& source, const uint8_t guid[16], uint32_t age, uint64_t image_base,
+                        ghirda::core::Program* program) const {
+  namespace fs = std::filesystem;
+  const std::string& recorded = program->debug_info().pdb_path;
+  // The recorded path is usually a Windows path from the build machine.
+  const size_t slash = recorded.find_last_of("/\\");
+  const std::string file_name = slash == std::string::npos ? recorded : recorded.substr(slash + 1);
+
+  std::vector<std::string> candidates{recorded};
+  if (!source.path().empty()) {
+    candidates.push_back((fs::path(source.path()).parent_path() / file_name).string());
+  }
+  for (const auto& dir : pdb_search_dirs_) {
+    candidates.push_back((fs::path(dir) / file_name).string());
+  }
+  for (const auto& candidate : candidates) {
+    std::error_code ec;
+    if (!fs::is_regular_file(candidate, ec)) {
+      continue;
+    }
+    std::unique_ptr<PdbFile> pdb = PdbFile::open(candidate, nullptr);
+    if (!pdb || !pdb->matches(guid, age)) {
+      continue;
+    }
+    pdb->set_image_base(image_base);
+    if (ingest_pdb(*pdb, program, pdb_options_, nullptr)) {
+      program->debug_info().debug_file = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace ghirda::loader
@@ -0,0 +1,509 @@
+#include "ghirda/loader/raw_loader.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "ghirda/core/address_space.h"
+#include "ghirda/core/memory_map.h"
+
+namespace ghirda::loader {
+namespace {
+
+// Blocks handed to a worker at a time (1 MiB at the default block size).
+constexpr size_t kBlocksPerTask = 256;
+// A block is padding when one byte value fills this share of it.
+constexpr double kPaddingShare = 0.97;
+// Compressed and encrypted data sit close to 8 bits per byte; code rarely
+// exceeds 7.
+constexpr double kHighEntropy = 7.5;
+
+struct PrologueSignature {
+  uint32_t mask = 0;
+  uint32_t value = 0;
+  uint8_t width = 4;
+};
+
+// Function-entry idioms for one architecture and byte order. Candidates are
+// tested every step bytes.
+struct SignatureSet {
+  RawArch arch = RawArch::Unknown;
+  bool big_endian = false;
+  uint8_t step = 4;
+  std::array<PrologueSignature, 3> signatures{};
+};
+
+constexpr std::array<SignatureSet, 12> kSignatureSets{{
+    // push rbp; mov rbp, rsp / endbr64 / sub rsp, imm8
+    {RawArch::X86_64, false, 1, {{{0xffffffff, 0xe5894855, 4}, {0xffffffff, 0xfa1e0ff3, 4}, {0x00ffffff, 0x00ec8348, 4}}}},
+    // push ebp; mov ebp, esp (both encodings) / endbr32
+    {RawArch::X86, false, 1, {{{0x00ffffff, 0x00e58955, 4}, {0x00ffffff, 0x00ec8b55, 4}, {0xffffffff, 0xfb1e0ff3, 4}}}},
+    // push {..., lr}
+    {RawArch::Arm, false, 4, {{{0xffff4000, 0xe92d4000, 4}}}},
+    {RawArch::Arm, true, 4, {{{0xffff4000, 0xe92d4000, 4}}}},
+    // push {..., lr} (16-bit) / push.w {..., lr}
+    {RawArch::Thumb, false, 2, {{{0xff00, 0xb500, 2}, {0x4000ffff, 0x4000e92d, 4}}}},
+    // stp x29, x30, [sp, #-n]! / paciasp / bti c
+    {RawArch::Aarch64, false, 4, {{{0xffc07fff, 0xa9807bfd, 4}, {0xffffffff, 0xd503233f, 4}, {0xffffffff, 0xd503245f, 4}}}},
+    // addi sp, sp, -n / c.addi sp, -16n or c.addi16sp -n followed by
+    // c.sdsp/c.swsp ra (the 16-bit forms alone match too much)
+    {RawArch::RiscV, false, 2, {{{0x800fffff, 0x80010113, 4}, {0xc07fffbf, 0xc0061101, 4}, {0xc07fff83, 0xc0067101, 4}}}},
+    // addiu sp, sp, -n
+    {RawArch::Mips, false, 4, {{{0xffff8000, 0x27bd8000, 4}}}},
+    {RawArch::Mips, true, 4, {{{0xffff8000, 0x27bd8000, 4}}}},
+    // stwu r1, -n(r1) / mflr r0
+    {RawArch::PowerPc, true, 4, {{{0xffff8000, 0x94218000, 4}, {0xffffffff, 0x7c0802a6, 4}}}},
+    {RawArch::PowerPc, false, 4, {{{0xffff8000, 0x94218000, 4}, {0xffffffff, 0x7c0802a6, 4}}}},
+    // stdu r1, -n(r1) (PowerPC64)
+    {RawArch::PowerPc, true, 4, {{{0xffff8003, 0xf8218001, 4}, {0xffffffff, 0x7c0802a6, 4}}}},
+}};
+
+struct BlockStats {
+  float entropy = 0.0f;
+  bool padding = false;
+  std::array<uint32_t, kSignatureSets.size()> hits{};
+};
+
+// Byte histogram over four interleaved count tables, so consecutive bytes
+// with the same value do not serialize on one counter.
+void byte_histogram(const uint8_t* data, size_t size, std::array<uint32_t, 256>* counts) {
+  uint32_t lanes[4][256] = {};
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    ++lanes[0][data[i]];
+    ++lanes[1][data[i + 1]];
+    ++lanes[2][data[i + 2]];
+    ++lanes[3][data[i + 3]];
+  }
+  for (; i < size; ++i) {
+    ++lanes[0][data[i]];
+  }
+  for (size_t b = 0; b < 256; ++b) {
+    (*counts)[b] = lanes[0][b] + lanes[1][b] + lanes[2][b] + lanes[3][b];
+  }
+}
+
+uint32_t load_word(const uint8_t* data, uint8_t width, bool big_endian) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < width; ++i) {
+    const uint32_t byte = data[i];
+    value |= big_endian ? byte << (8 * (width - 1 - i)) : byte << (8 * i);
+  }
+  return value;
+}
+
+// Cheap first test for a set: the byte at offset into a candidate must be
+// one the set's signatures allow there. offset is the byte position their
+// masks constrain most, so most positions are rejected with one lookup.
+struct SetFilter {
+  uint8_t offset = 0;
+  std::array<bool, 256> allowed{};
+};
+
+SetFilter make_filter(const SignatureSet& set) {
+  // Memory byte k of a width-byte pattern.
+  auto byte_of = [&](uint32_t word, uint8_t width, uint8_t k) {
+    const unsigned shift = set.big_endian ? 8 * (width - 1 - k) : 8 * k;
+    return static_cast<uint8_t>(word >> shift);
+  };
+  uint8_t width = 4;
+  for (const PrologueSignature& sig : set.signatures) {
+    if (sig.mask != 0) {
+      width = std::min(width, sig.width);
+    }
+  }
+  SetFilter filter;
+  int best = -1;
+  for (uint8_t k = 0; k < width; ++k) {
+    int weakest = 8;
+    for (const PrologueSignature& sig : set.signatures) {
+      if (sig.mask != 0) {
+        weakest = std::min(weakest, std::popcount(byte_of(sig.mask, sig.width, k)));
+      }
+    }
+    if (weakest > best) {
+      best = weakest;
+      filter.offset = k;
+    }
+  }
+  for (const PrologueSignature& sig : set.signatures) {
+    if (sig.mask == 0) {
+      continue;
+    }
+    const uint8_t mask = byte_of(sig.mask, sig.width, filter.offset);
+    const uint8_t value = byte_of(sig.value, sig.width, filter.offset);
+    for (size_t b = 0; b < 256; ++b) {
+      if ((b & mask) == value) {
+        filter.allowed[b] = true;
+      }
+    }
+  }
+  return filter;
+}
+
+// Counts prologue matches starting inside [0, size); data may extend up to
+// three bytes further so matches straddling the block end are seen.
+uint32_t count_prologues(const SignatureSet& set, const SetFilter& filter, const uint8_t* data, size_t size,
+                         size_t available) {
+  const bool swap = set.big_endian != (std::endian::native == std::endian::big);
+  uint32_t hits = 0;
+  for (size_t pos = 0; pos < size; pos += set.step) {
+    if (pos + filter.offset >= available || !filter.allowed[data[pos + filter.offset]]) {
+      continue;
+    }
+    // One 4-byte load serves every signature; 2-byte patterns take the half
+    // that comes first in memory.
+    uint32_t word = 0;
+    const bool full = pos + sizeof(word) <= available;
+    if (full) {
+      std::memcpy(&word, data + pos, sizeof(word));
+      word = swap ? __builtin_bswap32(word) : word;
+    }
+    for (const PrologueSignature& sig : set.signatures) {
+      if (sig.mask == 0 || pos + sig.width > available) {
+        continue;
+      }
+      uint32_t value = 0;
+      if (!full) {
+        value = load_word(data + pos, sig.width, set.big_endian);
+      } else if (sig.width == 2) {
+        value = set.big_endian ? word >> 16 : word & 0xffff;
+      } else {
+        value = word;
+      }
+      if ((value & sig.mask) == sig.value) {
+        ++hits;
+        break;
+      }
+    }
+  }
+  return hits;
+}
+
+// Matches expected per block from uniformly random bytes; a block must beat
+// it clearly to count as code.
+double chance_hits(const SignatureSet& set, uint32_t block_size) {
+  double expected = 0.0;
+  for (const PrologueSignature& sig : set.signatures) {
+    if (sig.mask != 0) {
+      expected += static_cast<double>(block_size / set.step) / std::ldexp(1.0, std::popcount(sig.mask));
+    }
+  }
+  return expected;
+}
+
+uint32_t code_threshold(const SignatureSet& set, uint32_t block_size) {
+  return static_cast<uint32_t>(std::ceil(2.0 * chance_hits(set, block_size))) + 2;
+}
+
+void scan_block(const uint8_t* data, size_t size, size_t available, const std::vector<size_t>& sets,
+                const std::vector<SetFilter>& filters, BlockStats* out) {
+  std::array<uint32_t, 256> counts{};
+  byte_histogram(data, size, &counts);
+  double entropy = 0.0;
+  uint32_t dominant = 0;
+  for (uint32_t count : counts) {
+    dominant = std::max(dominant, count);
+    if (count != 0) {
+      const double p = static_cast<double>(count) / static_cast<double>(size);
+      entropy -= p * std::log2(p);
+    }
+  }
+  out->entropy = static_cast<float>(entropy);
+  out->padding = static_cast<double>(dominant) >= kPaddingShare * static_cast<double>(size);
+  if (out->padding) {
+    return;
+  }
+  for (size_t i = 0; i < sets.size(); ++i) {
+    out->hits[sets[i]] = count_prologues(kSignatureSets[sets[i]], filters[i], data, size, available);
+  }
+}
+
+BlobRegionKind classify(const BlockStats& block, const SignatureSet* set, uint32_t threshold) {
+  if (block.padding) {
+    return BlobRegionKind::Padding;
+  }
+  if (block.entropy >= kHighEntropy) {
+    return BlobRegionKind::HighEntropy;
+  }
+  if (set && block.hits[static_cast<size_t>(set - kSignatureSets.data())] >= threshold) {
+    return BlobRegionKind::Code;
+  }
+  return BlobRegionKind::Data;
+}
+
+ghirda::core::Processor to_processor(RawArch arch) {
+  switch (arch) {
+    case RawArch::X86_64:
+      return ghirda::core::Processor::X86_64;
+    case RawArch::X86:
+      return ghirda::core::Processor::X86;
+    case RawArch::Arm:
+    case RawArch::Thumb:
+      return ghirda::core::Processor::Arm;
+    case RawArch::Aarch64:
+      return ghirda::core::Processor::Aarch64;
+    case RawArch::RiscV:
+      return ghirda::core::Processor::RiscV;
+    case RawArch::Mips:
+      return ghirda::core::Processor::Mips;
+    case RawArch::PowerPc:
+      return ghirda::core::Processor::PowerPc;
+    default:
+      return ghirda::core::Processor::Unknown;
+  }
+}
+
+} // namespace
+
+const char* raw_arch_name(RawArch arch) {
+  switch (arch) {
+    case RawArch::X86_64:
+      return "x86_64";
+    case RawArch::X86:
+      return "x86";
+    case RawArch::Arm:
+      return "arm";
+    case RawArch::Thumb:
+      return "thumb";
+    case RawArch::Aarch64:
+      return "aarch64";
+    case RawArch::RiscV:
+      return "riscv";
+    case RawArch::Mips:
+      return "mips";
+    case RawArch::PowerPc:
+      return "powerpc";
+    default:
+      return "unknown";
+  }
+}
+
+bool parse_raw_arch(std::string_view name, RawArch* arch) {
+  for (RawArch candidate : {RawArch::Unknown, RawArch::X86_64, RawArch::X86, RawArch::Arm, RawArch::Thumb,
+                            RawArch::Aarch64, RawArch::RiscV, RawArch::Mips, RawArch::PowerPc}) {
+    if (name == raw_arch_name(candidate)) {
+      *arch = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+RawLoader::RawLoader(RawLoaderOptions options) : options_(options) {}
+
+void RawLoader::set_options(const RawLoaderOptions& options) { options_ = options; }
+const RawLoaderOptions& RawLoader::options() const { return options_; }
+const BlobScan& RawLoader::last_scan() const { return last_scan_; }
+
+bool RawLoader::scan(const ByteSource& source, const RawLoaderOptions& options, BlobScan* out, std::string* error) {
+  *out = BlobScan{};
+  if (options.offset > source.size() || options.block_size == 0) {
+    if (error) {
+      *error = "raw window outside the source";
+    }
+    return false;
+  }
+  const uint64_t length = options.size == 0 ? source.size() - options.offset : options.size;
+  if (length > source.size() - options.offset) {
+    if (error) {
+      *error = "raw window outside the source";
+    }
+    return false;
+  }
+  if (length == 0) {
+    return true;
+  }
+
+  std::vector<size_t> sets;
+  for (size_t i = 0; i < kSignatureSets.size(); ++i) {
+    const SignatureSet& set = kSignatureSets[i];
+    const bool bi_endian = set.arch == RawArch::Arm || set.arch == RawArch::Mips || set.arch == RawArch::PowerPc;
+    if (options.arch == RawArch::Unknown ||
+        (set.arch == options.arch && (!bi_endian || set.big_endian == options.big_endian))) {
+      sets.push_back(i);
+    }
+  }
+  std::vector<SetFilter> filters;
+  for (size_t set : sets) {
+    filters.push_back(make_filter(kSignatureSets[set]));
+  }
+
+  const uint32_t block_size = options.block_size;
+  const size_t block_count = static_cast<size_t>((length + block_size - 1) / block_size);
+  std::vector<BlockStats> blocks(block_count);
+  const size_t task_count = (block_count + kBlocksPerTask - 1) / kBlocksPerTask;
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  auto worker = [&]() {
+    while (true) {
+      const size_t task = next.fetch_add(1, std::memory_order_relaxed);
+      if (task >= task_count) {
+        break;
+      }
+      const size_t first = task * kBlocksPerTask;
+      const size_t last = std::min(block_count, first + kBlocksPerTask);
+      const uint64_t start = static_cast<uint64_t>(first) * block_size;
+      const uint64_t end = std::min<uint64_t>(length, static_cast<uint64_t>(last) * block_size);
+      // One view per task, with a few bytes of tail for straddling matches.
+      const uint64_t tail = std::min<uint64_t>(3, length - end);
+      ByteView view;
+      if (!source.view(options.offset + start, end - start + tail, &view)) {
+        failed.store(true, std::memory_order_relaxed);
+        break;
+      }
+      for (size_t b = first; b < last; ++b) {
+        const size_t local = static_cast<size_t>(static_cast<uint64_t>(b - first) * block_size);
+        const size_t size = std::min<size_t>(block_size, static_cast<size_t>(end - start) - local);
+        scan_block(view.data() + local, size, view.size() - local, sets, filters, &blocks[b]);
+      }
+    }
+  };
+
+  size_t thread_count = options.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> threads;
+  const size_t workers = std::min(thread_count, task_count);
+  for (size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (failed.load()) {
+    if (error) {
+      *error = "failed to read raw image";
+    }
+    return false;
+  }
+
+  // The architecture is the set whose matches most exceed chance.
+  const SignatureSet* chosen = nullptr;
+  double best = 0.0;
+  for (size_t set : sets) {
+    const double chance = chance_hits(kSignatureSets[set], block_size);
+    double score = 0.0;
+    for (const BlockStats& block : blocks) {
+      if (!block.padding) {
+        score += std::max(0.0, static_cast<double>(block.hits[set]) - chance);
+      }
+    }
+    if (score > best) {
+      best = score;
+      chosen = &kSignatureSets[set];
+    }
+  }
+  const uint32_t threshold = chosen ? code_threshold(*chosen, block_size) : 0;
+  if (chosen) {
+    out->arch = chosen->arch;
+    out->big_endian = chosen->big_endian;
+  }
+
+  std::vector<BlobRegionKind> kinds(block_count);
+  for (size_t b = 0; b < block_count; ++b) {
+    kinds[b] = classify(blocks[b], chosen, threshold);
+  }
+  // Long functions leave blocks without an entry; a data block between two
+  // code blocks is taken as code.
+  for (size_t b = 1; b + 1 < block_count; ++b) {
+    if (kinds[b] == BlobRegionKind::Data && kinds[b - 1] == BlobRegionKind::Code &&
+        kinds[b + 1] == BlobRegionKind::Code) {
+      kinds[b] = BlobRegionKind::Code;
+    }
+  }
+
+  const size_t chosen_index = chosen ? static_cast<size_t>(chosen - kSignatureSets.data()) : 0;
+  size_t run_start = 0;
+  double entropy_sum = 0.0;
+  uint32_t prologues = 0;
+  for (size_t b = 0; b < block_count; ++b) {
+    entropy_sum += blocks[b].entropy;
+    prologues += chosen ? blocks[b].hits[chosen_index] : 0;
+    if (b + 1 < block_count && kinds[b + 1] == kinds[b]) {
+      continue;
+    }
+    BlobRegion region{};
+    region.start = options.base_address + static_cast<uint64_t>(run_start) * block_size;
+    region.size = std::min<uint64_t>(length, static_cast<uint64_t>(b + 1) * block_size) -
+                  static_cast<uint64_t>(run_start) * block_size;
+    region.kind = kinds[b];
+    region.entropy = entropy_sum / static_cast<double>(b + 1 - run_start);
+    region.prologues = prologues;
+    out->regions.push_back(region);
+    run_start = b + 1;
+    entropy_sum = 0.0;
+    prologues = 0;
+  }
+  return true;
+}
+
+// Any non-empty input can be mapped raw, so this only ever wins as the
+// fallback.
+uint32_t RawLoader::probe(std::span<const uint8_t> header) const { return header.empty() ? 0 : 1; }
+
+bool RawLoader::load(const ByteSource& source, ghirda::core::Program* program, std::string* error) {
+  if (!program) {
+    if (error) {
+      *error = "program output is null";
+    }
+    return false;
+  }
+
+  BlobScan result;
+  if (!scan(source, options_, &result, error)) {
+    return false;
+  }
+  const uint64_t length = options_.size == 0 ? source.size() - options_.offset : options_.size;
+  if (length == 0) {
+    if (error) {
+      *error = "raw image is empty";
+    }
+    return false;
+  }
+
+  // Map the window in place when the source can share its backing (an mmap),
+  // so multi-GB dumps are not duplicated; otherwise copy it.
+  ByteView window;
+  if (source.view(options_.offset, length, &window) && window.owner()) {
+    program->memory_image().map_view(options_.base_address, window.data(), window.size(), window.owner());
+  } else {
+    std::vector<uint8_t> bytes;
+    if (!source.read_blob(options_.offset, length, &bytes)) {
+      if (error) {
+        *error = "failed to read raw image";
+      }
+      return false;
+    }
+    program->memory_image().map_segment(options_.base_address, std::move(bytes));
+  }
+  program->add_address_space(ghirda::core::AddressSpace("ram", options_.base_address, length));
+  program->set_load_bias(options_.base_address);
+  program->set_processor(to_processor(result.arch));
+
+  ghirda::core::Program::Segment seg{};
+  seg.vaddr = options_.base_address;
+  seg.memsz = length;
+  seg.filesz = length;
+  program->add_segment(seg);
+
+  for (const BlobRegion& region : result.regions) {
+    ghirda::core::MemoryRegion mapped{};
+    mapped.start = region.start;
+    mapped.size = region.size;
+    mapped.readable = true;
+    mapped.executable = region.kind == BlobRegionKind::Code;
+    program->memory_map().add_region(mapped);
+  }
+
+  last_scan_ = std::move(result);
+  return true;
+}
+
+} // namespace ghirda::loader
@@ -0,0 +1,102 @@
+#include "ghirda/loader/relocation_batch.h"
+
+#include <algorithm>
+
+namespace ghirda::loader {
+
+RelocationBatch::RelocationBatch(ghirda::core::Program* program, Endian endian)
+    : program_(program), endian_(endian) {}
+
+uint32_t RelocationBatch::intern(std::string_view name) { return program_->relocations().intern(name); }
+
+const std::string& RelocationBatch::symbol_name(uint32_t id) const {
+  return program_->relocations().symbol_name(id);
+}
+
+void RelocationBatch::reserve(size_t count) { entries_.reserve(entries_.size() + count); }
+
+void RelocationBatch::store(const ghirda::core::Relocation& record, uint64_t value, uint8_t size, bool pointer) {
+  entries_.push_back(Entry{record, value, size, Mode::Store, pointer});
+}
+
+void RelocationBatch::add(const ghirda::core::Relocation& record, uint64_t delta, uint8_t size, bool pointer) {
+  entries_.push_back(Entry{record, delta, size, Mode::Add, pointer});
+}
+
+void RelocationBatch::record(const ghirda::core::Relocation& record, bool pointer) {
+  entries_.push_back(Entry{record, 0, record.size, Mode::None, pointer});
+}
+
+size_t RelocationBatch::pending() const { return entries_.size(); }
+
+bool RelocationBatch::read_word(const ghirda::core::MemoryImage& image, const Entry& entry, uint64_t* out) const {
+  if (entry.mode == Mode::Store) {
+    *out = entry.size == 4 ? static_cast<uint32_t>(entry.value) : entry.value;
+    return true;
+  }
+  // Added words hold the sum only once applied, and recorded ones what the
+  // image already stores, so read them back.
+  if (entry.size == 4) {
+    uint32_t word = 0;
+    if (!image.read_u32(entry.record.address, &word)) {
+      return false;
+    }
+    *out = endian_ == Endian::Big ? __builtin_bswap32(word) : word;
+    return true;
+  }
+  uint64_t word = 0;
+  if (!image.read_u64(entry.record.address, &word)) {
+    return false;
+  }
+  *out = endian_ == Endian::Big ? __builtin_bswap64(word) : word;
+  return true;
+}
+
+size_t RelocationBatch::commit() {
+  // Tables such as RELR and PE base relocations arrive in address order.
+  const auto by_address = [](const Entry& a, const Entry& b) { return a.record.address < b.record.address; };
+  if (!std::is_sorted(entries_.begin(), entries_.end(), by_address)) {
+    std::stable_sort(entries_.begin(), entries_.end(), by_address);
+  }
+  std::vector<ghirda::core::ImageWrite> writes;
+  writes.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    if (entry.mode != Mode::None) {
+      writes.push_back(ghirda::core::ImageWrite{entry.record.address, entry.value, entry.size, entry.mode == Mode::Add,
+                                                false});
+    }
+  }
+  // Stable on already sorted input, so writes stay aligned with entries_.
+  const size_t applied = program_->memory_image().apply_writes(&writes, endian_ == Endian::Big);
+
+  const ghirda::core::MemoryImage& image = program_->memory_image();
+  ghirda::core::RelocationTable& table = program_->relocations();
+  ghirda::core::ReferenceDatabase& references = program_->references();
+  table.reserve(table.size() + entries_.size());
+  size_t next_write = 0;
+  for (Entry& entry : entries_) {
+    if (entry.mode != Mode::None) {
+      entry.record.size = entry.size;
+      const bool landed = writes[next_write++].applied;
+      entry.record.status =
+          landed ? ghirda::core::RelocationStatus::Applied : ghirda::core::RelocationStatus::Unmapped;
+      uint64_t target = 0;
+      if (landed && entry.pointer && read_word(image, entry, &target) && image.contains(target)) {
+        references.add(entry.record.address, target, ghirda::core::ReferenceType::Pointer);
+      }
+    } else if (entry.pointer && entry.size != 0) {
+      uint64_t target = 0;
+      if (!read_word(image, entry, &target)) {
+        entry.record.status = ghirda::core::RelocationStatus::Unmapped;
+      } else if (image.contains(target)) {
+        references.add(entry.record.address, target, ghirda::core::ReferenceType::Pointer);
+      }
+    }
+    table.add(entry.record);
+  }
+  entries_.clear();
+  references.finalize();
+  return applied;
+}
+
+} // namespace ghirda::loader
@@ -0,0 +1,289 @@
+#include "ghirda/loader/split_dwarf.h"
+
+#include "ghirda/loader/debug_section.h"
+#include "ghirda/loader/elf_sections.h"
+
+namespace ghirda::loader {
+namespace {
+
+constexpr char kCuIndexName[] = ".debug_cu_index";
+constexpr uint64_t kCuIndexHeaderSize = 16;
+
+// DW_SECT_* column ids. Versions 2 (GNU) and 5 agree on everything the reader
+// consumes except id 8, which is DW_SECT_RNGLISTS only in version 5.
+constexpr uint32_t kSectInfo = 1;
+constexpr uint32_t kSectAbbrev = 3;
+constexpr uint32_t kSectLine = 4;
+constexpr uint32_t kSectStrOffsets = 6;
+constexpr uint32_t kSectRnglists = 8;
+
+std::string dir_name(const std::string& path) {
+  size_t slash = path.rfind('/');
+  if (slash == std::string::npos) {
+    return ".";
+  }
+  return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+std::string base_name(const std::string& path) {
+  size_t slash = path.rfind('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+std::string join_path(const std::string& dir, const std::string& file) {
+  if (dir.empty() || (!file.empty() && file[0] == '/')) {
+    return file;
+  }
+  return dir.back() == '/' ? dir + file : dir + "/" + file;
+}
+
+// Narrows a whole package section to one unit's contribution. The slice
+// keeps the package section alive, and with it the mapping.
+bool slice_section(const DwarfSection& whole, uint64_t offset, uint64_t size, DwarfSection* out) {
+  const ByteView* view = whole.view();
+  ByteView slice;
+  if (!view || !view->subview(offset, size, &slice)) {
+    return false;
+  }
+  out->section = std::make_shared<DebugSection>(whole.section->name(),
+                                                 ByteView(slice.data(), slice.size(), whole.section));
+  return true;
+}
+
+} // namespace
+
+struct SplitDwarfResolver::Package {
+  std::shared_ptr<ByteSource> source;
+  DwarfSections sections;
+  std::shared_ptr<DebugSection> cu_index;
+  const ByteView* index = nullptr;
+  uint32_t version = 0;
+  uint32_t section_count = 0;
+  uint32_t unit_count = 0;
+  uint32_t slot_count = 0;
+
+  uint64_t u64_at(uint64_t offset) const {
+    uint64_t value = 0;
+    ByteReader reader(*index);
+    reader.seek(offset);
+    reader.read_u64(&value);
+    return value;
+  }
+
+  uint32_t u32_at(uint64_t offset) const {
+    uint32_t value = 0;
+    ByteReader reader(*index);
+    reader.seek(offset);
+    reader.read_u32(&value);
+    return value;
+  }
+
+  // Open-addressed lookup as specified for DWARF packages: the low bits of
+  // the signature pick the slot, the high bits the (odd) probe step.
+  uint32_t find_row(uint64_t signature) const {
+    const uint64_t mask = slot_count - 1;
+    const uint64_t step = ((signature >> 32) & mask) | 1;
+    uint64_t slot = signature & mask;
+    for (uint32_t probe = 0; probe < slot_count; ++probe) {
+      const uint32_t row = u32_at(kCuIndexHeaderSize + 8ull * slot_count + 4ull * slot);
+      if (row == 0) {
+        return 0;
+      }
+      if (u64_at(kCuIndexHeaderSize + 8ull * slot) == signature) {
+        return row <= unit_count ? row : 0;
+      }
+      slot = (slot + step) & mask;
+    }
+    return 0;
+  }
+};
+
+SplitDwarfResolver::SplitDwarfResolver(std::string image_path) : image_path_(std::move(image_path)) {
+  if (!image_path_.empty()) {
+    package_path_ = image_path_ + ".dwp";
+    search_dirs_.push_back(dir_name(image_path_));
+  }
+}
+
+SplitDwarfResolver::~SplitDwarfResolver() = default;
+
+void SplitDwarfResolver::set_package_path(std::string path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  package_path_ = std::move(path);
+  package_opened_ = false;
+  package_.reset();
+}
+
+void SplitDwarfResolver::add_search_dir(std::string dir) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  search_dirs_.push_back(std::move(dir));
+}
+
+SplitDwarfStats SplitDwarfResolver::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+bool SplitDwarfResolver::resolve(uint64_t dwo_id, const std::string& dwo_name, const std::string& comp_dir,
+                                 DwarfSections* out, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.requested;
+  *out = DwarfSections{};
+  if (open_package() && resolve_in_package(dwo_id, out)) {
+    ++stats_.from_package;
+    return true;
+  }
+  if (resolve_dwo(dwo_name, comp_dir, out, error)) {
+    ++stats_.from_dwo;
+    return true;
+  }
+  ++stats_.missing;
+  return false;
+}
+
+bool SplitDwarfResolver::open_package() {
+  if (package_opened_) {
+    return package_ != nullptr;
+  }
+  package_opened_ = true;
+  if (package_path_.empty()) {
+    return false;
+  }
+  // Map rather than read: only the index and the requested contributions are
+  // ever paged in, however large the package is.
+  std::shared_ptr<ByteSource> source = MmapByteSource::open(package_path_, nullptr);
+  std::vector<ElfSectionHeader> headers;
+  if (!source || !read_elf_section_headers(*source, &headers, nullptr)) {
+    return false;
+  }
+
+  auto package = std::make_unique<Package>();
+  package->source = source;
+  collect_dwarf_sections(*source, headers, true, &package->sections, nullptr, nullptr);
+  for (const auto& header : headers) {
+    if (header.name == kCuIndexName) {
+      package->cu_index = DebugSection::from_elf(*source, header.name, header.offset, header.size, header.flags,
+                                                 true, Endian::Little, nullptr);
+      break;
+    }
+  }
+  if (!package->cu_index || !package->sections.debug_info.present()) {
+    return false;
+  }
+  package->index = package->cu_index->view();
+  if (!package->index) {
+    return false;
+  }
+
+  ByteReader reader(*package->index);
+  if (!reader.read_u32(&package->version) || !reader.read_u32(&package->section_count) ||
+      !reader.read_u32(&package->unit_count) || !reader.read_u32(&package->slot_count)) {
+    return false;
+  }
+  // Version 5 stores a 16-bit version and 16-bit padding; as a little-endian
+  // word it reads the same as the GNU version-2 header.
+  if (package->version != 2 && package->version != 5) {
+    return false;
+  }
+  const uint64_t table_size = 12ull * package->slot_count +
+                              4ull * package->section_count * (1 + 2ull * package->unit_count);
+  if ((package->slot_count & (package->slot_count - 1)) != 0 ||
+      table_size > package->index->size() - kCuIndexHeaderSize) {
+    return false;
+  }
+  package_ = std::move(package);
+  return true;
+}
+
+bool SplitDwarfResolver::resolve_in_package(uint64_t dwo_id, DwarfSections* out) {
+  const Package& package = *package_;
+  const uint32_t row = package.find_row(dwo_id);
+  if (row == 0) {
+    return false;
+  }
+  const uint64_t columns = kCuIndexHeaderSize + 12ull * package.slot_count;
+  const uint64_t offsets = columns + 4ull * package.section_count;
+  const uint64_t sizes = offsets + 4ull * package.section_count * package.unit_count;
+  const uint64_t row_start = 4ull * package.section_count * (row - 1);
+
+  for (uint32_t column = 0; column < package.section_count; ++column) {
+    const uint32_t id = package.u32_at(columns + 4ull * column);
+    const uint64_t offset = package.u32_at(offsets + row_start + 4ull * column);
+    const uint64_t size = package.u32_at(sizes + row_start + 4ull * column);
+    const DwarfSection* whole = nullptr;
+    DwarfSection* slot = nullptr;
+    switch (id) {
+      case kSectInfo:
+        whole = &package.sections.debug_info;
+        slot = &out->debug_info;
+        break;
+      case kSectAbbrev:
+        whole = &package.sections.debug_abbrev;
+        slot = &out->debug_abbrev;
+        break;
+      case kSectLine:
+        whole = &package.sections.debug_line;
+        slot = &out->debug_line;
+        break;
+      case kSectStrOffsets:
+        whole = &package.sections.debug_str_offsets;
+        slot = &out->debug_str_offsets;
+        break;
+      case kSectRnglists:
+        if (package.version >= 5) {
+          whole = &package.sections.debug_rnglists;
+          slot = &out->debug_rnglists;
+        }
+        break;
+      default:
+        break;
+    }
+    if (whole && whole->present() && !slice_section(*whole, offset, size, slot)) {
+      return false;
+    }
+  }
+  // Strings are pooled across the package, so the unit shares the whole table.
+  out->debug_str = package.sections.debug_str;
+  return out->debug_info.present() && out->debug_abbrev.present();
+}
+
+bool SplitDwarfResolver::resolve_dwo(const std::string& dwo_name, const std::string& comp_dir, DwarfSections* out,
+                                     std::string* error) {
+  if (dwo_name.empty()) {
+    if (error) {
+      *error = "split unit has no dwo name";
+    }
+    return false;
+  }
+  std::vector<std::string> candidates{join_path(comp_dir, dwo_name)};
+  for (const auto& dir : search_dirs_) {
+    candidates.push_back(join_path(dir, dwo_name));
+    candidates.push_back(join_path(dir, base_name(dwo_name)));
+  }
+
+  for (const auto& path : candidates) {
+    auto cached = dwo_files_.find(path);
+    if (cached != dwo_files_.end()) {
+      *out = cached->second;
+      return true;
+    }
+    auto source = MmapByteSource::open(path, nullptr);
+    std::vector<ElfSectionHeader> headers;
+    if (!source || !read_elf_section_headers(*source, &headers, nullptr)) {
+      continue;
+    }
+    DwarfSections sections{};
+    collect_dwarf_sections(*source, headers, true, &sections, nullptr, nullptr);
+    if (!sections.debug_info.present() || !sections.debug_abbrev.present()) {
+      continue;
+    }
+    *out = dwo_files_.emplace(path, std::move(sections)).first->second;
+    return true;
+  }
+  if (error) {
+    *error = "split unit " + dwo_name + " not found";
+  }
+  return false;
+}
+
+} // namespace ghirda::loader
@@ -1,9 +1,21 @@
 #include "ghirda/plugin/registry.h"
 
+#include <utility>
+
 namespace ghirda::plugin {
 
 void Registry::register_plugin(const PluginInfo& info) { plugins_.push_back(info); }
 
 const std::vector<PluginInfo>& Registry::plugins() const { return plugins_; }
 
+void Registry::register_loader(LoaderContribution contribution) { loaders_.push_back(std::move(contribution)); }
+
+const std::vector<LoaderContribution>& Registry::loaders() const { return loaders_; }
+
+void Registry::install_loaders(ghirda::loader::LoaderRegistry* registry) const {
+  for (const LoaderContribution& contribution : loaders_) {
+    registry->add(contribution.name, contribution.factory);
+  }
+}
+
 } // namespace ghirda::plugin